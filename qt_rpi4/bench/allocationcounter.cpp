@@ -0,0 +1,68 @@
+#include "allocationcounter.h"
+#include <atomic>
+#include <cstdlib>
+
+namespace {
+std::atomic<quint64> g_allocationCount{0};
+std::atomic<quint64> g_allocatedBytes{0};
+}
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+// These definitions take precedence over the ones of the C library for the whole process
+void* malloc(size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(count * size, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+
+bool AllocationCounter::isSupported()
+{
+    return true;
+}
+
+#else
+
+bool AllocationCounter::isSupported()
+{
+    return false;
+}
+
+#endif
+
+quint64 AllocationCounter::count()
+{
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+quint64 AllocationCounter::bytes()
+{
+    return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::reset()
+{
+    g_allocationCount.store(0, std::memory_order_relaxed);
+    g_allocatedBytes.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/*
+ * Counts heap allocations (malloc, calloc, realloc) of the whole process.
+ * Qt allocates its containers with malloc directly, so counting operator new alone
+ * wouldn't be enough. Only supported with glibc, where malloc can be interposed.
+ */
+namespace AllocationCounter
+{
+    bool isSupported();
+    quint64 count();
+    // Requested bytes, a realloc counts with its new size
+    quint64 bytes();
+    void reset();
+}
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,32 @@
+#include <QCoreApplication>
+#include <QTest>
+#include "logformatbench.h"
+#include "logcategorybench.h"
+#include "configparsebench.h"
+#include "weathermodelbench.h"
+#include "forecastdecoderbench.h"
+#include "forecastseriesbench.h"
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    // Use a lambda function to avoid writing the same code for each benchmark suite
+    int status = 0;
+    auto RUN_BENCHMARK = [&status, argc, argv](QObject* obj) {
+        status |= QTest::qExec(obj, argc, argv);
+        delete obj;
+    };
+
+    // Add new benchmarks here...
+    RUN_BENCHMARK(new LogFormatBench());
+    RUN_BENCHMARK(new LogCategoryBench());
+    RUN_BENCHMARK(new ConfigParseBench());
+    RUN_BENCHMARK(new WeatherModelBench());
+    RUN_BENCHMARK(new ForecastDecoderBench());
+    RUN_BENCHMARK(new ForecastSeriesBench());
+
+    qInfo() << "Benchmark status: " << status;
+
+    return status;
+}
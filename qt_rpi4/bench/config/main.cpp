@@ -0,0 +1,444 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <configcache.h>
+#include <configkey.h>
+#include <configmanager.h>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+/*
+ * The ConfigManager is a singleton and the peak memory of a process only grows, so every
+ * key count runs in a child process of its own:
+ *   rpi4_bench_config --run --file config_1000.ini --keys 1000
+ * The parent generates the files, runs the children and writes their results as one JSON
+ * document, to stdout or to the --output file.
+ *
+ * Per key count:
+ *   parseMsecs             ConfigCache::load() without the cache, i.e. reading and parsing
+ *   coldLoadMsecs          ConfigCache::load() without an image: parsing and queueing the
+ *                          image, which is written in the background outside of the timing
+ *   warmStartMsecs         The first load with an image: mapping and checking it, as at the
+ *                          start of a process (a single load)
+ *   warmLoadMsecs          Later loads, which share the table decoded from the image
+ *   initialiseMsecs        ConfigManager::initialise() without the cache: parsing, layers,
+ *                          snapshot, section index and history. initialise() keeps the snapshot
+ *                          of an unchanged file, so the loads alternate between the file and a
+ *                          copy with another Weather/Latitude and every one of them publishes.
+ *   initialiseCachedMsecs  The same with a valid cache for both files
+ *   baselineRssKb/peakRssKb  Peak resident memory before and after the first initialise()
+ *   lookups                Lookups/s of getValue(), getValue().toInt() and ConfigKey<int> on
+ *                          1..n reader threads at once
+ */
+
+namespace {
+
+struct Options
+{
+    QString fileName;
+    int keyCount = 0;
+    QList<int> threadCounts;
+    int lookupsPerThread = 0;
+    int repeat = 0;
+};
+
+// Keys read by the lookup benchmarks, at most that many different ones
+constexpr int MaxLookupKeys = 1024;
+
+// The generated files: the usual sections plus [Zone/N] sections of 10 keys each, like the
+// ones of ConfigParseBench
+QByteArray configuration(int keyCount)
+{
+    QByteArray content = "[Weather]\nOpenWeatherApiKey=0123456789abcdef\nLatitude=52.52\nLongitude=13.40\n"
+                         "[Logging]\nLogToFile=true\nLogToConsole=false\nFileName=greenoasis.log\n";
+    for (int key = 0; key < keyCount - 6; ++key)
+    {
+        if (key % 10 == 0)
+            content += "[Zone/" + QByteArray::number(key / 10) + "]\n";
+        content += "Setting" + QByteArray::number(key % 10) + " = " + QByteArray::number(key * 7) + "\n";
+    }
+    return content;
+}
+
+// A copy of the file with another Weather/Latitude, next to it
+QString writeAlternateFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    QByteArray content = file.readAll();
+    content.replace("Latitude=52.52", "Latitude=52.53");
+
+    const QFileInfo info(fileName);
+    const QString alternateFileName = info.dir().filePath(info.completeBaseName() + "_alternate.ini");
+    QFile alternate(alternateFileName);
+    if (!alternate.open(QIODevice::WriteOnly | QIODevice::Truncate) || alternate.write(content) != content.size())
+        return QString();
+    // Files modified within ConfigCache::SettleMsecs don't get a cache
+    alternate.flush();
+    alternate.setFileTime(QDateTime::currentDateTime().addSecs(-60), QFileDevice::FileModificationTime);
+    return alternateFileName;
+}
+
+// Zone keys spread over the whole file, all of them have an int value
+QStringList lookupKeys(int keyCount)
+{
+    const int zoneKeyCount = qMax(0, keyCount - 6);
+    const int count = qMin(zoneKeyCount, MaxLookupKeys);
+    QStringList keys;
+    keys.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        // A prime stride, so that consecutive lookups don't hit neighbouring entries
+        const int key = static_cast<int>((static_cast<qint64>(i) * 7919) % zoneKeyCount);
+        keys.append(QString("Zone/%1/Setting%2").arg(key / 10).arg(key % 10));
+    }
+    return keys;
+}
+
+qint64 peakRssKb()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+template<typename Function>
+double medianMsecs(int repeat, Function function)
+{
+    std::vector<double> msecs;
+    for (int i = 0; i < repeat; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        function();
+        msecs.push_back(static_cast<double>(timer.nsecsElapsed()) / 1e6);
+    }
+    return median(msecs);
+}
+
+// Runs lookup(thread, n) lookupsPerThread times on every thread at once, returns lookups/s
+template<typename Lookup>
+double lookupsPerSecond(int threadCount, int lookupsPerThread, Lookup lookup)
+{
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<qint64> checksum{0}; // Keeps the compiler from dropping the lookups
+    std::vector<QThread*> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.push_back(QThread::create([&, i]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                QThread::yieldCurrentThread();
+            qint64 sum = 0;
+            for (int n = 0; n < lookupsPerThread; ++n)
+                sum += lookup(i, n);
+            checksum.fetch_add(sum);
+        }));
+        threads.back()->start();
+    }
+    while (ready.load() < threadCount)
+        QThread::yieldCurrentThread();
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+    go.store(true, std::memory_order_release);
+    for (QThread* thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+    const double seconds = static_cast<double>(wallClock.nsecsElapsed()) / 1e9;
+    if (checksum.load() == -1)
+        fprintf(stderr, "Unexpected checksum\n");
+    return static_cast<double>(threadCount) * lookupsPerThread / seconds;
+}
+
+// Child process: measures one key count and prints the result as JSON to stdout
+int runKeyCount(const Options& options)
+{
+    // Keep the start-up messages of the ConfigManager out of the measurements
+    qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+    ConfigManager& configManager = ConfigManager::instance();
+    configManager.setCacheEnabled(false);
+    QFile::remove(ConfigCache::cacheFileName(options.fileName));
+
+    const qint64 baselineRssKb = peakRssKb();
+    try
+    {
+        configManager.initialise(options.fileName);
+    }
+    catch (const std::runtime_error& error)
+    {
+        fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    const qint64 loadedRssKb = peakRssKb();
+
+    QJsonObject result;
+    result["keys"] = options.keyCount;
+    result["parseMsecs"] = medianMsecs(options.repeat, [&options]() {
+        ConfigTable table;
+        ConfigCache::load(options.fileName, table, nullptr, nullptr, false);
+    });
+    std::vector<double> coldLoadMsecs;
+    for (int i = 0; i < options.repeat; ++i)
+    {
+        ConfigCache::waitForWrites();
+        QFile::remove(ConfigCache::cacheFileName(options.fileName));
+        ConfigTable table;
+        QElapsedTimer timer;
+        timer.start();
+        ConfigCache::load(options.fileName, table);
+        coldLoadMsecs.push_back(static_cast<double>(timer.nsecsElapsed()) / 1e6);
+    }
+    ConfigCache::waitForWrites();
+    result["coldLoadMsecs"] = median(coldLoadMsecs);
+    auto warmLoad = [&options]() {
+        ConfigTable table;
+        ConfigCache::load(options.fileName, table);
+    };
+    result["warmStartMsecs"] = medianMsecs(1, warmLoad);
+    result["warmLoadMsecs"] = medianMsecs(options.repeat, warmLoad);
+    QFile::remove(ConfigCache::cacheFileName(options.fileName));
+
+    const QString alternateFileName = writeAlternateFile(options.fileName);
+    if (alternateFileName.isEmpty())
+    {
+        fprintf(stderr, "Failed to write a copy of %s\n", qPrintable(options.fileName));
+        return 1;
+    }
+    // The original has been loaded last, every load switches to the other file
+    bool alternate = false;
+    auto initialiseOther = [&]() {
+        alternate = !alternate;
+        configManager.initialise(alternate ? alternateFileName : options.fileName);
+    };
+    result["initialiseMsecs"] = medianMsecs(options.repeat, initialiseOther);
+    configManager.setCacheEnabled(true);
+    configManager.initialise(options.fileName); // Writes the caches
+    configManager.initialise(alternateFileName);
+    alternate = true;
+    ConfigCache::waitForWrites();
+    result["initialiseCachedMsecs"] = medianMsecs(options.repeat, initialiseOther);
+    result["baselineRssKb"] = baselineRssKb;
+    result["peakRssKb"] = loadedRssKb;
+
+    const QStringList keys = lookupKeys(options.keyCount);
+    if (!keys.isEmpty())
+    {
+        std::vector<std::unique_ptr<ConfigKey<int>>> handles;
+        for (const QString& key : keys)
+            handles.push_back(std::make_unique<ConfigKey<int>>(key));
+        const int keyCount = static_cast<int>(keys.size());
+
+        QJsonArray lookups;
+        auto measure = [&](const char* variant, auto lookup) {
+            for (int threadCount : options.threadCounts)
+            {
+                const double rate = lookupsPerSecond(threadCount, options.lookupsPerThread, lookup);
+                QJsonObject measurement;
+                measurement["variant"] = QString::fromLatin1(variant);
+                measurement["threads"] = threadCount;
+                measurement["lookupsPerSecond"] = rate;
+                measurement["nsecsPerLookup"] = threadCount * 1e9 / rate;
+                lookups.append(measurement);
+            }
+        };
+        // Each thread starts at a different key
+        measure("getValue", [&](int thread, int n) -> qint64 {
+            return configManager.getValue(keys[(n + thread * 97) % keyCount]).isValid() ? 1 : 0;
+        });
+        measure("getValueInt", [&](int thread, int n) -> qint64 {
+            return configManager.getValue(keys[(n + thread * 97) % keyCount]).toInt();
+        });
+        measure("configKey", [&](int thread, int n) -> qint64 {
+            return handles[static_cast<size_t>((n + thread * 97) % keyCount)]->value();
+        });
+        result["lookups"] = lookups;
+    }
+    ConfigCache::waitForWrites();
+    QFile::remove(ConfigCache::cacheFileName(options.fileName));
+    QFile::remove(ConfigCache::cacheFileName(alternateFileName));
+    QFile::remove(alternateFileName);
+
+    printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+    return 0;
+}
+
+// Parent process: generates a file per key count and runs each of them in a child process
+int runAll(const QList<int>& keyCounts, const Options& options, const QString& outputFileName)
+{
+    QTemporaryDir directory;
+    if (!directory.isValid())
+    {
+        fprintf(stderr, "Failed to create a temporary directory: %s\n", qPrintable(directory.errorString()));
+        return 1;
+    }
+
+    QJsonArray results;
+    int status = 0;
+    for (int keyCount : keyCounts)
+    {
+        const QString fileName = directory.filePath(QString("config_%1.ini").arg(keyCount));
+        QFile file(fileName);
+        const QByteArray content = configuration(keyCount);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size())
+        {
+            fprintf(stderr, "Failed to write %s: %s\n", qPrintable(fileName), qPrintable(file.errorString()));
+            return 1;
+        }
+        // Files modified within ConfigCache::SettleMsecs don't get a cache
+        file.flush();
+        file.setFileTime(QDateTime::currentDateTime().addSecs(-60), QFileDevice::FileModificationTime);
+        file.close();
+
+        QStringList threadCounts;
+        for (int threadCount : options.threadCounts)
+            threadCounts.append(QString::number(threadCount));
+        QProcess child;
+        child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        child.start(QCoreApplication::applicationFilePath(),
+                    {"--run", "--file", fileName, "--keys", QString::number(keyCount),
+                     "--threads", threadCounts.join(','), "--lookups", QString::number(options.lookupsPerThread),
+                     "--repeat", QString::number(options.repeat)});
+        child.waitForFinished(-1);
+
+        const QJsonDocument result = QJsonDocument::fromJson(child.readAllStandardOutput());
+        if (child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0 || !result.isObject())
+        {
+            fprintf(stderr, "%d keys failed\n", keyCount);
+            status = 1;
+            continue;
+        }
+        fprintf(stderr, "%7d keys: parse %.3f ms, load cold %.3f ms / warm %.3f ms (mapped %.3f ms), "
+                        "initialise %.3f ms (cached %.3f ms), peak %lld kB\n", keyCount,
+                result["parseMsecs"].toDouble(), result["coldLoadMsecs"].toDouble(),
+                result["warmStartMsecs"].toDouble(), result["warmLoadMsecs"].toDouble(),
+                result["initialiseMsecs"].toDouble(), result["initialiseCachedMsecs"].toDouble(),
+                result["peakRssKb"].toInteger());
+        results.append(result.object());
+    }
+
+    QJsonObject report;
+    report["benchmark"] = QCoreApplication::applicationName();
+    report["qtVersion"] = QString::fromLatin1(qVersion());
+    report["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    report["idealThreadCount"] = QThread::idealThreadCount();
+    report["lookupsPerThread"] = options.lookupsPerThread;
+    report["repeat"] = options.repeat;
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (outputFileName.isEmpty())
+    {
+        fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+        return status;
+    }
+    QFile output(outputFileName);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || output.write(json) != json.size())
+    {
+        fprintf(stderr, "Failed to write %s: %s\n", qPrintable(outputFileName), qPrintable(output.errorString()));
+        return 1;
+    }
+    return status;
+}
+
+QList<int> parseIntegers(const QString& list)
+{
+    QList<int> values;
+    for (const QString& item : list.split(',', Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        const int value = item.trimmed().toInt(&ok);
+        if (!ok || value <= 0)
+            return {};
+        values.append(value);
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rpi4_bench_config");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures load time, peak memory and lookup throughput of the ConfigManager "
+                                     "for generated config files and writes them as JSON.");
+    parser.addHelpOption();
+    QCommandLineOption keysOption("keys", "Comma-separated key counts (default 10,100,1000,10000,100000)", "counts",
+                                  "10,100,1000,10000,100000");
+    QCommandLineOption threadsOption("threads", "Comma-separated numbers of reader threads (default 1,8)", "counts", "1,8");
+    QCommandLineOption lookupsOption("lookups", "Lookups per thread (default 1000000)", "count", "1000000");
+    QCommandLineOption repeatOption("repeat", "Loads per key count, the median is reported (default 5)", "count", "5");
+    QCommandLineOption outputOption("output", "Write the JSON to <file> instead of stdout", "file");
+    QCommandLineOption fileOption("file", "Single key count: the generated config file", "file");
+    QCommandLineOption runOption("run", "Measure a single key count: --file and --keys take a single value");
+    fileOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    runOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOption(keysOption);
+    parser.addOption(threadsOption);
+    parser.addOption(lookupsOption);
+    parser.addOption(repeatOption);
+    parser.addOption(outputOption);
+    parser.addOption(fileOption);
+    parser.addOption(runOption);
+    parser.process(app);
+
+    const QList<int> keyCounts = parseIntegers(parser.value(keysOption));
+    Options options;
+    options.threadCounts = parseIntegers(parser.value(threadsOption));
+    options.lookupsPerThread = parser.value(lookupsOption).toInt();
+    options.repeat = parser.value(repeatOption).toInt();
+    if (keyCounts.isEmpty() || options.threadCounts.isEmpty() || options.lookupsPerThread <= 0 || options.repeat <= 0)
+        parser.showHelp(1);
+
+    if (parser.isSet(runOption))
+    {
+        options.fileName = parser.value(fileOption);
+        options.keyCount = keyCounts.first();
+        if (options.fileName.isEmpty())
+            parser.showHelp(1);
+        return runKeyCount(options);
+    }
+    return runAll(keyCounts, options, parser.value(outputOption));
+}
@@ -0,0 +1,249 @@
+#include "configparsebench.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// The [Zone/N] sections of the generated files
+struct ZoneSettings
+{
+    int setting0 = 0, setting1 = 0, setting2 = 0, setting3 = 0, setting4 = 0;
+    int setting5 = 0, setting6 = 0, setting7 = 0, setting8 = 0, setting9 = 0;
+};
+
+constexpr int ZoneSettings::* ZoneSettingMembers[10] = {
+    &ZoneSettings::setting0, &ZoneSettings::setting1, &ZoneSettings::setting2, &ZoneSettings::setting3,
+    &ZoneSettings::setting4, &ZoneSettings::setting5, &ZoneSettings::setting6, &ZoneSettings::setting7,
+    &ZoneSettings::setting8, &ZoneSettings::setting9
+};
+
+} // namespace
+
+ConfigParseBench::ConfigParseBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ConfigParseBench");
+}
+
+void ConfigParseBench::initTestCase()
+{
+    QVERIFY(m_directory.isValid());
+
+    // A multi-zone deployment: the usual sections plus [Zone/N] sections of 10 keys each
+    for (int keyCount : {100, 1000, 10000})
+    {
+        QFile file(fileName(keyCount));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QByteArray content = "[Weather]\nOpenWeatherApiKey=0123456789abcdef\nLatitude=52.52\nLongitude=13.40\n"
+                             "[Logging]\nLogToFile=true\nLogToConsole=false\nFileName=greenoasis.log\n";
+        for (int key = 0; key < keyCount - 6; ++key)
+        {
+            if (key % 10 == 0)
+                content += "[Zone/" + QByteArray::number(key / 10) + "]\n";
+            content += "Setting" + QByteArray::number(key % 10) + " = " + QByteArray::number(key * 7) + "\n";
+        }
+        QCOMPARE(file.write(content), content.size());
+        // Files modified within ConfigCache::SettleMsecs don't get a cache
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(-60), QFileDevice::FileModificationTime));
+    }
+}
+
+QString ConfigParseBench::fileName(int keyCount) const
+{
+    return m_directory.filePath(QString("config_%1.ini").arg(keyCount));
+}
+
+void ConfigParseBench::addKeyCountColumns()
+{
+    QTest::addColumn<int>("keyCount");
+    QTest::newRow("100 keys") << 100;
+    QTest::newRow("1k keys") << 1000;
+    QTest::newRow("10k keys") << 10000;
+}
+
+QMap<QString, QVariant> ConfigParseBench::legacyParse(const QString &fileName)
+{
+    QMap<QString, QVariant> configData;
+    QFile configFile(fileName);
+    if (!configFile.open(QIODevice::ReadOnly))
+        return configData;
+
+    QTextStream stream(&configFile);
+    QString currentSection;
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine().trimmed();
+        if (line.startsWith("[") && line.endsWith("]"))
+        {
+            currentSection = line.mid(1, line.length() - 2);
+        }
+        else
+        {
+            QStringList parts = line.split('=');
+            if (parts.count() == 2)
+            {
+                QString key = currentSection.isEmpty() ? parts[0].trimmed() :
+                                  currentSection + "/" + parts[0].trimmed();
+                configData.insert(key, parts[1].trimmed());
+            }
+        }
+    }
+    return configData;
+}
+
+void ConfigParseBench::benchLegacyParse_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchLegacyParse()
+{
+    QFETCH(int, keyCount);
+    const QString name = fileName(keyCount);
+    QMap<QString, QVariant> configData;
+    QBENCHMARK {
+        configData = legacyParse(name);
+    }
+    QCOMPARE(configData.size(), keyCount);
+}
+
+void ConfigParseBench::benchIniParser_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchIniParser()
+{
+    QFETCH(int, keyCount);
+    const QString name = fileName(keyCount);
+    qsizetype size = 0;
+    QBENCHMARK {
+        ConfigTable table;
+        IniParser::parseFile(name, table);
+        size = table.size();
+    }
+    QCOMPARE(size, keyCount);
+}
+
+void ConfigParseBench::benchInitialise_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchInitialise()
+{
+    // Parsing, publishing the snapshot and resolving the registered keys
+    QFETCH(int, keyCount);
+    const QString name = fileName(keyCount);
+    QBENCHMARK {
+        ConfigManager::instance().initialise(name);
+    }
+    QCOMPARE(ConfigManager::instance().getValue("Weather/Latitude").toString(), QString("52.52"));
+}
+
+void ConfigParseBench::benchColdStart_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchColdStart()
+{
+    // Timed by hand: the image is written in the background and has to be removed before
+    // every load, neither of which belongs to the start-up
+    QFETCH(int, keyCount);
+    const QString name = fileName(keyCount);
+    std::vector<qint64> nsecs;
+    for (int i = 0; i < 21; ++i)
+    {
+        ConfigCache::waitForWrites();
+        QFile::remove(ConfigCache::cacheFileName(name));
+        ConfigTable table;
+        ConfigCache::Source source = ConfigCache::Source::Cache;
+        QElapsedTimer timer;
+        timer.start();
+        ConfigCache::load(name, table, nullptr, &source);
+        nsecs.push_back(timer.nsecsElapsed());
+        QCOMPARE(source, ConfigCache::Source::Parsed);
+        QCOMPARE(table.size(), keyCount);
+    }
+    ConfigCache::waitForWrites();
+    std::sort(nsecs.begin(), nsecs.end());
+    QTest::setBenchmarkResult(static_cast<qreal>(nsecs[nsecs.size() / 2]) / 1e6, QTest::WalltimeMilliseconds);
+}
+
+void ConfigParseBench::benchWarmStart_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchWarmStart()
+{
+    QFETCH(int, keyCount);
+    const QString name = fileName(keyCount);
+    ConfigTable table;
+    QVERIFY(ConfigCache::load(name, table));
+    ConfigCache::waitForWrites();
+    ConfigCache::Source source = ConfigCache::Source::Parsed;
+    qsizetype size = 0;
+    QBENCHMARK {
+        ConfigTable cached;
+        ConfigCache::load(name, cached, nullptr, &source);
+        size = cached.size();
+    }
+    QCOMPARE(source, ConfigCache::Source::Cache);
+    QCOMPARE(size, keyCount);
+}
+
+void ConfigParseBench::benchZonesByKey_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchZonesByKey()
+{
+    QFETCH(int, keyCount);
+    ConfigManager& configManager = ConfigManager::instance();
+    configManager.initialise(fileName(keyCount));
+    const int zoneCount = static_cast<int>(configManager.sections("Zone/").size());
+    QList<ZoneSettings> zones;
+    QBENCHMARK {
+        zones.clear();
+        for (int zone = 0; zone < zoneCount; ++zone)
+        {
+            ZoneSettings settings;
+            for (int setting = 0; setting < 10; ++setting)
+            {
+                const QString key = QString("Zone/%1/Setting%2").arg(zone).arg(setting);
+                settings.*ZoneSettingMembers[setting] = configManager.getValue(key, 0).toInt();
+            }
+            zones.append(settings);
+        }
+    }
+    QCOMPARE(zones.size(), zoneCount);
+}
+
+void ConfigParseBench::benchZonesBySchema_data()
+{
+    addKeyCountColumns();
+}
+
+void ConfigParseBench::benchZonesBySchema()
+{
+    QFETCH(int, keyCount);
+    ConfigManager& configManager = ConfigManager::instance();
+    configManager.initialise(fileName(keyCount));
+    ConfigSchema<ZoneSettings> schema;
+    for (int setting = 0; setting < 10; ++setting)
+        schema.field(QString("Setting%1").arg(setting), ZoneSettingMembers[setting]);
+    const int zoneCount = static_cast<int>(configManager.sections("Zone/").size());
+    QList<ZoneSettings> zones;
+    QBENCHMARK {
+        zones = configManager.readSections("Zone/", schema);
+    }
+    QCOMPARE(zones.size(), zoneCount);
+}
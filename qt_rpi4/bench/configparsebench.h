@@ -0,0 +1,46 @@
+#ifndef CONFIGPARSEBENCH_H
+#define CONFIGPARSEBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <QMap>
+#include <QTemporaryDir>
+#include <configmanager.h>
+#include <iniparser.h>
+#include <configcache.h>
+
+class ConfigParseBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigParseBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+
+    void benchLegacyParse_data();
+    void benchLegacyParse(); // The QTextStream based parser ConfigManager::initialise used before
+    void benchIniParser_data();
+    void benchIniParser();
+    void benchInitialise_data();
+    void benchInitialise();
+    void benchColdStart_data();
+    void benchColdStart(); // No cache yet: parse and queue the cache write
+    void benchWarmStart_data();
+    void benchWarmStart(); // Valid cache: views of the mapped image, mapped by the first load only
+    void benchZonesByKey_data();
+    void benchZonesByKey(); // Every zone setting through getValue("Zone/N/SettingM")
+    void benchZonesBySchema_data();
+    void benchZonesBySchema(); // All zones at once through the section index
+
+private:
+    void addKeyCountColumns();
+    QString fileName(int keyCount) const;
+    static QMap<QString, QVariant> legacyParse(const QString& fileName);
+
+    QTemporaryDir m_directory;
+};
+
+#endif // CONFIGPARSEBENCH_H
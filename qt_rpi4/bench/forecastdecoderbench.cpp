@@ -0,0 +1,159 @@
+#include "forecastdecoderbench.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "allocationcounter.h"
+
+namespace {
+
+constexpr qsizetype SegmentSize = 1460; // TCP payload of an Ethernet frame
+
+} // namespace
+
+ForecastDecoderBench::ForecastDecoderBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ForecastDecoderBench");
+}
+
+void ForecastDecoderBench::initTestCase()
+{
+    QFile file(GREENOASIS_TEST_DATA_DIR "/test_data_weather.json");
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+    m_replies.insert(0, file.readAll());
+
+    // Longer forecasts, the 40 entries of the test data repeated 3 hours apart
+    QJsonObject reply = QJsonDocument::fromJson(m_replies.value(0)).object();
+    const QJsonArray list = reply.value("list").toArray();
+    QVERIFY(!list.isEmpty());
+    const qint64 firstDt = list.first().toObject().value("dt").toInteger();
+    for (int entryCount : {1000, 10000})
+    {
+        QJsonArray entries;
+        for (int i = 0; i < entryCount; ++i)
+        {
+            QJsonObject entry = list.at(i % list.size()).toObject();
+            entry.insert("dt", firstDt + i * 3 * 3600);
+            entries.append(entry);
+        }
+        reply.insert("cnt", entryCount);
+        reply.insert("list", entries);
+        m_replies.insert(entryCount, QJsonDocument(reply).toJson(QJsonDocument::Compact));
+    }
+}
+
+void ForecastDecoderBench::addPayloadColumns()
+{
+    QTest::addColumn<int>("entryCount");
+    QTest::newRow("test data") << 0;
+    QTest::newRow("1k entries") << 1000;
+    QTest::newRow("10k entries") << 10000;
+}
+
+QList<ForecastEntry> ForecastDecoderBench::decodeJsonDocument(const QByteArray &reply, QString *cityName)
+{
+    const QJsonObject json = QJsonDocument::fromJson(reply).object();
+    *cityName = json.value("city").toObject().value("name").toString();
+    const QJsonArray list = json.value("list").toArray();
+    QList<ForecastEntry> entries;
+    entries.reserve(list.size());
+    for (const QJsonValue& listValue : list)
+        entries.append(ForecastEntry::fromJson(listValue.toObject(), entries.isEmpty()));
+    return entries;
+}
+
+void ForecastDecoderBench::benchJsonDocument_data()
+{
+    addPayloadColumns();
+}
+
+void ForecastDecoderBench::benchJsonDocument()
+{
+    QFETCH(int, entryCount);
+    const QByteArray reply = m_replies.value(entryCount);
+    QString cityName;
+    QList<ForecastEntry> entries;
+    QBENCHMARK { entries = decodeJsonDocument(reply, &cityName); }
+    QVERIFY(!entries.isEmpty());
+}
+
+void ForecastDecoderBench::benchDecoder_data()
+{
+    addPayloadColumns();
+}
+
+void ForecastDecoderBench::benchDecoder()
+{
+    QFETCH(int, entryCount);
+    const QByteArray reply = m_replies.value(entryCount);
+    ForecastDecoder decoder;
+    QList<ForecastEntry> entries;
+    QBENCHMARK {
+        decoder.decode(reply);
+        entries = decoder.takeEntries();
+    }
+    QVERIFY2(!decoder.hasError(), qPrintable(decoder.errorString()));
+    QVERIFY(!entries.isEmpty());
+}
+
+void ForecastDecoderBench::benchDecoderChunks_data()
+{
+    addPayloadColumns();
+}
+
+void ForecastDecoderBench::benchDecoderChunks()
+{
+    QFETCH(int, entryCount);
+    const QByteArray reply = m_replies.value(entryCount);
+    ForecastDecoder decoder;
+    QList<ForecastEntry> entries;
+    QBENCHMARK {
+        decoder.reset();
+        for (qsizetype i = 0; i < reply.size(); i += SegmentSize)
+            decoder.feed(QByteArrayView(reply).sliced(i, qMin(SegmentSize, reply.size() - i)));
+        decoder.finish();
+        entries = decoder.takeEntries();
+    }
+    QVERIFY2(!decoder.hasError(), qPrintable(decoder.errorString()));
+    QVERIFY(!entries.isEmpty());
+}
+
+void ForecastDecoderBench::testAllocations_data()
+{
+    addPayloadColumns();
+}
+
+void ForecastDecoderBench::testAllocations()
+{
+    if (!AllocationCounter::isSupported())
+        QSKIP("Counting allocations requires glibc");
+    QFETCH(int, entryCount);
+    const QByteArray reply = m_replies.value(entryCount);
+
+    QString cityName;
+    AllocationCounter::reset();
+    QList<ForecastEntry> expected = decodeJsonDocument(reply, &cityName);
+    const quint64 documentAllocations = AllocationCounter::count();
+    const quint64 documentBytes = AllocationCounter::bytes();
+
+    // The decoder of WeatherFetcher is reused from reply to reply
+    ForecastDecoder decoder;
+    decoder.decode(reply);
+    decoder.takeEntries();
+    AllocationCounter::reset();
+    decoder.reset();
+    for (qsizetype i = 0; i < reply.size(); i += SegmentSize)
+        decoder.feed(QByteArrayView(reply).sliced(i, qMin(SegmentSize, reply.size() - i)));
+    QVERIFY(decoder.finish());
+    QList<ForecastEntry> entries = decoder.takeEntries();
+    const quint64 decoderAllocations = AllocationCounter::count();
+    const quint64 decoderBytes = AllocationCounter::bytes();
+
+    qInfo() << reply.size() << "bytes," << entries.size() << "entries - QJsonDocument:" << documentAllocations
+            << "allocations," << documentBytes << "bytes; ForecastDecoder:" << decoderAllocations << "allocations,"
+            << decoderBytes << "bytes";
+    QCOMPARE(entries.size(), expected.size());
+    QVERIFY(decoderAllocations < documentAllocations);
+    QVERIFY(decoderBytes < documentBytes);
+}
@@ -0,0 +1,36 @@
+#ifndef FORECASTDECODERBENCH_H
+#define FORECASTDECODERBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <QMap>
+#include <forecastdecoder.h>
+
+class ForecastDecoderBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ForecastDecoderBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+
+    void benchJsonDocument_data();
+    void benchJsonDocument(); // QJsonDocument of the whole reply, as WeatherFetcher used to decode it
+    void benchDecoder_data();
+    void benchDecoder(); // ForecastDecoder on the whole reply
+    void benchDecoderChunks_data();
+    void benchDecoderChunks(); // ForecastDecoder fed with chunks of a TCP segment, as by readyRead()
+    void testAllocations_data();
+    void testAllocations();
+
+private:
+    void addPayloadColumns();
+    static QList<ForecastEntry> decodeJsonDocument(const QByteArray& reply, QString* cityName);
+
+    QMap<int, QByteArray> m_replies; // Entry count -> reply, 0 for test/data/test_data_weather.json
+};
+
+#endif // FORECASTDECODERBENCH_H
@@ -0,0 +1,253 @@
+#include "forecastseriesbench.h"
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <forecastkernels.h>
+#include <weatherdata.h>
+#include <limits>
+
+namespace {
+
+constexpr int MaxHorizon = 100000;
+constexpr qsizetype DayWindow = 8; // Entries of 3 hours
+
+struct Aggregates
+{
+    float totalRain = 0;
+    float maxPop = 0;
+    float minTemperature = 0;
+    float maxTemperature = 0;
+    float meanWindSpeed = 0;
+};
+
+template<typename Kernels>
+Aggregates aggregateSeries(const ForecastSeries& series)
+{
+    const qsizetype size = series.size();
+    Aggregates result;
+    result.totalRain = Kernels::sum(series.rains().constData(), size);
+    result.maxPop = Kernels::max(series.pops().constData(), size);
+    result.minTemperature = Kernels::min(series.minTemperatures().constData(), size);
+    result.maxTemperature = Kernels::max(series.maxTemperatures().constData(), size);
+    result.meanWindSpeed = Kernels::sum(series.windSpeeds().constData(), size) / float(size);
+    return result;
+}
+
+// The kernels as types, for aggregateSeries()
+struct VectorKernels
+{
+    static float sum(const float* values, qsizetype count) { return ForecastKernels::sum(values, count); }
+    static float min(const float* values, qsizetype count) { return ForecastKernels::min(values, count); }
+    static float max(const float* values, qsizetype count) { return ForecastKernels::max(values, count); }
+};
+
+struct ScalarKernels
+{
+    static float sum(const float* values, qsizetype count) { return ForecastKernels::Scalar::sum(values, count); }
+    static float min(const float* values, qsizetype count) { return ForecastKernels::Scalar::min(values, count); }
+    static float max(const float* values, qsizetype count) { return ForecastKernels::Scalar::max(values, count); }
+};
+
+} // namespace
+
+ForecastSeriesBench::ForecastSeriesBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ForecastSeriesBench");
+}
+
+void ForecastSeriesBench::initTestCase()
+{
+    qInfo() << "ForecastKernels use" << ForecastKernels::instructionSet();
+
+    // Three-hourly entries with plausible values
+    QRandomGenerator random(42);
+    m_entries.reserve(MaxHorizon);
+    for (int i = 0; i < MaxHorizon; ++i)
+    {
+        ForecastEntry entry;
+        entry.dt = 1701540000 + qint64(i) * 3 * 3600;
+        entry.mainTemp = random.bounded(40.0) - 10;
+        entry.mainTempMin = entry.mainTemp - random.bounded(3.0);
+        entry.mainTempMax = entry.mainTemp + random.bounded(3.0);
+        entry.pop = random.bounded(1.0);
+        entry.rain3h = entry.pop > 0.6 ? random.bounded(5.0) : 0;
+        entry.windSpeed = random.bounded(12.0);
+        entry.isCurrent = i == 0;
+        m_entries.append(entry);
+    }
+
+    // Only the aggregation is measured, not the debug output of the WeatherData objects
+    QLoggingCategory::setFilterRules("weather.parse.debug=false");
+}
+
+void ForecastSeriesBench::cleanupTestCase()
+{
+    m_entries.clear();
+    QLoggingCategory::setFilterRules(QString());
+}
+
+void ForecastSeriesBench::addHorizonColumns()
+{
+    QTest::addColumn<int>("horizon");
+    QTest::newRow("40 entries") << 40;
+    QTest::newRow("1k entries") << 1000;
+    QTest::newRow("10k entries") << 10000;
+    QTest::newRow("100k entries") << MaxHorizon;
+}
+
+void ForecastSeriesBench::benchWeatherDataPointers_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchWeatherDataPointers()
+{
+    QFETCH(int, horizon);
+    QList<WeatherData*> forecast;
+    forecast.reserve(horizon);
+    for (int i = 0; i < horizon; ++i)
+        forecast.append(new WeatherData(m_entries.at(i), "Ulm"));
+
+    Aggregates result;
+    QBENCHMARK {
+        result = Aggregates{0, 0, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), 0};
+        double windSpeed = 0;
+        for (const WeatherData* data : std::as_const(forecast))
+        {
+            result.totalRain += float(data->rain3h());
+            result.maxPop = qMax(result.maxPop, float(data->pop()));
+            result.minTemperature = qMin(result.minTemperature, float(data->mainTempMin()));
+            result.maxTemperature = qMax(result.maxTemperature, float(data->mainTempMax()));
+            windSpeed += data->windSpeed();
+        }
+        result.meanWindSpeed = float(windSpeed / horizon);
+    }
+    qDeleteAll(forecast);
+    QVERIFY(result.maxTemperature > result.minTemperature);
+}
+
+void ForecastSeriesBench::benchEntries_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchEntries()
+{
+    QFETCH(int, horizon);
+    const QList<ForecastEntry> forecast = m_entries.first(horizon);
+    Aggregates result;
+    QBENCHMARK {
+        result = Aggregates{0, 0, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), 0};
+        double windSpeed = 0;
+        for (const ForecastEntry& entry : forecast)
+        {
+            result.totalRain += float(entry.rain3h);
+            result.maxPop = qMax(result.maxPop, float(entry.pop));
+            result.minTemperature = qMin(result.minTemperature, float(entry.mainTempMin));
+            result.maxTemperature = qMax(result.maxTemperature, float(entry.mainTempMax));
+            windSpeed += entry.windSpeed;
+        }
+        result.meanWindSpeed = float(windSpeed / horizon);
+    }
+    QVERIFY(result.maxTemperature > result.minTemperature);
+}
+
+void ForecastSeriesBench::benchSeriesScalar_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchSeriesScalar()
+{
+    QFETCH(int, horizon);
+    const ForecastSeries series(m_entries.first(horizon));
+    Aggregates result;
+    QBENCHMARK { result = aggregateSeries<ScalarKernels>(series); }
+    QVERIFY(result.maxTemperature > result.minTemperature);
+}
+
+void ForecastSeriesBench::benchSeries_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchSeries()
+{
+    QFETCH(int, horizon);
+    const ForecastSeries series(m_entries.first(horizon));
+    Aggregates result;
+    QBENCHMARK { result = aggregateSeries<VectorKernels>(series); }
+    QVERIFY(result.maxTemperature > result.minTemperature);
+
+    // The same values as the scalar kernels, up to the order of the additions
+    const Aggregates scalar = aggregateSeries<ScalarKernels>(series);
+    QCOMPARE(result.maxPop, scalar.maxPop);
+    QCOMPARE(result.minTemperature, scalar.minTemperature);
+    QCOMPARE(result.maxTemperature, scalar.maxTemperature);
+    QVERIFY(qAbs(result.totalRain - scalar.totalRain) <= 1e-4f * scalar.totalRain);
+}
+
+void ForecastSeriesBench::benchRainWindowsScalar_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchRainWindowsScalar()
+{
+    QFETCH(int, horizon);
+    const ForecastSeries series(m_entries.first(horizon));
+    QList<float> windows(horizon - DayWindow + 1);
+    QBENCHMARK { ForecastKernels::Scalar::windowSum(series.rains().constData(), horizon, DayWindow, windows.data()); }
+}
+
+void ForecastSeriesBench::benchRainWindows_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchRainWindows()
+{
+    QFETCH(int, horizon);
+    const ForecastSeries series(m_entries.first(horizon));
+    QList<float> windows(horizon - DayWindow + 1);
+    QBENCHMARK { ForecastKernels::windowSum(series.rains().constData(), horizon, DayWindow, windows.data()); }
+}
+
+void ForecastSeriesBench::benchPeakWindows_data()
+{
+    // Up to ShortWindow values the windows are taken four at a time, longer ones in O(horizon)
+    QTest::addColumn<int>("horizon");
+    QTest::addColumn<int>("window");
+    QTest::newRow("1k entries, a day") << 1000 << int(DayWindow);
+    QTest::newRow("1k entries, a week") << 1000 << int(7 * DayWindow);
+    QTest::newRow("100k entries, a day") << MaxHorizon << int(DayWindow);
+    QTest::newRow("100k entries, a week") << MaxHorizon << int(7 * DayWindow);
+    QTest::newRow("100k entries, 1k") << MaxHorizon << 1000;
+    QTest::newRow("100k entries, 10k") << MaxHorizon << 10000;
+}
+
+void ForecastSeriesBench::benchPeakWindows()
+{
+    QFETCH(int, horizon);
+    QFETCH(int, window);
+    const ForecastSeries series(m_entries.first(horizon));
+    const float* temperatures = series.maxTemperatures().constData();
+    QList<float> windows(horizon - window + 1);
+    QBENCHMARK { ForecastKernels::windowMax(temperatures, horizon, window, windows.data()); }
+    QCOMPARE(windows.first(), ForecastKernels::Scalar::max(temperatures, window));
+    QCOMPARE(windows.last(), ForecastKernels::Scalar::max(temperatures + horizon - window, window));
+}
+
+void ForecastSeriesBench::benchAssign_data()
+{
+    addHorizonColumns();
+}
+
+void ForecastSeriesBench::benchAssign()
+{
+    QFETCH(int, horizon);
+    const QList<ForecastEntry> forecast = m_entries.first(horizon);
+    ForecastSeries series;
+    QBENCHMARK { series.assign(forecast); }
+    QCOMPARE(series.size(), qsizetype(horizon));
+}
@@ -0,0 +1,44 @@
+#ifndef FORECASTSERIESBENCH_H
+#define FORECASTSERIESBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <forecastseries.h>
+
+class ForecastSeriesBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ForecastSeriesBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+    void cleanupTestCase(); // Will be called after the last benchmark function was executed
+
+    // The aggregates of the irrigation: total rain, max. pop, min./max. temperature, mean wind
+    void benchWeatherDataPointers_data();
+    void benchWeatherDataPointers(); // Through the getters of a QList<WeatherData*>
+    void benchEntries_data();
+    void benchEntries(); // One loop over the ForecastEntry values
+    void benchSeriesScalar_data();
+    void benchSeriesScalar(); // ForecastKernels::Scalar over the columns
+    void benchSeries_data();
+    void benchSeries(); // ForecastKernels over the columns, SSE2 or NEON
+    void benchRainWindowsScalar_data();
+    void benchRainWindowsScalar(); // Rain within a day from every entry on
+    void benchRainWindows_data();
+    void benchRainWindows();
+    void benchPeakWindows_data();
+    void benchPeakWindows(); // Max. temperature within every window, the long ones from block maxima
+    void benchAssign_data();
+    void benchAssign(); // Building the columns from the entries, done by every fetch
+
+private:
+    void addHorizonColumns();
+
+    QList<ForecastEntry> m_entries; // The longest horizon, the shorter ones are its beginning
+};
+
+#endif // FORECASTSERIESBENCH_H
@@ -0,0 +1,81 @@
+#include "logcategorybench.h"
+#include <QLoggingCategory>
+#include <weatherdata.h>
+
+namespace {
+// Discards every message, so the benchmarks measure formatting and not the console
+void discardMessage(QtMsgType, const QMessageLogContext &, const QString &) {}
+}
+
+LogCategoryBench::LogCategoryBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogCategoryBench");
+}
+
+void LogCategoryBench::initTestCase()
+{
+    // One entry of the OpenWeather forecast list
+    m_forecastItem = QJsonObject{
+        {"dt", 1701421200},
+        {"main", QJsonObject{{"temp", 3.67}, {"temp_min", 2.9}, {"temp_max", 3.67}}},
+        {"weather", QJsonArray{QJsonObject{{"id", 804}, {"main", "Clouds"},
+                                           {"description", "overcast clouds"}, {"icon", "04d"}}}},
+        {"wind", QJsonObject{{"speed", 2.81}}},
+        {"pop", 0.2},
+        {"dt_txt", "2023-12-01 09:00:00"}
+    };
+    m_previousHandler = qInstallMessageHandler(discardMessage);
+}
+
+void LogCategoryBench::cleanupTestCase()
+{
+    qInstallMessageHandler(m_previousHandler);
+    QLoggingCategory::setFilterRules(QString());
+}
+
+void LogCategoryBench::benchDebugStatement_data()
+{
+    QTest::addColumn<int>("variant");
+    QTest::newRow("qDebug") << 0;
+    QTest::newRow("qCDebug enabled") << 1;
+    QTest::newRow("qCDebug disabled") << 2;
+}
+
+void LogCategoryBench::benchDebugStatement()
+{
+    QFETCH(int, variant);
+    QLoggingCategory::setFilterRules(variant == 2 ? "weather.parse.debug=false" : "");
+
+    // The same statement as in the WeatherData constructor
+    QObject object;
+    object.setObjectName("2023-12-01 09:00:00");
+    switch (variant)
+    {
+    case 0:
+        QBENCHMARK { qDebug() << &object << "has been successfully created"; }
+        break;
+    default:
+        QBENCHMARK { qCDebug(lcWeatherParse) << &object << "has been successfully created"; }
+        break;
+    }
+}
+
+void LogCategoryBench::benchWeatherDataLifetime_data()
+{
+    QTest::addColumn<bool>("debugEnabled");
+    QTest::newRow("weather.parse debug enabled") << true;
+    QTest::newRow("weather.parse debug disabled") << false;
+}
+
+void LogCategoryBench::benchWeatherDataLifetime()
+{
+    QFETCH(bool, debugEnabled);
+    QLoggingCategory::setFilterRules(debugEnabled ? "" : "weather.parse.debug=false");
+
+    // Constructing and destroying one forecast entry logs twice
+    QBENCHMARK {
+        WeatherData data("2023-12-01 09:00:00", m_forecastItem, "Berlin", false);
+        Q_UNUSED(data)
+    }
+}
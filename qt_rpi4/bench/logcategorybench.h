@@ -0,0 +1,31 @@
+#ifndef LOGCATEGORYBENCH_H
+#define LOGCATEGORYBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <QJsonObject>
+#include <logcategories.h>
+
+class LogCategoryBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogCategoryBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+    void cleanupTestCase(); // Will be called after the last benchmark function was executed
+
+    void benchDebugStatement_data();
+    void benchDebugStatement();
+    void benchWeatherDataLifetime_data();
+    void benchWeatherDataLifetime();
+
+private:
+    QJsonObject m_forecastItem;
+    QtMessageHandler m_previousHandler = nullptr;
+};
+
+#endif // LOGCATEGORYBENCH_H
@@ -0,0 +1,100 @@
+#include "logformatbench.h"
+#include <QDateTime>
+#include <allocationcounter.h>
+
+LogFormatBench::LogFormatBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogFormatBench");
+}
+
+void LogFormatBench::initTestCase()
+{
+    // A typical message of the weather fetcher, including a non-ASCII character
+    m_message = QString("WeatherFetcher(0x5581f6a3c0e0, name = \"WeatherFetcher\") "
+                        "requestWasSuccessful() returned status: true (temp 21.5 °C)");
+}
+
+QByteArray LogFormatBench::legacyFormat(QtMsgType type, const QMessageLogContext &context, const QString &msg) const
+{
+    QString logLevel;
+    switch (type)
+    {
+    case QtDebugMsg: logLevel = "DEBUG"; break;
+    case QtInfoMsg: logLevel = "INFO"; break;
+    case QtWarningMsg: logLevel = "WARNING"; break;
+    case QtCriticalMsg: logLevel = "CRITICAL"; break;
+    case QtFatalMsg: logLevel = "FATAL"; break;
+    }
+    QString timeStamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
+    QString formattedMessage = QString("%1 [%2]").arg(timeStamp, logLevel);
+    formattedMessage += QString(" (%1:%2)").arg(QString::fromUtf8(context.file), QString::number(context.line));
+    formattedMessage += QString(": %1").arg(msg);
+    return formattedMessage.toLocal8Bit();
+}
+
+void LogFormatBench::benchLegacyFormat()
+{
+    QByteArray line;
+    QBENCHMARK {
+        line = legacyFormat(QtDebugMsg, m_context, m_message);
+    }
+    QVERIFY(line.endsWith(m_message.toUtf8()));
+}
+
+void LogFormatBench::benchFormat()
+{
+    LogLineBuffer& line = LogFormatter::threadBuffer();
+    QBENCHMARK {
+        LogFormatter::format(line, QtDebugMsg, m_context, m_message, true, true);
+    }
+    QVERIFY(line.view().endsWith(m_message.toUtf8()));
+}
+
+void LogFormatBench::benchFormatAndQueue()
+{
+    // Everything the async path does on the calling thread, plus the writer's pop
+    LogRingBuffer<LogMessage> queue(64);
+    LogLineBuffer& line = LogFormatter::threadBuffer();
+    LogMessage popped;
+    QBENCHMARK {
+        LogFormatter::format(line, QtDebugMsg, m_context, m_message, true, true);
+        LogMessage message(QtDebugMsg, line.view());
+        queue.tryPush(std::move(message));
+        queue.tryPop(popped);
+    }
+    QCOMPARE(popped.line().toByteArray(), line.view().toByteArray());
+}
+
+void LogFormatBench::testSteadyStateAllocations()
+{
+    if (!AllocationCounter::isSupported())
+        QSKIP("Counting allocations requires glibc");
+
+    const int messageCount = 10000;
+    LogRingBuffer<LogMessage> queue(64);
+    LogLineBuffer& line = LogFormatter::threadBuffer();
+    LogMessage popped;
+
+    // Warm up: let the buffers grow to their final size
+    for (int i = 0; i < 100; ++i)
+    {
+        LogFormatter::format(line, QtWarningMsg, m_context, m_message, true, true);
+        LogMessage message(QtWarningMsg, line.view());
+        queue.tryPush(std::move(message));
+        queue.tryPop(popped);
+    }
+
+    AllocationCounter::reset();
+    for (int i = 0; i < messageCount; ++i)
+    {
+        LogFormatter::format(line, static_cast<QtMsgType>(i % 5), m_context, m_message, true, true);
+        LogMessage message(QtWarningMsg, line.view());
+        queue.tryPush(std::move(message));
+        queue.tryPop(popped);
+    }
+    const quint64 allocations = AllocationCounter::count();
+
+    qInfo() << "Allocations for" << messageCount << "messages:" << allocations;
+    QCOMPARE(allocations, quint64(0));
+}
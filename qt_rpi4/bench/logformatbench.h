@@ -0,0 +1,33 @@
+#ifndef LOGFORMATBENCH_H
+#define LOGFORMATBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <QMessageLogContext>
+#include <logformatter.h>
+#include <logwriterthread.h>
+
+class LogFormatBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogFormatBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+
+    void benchLegacyFormat(); // The QString based formatting Logger::log used before
+    void benchFormat();
+    void benchFormatAndQueue();
+    void testSteadyStateAllocations();
+
+private:
+    QByteArray legacyFormat(QtMsgType type, const QMessageLogContext &context, const QString &msg) const;
+
+    const QMessageLogContext m_context{"weatherfetcher.cpp", 123, "requestWasSuccessful", "default"};
+    QString m_message;
+};
+
+#endif // LOGFORMATBENCH_H
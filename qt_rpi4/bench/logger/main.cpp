@@ -0,0 +1,382 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <configmanager.h>
+#include <logger.h>
+
+/*
+ * The logger is a singleton configured once from the config file, so every scenario
+ * (sinks, sync/async, threads, message size) runs in a child process of its own:
+ *   rpi4_bench_logger --run --sinks both --async --threads 4 --size 256
+ * The parent runs the whole matrix, sends the console output of the children to a
+ * temporary file and prints one line per scenario.
+ */
+
+namespace {
+
+struct Scenario
+{
+    QString sinks; // file | console | both
+    bool async = false;
+    int threads = 1;
+    int messageSize = 0;
+    int messagesPerThread = 0;
+};
+
+struct Result
+{
+    quint64 messages = 0;
+    double seconds = 0;
+    qint64 p50Nsecs = 0;
+    qint64 p99Nsecs = 0;
+    qint64 p999Nsecs = 0;
+    qint64 bytes = 0;
+    quint64 dropped = 0;
+};
+
+constexpr qint64 DrainTimeoutMsecs = 60000;
+
+QString logFilePath()
+{
+    // The logger puts the log file into the temp directory
+    const QString fileName = QString("greenoasis-bench-%1.log").arg(QCoreApplication::applicationPid());
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).filePath(fileName);
+}
+
+QByteArray configuration(const Scenario& scenario)
+{
+    const bool toFile = scenario.sinks != "console";
+    const bool toConsole = scenario.sinks != "file";
+    QByteArray config;
+    config += "[Logging]\n";
+    config += "LogToFile=" + QByteArray(toFile ? "true" : "false") + "\n";
+    config += "LogToConsole=" + QByteArray(toConsole ? "true" : "false") + "\n";
+    config += "LogFileAndLineEnabled=true\n";
+    config += "LogContentEnabled=true\n";
+    config += "FileName=" + QFileInfo(logFilePath()).fileName().toUtf8() + "\n";
+    config += "Format=text\n";
+    config += "Level=debug\n";
+    config += "Async=" + QByteArray(scenario.async ? "true" : "false") + "\n";
+    config += "AsyncQueueSize=4096\n";
+    config += "AsyncOverflowPolicy=block\n";
+    config += "RotateMaxBytes=0\n";
+    // Every message of a thread comes from the same call site, the throttle would drop them
+    config += "DuplicateWindowSecs=0\n";
+    config += "RateLimitPerSecond=0\n";
+    return config;
+}
+
+QString message(int size)
+{
+    // A typical line of the weather fetcher, repeated up to the requested size
+    const QString sample = QString("requestWasSuccessful() returned status: true (temp 21.5 °C) ");
+    QString text;
+    text.reserve(size);
+    while (text.size() < size)
+        text += sample.left(size - text.size());
+    return text;
+}
+
+qint64 percentile(const std::vector<qint64>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+    const size_t index = qMin(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+    return sorted[index];
+}
+
+quint64 processedCount(const Logger& logger)
+{
+    quint64 count = 0;
+    for (const LogSink::Statistics& statistics : logger.sinkStatistics())
+        count += statistics.written + statistics.dropped;
+    return count;
+}
+
+// Child process: runs one scenario and prints the result as key=value pairs to stdout
+int runScenario(const Scenario& scenario)
+{
+    QTemporaryFile configFile(QDir::tempPath() + "/greenoasis-bench-XXXXXX.ini");
+    if (!configFile.open() || configFile.write(configuration(scenario)) < 0 || !configFile.flush())
+    {
+        fprintf(stderr, "Failed to write the config file: %s\n", qPrintable(configFile.errorString()));
+        return 1;
+    }
+    QFile::remove(logFilePath());
+
+    // Keep the logger's own start-up messages out of the console output that is counted
+    qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+    ConfigManager::instance().initialise(configFile.fileName());
+    Logger& logger = Logger::instance();
+    const int sinkCount = static_cast<int>(logger.sinkStatistics().size());
+    if (sinkCount == 0)
+    {
+        fprintf(stderr, "No sink could be opened\n");
+        return 1;
+    }
+
+    const QString text = message(scenario.messageSize);
+    std::vector<std::vector<qint64>> latencies(static_cast<size_t>(scenario.threads));
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<QThread*> threads;
+    for (int i = 0; i < scenario.threads; ++i)
+    {
+        latencies[static_cast<size_t>(i)].resize(static_cast<size_t>(scenario.messagesPerThread));
+        threads.push_back(QThread::create([&, i]() {
+            std::vector<qint64>& threadLatencies = latencies[static_cast<size_t>(i)];
+            const QMessageLogContext context("bench/logger/main.cpp", 100 + i, "runScenario", "bench");
+            QElapsedTimer timer;
+            timer.start();
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                QThread::yieldCurrentThread();
+            for (int n = 0; n < scenario.messagesPerThread; ++n)
+            {
+                const qint64 begin = timer.nsecsElapsed();
+                logger.log(QtInfoMsg, context, text);
+                threadLatencies[static_cast<size_t>(n)] = timer.nsecsElapsed() - begin;
+            }
+        }));
+        threads.back()->start();
+    }
+    while (ready.load() < scenario.threads)
+        QThread::yieldCurrentThread();
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+    go.store(true, std::memory_order_release);
+    for (QThread* thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+
+    // Async sinks are done once their writers have caught up
+    const quint64 messages = static_cast<quint64>(scenario.threads) * static_cast<quint64>(scenario.messagesPerThread);
+    while (processedCount(logger) < messages * static_cast<quint64>(sinkCount))
+    {
+        if (wallClock.elapsed() > DrainTimeoutMsecs)
+        {
+            fprintf(stderr, "The writers didn't catch up within %lld ms\n", DrainTimeoutMsecs);
+            return 1;
+        }
+        QThread::msleep(1);
+    }
+    const double seconds = static_cast<double>(wallClock.nsecsElapsed()) / 1e9;
+
+    std::vector<qint64> all;
+    all.reserve(static_cast<size_t>(messages));
+    for (const std::vector<qint64>& threadLatencies : latencies)
+        all.insert(all.end(), threadLatencies.begin(), threadLatencies.end());
+    std::sort(all.begin(), all.end());
+
+    quint64 dropped = 0;
+    for (const LogSink::Statistics& statistics : logger.sinkStatistics())
+        dropped += statistics.dropped;
+
+    Result result;
+    result.messages = messages;
+    result.seconds = seconds;
+    result.p50Nsecs = percentile(all, 0.50);
+    result.p99Nsecs = percentile(all, 0.99);
+    result.p999Nsecs = percentile(all, 0.999);
+    result.bytes = QFileInfo(logFilePath()).size(); // 0 without a file sink
+    result.dropped = dropped;
+    QFile::remove(logFilePath());
+
+    printf("messages=%llu seconds=%.6f p50=%lld p99=%lld p999=%lld bytes=%lld dropped=%llu\n",
+           result.messages, result.seconds, result.p50Nsecs, result.p99Nsecs, result.p999Nsecs,
+           result.bytes, result.dropped);
+    fflush(stdout);
+    return 0;
+}
+
+bool parseResult(const QByteArray& output, Result& result)
+{
+    int found = 0;
+    for (const QByteArray& pair : output.trimmed().split(' '))
+    {
+        const qsizetype separator = pair.indexOf('=');
+        if (separator < 0)
+            continue;
+        const QByteArray key = pair.left(separator);
+        const QByteArray value = pair.mid(separator + 1);
+        ++found;
+        if (key == "messages") result.messages = value.toULongLong();
+        else if (key == "seconds") result.seconds = value.toDouble();
+        else if (key == "p50") result.p50Nsecs = value.toLongLong();
+        else if (key == "p99") result.p99Nsecs = value.toLongLong();
+        else if (key == "p999") result.p999Nsecs = value.toLongLong();
+        else if (key == "bytes") result.bytes = value.toLongLong();
+        else if (key == "dropped") result.dropped = value.toULongLong();
+        else --found;
+    }
+    return found == 7 && result.seconds > 0;
+}
+
+// Parent process: runs every scenario in a child process
+int runMatrix(const QStringList& sinkConfigurations, const QList<bool>& modes, const QList<int>& threadCounts,
+              const QList<int>& sizes, int messagesPerThread)
+{
+    QTemporaryFile consoleFile(QDir::tempPath() + "/greenoasis-bench-console-XXXXXX");
+    if (!consoleFile.open())
+    {
+        fprintf(stderr, "Failed to create a temporary file: %s\n", qPrintable(consoleFile.errorString()));
+        return 1;
+    }
+
+    printf("%-8s %-6s %7s %6s %12s %9s %9s %9s %12s %8s\n",
+           "sinks", "mode", "threads", "size", "msgs/s", "p50 us", "p99 us", "p999 us", "bytes", "dropped");
+    int status = 0;
+    for (const QString& sinks : sinkConfigurations)
+    {
+        for (bool async : modes)
+        {
+            for (int threadCount : threadCounts)
+            {
+                for (int size : sizes)
+                {
+                    QStringList arguments = {"--run", "--sinks", sinks,
+                                             "--threads", QString::number(threadCount),
+                                             "--sizes", QString::number(size),
+                                             "--messages", QString::number(messagesPerThread)};
+                    if (async)
+                        arguments << "--async";
+
+                    // The console sink writes to the file, so its bytes can be counted as well
+                    QProcess child;
+                    child.setStandardErrorFile(consoleFile.fileName());
+                    child.start(QCoreApplication::applicationFilePath(), arguments);
+                    child.waitForFinished(-1);
+
+                    Result result;
+                    if (child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0
+                        || !parseResult(child.readAllStandardOutput(), result))
+                    {
+                        QFile errors(consoleFile.fileName());
+                        const QByteArray errorOutput = errors.open(QIODevice::ReadOnly) ? errors.readAll().right(512) : QByteArray();
+                        fprintf(stderr, "%s %s %d threads %d chars failed: %s\n", qPrintable(sinks),
+                                async ? "async" : "sync", threadCount, size, errorOutput.constData());
+                        status = 1;
+                        continue;
+                    }
+                    if (sinks != "file")
+                        result.bytes += QFileInfo(consoleFile.fileName()).size();
+
+                    printf("%-8s %-6s %7d %6d %12.0f %9.2f %9.2f %9.2f %12lld %8llu\n",
+                           qPrintable(sinks), async ? "async" : "sync", threadCount, size,
+                           static_cast<double>(result.messages) / result.seconds,
+                           static_cast<double>(result.p50Nsecs) / 1000.0,
+                           static_cast<double>(result.p99Nsecs) / 1000.0,
+                           static_cast<double>(result.p999Nsecs) / 1000.0,
+                           result.bytes, result.dropped);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    return status;
+}
+
+QList<int> parseIntegers(const QString& list)
+{
+    QList<int> values;
+    for (const QString& item : list.split(',', Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        const int value = item.trimmed().toInt(&ok);
+        if (!ok || value <= 0)
+            return {};
+        values.append(value);
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rpi4_bench_logger");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures messages/s, call latency and bytes written of Logger::log() "
+                                     "for file, console and both sinks, synchronous and async.");
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Up to <count> logging threads: 1, 2, 4, ... count (default 4)", "count", "4");
+    QCommandLineOption sizesOption("sizes", "Comma-separated message sizes in characters (default 32,256,2048)", "sizes", "32,256,2048");
+    QCommandLineOption messagesOption("messages", "Messages per thread (default 20000)", "count", "20000");
+    QCommandLineOption sinksOption("sinks", "Comma-separated sink configurations: file, console, both (default all)", "sinks", "file,console,both");
+    QCommandLineOption modesOption("modes", "Comma-separated modes: sync, async (default both)", "modes", "sync,async");
+    QCommandLineOption asyncOption("async", "Single scenario: use async sinks");
+    QCommandLineOption runOption("run", "Run a single scenario: --sinks, --threads and --sizes take a single value");
+    asyncOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    runOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOption(threadsOption);
+    parser.addOption(sizesOption);
+    parser.addOption(messagesOption);
+    parser.addOption(sinksOption);
+    parser.addOption(modesOption);
+    parser.addOption(asyncOption);
+    parser.addOption(runOption);
+    parser.process(app);
+
+    const int maxThreads = parser.value(threadsOption).toInt();
+    const QList<int> sizes = parseIntegers(parser.value(sizesOption));
+    const int messagesPerThread = parser.value(messagesOption).toInt();
+    const QStringList sinkConfigurations = parser.value(sinksOption).split(',', Qt::SkipEmptyParts);
+    if (maxThreads <= 0 || sizes.isEmpty() || messagesPerThread <= 0 || sinkConfigurations.isEmpty())
+        parser.showHelp(1);
+    for (const QString& sinks : sinkConfigurations)
+    {
+        if (sinks != "file" && sinks != "console" && sinks != "both")
+        {
+            fprintf(stderr, "Unknown sink configuration: %s\n", qPrintable(sinks));
+            return 1;
+        }
+    }
+
+    if (parser.isSet(runOption))
+    {
+        Scenario scenario;
+        scenario.sinks = sinkConfigurations.first();
+        scenario.async = parser.isSet(asyncOption);
+        scenario.threads = maxThreads;
+        scenario.messageSize = sizes.first();
+        scenario.messagesPerThread = messagesPerThread;
+        return runScenario(scenario);
+    }
+
+    QList<bool> modes;
+    for (const QString& mode : parser.value(modesOption).split(',', Qt::SkipEmptyParts))
+    {
+        if (mode == "sync" || mode == "async")
+            modes.append(mode == "async");
+        else
+        {
+            fprintf(stderr, "Unknown mode: %s\n", qPrintable(mode));
+            return 1;
+        }
+    }
+    if (modes.isEmpty())
+        parser.showHelp(1);
+
+    QList<int> threadCounts;
+    for (int count = 1; count < maxThreads; count *= 2)
+        threadCounts.append(count);
+    threadCounts.append(maxThreads);
+
+    return runMatrix(sinkConfigurations, modes, threadCounts, sizes, messagesPerThread);
+}
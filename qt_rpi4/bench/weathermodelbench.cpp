@@ -0,0 +1,182 @@
+#include "weathermodelbench.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <logcategories.h>
+#include "allocationcounter.h"
+
+// WeatherData as fetches stored it before ForecastEntry: a QObject with every field in its own
+// member, strings included. Its properties and signal were only metadata, they don't change
+// what an instance allocates, so they are left out.
+class LegacyWeatherData : public QObject
+{
+public:
+    LegacyWeatherData(const QString& objectName, const QJsonObject& data, const QString& cityName,
+                      bool isCurrentWeather, QObject* parent = nullptr)
+        : QObject{parent}
+    {
+        setObjectName(objectName);
+        m_cityName = cityName;
+        m_isCurrentWeather = isCurrentWeather;
+        if (!data.isEmpty())
+        {
+            extractData(data);
+            qCDebug(lcWeatherParse) << this << "has been successfully created";
+        }
+    }
+
+    ~LegacyWeatherData() override
+    {
+        qCDebug(lcWeatherParse) << this << "has been destroyed";
+    }
+
+private:
+    void extractData(const QJsonObject& data)
+    {
+        if (data.contains("dt"))
+        {
+            m_dt = data["dt"].toInt();
+            m_qDateTime = QDateTime::fromSecsSinceEpoch(m_dt);
+        }
+        if (data.contains("main"))
+        {
+            QJsonObject mainObject = data["main"].toObject();
+            m_mainTemp = mainObject["temp"].toDouble();
+            m_mainTempMin = mainObject["temp_min"].toDouble();
+            m_mainTempMax = mainObject["temp_max"].toDouble();
+        }
+        if (data.contains("weather"))
+        {
+            QJsonArray weatherArray = data["weather"].toArray();
+            QJsonObject weatherObject = weatherArray.at(0).toObject();
+            m_weatherId = weatherObject["id"].toString();
+            m_weatherMain = weatherObject["main"].toString();
+            m_weatherDescription = weatherObject["description"].toString();
+            m_weatherIcon = weatherObject["icon"].toString();
+        }
+        if (data.contains("wind"))
+        {
+            QJsonObject windObject = data["wind"].toObject();
+            m_windSpeed = windObject["speed"].toDouble();
+        }
+        if (data.contains("pop"))
+            m_pop = data["pop"].toDouble();
+        if (data.contains("rain"))
+        {
+            QJsonObject rainObject = data["rain"].toObject();
+            m_rain3h = rainObject["3h"].toDouble();
+        }
+        if (data.contains("snow"))
+        {
+            QJsonObject snowObject = data["snow"].toObject();
+            m_snow3h = snowObject["3h"].toDouble();
+        }
+    }
+
+    bool m_isCurrentWeather = false;
+    int m_dt = 0;
+    QDateTime m_qDateTime;
+    QString m_cityName;
+    QString m_weatherId;
+    QString m_weatherMain;
+    QString m_weatherDescription;
+    QString m_weatherIcon;
+    double m_mainTemp = 0;
+    double m_mainTempMin = 0;
+    double m_mainTempMax = 0;
+    double m_windSpeed = 0;
+    double m_snow3h = 0;
+    double m_rain3h = 0;
+    double m_pop = 0;
+};
+
+WeatherModelBench::WeatherModelBench(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("WeatherModelBench");
+}
+
+void WeatherModelBench::initTestCase()
+{
+    QFile file(GREENOASIS_TEST_DATA_DIR "/test_data_weather.json");
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+    m_forecast = QJsonDocument::fromJson(file.readAll()).object();
+    QCOMPARE(m_forecast.value("list").toArray().size(), 40);
+
+    // Only the storage of the entries is measured, not the debug output of the constructors
+    QLoggingCategory::setFilterRules("weather.parse.debug=false\nweather.model.debug=false");
+}
+
+void WeatherModelBench::cleanupTestCase()
+{
+    qDeleteAll(m_qObjectEntries);
+    m_qObjectEntries.clear();
+    QLoggingCategory::setFilterRules(QString());
+}
+
+void WeatherModelBench::storeQObjectEntries()
+{
+    // What a fetch did before: a heap allocated QObject per entry, deleted by the next fetch
+    qDeleteAll(m_qObjectEntries);
+    m_qObjectEntries.clear();
+
+    const QString cityName = m_forecast.value("city").toObject().value("name").toString();
+    bool isCurrentWeather = true;
+    for (const QJsonValue& listValue : m_forecast.value("list").toArray())
+    {
+        const QJsonObject listObject = listValue.toObject();
+        m_qObjectEntries.append(new LegacyWeatherData(listObject["dt_txt"].toString(), listObject, cityName, isCurrentWeather));
+        isCurrentWeather = false;
+    }
+}
+
+void WeatherModelBench::storeValueEntries()
+{
+    // What WeatherFetcher did before it had the ForecastDecoder
+    const QString cityName = m_forecast.value("city").toObject().value("name").toString();
+    const QJsonArray list = m_forecast.value("list").toArray();
+    QList<ForecastEntry> entries;
+    entries.reserve(list.size());
+    for (const QJsonValue& listValue : list)
+        entries.append(ForecastEntry::fromJson(listValue.toObject(), entries.isEmpty()));
+    m_model.setForecast(cityName, std::move(entries));
+}
+
+void WeatherModelBench::benchQObjectEntries()
+{
+    QBENCHMARK { storeQObjectEntries(); }
+}
+
+void WeatherModelBench::benchValueEntries()
+{
+    QBENCHMARK { storeValueEntries(); }
+}
+
+void WeatherModelBench::testAllocationsPerFetch()
+{
+    if (!AllocationCounter::isSupported())
+        QSKIP("Counting allocations requires glibc");
+
+    // Replacing the entries of the previous fetch is part of a fetch, so count the second one
+    const int fetchCount = 10;
+    storeQObjectEntries();
+    AllocationCounter::reset();
+    for (int i = 0; i < fetchCount; ++i)
+        storeQObjectEntries();
+    const quint64 qObjectAllocations = AllocationCounter::count() / fetchCount;
+    const quint64 qObjectBytes = AllocationCounter::bytes() / fetchCount;
+
+    storeValueEntries();
+    AllocationCounter::reset();
+    for (int i = 0; i < fetchCount; ++i)
+        storeValueEntries();
+    const quint64 valueAllocations = AllocationCounter::count() / fetchCount;
+    const quint64 valueBytes = AllocationCounter::bytes() / fetchCount;
+
+    qInfo() << "Per fetch of 40 entries - QObject per entry:" << qObjectAllocations << "allocations,"
+            << qObjectBytes << "bytes; values:" << valueAllocations << "allocations," << valueBytes << "bytes";
+    QVERIFY(valueAllocations < qObjectAllocations);
+    QVERIFY(valueBytes < qObjectBytes);
+}
@@ -0,0 +1,36 @@
+#ifndef WEATHERMODELBENCH_H
+#define WEATHERMODELBENCH_H
+
+#include <QObject>
+#include <QTest>
+#include <QJsonObject>
+#include <weathermodel.h>
+
+class LegacyWeatherData;
+
+class WeatherModelBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WeatherModelBench(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first benchmark function is executed
+    void cleanupTestCase(); // Will be called after the last benchmark function was executed
+
+    void benchQObjectEntries(); // One QObject per forecast entry, as fetches used to store them
+    void benchValueEntries(); // ForecastEntry values in the WeatherModel
+    void testAllocationsPerFetch();
+
+private:
+    void storeQObjectEntries();
+    void storeValueEntries();
+
+    QJsonObject m_forecast; // test/data/test_data_weather.json
+    WeatherModel m_model;
+    QList<LegacyWeatherData*> m_qObjectEntries;
+};
+
+#endif // WEATHERMODELBENCH_H
@@ -0,0 +1,6 @@
+# Copies the config template SOURCE to DESTINATION unless there is a config file already,
+# so that neither a build nor an install overwrites the API key and settings of a device.
+# Used by the POST_BUILD step and the install step of app_qt_rpi4.
+if(NOT EXISTS "${DESTINATION}")
+    configure_file("${SOURCE}" "${DESTINATION}" COPYONLY)
+endif()
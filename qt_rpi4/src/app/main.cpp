@@ -2,15 +2,35 @@
 #include <QQmlApplicationEngine>
 #include <QNetworkAccessManager>
 #include <QQmlContext>
+#include <QCommandLineParser>
+#include <QDir>
 #include <QDebug>
+#include <utility>
 #include <weatherdata.h>
 #include <weathermodel.h>
 #include <configmanager.h>
+#include <configkey.h>
 #include <weatherfetcher.h>
 #include <custommessagehandler.h>
+#include <logcategories.h>
+#include <logtailmodel.h>
+
+namespace {
+
+// The [Weather] keys, resolved whenever the config is (re)loaded
+struct WeatherConfig
+{
+    ConfigKey<QString> apiKey{"Weather/OpenWeatherApiKey"};
+    ConfigKey<double> latitude{"Weather/Latitude"};
+    ConfigKey<double> longitude{"Weather/Longitude"};
+    ConfigKey<int> fetchIntervalSecs{"Weather/FetchIntervalSecs", 20};
+};
+
+} // namespace
 
 // Function prototypes
-void initWeatherFetcher(WeatherFetcher& weatherFetcher);
+QString configFileName(const QCommandLineParser& parser, const QCommandLineOption& configOption);
+void initWeatherFetcher(WeatherFetcher& weatherFetcher, const WeatherConfig& weatherConfig);
 void printImportPathsToConsole(QQmlApplicationEngine& engine);
 
 int main(int argc, char *argv[])
@@ -18,33 +38,114 @@ int main(int argc, char *argv[])
     QGuiApplication app(argc, argv);
     QQmlApplicationEngine engine;
 
-    // Initialise the ConfigManager
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Green Oasis");
+    parser.addHelpOption();
+    QCommandLineOption configOption("config", "The config file. Default: $GREENOASIS_CONFIG, or config.ini next to the executable.", "file");
+    QCommandLineOption setOption("set", "Overrides a config value, e.g. --set Weather/Latitude=52.52. Can be given more than once.", "Section/Key=value");
+    parser.addOption(configOption);
+    parser.addOption(setOption);
+    parser.process(app);
+
+    // Initialise the ConfigManager: built-in defaults < config file < GREENOASIS_* environment < --set
+    ConfigManager::instance().setDefaults({{"Weather/FetchIntervalSecs", 20}});
+    QString overrideError;
+    if (!ConfigManager::instance().setOverrides(parser.values(setOption), &overrideError))
+    {
+        qCritical().noquote() << "Invalid --set option:" << overrideError;
+        return 1;
+    }
+    // The versions of the config survive restarts, e.g. to go back to an earlier schedule
+    const QString configFile = configFileName(parser, configOption);
+    ConfigManager::instance().setHistoryFile(configFile + ".history");
     try {
-        // TODO get rid of absolute path
-        ConfigManager::instance().initialise("/home/parallels/QtProjects/qt-green-oasis/qt_rpi4/resources/config/config.ini");
+        ConfigManager::instance().initialise(configFile);
     } catch (const std::exception &e) {
         qDebug() << "Exception ocurred while initialising the ConfigManager: " << e.what();
     }
 
+    // Apply the log level thresholds of the logging categories
+    LogCategories::applyConfiguration();
+
     // Install the custom message handler
     qInstallMessageHandler(customMessageHandler);
 
     // Register and expose C++ classes to QML
     qmlRegisterType<WeatherData>("com.greenoasis.weather", 1, 0, "WeatherData");
     qmlRegisterType<WeatherModel>("com.greenoasis.weather", 1, 0, "WeatherModel");
+    qmlRegisterType<LogTailModel>("com.greenoasis.logging", 1, 0, "LogTailModel");
 
     // printImportPathsToConsole(engine);
 
     // Get the openweather API key from the config.ini file
-    auto apiKey = ConfigManager::instance().getValue("Weather/OpenWeatherApiKey");
+    WeatherConfig weatherConfig;
+    if (!weatherConfig.apiKey.isSet())
+        qWarning() << "Weather/OpenWeatherApiKey is missing in the config file";
 
     // Create objects related to the weather feature
     WeatherModel weatherModel(&app);
     engine.rootContext()->setContextProperty("weatherModel", &weatherModel);
+    // The latest log lines, requires LogToMemory=true in the [Logging] section
+    LogTailModel logTailModel(&app);
+    engine.rootContext()->setContextProperty("logTailModel", &logTailModel);
     QNetworkAccessManager nam(&app);
-    WeatherFetcher weatherFetcher(&nam, weatherModel, apiKey.toString(), &app);
-    initWeatherFetcher(weatherFetcher);
-    weatherFetcher.startFetching(20000); // [ms] Fetch the current weather in x second intervals
+    WeatherFetcher weatherFetcher(&nam, weatherModel, weatherConfig.apiKey.value(), &app);
+    initWeatherFetcher(weatherFetcher, weatherConfig);
+    // [s] Fetch the current weather in x second intervals
+    const int fetchIntervalSecs = weatherConfig.fetchIntervalSecs.value();
+    weatherFetcher.startFetching((fetchIntervalSecs > 0 ? fetchIntervalSecs : weatherConfig.fetchIntervalSecs.defaultValue()) * 1000);
+
+    // Apply changes of the config file without a restart, the Logger takes care of [Logging] itself.
+    // valueChanged() only notes which keys changed; the values are read from the typed keys once the
+    // snapshot is complete, so they are converted and validated like at start-up. A value that isn't
+    // valid keeps the one in use, the ConfigManager has already reported it.
+    struct WeatherChanges
+    {
+        bool apiKey = false;
+        bool location = false;
+        bool fetchInterval = false;
+    };
+    WeatherChanges weatherChanges;
+    QObject::connect(&ConfigManager::instance(), &ConfigManager::valueChanged, &weatherFetcher,
+                     [&weatherChanges](const QString& key, const QVariant&) {
+        if (key == "Weather/OpenWeatherApiKey")
+            weatherChanges.apiKey = true;
+        else if (key == "Weather/Latitude" || key == "Weather/Longitude")
+            weatherChanges.location = true;
+        else if (key == "Weather/FetchIntervalSecs")
+            weatherChanges.fetchInterval = true;
+        else if (key.startsWith("LogCategories/"))
+            LogCategories::applyConfiguration();
+    });
+    // Latitude and longitude usually change together: fetch once per reload, not once per key
+    QObject::connect(&ConfigManager::instance(), &ConfigManager::reloaded, &weatherFetcher,
+                     [&weatherFetcher, &weatherConfig, &weatherChanges]() {
+        const WeatherChanges changes = std::exchange(weatherChanges, WeatherChanges{});
+        bool fetchNow = false;
+        if (changes.apiKey && weatherConfig.apiKey.isSet())
+        {
+            weatherFetcher.setApiKey(weatherConfig.apiKey.value());
+            fetchNow = true;
+        }
+        if (changes.location)
+        {
+            if (weatherConfig.latitude.isSet())
+                weatherFetcher.setLatitude(weatherConfig.latitude.value());
+            if (weatherConfig.longitude.isSet())
+                weatherFetcher.setLongitude(weatherConfig.longitude.value());
+            fetchNow = weatherConfig.latitude.isSet() || weatherConfig.longitude.isSet() || fetchNow;
+        }
+        if (changes.fetchInterval && weatherConfig.fetchIntervalSecs.isSet())
+        {
+            const int fetchIntervalSecs = weatherConfig.fetchIntervalSecs.value();
+            if (fetchIntervalSecs > 0)
+                weatherFetcher.startFetching(fetchIntervalSecs * 1000);
+            else
+                qWarning() << "Weather/FetchIntervalSecs must be positive, keeping the current interval";
+        }
+        if (fetchNow)
+            weatherFetcher.fetchWeatherData();
+    });
 
     // Follow the new URL policy introduced in Qt6.5, where ':/qt/qml/' is the default resource prefix for QML modules.
     const QUrl url(u"qrc:/qt/qml/qt_rpi4/qml/Main.qml"_qs);
@@ -56,17 +157,25 @@ int main(int argc, char *argv[])
     return app.exec();
 }
 
-void initWeatherFetcher(WeatherFetcher& weatherFetcher)
+QString configFileName(const QCommandLineParser& parser, const QCommandLineOption& configOption)
+{
+    if (parser.isSet(configOption))
+        return parser.value(configOption);
+    const QString fromEnvironment = qEnvironmentVariable("GREENOASIS_CONFIG");
+    if (!fromEnvironment.isEmpty())
+        return fromEnvironment;
+    return QDir(QCoreApplication::applicationDirPath()).filePath("config.ini");
+}
+
+void initWeatherFetcher(WeatherFetcher& weatherFetcher, const WeatherConfig& weatherConfig)
 {
     static bool initDone = false;
     if (initDone) return;
     qInfo() << "Initialising the weather fetcher...";
 
     // Define the weather location to be fetched
-    auto latitude = ConfigManager::instance().getValue("Weather/Latitude");
-    auto longitude = ConfigManager::instance().getValue("Weather/Longitude");
-    weatherFetcher.setLatitude(latitude.toDouble());
-    weatherFetcher.setLongitude(longitude.toDouble());
+    weatherFetcher.setLatitude(weatherConfig.latitude.value());
+    weatherFetcher.setLongitude(weatherConfig.longitude.value());
     weatherFetcher.fetchWeatherData();
     initDone = true;
 }
@@ -0,0 +1,276 @@
+#include "configcache.h"
+#include "iniparser.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QMutex>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+constexpr char Magic[8] = {'G', 'O', 'C', 'F', 'G', 'B', 'I', 'N'};
+
+constexpr qsizetype align8(qsizetype size)
+{
+    return (size + 7) & ~qsizetype(7);
+}
+
+qsizetype recordSize(qsizetype keyLength, qsizetype valueLength)
+{
+    return align8(16 + (keyLength + valueLength) * qsizetype(sizeof(char16_t)));
+}
+
+#ifdef Q_OS_UNIX
+qint64 nsecs(const timespec& time)
+{
+    return qint64(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+#endif
+
+// One thread, so the images of a file are written in the order of the loads. Pending
+// writes are finished when the statics are destroyed.
+struct Writer
+{
+    Writer() { pool.setMaxThreadCount(1); }
+    QThreadPool pool;
+};
+
+Writer& writer()
+{
+    static Writer instance;
+    return instance;
+}
+
+} // namespace
+
+QString ConfigCache::cacheFileName(const QString &iniFileName)
+{
+    return iniFileName + ".cache";
+}
+
+quint64 ConfigCache::hash(QByteArrayView data)
+{
+    quint64 hash = 0x9E3779B97F4A7C15ULL ^ quint64(data.size());
+    const char* position = data.data();
+    const char* const end = position + data.size();
+    for (; end - position >= 8; position += 8)
+    {
+        quint64 word;
+        std::memcpy(&word, position, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    }
+    for (; position < end; ++position)
+        hash = (hash ^ static_cast<uchar>(*position)) * 0x100000001B3ULL;
+    return hash;
+}
+
+bool ConfigCache::load(const QString &iniFileName, ConfigTable &table, QString *errorString, Source *source, bool useCache)
+{
+    QFile iniFile(iniFileName);
+    if (!iniFile.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+            *errorString = iniFile.errorString();
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(Header);
+    const bool identified = useCache && identify(iniFile, header);
+    if (identified)
+    {
+        // Warm start: only the identity of the INI file is checked, its content isn't read
+        if (loadImage(cacheFileName(iniFileName), header, table))
+        {
+            if (source)
+                *source = Source::Cache;
+            return true;
+        }
+    }
+
+    ConfigTable parsed;
+    if (!IniParser::parseFile(iniFile, parsed, errorString))
+        return false;
+
+    // An edit within the same tick of the file system's clock wouldn't change the identity. Every
+    // edit sets the modification time to now, so one far enough in the past can't be repeated.
+    const qint64 nowNsecs = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    const bool settled = nowNsecs - header.iniModifiedNsecs >= SettleMsecs * 1000000;
+    if (identified && settled)
+    {
+        // The copy shares the strings of the table
+        const QString name = cacheFileName(iniFileName);
+        writer().pool.start([name, header, parsed]() { write(name, header, parsed); });
+    }
+    table = std::move(parsed);
+    if (source)
+        *source = Source::Parsed;
+    return true;
+}
+
+void ConfigCache::waitForWrites()
+{
+    writer().pool.waitForDone();
+}
+
+bool ConfigCache::identify(const QFile &iniFile, Header &header)
+{
+#ifdef Q_OS_UNIX
+    // The file that has been opened, even if it has been replaced in the meantime
+    struct stat status;
+    if (fstat(iniFile.handle(), &status) != 0)
+        return false;
+    header.iniSize = status.st_size;
+    header.iniInode = status.st_ino;
+    header.iniDevice = status.st_dev;
+#ifdef Q_OS_DARWIN
+    header.iniModifiedNsecs = nsecs(status.st_mtimespec);
+    header.iniChangedNsecs = nsecs(status.st_ctimespec);
+#else
+    header.iniModifiedNsecs = nsecs(status.st_mtim);
+    header.iniChangedNsecs = nsecs(status.st_ctim);
+#endif
+#else
+    const QFileInfo info(iniFile.fileName());
+    header.iniSize = info.size();
+    header.iniModifiedNsecs = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    header.iniChangedNsecs = info.metadataChangeTime().toMSecsSinceEpoch() * 1000000;
+#endif
+    return true;
+}
+
+bool ConfigCache::sameIni(const Header &header, const Header &expected)
+{
+    return std::memcmp(header.magic, Magic, sizeof(Magic)) == 0
+           && header.version == Version
+           && header.headerSize == sizeof(Header)
+           && sameFile(header, expected);
+}
+
+bool ConfigCache::sameFile(const Header &identity, const Header &expected)
+{
+    return identity.iniModifiedNsecs == expected.iniModifiedNsecs
+           && identity.iniChangedNsecs == expected.iniChangedNsecs
+           && identity.iniSize == expected.iniSize
+           && identity.iniInode == expected.iniInode
+           && identity.iniDevice == expected.iniDevice;
+}
+
+bool ConfigCache::loadImage(const QString &cacheFileName, const Header &expected, ConfigTable &table)
+{
+    // The latest table of every cache file. Its strings are shared with the loaded tables,
+    // a table which has been replaced is freed once the last copy of it is gone.
+    static QMutex mutex;
+    static auto* images = new std::vector<Image>();
+
+    QFile file(cacheFileName);
+    Header fileIdentity{};
+    if (!file.open(QIODevice::ReadOnly) || !identify(file, fileIdentity))
+        return false;
+
+    QMutexLocker locker(&mutex);
+    auto image = std::find_if(images->begin(), images->end(), [&cacheFileName](const Image& candidate) {
+        return candidate.cacheFileName == cacheFileName;
+    });
+    if (image != images->end() && sameFile(image->fileIdentity, fileIdentity) && sameIni(image->header, expected))
+    {
+        table = image->table;
+        return true;
+    }
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(Header)))
+        return false;
+    uchar* mapped = file.map(0, size);
+    if (!mapped)
+        return false;
+
+    Header header;
+    std::memcpy(&header, mapped, sizeof(Header));
+    const QByteArrayView body(reinterpret_cast<const char*>(mapped) + sizeof(Header), size - qint64(sizeof(Header)));
+    ConfigTable decoded;
+    const bool valid = sameIni(header, expected)
+                       && header.bodySize == quint64(body.size())
+                       && header.bodyHash == hash(body)
+                       && decode(body, header.entryCount, decoded);
+    // The strings have been copied out of the mapping, nothing points into it anymore
+    file.unmap(mapped);
+    if (!valid)
+        return false;
+
+    if (image == images->end())
+        image = images->insert(images->end(), Image{cacheFileName, {}, {}, {}});
+    image->fileIdentity = fileIdentity;
+    image->header = header;
+    image->table = decoded;
+    table = std::move(decoded);
+    return true;
+}
+
+bool ConfigCache::decode(QByteArrayView body, quint64 entryCount, ConfigTable &table)
+{
+    // The body hash has matched, the bounds checks only guard against a broken writer
+    table.reserve(static_cast<qsizetype>(qMin<quint64>(entryCount, quint64(body.size() / 16))));
+    qsizetype offset = 0;
+    for (quint64 i = 0; i < entryCount; ++i)
+    {
+        if (body.size() - offset < qsizetype(sizeof(Record)))
+            return false;
+        Record record;
+        std::memcpy(&record, body.data() + offset, sizeof(Record));
+        const qsizetype size = recordSize(record.keyLength, record.valueLength);
+        if (body.size() - offset < size)
+            return false;
+
+        // Copied straight out of the image, the text is UTF-16 already
+        const QChar* text = reinterpret_cast<const QChar*>(body.data() + offset + sizeof(Record));
+        QString key(text, record.keyLength);
+        QString value(text + record.keyLength, record.valueLength);
+        if (!table.appendUnique(std::move(key), QVariant(std::move(value)), record.keyHash))
+            return false;
+        offset += size;
+    }
+    return offset == body.size();
+}
+
+bool ConfigCache::write(const QString &cacheFileName, Header header, const ConfigTable &table)
+{
+    QByteArray body;
+    qsizetype bodySize = 0;
+    for (const ConfigTable::Entry& entry : table)
+        bodySize += recordSize(entry.key.size(), entry.value.toString().size());
+    body.reserve(bodySize);
+
+    for (const ConfigTable::Entry& entry : table)
+    {
+        const QString value = entry.value.toString();
+        Record record{entry.hash, static_cast<quint32>(entry.key.size()), static_cast<quint32>(value.size())};
+        const qsizetype start = body.size();
+        body.append(reinterpret_cast<const char*>(&record), sizeof(Record));
+        body.append(reinterpret_cast<const char*>(entry.key.constData()), entry.key.size() * qsizetype(sizeof(char16_t)));
+        body.append(reinterpret_cast<const char*>(value.constData()), value.size() * qsizetype(sizeof(char16_t)));
+        body.append(recordSize(entry.key.size(), value.size()) - (body.size() - start), '\0');
+    }
+
+    header.entryCount = static_cast<quint64>(table.size());
+    header.bodySize = static_cast<quint64>(body.size());
+    header.bodyHash = hash(body);
+
+    // Readers see either the old or the new image, never a partly written one
+    QSaveFile file(cacheFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(body);
+    return file.commit();
+}
@@ -0,0 +1,98 @@
+#ifndef CONFIGCACHE_H
+#define CONFIGCACHE_H
+
+#include <QByteArrayView>
+#include <QString>
+#include "configtable.h"
+
+class QFile;
+
+/*
+ * Binary image of a parsed config file, kept next to it as "<file>.cache".
+ *
+ * The image stores the identity of the INI file it was built from (size, modification and
+ * status change time in nanoseconds, inode and device). The INI file is checked by this
+ * identity only, its content is neither read nor hashed; only the body of the image has a
+ * hash, checked when it is decoded. If the identity matches, the INI file isn't read at all:
+ * the table is rebuilt from the mapped image, its keys and values are copied from the UTF-16
+ * text in there and the key hashes are stored, so nothing is tokenized, converted or
+ * rehashed. Otherwise the INI file is parsed
+ * and the image is rewritten (temp file + rename) on a background thread, off the start-up
+ * path. Files modified within the last SettleMsecs don't get an image yet, a second edit
+ * within the resolution of the file system's time stamps would go unnoticed.
+ *
+ * The image is unmapped as soon as it has been decoded. The table decoded last is kept per
+ * cache file and shared (implicitly, like any QString) by all later loads as long as neither
+ * the INI file nor the cache file have been replaced, so a warm load copies no strings. A
+ * newer image replaces it, the old one is freed with the last table using it.
+ *
+ * Layout, native byte order:
+ *   Header (80 bytes): magic "GOCFGBIN", version, headerSize, iniModifiedNsecs,
+ *                      iniChangedNsecs, iniSize, iniInode, iniDevice, entryCount,
+ *                      bodySize, bodyHash
+ *   entryCount records, each aligned to 8 bytes:
+ *     keyHash (8), keyLength (4), valueLength (4), key (UTF-16), value (UTF-16)
+ */
+class ConfigCache
+{
+public:
+    static constexpr quint32 Version = 3; // 3: 64 bit key hashes on 32 bit platforms as well
+    static constexpr qint64 SettleMsecs = 2000;
+
+    enum class Source { Cache, Parsed };
+
+    static QString cacheFileName(const QString& iniFileName);
+    // Loads the INI file through the cache, or parses it if useCache is false.
+    // Returns false if the INI file can't be read; a cache that can't be written is ignored.
+    static bool load(const QString& iniFileName, ConfigTable& table, QString* errorString = nullptr,
+                     Source* source = nullptr, bool useCache = true);
+    // Blocks until the images queued by load() have been written
+    static void waitForWrites();
+
+    // Multiply-xorshift over 8 byte words, stable across builds and runs
+    static quint64 hash(QByteArrayView data);
+
+private:
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 headerSize;
+        qint64 iniModifiedNsecs;
+        qint64 iniChangedNsecs;
+        qint64 iniSize;
+        quint64 iniInode;
+        quint64 iniDevice;
+        quint64 entryCount;
+        quint64 bodySize;
+        quint64 bodyHash;
+    };
+    static_assert(sizeof(Header) == 80, "The cache header has to be 80 bytes");
+
+    struct Record
+    {
+        quint64 keyHash;
+        quint32 keyLength;   // UTF-16 code units
+        quint32 valueLength; // UTF-16 code units
+    };
+    static_assert(sizeof(Record) == 16, "A cache record has to be 16 bytes");
+
+    // The table decoded from the latest validated image of a cache file
+    struct Image
+    {
+        QString cacheFileName;
+        Header fileIdentity; // Of the cache file, only the ini* fields are set
+        Header header;
+        ConfigTable table;
+    };
+
+    static bool identify(const QFile& iniFile, Header& header);
+    static bool sameIni(const Header& header, const Header& expected);
+    static bool sameFile(const Header& identity, const Header& expected);
+    // False if there is no valid image for the INI file
+    static bool loadImage(const QString& cacheFileName, const Header& expected, ConfigTable& table);
+    static bool decode(QByteArrayView body, quint64 entryCount, ConfigTable& table);
+    static bool write(const QString& cacheFileName, Header header, const ConfigTable& table);
+};
+
+#endif // CONFIGCACHE_H
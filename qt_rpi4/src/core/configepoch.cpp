@@ -0,0 +1,48 @@
+#include "configepoch.h"
+#include <QThread>
+
+int ConfigEpoch::enter()
+{
+    // All operations are sequentially consistent: a reader that has loaded the old snapshot
+    // pointer has entered before the writer published the new one, so the writer sees it
+    const int parity = static_cast<int>(m_epoch.load() & 1);
+    const int stripe = threadStripe();
+    m_counters[parity][stripe].readers.fetch_add(1);
+    return parity * Stripes + stripe;
+}
+
+void ConfigEpoch::leave(int slot)
+{
+    m_counters[slot / Stripes][slot % Stripes].readers.fetch_sub(1);
+}
+
+void ConfigEpoch::synchronize()
+{
+    // New readers go to the other counter after each flip, so both waits come to an end
+    for (int i = 0; i < 2; ++i)
+    {
+        const int oldParity = static_cast<int>(m_epoch.fetch_add(1) & 1);
+        waitForReaders(oldParity);
+    }
+}
+
+void ConfigEpoch::waitForReaders(int parity) const
+{
+    // A reader stays on one stripe, so every stripe is >= 0 and the sum is 0 only without readers
+    for (;;)
+    {
+        qint64 readers = 0;
+        for (const Counter& counter : m_counters[parity])
+            readers += counter.readers.load();
+        if (readers == 0)
+            return;
+        QThread::yieldCurrentThread();
+    }
+}
+
+int ConfigEpoch::threadStripe()
+{
+    static std::atomic<int> nextStripe{0};
+    static thread_local const int stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % Stripes;
+    return stripe;
+}
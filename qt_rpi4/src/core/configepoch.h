@@ -0,0 +1,61 @@
+#ifndef CONFIGEPOCH_H
+#define CONFIGEPOCH_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/*
+ * Lets readers use a published config snapshot without taking a lock, and tells the writer
+ * when a replaced snapshot can be deleted.
+ *
+ * A reader enters one of two counters, chosen by the current epoch, before it loads the
+ * snapshot pointer and leaves it when it is done: one fetch_add and one fetch_sub, no retry
+ * loop, so reads are wait-free. After publishing a new pointer the writer flips the epoch and
+ * waits for the counter of the old epoch to drain, then does the same for the other one, which
+ * also covers readers that read the epoch just before a flip. Each counter is spread over
+ * cache lines by thread, so concurrent readers don't contend for a single line.
+ *
+ * Only one thread at a time may call synchronize().
+ */
+class ConfigEpoch
+{
+public:
+    // RAII read section: the snapshot loaded inside stays valid until it is destroyed
+    class Reader
+    {
+    public:
+        explicit Reader(ConfigEpoch& epoch) : m_epoch{epoch}, m_slot{epoch.enter()} {}
+        ~Reader() { m_epoch.leave(m_slot); }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+    private:
+        ConfigEpoch& m_epoch;
+        const int m_slot;
+    };
+
+    ConfigEpoch() = default;
+    ConfigEpoch(const ConfigEpoch&) = delete;
+    ConfigEpoch& operator=(const ConfigEpoch&) = delete;
+
+    int enter();
+    void leave(int slot);
+    // Returns once every reader that could still see the previous snapshot has left
+    void synchronize();
+
+private:
+    static constexpr int Stripes = 16;
+
+    struct alignas(64) Counter
+    {
+        std::atomic<qint64> readers{0};
+    };
+
+    void waitForReaders(int parity) const;
+    static int threadStripe();
+
+    std::atomic<quint64> m_epoch{0};
+    Counter m_counters[2][Stripes];
+};
+
+#endif // CONFIGEPOCH_H
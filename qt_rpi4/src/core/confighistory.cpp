@@ -0,0 +1,238 @@
+#include "confighistory.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = {'G', 'O', 'C', 'F', 'G', 'H', 'I', 'S'};
+
+} // namespace
+
+void ConfigHistory::setCapacity(int capacity)
+{
+    m_capacity = qMax(capacity, 1);
+    trim();
+}
+
+int ConfigHistory::capacity() const
+{
+    return m_capacity;
+}
+
+bool ConfigHistory::isEmpty() const
+{
+    return m_versions.empty();
+}
+
+qsizetype ConfigHistory::size() const
+{
+    return static_cast<qsizetype>(m_versions.size());
+}
+
+quint64 ConfigHistory::lastId() const
+{
+    return m_lastId;
+}
+
+QList<quint64> ConfigHistory::ids() const
+{
+    QList<quint64> ids;
+    ids.reserve(size());
+    for (const Version& version : m_versions)
+        ids.append(version.id);
+    return ids;
+}
+
+const ConfigHistory::Version *ConfigHistory::version(quint64 id) const
+{
+    const auto it = std::lower_bound(m_versions.begin(), m_versions.end(), id,
+                                     [](const Version& version, quint64 id) { return version.id < id; });
+    return it != m_versions.end() && it->id == id ? &*it : nullptr;
+}
+
+const ConfigHistory::Version *ConfigHistory::latest() const
+{
+    return m_versions.empty() ? nullptr : &m_versions.back();
+}
+
+void ConfigHistory::record(quint64 id, const QString &origin, qint64 timestampMsecs, const ConfigTable &values,
+                           const QStringList &changedKeys)
+{
+    ConfigPersistentMap map = m_versions.empty() ? ConfigPersistentMap() : m_versions.back().values;
+    for (const QString& key : changedKeys)
+    {
+        const QVariant* value = values.find(key);
+        map = value ? map.inserted(key, *value) : map.removed(key);
+    }
+    record(id, origin, timestampMsecs, map);
+}
+
+void ConfigHistory::record(quint64 id, const QString &origin, qint64 timestampMsecs, const ConfigTable &values)
+{
+    const ConfigPersistentMap latest = m_versions.empty() ? ConfigPersistentMap() : m_versions.back().values;
+    record(id, origin, timestampMsecs, withValues(latest, values));
+}
+
+ConfigPersistentMap ConfigHistory::withValues(const ConfigPersistentMap &base, const ConfigTable &values)
+{
+    ConfigPersistentMap map = base;
+    QStringList removedKeys;
+    map.forEach([&values, &removedKeys](const QString& key, const QVariant&) {
+        if (!values.contains(key))
+            removedKeys.append(key);
+    });
+    for (const QString& key : std::as_const(removedKeys))
+        map = map.removed(key);
+    // Unchanged values leave the map as it is
+    for (const ConfigTable::Entry& entry : values)
+        map = map.inserted(entry.key, entry.value);
+    return map;
+}
+
+void ConfigHistory::record(quint64 id, const QString &origin, qint64 timestampMsecs, const ConfigPersistentMap &values)
+{
+    if (id <= m_lastId)
+        return;
+    m_versions.push_back({id, timestampMsecs, origin, values});
+    m_lastId = id;
+    trim();
+}
+
+bool ConfigHistory::diff(quint64 from, quint64 to, QList<ConfigPersistentMap::Change> *changes) const
+{
+    const Version* fromVersion = version(from);
+    const Version* toVersion = version(to);
+    if (!fromVersion || !toVersion)
+        return false;
+    *changes = ConfigPersistentMap::diff(fromVersion->values, toVersion->values);
+    return true;
+}
+
+bool ConfigHistory::save(const QString &fileName, QString *errorString) const
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_5);
+        stream << static_cast<quint32>(m_versions.size());
+        const ConfigPersistentMap* previous = nullptr;
+        for (const Version& version : m_versions)
+        {
+            stream << version.id << version.timestampMsecs << version.origin;
+            if (!previous)
+            {
+                // The oldest version in full
+                stream << static_cast<quint32>(version.values.size());
+                version.values.forEach([&stream](const QString& key, const QVariant& value) {
+                    stream << key << true << value;
+                });
+            }
+            else
+            {
+                // Only what has changed since the one before it
+                const QList<ConfigPersistentMap::Change> changes = ConfigPersistentMap::diff(*previous, version.values);
+                stream << static_cast<quint32>(changes.size());
+                for (const ConfigPersistentMap::Change& change : changes)
+                {
+                    stream << change.key << change.newValue.isValid();
+                    if (change.newValue.isValid())
+                        stream << change.newValue;
+                }
+            }
+            previous = &version.values;
+        }
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    QDataStream header(&file);
+    header.writeRawData(Magic, sizeof(Magic));
+    header << FormatVersion;
+    file.write(qCompress(payload));
+    if (!file.commit())
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ConfigHistory::load(const QString &fileName, QString *errorString)
+{
+    auto fail = [errorString](const QString& error) {
+        if (errorString)
+            *errorString = error;
+        return false;
+    };
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(file.errorString());
+    const QByteArray content = file.readAll();
+    const qsizetype headerSize = sizeof(Magic) + sizeof(quint32);
+    if (content.size() < headerSize || std::memcmp(content.constData(), Magic, sizeof(Magic)) != 0)
+        return fail("Not a config history file");
+    QDataStream header(content.sliced(sizeof(Magic), sizeof(quint32)));
+    quint32 formatVersion = 0;
+    header >> formatVersion;
+    if (formatVersion != FormatVersion)
+        return fail(QString("Unsupported config history format %1").arg(formatVersion));
+    const QByteArray payload = qUncompress(content.sliced(headerSize));
+    if (payload.isEmpty())
+        return fail("The config history is corrupt");
+
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_6_5);
+    std::deque<Version> versions;
+    quint32 count = 0;
+    stream >> count;
+    ConfigPersistentMap values;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        Version version;
+        quint32 changeCount = 0;
+        stream >> version.id >> version.timestampMsecs >> version.origin >> changeCount;
+        for (quint32 change = 0; change < changeCount && stream.status() == QDataStream::Ok; ++change)
+        {
+            QString key;
+            bool present = false;
+            stream >> key >> present;
+            if (present)
+            {
+                QVariant value;
+                stream >> value;
+                values = values.inserted(key, value);
+            }
+            else
+            {
+                values = values.removed(key);
+            }
+        }
+        if (!versions.empty() && version.id <= versions.back().id)
+            return fail("The config history is corrupt");
+        version.values = values;
+        versions.push_back(std::move(version));
+    }
+    if (stream.status() != QDataStream::Ok)
+        return fail("The config history is corrupt");
+
+    m_versions = std::move(versions);
+    m_lastId = qMax(m_lastId, m_versions.empty() ? 0 : m_versions.back().id);
+    trim();
+    return true;
+}
+
+void ConfigHistory::trim()
+{
+    while (m_versions.size() > static_cast<size_t>(m_capacity))
+        m_versions.pop_front();
+}
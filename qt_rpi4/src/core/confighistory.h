@@ -0,0 +1,78 @@
+#ifndef CONFIGHISTORY_H
+#define CONFIGHISTORY_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <deque>
+#include "configpersistentmap.h"
+#include "configtable.h"
+
+/*
+ * The latest versions of the config, e.g. to see when an irrigation schedule was changed and
+ * to go back to it.
+ *
+ * Every version is a ConfigPersistentMap which shares all unchanged values with the version
+ * before it, so recording a version costs O(changed keys), and so do diffing two versions and
+ * restoring one. Versions are addressed by id, which is the version of the ConfigSnapshot.
+ *
+ * On disk, the oldest version is stored in full and every later one as the keys that changed,
+ * the whole history compressed with qCompress():
+ *   "GOCFGHIS", format version (quint32), compressed QDataStream payload
+ */
+class ConfigHistory
+{
+public:
+    static constexpr int DefaultCapacity = 100;
+    static constexpr quint32 FormatVersion = 2; // 2: ConfigManager records the file layer
+
+    struct Version
+    {
+        quint64 id = 0;
+        qint64 timestampMsecs = 0; // Since the epoch
+        QString origin;            // What created it, e.g. "reload" or "restore 12"
+        ConfigPersistentMap values;
+    };
+
+    // The oldest versions are dropped once there are more
+    void setCapacity(int capacity);
+    int capacity() const;
+
+    bool isEmpty() const;
+    qsizetype size() const;
+    // 0 if nothing has been recorded yet
+    quint64 lastId() const;
+    // Oldest first
+    QList<quint64> ids() const;
+    // nullptr if there is no such version (anymore)
+    const Version* version(quint64 id) const;
+    const Version* latest() const;
+
+    // Records a version with the values of the latest one, except for changedKeys, which are
+    // taken from values (removed if values doesn't have them). id has to be larger than lastId().
+    void record(quint64 id, const QString& origin, qint64 timestampMsecs, const ConfigTable& values,
+                const QStringList& changedKeys);
+    // Records a version with exactly the values of the table, sharing what is unchanged with the latest one
+    void record(quint64 id, const QString& origin, qint64 timestampMsecs, const ConfigTable& values);
+    // Records a version with exactly these values, e.g. those of an older version
+    void record(quint64 id, const QString& origin, qint64 timestampMsecs, const ConfigPersistentMap& values);
+
+    // The map with exactly the values of the table, sharing everything unchanged with base
+    static ConfigPersistentMap withValues(const ConfigPersistentMap& base, const ConfigTable& values);
+
+    // False if one of the versions doesn't exist
+    bool diff(quint64 from, quint64 to, QList<ConfigPersistentMap::Change>* changes) const;
+
+    bool save(const QString& fileName, QString* errorString = nullptr) const;
+    // Replaces the versions in memory, false if the file can't be read or is corrupt
+    bool load(const QString& fileName, QString* errorString = nullptr);
+
+private:
+    void trim();
+
+    std::deque<Version> m_versions; // Oldest first, ids in ascending order
+    int m_capacity = DefaultCapacity;
+    quint64 m_lastId = 0; // Kept when all versions have been dropped
+};
+
+#endif // CONFIGHISTORY_H
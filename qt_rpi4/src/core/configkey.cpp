@@ -0,0 +1,72 @@
+#include "configkey.h"
+#include "configmanager.h"
+
+bool ConfigConversion::convert(const QVariant &value, bool &result)
+{
+    const QString text = value.toString().trimmed().toLower();
+    if (text == "true" || text == "yes" || text == "on" || text == "1")
+        result = true;
+    else if (text == "false" || text == "no" || text == "off" || text == "0")
+        result = false;
+    else
+        return false;
+    return true;
+}
+
+bool ConfigConversion::convert(const QVariant &value, int &result)
+{
+    bool ok = false;
+    const int converted = value.toString().trimmed().toInt(&ok);
+    if (ok)
+        result = converted;
+    return ok;
+}
+
+bool ConfigConversion::convert(const QVariant &value, qint64 &result)
+{
+    bool ok = false;
+    const qint64 converted = value.toString().trimmed().toLongLong(&ok);
+    if (ok)
+        result = converted;
+    return ok;
+}
+
+bool ConfigConversion::convert(const QVariant &value, double &result)
+{
+    bool ok = false;
+    const double converted = value.toString().trimmed().toDouble(&ok);
+    if (ok)
+        result = converted;
+    return ok;
+}
+
+bool ConfigConversion::convert(const QVariant &value, QString &result)
+{
+    result = value.toString();
+    return true;
+}
+
+ConfigKeyBase::ConfigKeyBase(const QString &key)
+    : m_epoch{ConfigManager::instance().m_epoch},
+      m_key{key}
+{
+}
+
+ConfigKeyBase::~ConfigKeyBase()
+{
+}
+
+QString ConfigKeyBase::key() const
+{
+    return m_key;
+}
+
+void ConfigKeyBase::registerKey()
+{
+    ConfigManager::instance().registerKey(this);
+}
+
+void ConfigKeyBase::unregisterKey()
+{
+    ConfigManager::instance().unregisterKey(this);
+}
@@ -0,0 +1,157 @@
+#ifndef CONFIGKEY_H
+#define CONFIGKEY_H
+
+#include <QString>
+#include <QVariant>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "configepoch.h"
+#include "configsnapshot.h"
+
+// Strict conversions of config values, false if the value isn't valid for the type
+namespace ConfigConversion
+{
+    bool convert(const QVariant& value, bool& result);   // true/false, yes/no, on/off, 1/0
+    bool convert(const QVariant& value, int& result);
+    bool convert(const QVariant& value, qint64& result);
+    bool convert(const QVariant& value, double& result);
+    bool convert(const QVariant& value, QString& result);
+
+    // Anything else QVariant can convert to
+    template<typename T>
+    bool convert(const QVariant& value, T& result)
+    {
+        QVariant converted = value;
+        if (!converted.convert(QMetaType::fromType<T>()))
+            return false;
+        result = converted.value<T>();
+        return true;
+    }
+}
+
+/*
+ * Untyped part of ConfigKey. The ConfigManager resolves every registered key whenever it
+ * publishes a new snapshot, so reading a key never looks anything up.
+ */
+class ConfigKeyBase
+{
+public:
+    QString key() const;
+
+    ConfigKeyBase(const ConfigKeyBase&) = delete;
+    ConfigKeyBase& operator=(const ConfigKeyBase&) = delete;
+
+protected:
+    explicit ConfigKeyBase(const QString& key);
+    virtual ~ConfigKeyBase(); // Deconstructor
+
+    // Have to be called by the constructor and the destructor of the derived class
+    void registerKey();
+    void unregisterKey();
+
+    ConfigEpoch& m_epoch; // Of the ConfigManager, guards the resolved values
+
+private:
+    friend class ConfigManager;
+
+    // Called by the ConfigManager with its writer lock held. Publishes the value of the key in
+    // the snapshot (nullptr: none loaded yet) and returns a description of a type error, if any.
+    virtual QString resolve(const ConfigSnapshot* snapshot) = 0;
+    // Called by the ConfigManager once no reader can see the replaced values anymore
+    virtual void reclaim() = 0;
+
+    const QString m_key;
+};
+
+/*
+ * A typed, pre-resolved config value, e.g.
+ *   ConfigKey<double> latitude{"Weather/Latitude", 52.52};
+ *   weatherFetcher.setLatitude(latitude.value());
+ *
+ * value() is a pointer dereference, wait-free and safe on any thread. Values that can't be
+ * converted to T are reported once when the config is loaded and read as the default.
+ */
+template<typename T>
+class ConfigKey : public ConfigKeyBase
+{
+public:
+    ConfigKey(const QString& key, const T& defaultValue = T())
+        : ConfigKeyBase{key},
+          m_defaultValue{defaultValue}
+    {
+        registerKey();
+    }
+
+    ~ConfigKey() override
+    {
+        unregisterKey();
+        delete m_current.load();
+        reclaim();
+    }
+
+    T value() const
+    {
+        ConfigEpoch::Reader reader(m_epoch);
+        return m_current.load()->value;
+    }
+
+    // False if the key is missing or its value isn't valid, value() returns the default then
+    bool isSet() const
+    {
+        ConfigEpoch::Reader reader(m_epoch);
+        return m_current.load()->isSet;
+    }
+
+    T defaultValue() const
+    {
+        return m_defaultValue;
+    }
+
+private:
+    struct Resolved
+    {
+        T value;
+        bool isSet;
+    };
+
+    QString resolve(const ConfigSnapshot* snapshot) override;
+
+    void reclaim() override
+    {
+        for (const Resolved* resolved : m_retired)
+            delete resolved;
+        m_retired.clear();
+    }
+
+    const T m_defaultValue;
+    std::atomic<const Resolved*> m_current{nullptr};
+    std::vector<const Resolved*> m_retired; // Replaced, but possibly still being read
+};
+
+template<typename T>
+QString ConfigKey<T>::resolve(const ConfigSnapshot* snapshot)
+{
+    QString error;
+    auto resolved = std::make_unique<Resolved>(Resolved{m_defaultValue, false});
+    const QVariant rawValue = snapshot ? snapshot->value(key()) : QVariant();
+    if (rawValue.isValid())
+    {
+        T value = m_defaultValue;
+        if (ConfigConversion::convert(rawValue, value))
+        {
+            resolved->value = value;
+            resolved->isSet = true;
+        }
+        else
+        {
+            error = QString("%1=%2 is not a valid %3, using the default")
+                        .arg(key(), rawValue.toString(), QString::fromLatin1(QMetaType::fromType<T>().name()));
+        }
+    }
+    if (const Resolved* previous = m_current.exchange(resolved.release()))
+        m_retired.push_back(previous);
+    return error;
+}
+
+#endif // CONFIGKEY_H
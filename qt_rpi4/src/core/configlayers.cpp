@@ -0,0 +1,124 @@
+#include "configlayers.h"
+#include <algorithm>
+
+void ConfigLayers::setDefaults(const ConfigTable &defaults)
+{
+    m_defaults = ConfigTable();
+    m_defaults.reserve(defaults.size());
+    for (const ConfigTable::Entry& entry : defaults)
+        m_defaults.insert(entry.key, entry.value.toString(), ConfigSource::Default);
+}
+
+void ConfigLayers::setEnvironment(const QProcessEnvironment &environment)
+{
+    m_environment = ConfigTable();
+    const QString prefix = QString::fromLatin1(EnvironmentPrefix);
+    for (const QString& name : environment.keys())
+    {
+        if (!name.startsWith(prefix) || !name.contains("__"))
+            continue;
+        const QString key = name.sliced(prefix.size()).replace("__", "/");
+        if (key.startsWith('/') || key.endsWith('/'))
+            continue;
+        m_environment.insert(key, environment.value(name), ConfigSource::Environment);
+    }
+}
+
+bool ConfigLayers::setCommandLine(const QStringList &assignments, QString *errorString)
+{
+    ConfigTable commandLine;
+    for (const QString& assignment : assignments)
+    {
+        // Like in the file, the value is everything after the first '='
+        const qsizetype separator = assignment.indexOf('=');
+        const QString key = assignment.left(separator).trimmed();
+        if (separator < 0 || key.isEmpty())
+        {
+            if (errorString)
+                *errorString = QString("Expected Section/Key=value, got \"%1\"").arg(assignment);
+            return false;
+        }
+        commandLine.insert(key, assignment.sliced(separator + 1).trimmed(), ConfigSource::CommandLine);
+    }
+    m_commandLine = std::move(commandLine);
+    return true;
+}
+
+ConfigTable ConfigLayers::merge(ConfigTable file) const
+{
+    if (m_defaults.isEmpty() && m_environment.isEmpty() && m_commandLine.isEmpty())
+        return file;
+
+    ConfigTable merged;
+    merged.reserve(m_defaults.size() + file.size() + m_environment.size() + m_commandLine.size());
+    apply(merged, m_defaults, ConfigSource::Default, true);
+    apply(merged, file, ConfigSource::File, true);
+    apply(merged, m_environment, ConfigSource::Environment, false);
+    apply(merged, m_commandLine, ConfigSource::CommandLine, true);
+    return merged;
+}
+
+bool ConfigLayers::resolve(const QString &key, const QVariant *fileValue, ConfigTable::Entry &merged) const
+{
+    for (const ConfigTable::Entry& entry : m_environment)
+    {
+        if (entry.key != key && entry.key.compare(key, Qt::CaseInsensitive) == 0)
+            return false;
+    }
+
+    merged = ConfigTable::Entry{key, QVariant(), ConfigTable::hashKey(key), ConfigSource::Unset};
+    const ConfigTable::Entry* overriding = m_commandLine.findEntry(key);
+    if (!overriding)
+        overriding = m_environment.findEntry(key);
+    if (overriding)
+    {
+        merged.value = overriding->value;
+        merged.source = overriding->source;
+    }
+    else if (fileValue)
+    {
+        merged.value = *fileValue;
+        merged.source = ConfigSource::File;
+    }
+    else if (const ConfigTable::Entry* defaultEntry = m_defaults.findEntry(key))
+    {
+        merged.value = defaultEntry->value;
+        merged.source = ConfigSource::Default;
+    }
+    return true;
+}
+
+QString ConfigLayers::sourceName(ConfigSource source)
+{
+    switch (source)
+    {
+    case ConfigSource::Unset: return "unset";
+    case ConfigSource::Default: return "default";
+    case ConfigSource::File: return "file";
+    case ConfigSource::Environment: return "environment";
+    case ConfigSource::CommandLine: return "command line";
+    }
+    return QString();
+}
+
+void ConfigLayers::apply(ConfigTable &merged, const ConfigTable &layer, ConfigSource source, bool matchCase)
+{
+    for (const ConfigTable::Entry& entry : layer)
+    {
+        if (!matchCase && !merged.contains(entry.key))
+        {
+            // Environment variables are often written in upper case: use the spelling of the key
+            // a lower layer has, there are only a few overrides to look up like this
+            auto existing = std::find_if(merged.begin(), merged.end(), [&entry](const ConfigTable::Entry& other) {
+                return other.key.compare(entry.key, Qt::CaseInsensitive) == 0;
+            });
+            if (existing != merged.end())
+            {
+                const QString key = existing->key;
+                merged.insert(key, entry.value, source);
+                continue;
+            }
+        }
+        merged.insert(entry.key, entry.value, source);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CONFIGLAYERS_H
+#define CONFIGLAYERS_H
+
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+#include "configtable.h"
+
+/*
+ * The layers around the config file: built-in defaults below it, environment variables and
+ * command line overrides above it. merge() flattens them into one table, so a lookup is still a
+ * single hash probe, and tags every entry with the layer its value comes from.
+ *
+ * Environment variables: GREENOASIS_<Section>__<Key>, "__" separates the parts of the key,
+ * e.g. GREENOASIS_Weather__Latitude=52.52 or GREENOASIS_Zone__1__Valve=3. If a lower layer has
+ * the key in another case (GREENOASIS_WEATHER__LATITUDE), its spelling is used. Names without
+ * "__", like GREENOASIS_CONFIG, aren't config values and are ignored.
+ */
+class ConfigLayers
+{
+public:
+    static constexpr const char* EnvironmentPrefix = "GREENOASIS_";
+
+    void setDefaults(const ConfigTable& defaults);
+    void setEnvironment(const QProcessEnvironment& environment);
+    // "Section/Key=value", as given to --set. Nothing is changed if one of them is malformed.
+    bool setCommandLine(const QStringList& assignments, QString* errorString = nullptr);
+
+    // Defaults, then the file, then the environment, then the command line
+    ConfigTable merge(ConfigTable file) const;
+    // The entry merge() makes of one key, given its value in the file (nullptr if the file
+    // doesn't have it). The value is invalid if no layer has the key. False if the result
+    // depends on the other keys of the file: an environment variable names the key in
+    // another case.
+    bool resolve(const QString& key, const QVariant* fileValue, ConfigTable::Entry& merged) const;
+
+    static QString sourceName(ConfigSource source);
+
+private:
+    static void apply(ConfigTable& merged, const ConfigTable& layer, ConfigSource source, bool matchCase);
+
+    ConfigTable m_defaults;
+    ConfigTable m_environment;
+    ConfigTable m_commandLine;
+};
+
+#endif // CONFIGLAYERS_H
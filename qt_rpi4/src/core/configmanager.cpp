@@ -1,13 +1,39 @@
 #include "configmanager.h"
+#include "configkey.h"
+#include "configcache.h"
+#include "iniwriter.h"
+#include "logcategories.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QThreadPool>
+
+namespace {
+
+// Inserts the changed values into the table, invalid values remove their key
+void applyChanges(ConfigTable& values, const ConfigTable& changes)
+{
+    for (const ConfigTable::Entry& entry : changes)
+    {
+        if (entry.value.isValid())
+            values.insert(entry.key, entry.value);
+        else
+            values.remove(entry.key);
+    }
+}
+
+} // namespace
 
 ConfigManager::ConfigManager()
 {
     setObjectName("ConfigManager");
+    m_layers.setEnvironment(QProcessEnvironment::systemEnvironment());
 }
 
 ConfigManager::~ConfigManager()
 {
-    // Cleanup if necessary
+    // Nobody can be reading anymore
+    delete m_snapshot.exchange(nullptr);
 }
 
 /* Singleton pattern -> ensures that this class has only one instance
@@ -20,42 +46,583 @@ ConfigManager &ConfigManager::instance()
 
 void ConfigManager::initialise(const QString& configFileName)
 {
-    QFile configFile(configFileName);
-    if (!configFile.open(QIODevice::ReadOnly))
+    Published published;
+    QString persistError;
     {
-        throw std::runtime_error("Couldn't open the config file: " + configFile.errorString().toStdString());
+        QMutexLocker locker(&m_writeMutex);
+        ConfigTable values;
+        QString errorString;
+        if (!ConfigCache::load(configFileName, values, &errorString, nullptr, m_cacheEnabled))
+        {
+            throw std::runtime_error("Couldn't open the config file: " + errorString.toStdString());
+        }
+        if (configFileName != m_fileName && !m_pendingWrites.isEmpty())
+        {
+            persistError = persist(); // Written values belong to the previous file
+            m_pendingWrites = ConfigTable();
+        }
+        // Values which haven't been written to this file yet still apply
+        applyChanges(values, m_pendingWrites);
+        m_fileName = configFileName;
+        m_fileValues = values;
+        m_fileMap = ConfigHistory::withValues(m_fileMap, m_fileValues);
+        published = publish(m_layers.merge(std::move(values)), "initialise");
     }
+    if (!persistError.isEmpty())
+        qCWarning(lcCore) << this << "Failed to write the changed values:" << persistError;
+    logPublishErrors(published);
+    logOverrides();
+    emitChanges(published);
+    scheduleWrite();
+
+    // The watcher has to live in the thread of the event loop
+    if (QCoreApplication* app = QCoreApplication::instance())
+        QMetaObject::invokeMethod(app, [this, configFileName]() { watch(configFileName); });
+}
+
+void ConfigManager::reload()
+{
+    const QString configFileName = fileName();
+    if (configFileName.isEmpty())
+        return;
+    QThreadPool::globalInstance()->start([this, configFileName]() { reloadFile(configFileName); });
+}
+
+QString ConfigManager::fileName() const
+{
+    QMutexLocker locker(&m_writeMutex);
+    return m_fileName;
+}
+
+void ConfigManager::setCacheEnabled(bool enabled)
+{
+    m_cacheEnabled = enabled;
+}
+
+void ConfigManager::setDefaults(const ConfigTable &defaults)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_layers.setDefaults(defaults);
+}
+
+void ConfigManager::setEnvironment(const QProcessEnvironment &environment)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_layers.setEnvironment(environment);
+}
+
+bool ConfigManager::setOverrides(const QStringList &assignments, QString *errorString)
+{
+    QMutexLocker locker(&m_writeMutex);
+    return m_layers.setCommandLine(assignments, errorString);
+}
+
+ConfigSource ConfigManager::source(const QString &key) const
+{
+    ConfigEpoch::Reader reader(m_epoch);
+    const ConfigSnapshot* snapshot = m_snapshot.load();
+    const ConfigTable::Entry* entry = snapshot ? snapshot->values().findEntry(key) : nullptr;
+    return entry ? entry->source : ConfigSource::Unset;
+}
+
+quint64 ConfigManager::version() const
+{
+    ConfigEpoch::Reader reader(m_epoch);
+    const ConfigSnapshot* snapshot = m_snapshot.load();
+    return snapshot ? snapshot->version() : 0;
+}
 
-    QTextStream stream(&configFile);
-    QString currentSection;
-    while (!stream.atEnd())
+QVariant ConfigManager::getValue(const QString &key) const
+{
     {
-        QString line = stream.readLine().trimmed();
-        if (line.startsWith("[") && line.endsWith("]"))
+        ConfigEpoch::Reader reader(m_epoch);
+        const ConfigSnapshot* snapshot = m_snapshot.load();
+        if (snapshot)
         {
-            // Set current section
-            currentSection = line.mid(1, line.length() - 2);
+            if (const QVariant* value = snapshot->values().find(key))
+                return *value;
         }
-        else
+    }
+    qCWarning(lcCore) << this << "key not found: " << key;
+    return QVariant();
+}
+
+QVariant ConfigManager::getValue(const QString &key, const QVariant &defaultValue) const
+{
+    ConfigEpoch::Reader reader(m_epoch);
+    const ConfigSnapshot* snapshot = m_snapshot.load();
+    return snapshot ? snapshot->value(key, defaultValue) : defaultValue;
+}
+
+void ConfigManager::setValue(const QString &key, const QVariant &value)
+{
+    Published published;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        m_update.insert(key, value.toString());
+        if (m_updateDepth > 0)
+            return; // Published by commit()
+        published = applyUpdate("set");
+    }
+    finishUpdate(published);
+}
+
+void ConfigManager::beginUpdate()
+{
+    QMutexLocker locker(&m_writeMutex);
+    ++m_updateDepth;
+}
+
+void ConfigManager::commit()
+{
+    Published published;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        if (m_updateDepth == 0 || --m_updateDepth > 0)
+            return;
+        published = applyUpdate("set");
+    }
+    finishUpdate(published);
+}
+
+void ConfigManager::setWriteDelay(int msecs)
+{
+    m_writeDelayMsecs = qMax(msecs, 0);
+}
+
+bool ConfigManager::flush()
+{
+    QString errorString;
+    bool hadPendingWrites = false;
+    QString fileName;
+    // The versions share their values with the history, so the copy is cheap
+    std::optional<ConfigHistory> history;
+    QString historyFile;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        if (m_historyDirty && !m_historyFile.isEmpty())
         {
-            // Split the line into key/value pairs
-            QStringList parts = line.split('=');
-            if (parts.count() == 2)
-            {
-                // Use the ternary operator to handle keys with and without sections
-                QString key = currentSection.isEmpty() ? parts[0].trimmed() :
-                                  currentSection + "/" + parts[0].trimmed();
-                m_configData.insert(key, parts[1].trimmed());
-            }
+            history = m_history;
+            historyFile = m_historyFile;
+        }
+        m_historyDirty = false;
+        hadPendingWrites = !m_pendingWrites.isEmpty();
+        if (hadPendingWrites)
+        {
+            fileName = m_fileName;
+            errorString = persist();
         }
     }
-    configFile.close();
+    const bool historySaved = !history || saveHistory(*history, historyFile);
+    if (!errorString.isEmpty())
+    {
+        qCWarning(lcCore) << this << "Failed to write the changed values to" << fileName << ":" << errorString;
+        return false;
+    }
+    if (hadPendingWrites)
+        emit valuesWritten(fileName);
+    return historySaved;
 }
 
-QVariant ConfigManager::getValue(const QString &key) const
+ConfigManager::Published ConfigManager::applyUpdate(const QString& origin)
 {
-    if (!m_configData.contains(key)) qWarning() << this << "key not found: " << key;
-    return m_configData.value(key);
+    // The changes go to the file layer, the other layers still override them
+    applyChanges(m_fileValues, m_update);
+    QStringList keys;
+    keys.reserve(m_update.size());
+    for (const ConfigTable::Entry& entry : m_update)
+    {
+        m_pendingWrites.insert(entry.key, entry.value);
+        m_fileMap = entry.value.isValid() ? m_fileMap.inserted(entry.key, entry.value) : m_fileMap.removed(entry.key);
+        keys.append(entry.key);
+    }
+    m_update = ConfigTable();
+    return publishChanges(keys, origin);
 }
 
+void ConfigManager::finishUpdate(Published &published)
+{
+    logPublishErrors(published);
+    emitChanges(published);
+    scheduleWrite();
+}
+
+void ConfigManager::scheduleWrite()
+{
+    // Written in one go once the delay has passed, however many values change in the meantime
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app)
+    {
+        flush();
+        return;
+    }
+    QMetaObject::invokeMethod(app, [this]() {
+        if (!m_writeTimer)
+        {
+            m_writeTimer = new QTimer(QCoreApplication::instance());
+            m_writeTimer->setSingleShot(true);
+            connect(m_writeTimer, &QTimer::timeout, m_writeTimer, [this]() {
+                QThreadPool::globalInstance()->start([this]() { flush(); });
+            });
+            // Nothing is lost when the application quits within the delay
+            connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, m_writeTimer, [this]() {
+                m_writeTimer->stop();
+                flush();
+            });
+        }
+        if (!m_writeTimer->isActive())
+            m_writeTimer->start(m_writeDelayMsecs.load());
+    });
+}
+
+QString ConfigManager::persist()
+{
+    if (m_fileName.isEmpty())
+        return "No config file has been loaded";
+
+    QFile file(m_fileName);
+    QByteArray content;
+    if (file.exists())
+    {
+        if (!file.open(QIODevice::ReadOnly))
+            return file.errorString();
+        content = file.readAll();
+        file.close();
+    }
+    QString errorString;
+    if (!IniWriter::writeFile(m_fileName, IniWriter::apply(content, m_pendingWrites), &errorString))
+        return errorString;
+    m_pendingWrites = ConfigTable();
+    return QString();
+}
+
+void ConfigManager::setHistoryFile(const QString &fileName)
+{
+    QString errorString;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        m_historyFile = fileName;
+        if (!fileName.isEmpty() && QFileInfo::exists(fileName))
+            m_history.load(fileName, &errorString);
+    }
+    if (!errorString.isEmpty())
+        qCWarning(lcCore) << this << "Couldn't load the config history from" << fileName << ":" << errorString;
+}
+
+QString ConfigManager::historyFile() const
+{
+    QMutexLocker locker(&m_writeMutex);
+    return m_historyFile;
+}
 
+void ConfigManager::setHistoryCapacity(int capacity)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_history.setCapacity(capacity);
+}
+
+QList<quint64> ConfigManager::history() const
+{
+    QMutexLocker locker(&m_writeMutex);
+    return m_history.ids();
+}
+
+QList<ConfigPersistentMap::Change> ConfigManager::diff(quint64 fromVersion, quint64 toVersion, bool *ok) const
+{
+    QList<ConfigPersistentMap::Change> changes;
+    QMutexLocker locker(&m_writeMutex);
+    const bool found = m_history.diff(fromVersion, toVersion, &changes);
+    if (ok)
+        *ok = found;
+    return changes;
+}
+
+bool ConfigManager::restore(quint64 version)
+{
+    Published published;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        const ConfigHistory::Version* restored = m_history.version(version);
+        if (!restored)
+            return false;
+        // Only the keys that differ are set, in the file layer like setValue(): they are written
+        // to the file, and values of the environment or --set keep overriding them. The file
+        // layer shares its map with the history, so the diff skips everything unchanged.
+        const QList<ConfigPersistentMap::Change> changes = ConfigPersistentMap::diff(m_fileMap, restored->values);
+        for (const ConfigPersistentMap::Change& change : changes)
+            m_update.insert(change.key, change.newValue.isValid() ? QVariant(change.newValue.toString()) : QVariant());
+        if (m_updateDepth > 0)
+            return true; // Published by commit()
+        published = applyUpdate(QString("restore %1").arg(version));
+    }
+    finishUpdate(published);
+    qCInfo(lcCore) << this << "Restored version" << version << "as version" << published.version;
+    return true;
+}
+
+QStringList ConfigManager::sections(const QString &prefix) const
+{
+    ConfigEpoch::Reader reader(m_epoch);
+    const ConfigSnapshot* snapshot = m_snapshot.load();
+    return snapshot ? snapshot->sections().sectionNames(prefix) : QStringList();
+}
+
+QMap<QString, QVariant> ConfigManager::sectionValues(const QString &section) const
+{
+    QMap<QString, QVariant> values;
+    ConfigEpoch::Reader reader(m_epoch);
+    if (const ConfigSnapshot* snapshot = m_snapshot.load())
+    {
+        const ConfigSection found = snapshot->sections().section(section);
+        for (qsizetype i = 0; i < found.size(); ++i)
+            values.insert(found.key(i).toString(), found.value(i));
+    }
+    return values;
+}
+
+void ConfigManager::reloadFile(const QString &fileName)
+{
+    // Runs on a thread of the pool
+    // Nothing is logged with the lock held: the first message creates the Logger, which reads the config
+    Published published;
+    QString errorString;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        if (fileName != m_fileName)
+            return; // Initialised with another file in the meantime
+
+        ConfigTable values;
+        if (ConfigCache::load(fileName, values, &errorString, nullptr, m_cacheEnabled))
+        {
+            // Values which haven't been written yet still apply
+            applyChanges(values, m_pendingWrites);
+            m_fileValues = values;
+            m_fileMap = ConfigHistory::withValues(m_fileMap, m_fileValues);
+            published = publish(m_layers.merge(std::move(values)), "reload");
+        }
+    }
+    if (!errorString.isEmpty())
+    {
+        qCWarning(lcCore) << this << "Failed to reload" << fileName << ":" << errorString << "- keeping the current values";
+        return;
+    }
+    logPublishErrors(published);
+    if (!published.changedKeys.isEmpty())
+        qCInfo(lcCore) << this << "Reloaded" << fileName << "version" << published.version << "changed keys:" << published.changedKeys;
+    emitChanges(published);
+    if (!published.changedKeys.isEmpty())
+        scheduleWrite();
+}
+
+ConfigManager::Published ConfigManager::publish(ConfigTable values, const QString &origin)
+{
+    Published published;
+    const ConfigSnapshot* previous = m_snapshot.load();
+    // Versions continue the history, which may have been loaded from a previous run
+    const quint64 nextVersion = qMax(previous ? previous->version() : 0, m_history.lastId()) + 1;
+    auto next = std::make_unique<ConfigSnapshot>(nextVersion, std::move(values));
+    published.changedKeys = next->changedKeys(previous);
+    if (previous && published.changedKeys.isEmpty())
+    {
+        published.version = previous->version();
+        return published; // Saved without changes, keep the current snapshot
+    }
+    // Taken now, a later snapshot may have been published by the time they are emitted
+    published.changedValues.reserve(published.changedKeys.size());
+    for (const QString& key : std::as_const(published.changedKeys))
+        published.changedValues.append(next->value(key, QVariant()));
+
+    published.version = next->version();
+    published.typeErrors = install(std::move(next), nullptr, origin);
+    return published;
+}
+
+ConfigManager::Published ConfigManager::publishChanges(const QStringList &fileKeys, const QString &origin)
+{
+    const ConfigSnapshot* previous = m_snapshot.load();
+    if (!previous)
+        return publish(m_layers.merge(m_fileValues), origin);
+
+    // Merge only the changed keys with the other layers and compare them with the current values
+    ConfigTable changes;
+    for (const QString& key : fileKeys)
+    {
+        ConfigTable::Entry merged;
+        if (!m_layers.resolve(key, m_fileValues.find(key), merged))
+            return publish(m_layers.merge(m_fileValues), origin); // Depends on the spelling of other keys
+        const QVariant* current = previous->values().find(key);
+        const bool changed = merged.value.isValid() ? !current || *current != merged.value : current != nullptr;
+        if (changed)
+            changes.insert(key, merged.value, merged.source);
+    }
+
+    Published published;
+    if (changes.isEmpty())
+    {
+        // E.g. a value the environment overrides. The history gets it with the next version.
+        published.version = previous->version();
+        return published;
+    }
+    const quint64 nextVersion = qMax(previous->version(), m_history.lastId()) + 1;
+    auto next = std::make_unique<ConfigSnapshot>(nextVersion, *previous, changes);
+    published.changedKeys.reserve(changes.size());
+    published.changedValues.reserve(changes.size());
+    for (const ConfigTable::Entry& change : changes)
+    {
+        published.changedKeys.append(change.key);
+        published.changedValues.append(change.value);
+    }
+    published.version = nextVersion;
+    published.typeErrors = install(std::move(next), &published.changedKeys, origin);
+    return published;
+}
+
+QStringList ConfigManager::install(std::unique_ptr<ConfigSnapshot> next, const QStringList *keys, const QString &origin)
+{
+    QStringList typeErrors;
+    const ConfigSnapshot* previous = m_snapshot.load();
+    const ConfigSnapshot* current = next.release();
+    m_snapshot.store(current);
+    QList<ConfigKeyBase*> resolvedKeys;
+    if (keys)
+    {
+        for (const QString& key : *keys)
+        {
+            for (auto it = m_keys.constFind(key); it != m_keys.cend() && it.key() == key; ++it)
+                resolvedKeys.append(it.value());
+        }
+    }
+    else
+    {
+        resolvedKeys = m_keys.values();
+    }
+    for (ConfigKeyBase* key : std::as_const(resolvedKeys))
+    {
+        const QString error = key->resolve(current);
+        if (!error.isEmpty())
+            typeErrors.append(error);
+    }
+
+    // The file layer, so that restoring a version doesn't write the values of the environment
+    // or --set to the file. It shares everything unchanged with the version before.
+    m_history.record(current->version(), origin, QDateTime::currentMSecsSinceEpoch(), m_fileMap);
+    m_historyDirty = true; // Saved with the next write, see flush()
+
+    // Readers may still be using the previous values until they have left
+    m_epoch.synchronize();
+    delete previous;
+    for (ConfigKeyBase* key : std::as_const(resolvedKeys))
+        key->reclaim();
+    return typeErrors;
+}
+
+bool ConfigManager::saveHistory(const ConfigHistory &history, const QString &fileName)
+{
+    QString errorString;
+    {
+        // Flushes may get here in any order, an older copy must not replace a newer one
+        QMutexLocker locker(&m_historySaveMutex);
+        if (fileName == m_savedHistoryFile && history.lastId() <= m_savedHistoryId)
+            return true;
+        if (history.save(fileName, &errorString))
+        {
+            m_savedHistoryFile = fileName;
+            m_savedHistoryId = history.lastId();
+            return true;
+        }
+    }
+    qCWarning(lcCore) << this << "Failed to save the config history to" << fileName << ":" << errorString;
+    // Tried again with the next write
+    QMutexLocker locker(&m_writeMutex);
+    m_historyDirty = true;
+    return false;
+}
+
+void ConfigManager::logTypeErrors(const QStringList &typeErrors)
+{
+    for (const QString& error : typeErrors)
+        qCWarning(lcCore) << "Config type error:" << error;
+}
+
+void ConfigManager::logPublishErrors(const Published &published) const
+{
+    logTypeErrors(published.typeErrors);
+}
+
+void ConfigManager::logOverrides() const
+{
+    // Values which don't come from the file are easy to miss when looking at it
+    QStringList overrides;
+    {
+        ConfigEpoch::Reader reader(m_epoch);
+        const ConfigSnapshot* snapshot = m_snapshot.load();
+        if (!snapshot)
+            return;
+        for (const ConfigTable::Entry& entry : snapshot->values())
+        {
+            if (entry.source == ConfigSource::Environment || entry.source == ConfigSource::CommandLine)
+                overrides.append(QString("%1 (%2)").arg(entry.key, ConfigLayers::sourceName(entry.source)));
+        }
+    }
+    if (!overrides.isEmpty())
+        qCInfo(lcCore) << this << "Overridden config values:" << overrides;
+}
+
+void ConfigManager::registerKey(ConfigKeyBase *key)
+{
+    QString error;
+    {
+        QMutexLocker locker(&m_writeMutex);
+        m_keys.insert(key->key(), key);
+        // Nobody can read the new key yet, so there is nothing to wait for
+        error = key->resolve(m_snapshot.load());
+    }
+    if (!error.isEmpty())
+        logTypeErrors({error});
+}
+
+void ConfigManager::unregisterKey(ConfigKeyBase *key)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_keys.remove(key->key(), key);
+}
+
+void ConfigManager::emitChanges(const Published &published)
+{
+    if (published.changedKeys.isEmpty())
+        return;
+    for (qsizetype i = 0; i < published.changedKeys.size(); ++i)
+        emit valueChanged(published.changedKeys[i], published.changedValues[i]);
+    emit reloaded(published.version);
+}
+
+void ConfigManager::watch(const QString &fileName)
+{
+    // Runs in the application's thread
+    if (!m_watcher)
+    {
+        // A child of the application, so that it is gone before the statics are destroyed
+        m_watcher = new QFileSystemWatcher(QCoreApplication::instance());
+        m_reloadTimer = new QTimer(m_watcher);
+        m_reloadTimer->setSingleShot(true);
+        m_reloadTimer->setInterval(ReloadDelayMsecs);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, m_reloadTimer, qOverload<>(&QTimer::start));
+        // Editors often save by replacing the file, which removes it from the watcher
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_watcher, [this]() {
+            if (!m_watcher->files().contains(m_watchedFile) && QFileInfo::exists(m_watchedFile))
+            {
+                m_watcher->addPath(m_watchedFile);
+                m_reloadTimer->start();
+            }
+        });
+        connect(m_reloadTimer, &QTimer::timeout, m_watcher, [this]() { reload(); });
+    }
+
+    if (!m_watcher->files().isEmpty())
+        m_watcher->removePaths(m_watcher->files());
+    if (!m_watcher->directories().isEmpty())
+        m_watcher->removePaths(m_watcher->directories());
+    m_watchedFile = QFileInfo(fileName).absoluteFilePath();
+    m_watcher->addPath(m_watchedFile);
+    m_watcher->addPath(QFileInfo(m_watchedFile).absolutePath());
+}
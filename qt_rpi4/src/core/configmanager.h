@@ -8,25 +8,224 @@
 #include <QMap>
 #include <QVariant>
 #include <QDebug>
+#include <QMutex>
+#include <QPointer>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QMultiHash>
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include "configepoch.h"
+#include "configsnapshot.h"
+#include "configlayers.h"
+#include "configschema.h"
+#include "confighistory.h"
 
+class ConfigKeyBase;
+
+/*
+ * The values of the config file, reloaded automatically when the file changes.
+ * A binary image of the parsed file is kept next to it, so unchanged files load without
+ * parsing (see ConfigCache).
+ *
+ * Built-in defaults, GREENOASIS_* environment variables and --set overrides are layered around
+ * the file (see ConfigLayers) and merged into the snapshot on every load, so a lookup doesn't
+ * depend on the number of layers. source() tells which layer a value comes from.
+ *
+ * Sections ("Zone/12" of "Zone/12/Valve") are indexed per snapshot: sections() lists them by
+ * prefix and readSections() extracts whole sections into structs (see ConfigSchema).
+ *
+ * Every published snapshot is recorded in a ConfigHistory, its version is the id there. The
+ * history holds the file layer of each version, not what the other layers make of it. Old
+ * versions can be compared with diff() and brought back with restore(); with a history file
+ * the history survives restarts.
+ *
+ * setValue() changes a value right away in memory and writes it to the file later: all values
+ * changed within the write delay are written at once (see IniWriter), so a burst of changes
+ * from the UI is a single write to the flash. beginUpdate()/commit() publish several values
+ * as one version. Such an update derives the next snapshot from the current one: only the
+ * changed keys are merged with the other layers, compared, indexed and resolved.
+ *
+ * Every (re)load parses the file into a new immutable ConfigSnapshot, off the GUI thread for
+ * reloads, and publishes it with an atomic pointer swap. getValue() never takes a lock, so it
+ * can be called from any thread, including the logger's. For keys that are read often, use a
+ * ConfigKey (configkey.h): it is resolved once per snapshot. Keys whose value has changed are
+ * reported with valueChanged(), which is emitted on the thread that did the reload: connect
+ * with a context object to get it queued, or use a direct connection if the slot is thread-safe.
+ *
+ * Threads: all methods may be called from any thread.
+ *  - Reads (getValue(), source(), version(), sections(), sectionValues(), readSections() and
+ *    ConfigKey::value()) are wait-free and see one snapshot each, never a mix of two.
+ *  - Everything that publishes a snapshot (initialise(), reloads, setValue()/commit(), restore())
+ *    is serialised by one lock, so versions are published in order. The file watcher always
+ *    lives in the application's thread, whichever thread called initialise().
+ *  - ConfigKeys can be created and destroyed on any thread, but not while they are being read.
+ * ConfigConcurrencyTest checks this, best built with -DGREENOASIS_SANITIZER=thread.
+ */
 class ConfigManager : public QObject
 {
     Q_OBJECT
 public:
     // Singleton
     static ConfigManager& instance();
+    // Loads the file and watches it from now on. Throws std::runtime_error if it can't be read.
     void initialise(const QString& configFileName);
+    // Reads the file again in the background, called automatically when the file has changed
+    void reload();
+    QString fileName() const;
+    // Loads go through a binary image next to the config file, see ConfigCache (default true)
+    void setCacheEnabled(bool enabled);
+
+    // The layers around the file, call these before initialise(). They take effect with the next load.
+    void setDefaults(const ConfigTable& defaults);
+    // The environment of the process is used by default
+    void setEnvironment(const QProcessEnvironment& environment);
+    // "Section/Key=value" overrides, e.g. the values of --set. False if one of them is malformed.
+    bool setOverrides(const QStringList& assignments, QString* errorString = nullptr);
+    // The layer the current value of the key comes from, ConfigSource::Unset if it doesn't exist
+    ConfigSource source(const QString& key) const;
+    // Version of the current snapshot, 0 before initialise()
+    quint64 version() const;
 
     QVariant getValue(const QString &key) const;
+    // For optional keys: returns defaultValue without a warning if the key doesn't exist
+    QVariant getValue(const QString &key, const QVariant &defaultValue) const;
+
+    // Stores the value (as a string) in the file layer and publishes a new snapshot, unless an
+    // update has been begun. The file is written after the write delay.
+    void setValue(const QString& key, const QVariant& value);
+    // setValue() calls up to the matching commit() are published together, as one version.
+    // Updates can be nested; there is only one at a time, shared by all threads.
+    void beginUpdate();
+    void commit();
+    // How long changed values are collected before the file is written (default 1000 ms)
+    void setWriteDelay(int msecs);
+    // Writes the changed values and the history to their files now, false if that has failed
+    // (they are kept and written with the next flush)
+    bool flush();
+
+    // Loads the history from the file, if it exists, and saves it there with the changed values:
+    // new versions are collected for the write delay and saved on a thread of the pool. Call it
+    // before initialise(), so that the version numbers continue those in the file.
+    void setHistoryFile(const QString& fileName);
+    QString historyFile() const;
+    // Number of versions kept (default ConfigHistory::DefaultCapacity)
+    void setHistoryCapacity(int capacity);
+    // The versions in the history, oldest first
+    QList<quint64> history() const;
+    // What changed in the file layer from one version to the other, sorted by key. Empty and
+    // ok false if one is unknown.
+    QList<ConfigPersistentMap::Change> diff(quint64 fromVersion, quint64 toVersion, bool* ok = nullptr) const;
+    // Sets the file values that differ from an older version, like setValue() (the keys it
+    // doesn't have are removed from the file), and publishes them as a new version, or with the
+    // update that has been begun. The environment and --set keep overriding them. Costs about as
+    // much as the number of keys that differ. False if the version isn't in the history.
+    bool restore(quint64 version);
+
+    // Names of the sections starting with prefix, sorted, e.g. sections("Zone/")
+    QStringList sections(const QString& prefix = QString()) const;
+    // Key (without the section) -> value of one section
+    QMap<QString, QVariant> sectionValues(const QString& section) const;
+    // Extracts every section starting with prefix into a struct, see ConfigSchema.
+    // Values that can't be converted are logged and leave the member at its default.
+    template<typename T>
+    QList<T> readSections(const QString& prefix, const ConfigSchema<T>& schema, const T& defaults = T()) const
+    {
+        QStringList errors;
+        QList<T> results;
+        {
+            ConfigEpoch::Reader reader(m_epoch);
+            if (const ConfigSnapshot* snapshot = m_snapshot.load())
+                results = schema.readSections(snapshot->sections(), prefix, defaults, &errors);
+        }
+        logTypeErrors(errors);
+        return results;
+    }
 
 signals:
+    // The value is invalid if the key has been removed. It is the value of the snapshot that
+    // changed it, even if a newer one has been published since. reloaded() follows the last
+    // valueChanged() of a snapshot.
+    void valueChanged(const QString& key, const QVariant& value);
+    void reloaded(quint64 version);
+    // Changed values have been written to the file, emitted on the writing thread
+    void valuesWritten(const QString& fileName);
 
 private:
+    friend class ConfigKeyBase;
+
     ConfigManager(); // Private constructor to prevent instantiation
     ~ConfigManager(); // Private deconstructor
 
-    QMap<QString, QVariant> m_configData;
+    static constexpr int ReloadDelayMsecs = 250; // Editors write a file in several steps
+    static constexpr int DefaultWriteDelayMsecs = 1000;
+
+    // What publish() has done, errors are returned so that they are logged without the lock
+    struct Published
+    {
+        QStringList changedKeys;
+        QVariantList changedValues; // Of the published snapshot, invalid for removed keys
+        quint64 version = 0;
+        QStringList typeErrors; // Of the ConfigKeys
+    };
+
+    void reloadFile(const QString& fileName);
+    // Called with m_writeMutex locked after the file layer has been loaded: publishes the merged
+    // values if they have changed and records the new version in the history
+    Published publish(ConfigTable values, const QString& origin);
+    // Called with m_writeMutex locked after fileKeys have been changed in the file layer: derives
+    // the next snapshot from the current one, in O(fileKeys)
+    Published publishChanges(const QStringList& fileKeys, const QString& origin);
+    // Makes next the current snapshot, records it in the history and resolves the ConfigKeys of
+    // the keys given, or all of them if keys is nullptr. Returns their type errors.
+    QStringList install(std::unique_ptr<ConfigSnapshot> next, const QStringList* keys, const QString& origin);
+    // Called without the lock by flush(): writes the history, unless a newer one has been written already
+    bool saveHistory(const ConfigHistory& history, const QString& fileName);
+    // Called with m_writeMutex locked: moves m_update to the file layer and publishes it.
+    // Invalid values in m_update remove their key.
+    Published applyUpdate(const QString& origin);
+    void finishUpdate(Published& published);
+    // Starts the write delay, after which flush() writes the changed values and the history
+    void scheduleWrite();
+    // Called with m_writeMutex locked, returns an error message if the file couldn't be written
+    QString persist();
+    void emitChanges(const Published& published);
+    static void logTypeErrors(const QStringList& typeErrors);
+    void logPublishErrors(const Published& published) const;
+    void logOverrides() const;
+    void registerKey(ConfigKeyBase* key);
+    void unregisterKey(ConfigKeyBase* key);
+    void watch(const QString& fileName);
+
+    std::atomic<const ConfigSnapshot*> m_snapshot{nullptr};
+    mutable ConfigEpoch m_epoch;
+    mutable QMutex m_writeMutex; // Serialises initialise(), reloads, restores and updates
+    QString m_fileName;
+    std::atomic<bool> m_cacheEnabled{true};
+    ConfigLayers m_layers; // Guarded by m_writeMutex
+    // Guarded by m_writeMutex as well
+    ConfigTable m_fileValues;    // The file layer: the file as loaded, plus the values set since
+    ConfigPersistentMap m_fileMap; // The same values, shared with the history
+    ConfigTable m_pendingWrites; // Set, but not written to the file yet
+    ConfigTable m_update;        // Set since beginUpdate(), invalid values are removed keys
+    int m_updateDepth = 0;
+    std::atomic<int> m_writeDelayMsecs{DefaultWriteDelayMsecs};
+    ConfigHistory m_history; // Guarded by m_writeMutex
+    QString m_historyFile;
+    bool m_historyDirty = false; // New versions since the last flush(), guarded by m_writeMutex
+    // Serialises saving the history, which happens without m_writeMutex
+    QMutex m_historySaveMutex;
+    QString m_savedHistoryFile;
+    quint64 m_savedHistoryId = 0;
+    QMultiHash<QString, ConfigKeyBase*> m_keys; // By key, resolved when their value changes
+
+    // Live in the application's thread
+    QPointer<QFileSystemWatcher> m_watcher;
+    QPointer<QTimer> m_reloadTimer;
+    QPointer<QTimer> m_writeTimer;
+    QString m_watchedFile;
 };
 
 #endif // CONFIGMANAGER_H
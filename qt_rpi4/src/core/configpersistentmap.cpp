@@ -0,0 +1,284 @@
+#include "configpersistentmap.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+qsizetype ConfigPersistentMap::size() const
+{
+    return m_size;
+}
+
+bool ConfigPersistentMap::isEmpty() const
+{
+    return m_size == 0;
+}
+
+const QVariant *ConfigPersistentMap::find(QStringView key) const
+{
+    const quint64 hash = hashKey(key);
+    const Node* node = m_root.get();
+    for (int depth = 0; node; ++depth)
+    {
+        if (depth >= MaxDepth)
+        {
+            for (const LeafPtr& leaf : node->collisions)
+            {
+                if (leaf->key == key)
+                    return &leaf->value;
+            }
+            return nullptr;
+        }
+        const quint32 bit = 1u << slot(hash, depth);
+        if (!(node->bitmap & bit))
+            return nullptr;
+        const Item& item = node->items[qPopulationCount(node->bitmap & (bit - 1))];
+        if (item.leaf)
+            return item.leaf->key == key ? &item.leaf->value : nullptr;
+        node = item.node.get();
+    }
+    return nullptr;
+}
+
+ConfigPersistentMap ConfigPersistentMap::inserted(const QString &key, const QVariant &value) const
+{
+    bool added = false;
+    const LeafPtr leaf = std::make_shared<const Leaf>(Leaf{hashKey(key), key, value});
+    NodePtr root = insert(m_root, 0, leaf, &added);
+    return ConfigPersistentMap(std::move(root), added ? m_size + 1 : m_size);
+}
+
+ConfigPersistentMap ConfigPersistentMap::removed(const QString &key) const
+{
+    bool wasRemoved = false;
+    NodePtr root = remove(m_root, 0, hashKey(key), key, &wasRemoved);
+    return ConfigPersistentMap(std::move(root), wasRemoved ? m_size - 1 : m_size);
+}
+
+QList<ConfigPersistentMap::Change> ConfigPersistentMap::diff(const ConfigPersistentMap &from, const ConfigPersistentMap &to)
+{
+    QList<Change> changes;
+    diff(from.m_root.get(), to.m_root.get(), 0, changes);
+    std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b) { return a.key < b.key; });
+    return changes;
+}
+
+bool ConfigPersistentMap::isSharedWith(const ConfigPersistentMap &other) const
+{
+    return m_root == other.m_root;
+}
+
+quint64 ConfigPersistentMap::hashKey(QStringView key)
+{
+    // FNV-1a over the UTF-16 code units, 64 bit on every platform as it selects the path in the trie
+    quint64 hash = 14695981039346656037ULL;
+    for (QChar c : key)
+    {
+        hash ^= c.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int ConfigPersistentMap::slot(quint64 hash, int depth)
+{
+    return static_cast<int>((hash >> (depth * BitsPerLevel)) & 0x1F);
+}
+
+ConfigPersistentMap::NodePtr ConfigPersistentMap::insert(const NodePtr &node, int depth, const LeafPtr &leaf, bool *added)
+{
+    if (depth >= MaxDepth)
+    {
+        // All 64 bits of the hash are used up, the keys are compared one by one
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        for (LeafPtr& existing : copy->collisions)
+        {
+            if (existing->key == leaf->key)
+            {
+                if (existing->value == leaf->value)
+                    return node;
+                existing = leaf;
+                return copy;
+            }
+        }
+        copy->collisions.push_back(leaf);
+        *added = true;
+        return copy;
+    }
+
+    const quint32 bitmap = node ? node->bitmap : 0;
+    const quint32 bit = 1u << slot(leaf->hash, depth);
+    const size_t position = qPopulationCount(bitmap & (bit - 1));
+    if (!(bitmap & bit))
+    {
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        copy->bitmap |= bit;
+        copy->items.insert(copy->items.begin() + static_cast<std::ptrdiff_t>(position), Item{leaf, nullptr});
+        *added = true;
+        return copy;
+    }
+
+    const Item& item = node->items[position];
+    Item replacement;
+    if (item.leaf && item.leaf->key == leaf->key)
+    {
+        if (item.leaf->value == leaf->value)
+            return node;
+        replacement.leaf = leaf;
+    }
+    else if (item.leaf)
+    {
+        // Another key in the same slot: move both one level down
+        bool movedDown = false;
+        const NodePtr child = insert(nullptr, depth + 1, item.leaf, &movedDown);
+        replacement.node = insert(child, depth + 1, leaf, added);
+    }
+    else
+    {
+        replacement.node = insert(item.node, depth + 1, leaf, added);
+        if (replacement.node == item.node)
+            return node;
+    }
+    auto copy = std::make_shared<Node>(*node);
+    copy->items[position] = std::move(replacement);
+    return copy;
+}
+
+ConfigPersistentMap::NodePtr ConfigPersistentMap::remove(const NodePtr &node, int depth, quint64 hash, QStringView key, bool *removed)
+{
+    if (!node)
+        return node;
+    if (depth >= MaxDepth)
+    {
+        const auto it = std::find_if(node->collisions.begin(), node->collisions.end(),
+                                     [key](const LeafPtr& leaf) { return leaf->key == key; });
+        if (it == node->collisions.end())
+            return node;
+        auto copy = std::make_shared<Node>(*node);
+        copy->collisions.erase(copy->collisions.begin() + (it - node->collisions.begin()));
+        *removed = true;
+        return copy->collisions.empty() ? nullptr : copy;
+    }
+
+    const quint32 bit = 1u << slot(hash, depth);
+    if (!(node->bitmap & bit))
+        return node;
+    const size_t position = qPopulationCount(node->bitmap & (bit - 1));
+    const Item& item = node->items[position];
+
+    Item replacement;
+    if (item.leaf)
+    {
+        if (item.leaf->key != key)
+            return node;
+        *removed = true;
+    }
+    else
+    {
+        const NodePtr child = remove(item.node, depth + 1, hash, key, removed);
+        if (child == item.node)
+            return node;
+        // A single leaf moves back up, so the shape of the trie only depends on its keys
+        if (child && child->items.size() == 1 && child->items.front().leaf && child->collisions.empty())
+            replacement.leaf = child->items.front().leaf;
+        else if (child && child->items.empty() && child->collisions.size() == 1)
+            replacement.leaf = child->collisions.front();
+        else
+            replacement.node = child;
+    }
+
+    auto copy = std::make_shared<Node>(*node);
+    if (replacement.leaf || replacement.node)
+    {
+        copy->items[position] = std::move(replacement);
+        return copy;
+    }
+    copy->bitmap &= ~bit;
+    copy->items.erase(copy->items.begin() + static_cast<std::ptrdiff_t>(position));
+    return copy->items.empty() ? nullptr : copy;
+}
+
+void ConfigPersistentMap::diff(const Node *from, const Node *to, int depth, QList<Change> &changes)
+{
+    if (from == to)
+        return; // Shared, nothing below has changed
+    if (!from || !to)
+    {
+        const Node* node = from ? from : to;
+        for (const Item& item : node->items)
+            collect(item, !from, changes);
+        for (const LeafPtr& leaf : node->collisions)
+            collect(Item{leaf, nullptr}, !from, changes);
+        return;
+    }
+
+    if (depth >= MaxDepth)
+    {
+        for (const LeafPtr& leaf : from->collisions)
+        {
+            const auto it = std::find_if(to->collisions.begin(), to->collisions.end(),
+                                         [&leaf](const LeafPtr& other) { return other->key == leaf->key; });
+            if (it == to->collisions.end())
+                changes.append({leaf->key, leaf->value, QVariant()});
+            else if ((*it)->value != leaf->value)
+                changes.append({leaf->key, leaf->value, (*it)->value});
+        }
+        for (const LeafPtr& leaf : to->collisions)
+        {
+            const bool existed = std::any_of(from->collisions.begin(), from->collisions.end(),
+                                             [&leaf](const LeafPtr& other) { return other->key == leaf->key; });
+            if (!existed)
+                changes.append({leaf->key, QVariant(), leaf->value});
+        }
+        return;
+    }
+
+    const quint32 bitmap = from->bitmap | to->bitmap;
+    for (int index = 0; index < 32; ++index)
+    {
+        const quint32 bit = 1u << index;
+        if (!(bitmap & bit))
+            continue;
+        const Item* fromItem = (from->bitmap & bit) ? &from->items[qPopulationCount(from->bitmap & (bit - 1))] : nullptr;
+        const Item* toItem = (to->bitmap & bit) ? &to->items[qPopulationCount(to->bitmap & (bit - 1))] : nullptr;
+        diffItems(fromItem, toItem, depth + 1, changes);
+    }
+}
+
+void ConfigPersistentMap::diffItems(const Item *from, const Item *to, int depth, QList<Change> &changes)
+{
+    if (!from || !to)
+    {
+        collect(from ? *from : *to, !from, changes);
+        return;
+    }
+    if (from->leaf && to->leaf)
+    {
+        if (from->leaf == to->leaf)
+            return;
+        if (from->leaf->key == to->leaf->key)
+        {
+            if (from->leaf->value != to->leaf->value)
+                changes.append({from->leaf->key, from->leaf->value, to->leaf->value});
+            return;
+        }
+        changes.append({from->leaf->key, from->leaf->value, QVariant()});
+        changes.append({to->leaf->key, QVariant(), to->leaf->value});
+        return;
+    }
+
+    // A leaf on one side and a node on the other: compare the leaf as a node of its own
+    bool added = false;
+    const NodePtr fromNode = from->node ? from->node : insert(nullptr, depth, from->leaf, &added);
+    const NodePtr toNode = to->node ? to->node : insert(nullptr, depth, to->leaf, &added);
+    diff(fromNode.get(), toNode.get(), depth, changes);
+}
+
+void ConfigPersistentMap::collect(const Item &item, bool added, QList<Change> &changes)
+{
+    auto append = [&changes, added](const QString& key, const QVariant& value) {
+        changes.append(added ? Change{key, QVariant(), value} : Change{key, value, QVariant()});
+    };
+    if (item.leaf)
+        append(item.leaf->key, item.leaf->value);
+    else
+        forEach(*item.node, append);
+}
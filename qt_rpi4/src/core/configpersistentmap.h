@@ -0,0 +1,113 @@
+#ifndef CONFIGPERSISTENTMAP_H
+#define CONFIGPERSISTENTMAP_H
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QVariant>
+#include <memory>
+#include <vector>
+
+/*
+ * Immutable map of config values with structural sharing (a hash array mapped trie).
+ *
+ * inserted() and removed() return a new map and leave this one as it is. They copy only the
+ * nodes on the path to the key, at most 13 nodes of up to 32 pointers, and share everything
+ * else with the original, so keeping many versions of a large config costs memory in
+ * proportion to what has changed between them. diff() skips every subtree both maps share,
+ * so comparing two versions costs about as much as the keys which differ.
+ *
+ * Copies are cheap and thread-safe: nodes are never modified once they are shared.
+ */
+class ConfigPersistentMap
+{
+public:
+    struct Change
+    {
+        QString key;
+        QVariant oldValue; // Invalid if the key has been added
+        QVariant newValue; // Invalid if the key has been removed
+    };
+
+    ConfigPersistentMap() = default;
+
+    qsizetype size() const;
+    bool isEmpty() const;
+    // nullptr if the key doesn't exist
+    const QVariant* find(QStringView key) const;
+
+    ConfigPersistentMap inserted(const QString& key, const QVariant& value) const;
+    ConfigPersistentMap removed(const QString& key) const;
+
+    // Calls f(const QString& key, const QVariant& value) for every entry, in no particular order
+    template<typename F>
+    void forEach(F f) const
+    {
+        if (m_root)
+            forEach(*m_root, f);
+    }
+
+    // What has to be applied to from to get to, sorted by key
+    static QList<Change> diff(const ConfigPersistentMap& from, const ConfigPersistentMap& to);
+    // True if both maps share their root, i.e. are the same version
+    bool isSharedWith(const ConfigPersistentMap& other) const;
+
+    static quint64 hashKey(QStringView key);
+
+private:
+    struct Leaf
+    {
+        quint64 hash;
+        QString key;
+        QVariant value;
+    };
+    struct Node;
+    using LeafPtr = std::shared_ptr<const Leaf>;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Either a leaf or a node
+    struct Item
+    {
+        LeafPtr leaf;
+        NodePtr node;
+    };
+
+    struct Node
+    {
+        quint32 bitmap = 0;           // The slots in use, 5 bits of the hash per level
+        std::vector<Item> items;      // One per bit of the bitmap, in bit order
+        std::vector<LeafPtr> collisions; // Below the last level: leaves with the same hash
+    };
+
+    static constexpr int BitsPerLevel = 5;
+    static constexpr int MaxDepth = (64 + BitsPerLevel - 1) / BitsPerLevel;
+
+    ConfigPersistentMap(NodePtr root, qsizetype size) : m_root{std::move(root)}, m_size{size} {}
+
+    // Return node itself if nothing has changed, nullptr if the node has become empty
+    static NodePtr insert(const NodePtr& node, int depth, const LeafPtr& leaf, bool* added);
+    static NodePtr remove(const NodePtr& node, int depth, quint64 hash, QStringView key, bool* removed);
+    static void diff(const Node* from, const Node* to, int depth, QList<Change>& changes);
+    static void diffItems(const Item* from, const Item* to, int depth, QList<Change>& changes);
+    static void collect(const Item& item, bool added, QList<Change>& changes);
+    static int slot(quint64 hash, int depth);
+
+    template<typename F>
+    static void forEach(const Node& node, F& f)
+    {
+        for (const Item& item : node.items)
+        {
+            if (item.leaf)
+                f(item.leaf->key, item.leaf->value);
+            else
+                forEach(*item.node, f);
+        }
+        for (const LeafPtr& leaf : node.collisions)
+            f(leaf->key, leaf->value);
+    }
+
+    NodePtr m_root;
+    qsizetype m_size = 0;
+};
+
+#endif // CONFIGPERSISTENTMAP_H
@@ -0,0 +1,108 @@
+#ifndef CONFIGSCHEMA_H
+#define CONFIGSCHEMA_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "configkey.h"
+#include "configsection.h"
+
+/*
+ * Maps the keys of a section to the members of a struct, so whole sections are extracted in
+ * one go, e.g. the settings of every irrigation zone:
+ *
+ *   struct Zone { QString id; int valve = 0; int durationSecs = 600; bool enabled = true; };
+ *   const auto zoneSchema = ConfigSchema<Zone>()
+ *                               .sectionName(&Zone::id)
+ *                               .field("Valve", &Zone::valve)
+ *                               .field("DurationSecs", &Zone::durationSecs)
+ *                               .field("Enabled", &Zone::enabled);
+ *   const QList<Zone> zones = ConfigManager::instance().readSections("Zone/", zoneSchema);
+ *
+ * The fields are sorted by key, so every key of a section costs one binary search over the
+ * fields and one conversion (ConfigConversion): no key strings are built. Keys the schema
+ * doesn't know are ignored, missing keys and invalid values leave the member as it is.
+ */
+template<typename T>
+class ConfigSchema
+{
+public:
+    template<typename V>
+    ConfigSchema& field(const QString& key, V T::*member)
+    {
+        Field newField{key, QString::fromLatin1(QMetaType::fromType<V>().name()),
+                       [member](const QVariant& value, T& result) {
+                           return ConfigConversion::convert(value, result.*member);
+                       }};
+        const auto it = std::lower_bound(m_fields.begin(), m_fields.end(), key, FieldLess());
+        if (it != m_fields.end() && it->key == key)
+            *it = std::move(newField);
+        else
+            m_fields.insert(it, std::move(newField));
+        return *this;
+    }
+
+    // Stores the name of the section, e.g. "Zone/12"
+    ConfigSchema& sectionName(QString T::*member)
+    {
+        m_sectionName = member;
+        return *this;
+    }
+
+    // False if a value couldn't be converted, a description of every such value is appended to errors
+    bool read(const ConfigSection& section, T& result, QStringList* errors = nullptr) const
+    {
+        if (m_sectionName)
+            result.*m_sectionName = section.name().toString();
+
+        bool ok = true;
+        for (qsizetype i = 0; i < section.size(); ++i)
+        {
+            const QStringView key = section.key(i);
+            const auto it = std::lower_bound(m_fields.begin(), m_fields.end(), key, FieldLess());
+            if (it == m_fields.end() || it->key != key)
+                continue;
+            if (!it->assign(section.value(i), result))
+            {
+                ok = false;
+                if (errors)
+                    errors->append(QString("%1=%2 is not a valid %3")
+                                       .arg(section.entry(i).key, section.value(i).toString(), it->typeName));
+            }
+        }
+        return ok;
+    }
+
+    // Every section whose name starts with prefix, sorted by name, starting from defaults
+    QList<T> readSections(const ConfigSectionIndex& index, QStringView prefix, const T& defaults = T(),
+                          QStringList* errors = nullptr) const
+    {
+        QList<T> results;
+        index.forEachSection(prefix, [&](const ConfigSection& section) {
+            results.append(defaults);
+            read(section, results.last(), errors);
+        });
+        return results;
+    }
+
+private:
+    struct Field
+    {
+        QString key;
+        QString typeName;
+        std::function<bool(const QVariant&, T&)> assign;
+    };
+
+    struct FieldLess
+    {
+        bool operator()(const Field& field, QStringView key) const { return QStringView(field.key) < key; }
+    };
+
+    std::vector<Field> m_fields; // Sorted by key
+    QString T::*m_sectionName = nullptr;
+};
+
+#endif // CONFIGSCHEMA_H
@@ -0,0 +1,99 @@
+#include "configsection.h"
+#include <algorithm>
+
+QStringView ConfigSection::key(qsizetype i) const
+{
+    const QString& key = m_entries[i]->key;
+    return m_name.isEmpty() ? QStringView(key) : QStringView(key).sliced(m_name.size() + 1);
+}
+
+const QVariant &ConfigSection::value(qsizetype i) const
+{
+    return m_entries[i]->value;
+}
+
+const QVariant *ConfigSection::find(QStringView key) const
+{
+    for (qsizetype i = 0; i < m_count; ++i)
+    {
+        if (this->key(i) == key)
+            return &m_entries[i]->value;
+    }
+    return nullptr;
+}
+
+ConfigSectionIndex::ConfigSectionIndex(const ConfigTable &table)
+{
+    // Sort the entries by section, the stable sort keeps the keys of a section in insertion order
+    std::vector<std::pair<QStringView, const ConfigTable::Entry*>> entries;
+    entries.reserve(static_cast<size_t>(table.size()));
+    for (const ConfigTable::Entry& entry : table)
+        entries.emplace_back(sectionOf(entry.key), &entry);
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    m_entries.reserve(entries.size());
+    for (const auto& [name, entry] : entries)
+    {
+        if (m_sections.empty() || m_sections.back().name != name)
+            m_sections.push_back({name, static_cast<qint32>(m_entries.size()), 0});
+        ++m_sections.back().count;
+        m_entries.push_back(entry);
+    }
+}
+
+ConfigSectionIndex::ConfigSectionIndex(const ConfigTable &table, const ConfigSectionIndex &previous,
+                                       const ConfigTable &previousTable)
+    : m_sections{previous.m_sections}
+{
+    // Same keys at the same positions: each entry moves by the distance between the tables
+    const ConfigTable::Entry* previousFirst = previousTable.isEmpty() ? nullptr : &*previousTable.begin();
+    const ConfigTable::Entry* first = table.isEmpty() ? nullptr : &*table.begin();
+    m_entries.reserve(previous.m_entries.size());
+    for (const ConfigTable::Entry* entry : previous.m_entries)
+        m_entries.push_back(first + (entry - previousFirst));
+    // The names are views of the keys of the new table
+    for (Section& section : m_sections)
+        section.name = sectionOf(m_entries[static_cast<size_t>(section.first)]->key);
+}
+
+qsizetype ConfigSectionIndex::sectionCount() const
+{
+    return static_cast<qsizetype>(m_sections.size());
+}
+
+ConfigSection ConfigSectionIndex::section(QStringView name) const
+{
+    const auto it = lowerBound(name);
+    if (it == m_sections.end() || it->name != name)
+        return ConfigSection();
+    return makeSection(*it);
+}
+
+QStringList ConfigSectionIndex::sectionNames(QStringView prefix) const
+{
+    QStringList names;
+    forEachSection(prefix, [&names](const ConfigSection& section) {
+        names.append(section.name().toString());
+    });
+    return names;
+}
+
+QStringView ConfigSectionIndex::sectionOf(QStringView key)
+{
+    const qsizetype separator = key.lastIndexOf(u'/');
+    return separator < 0 ? QStringView() : key.left(separator);
+}
+
+std::vector<ConfigSectionIndex::Section>::const_iterator ConfigSectionIndex::lowerBound(QStringView name) const
+{
+    return std::lower_bound(m_sections.begin(), m_sections.end(), name, [](const Section& section, QStringView name) {
+        return section.name < name;
+    });
+}
+
+ConfigSection ConfigSectionIndex::makeSection(const Section &section) const
+{
+    return ConfigSection(section.name, m_entries.data() + section.first, section.count);
+}
@@ -0,0 +1,99 @@
+#ifndef CONFIGSECTION_H
+#define CONFIGSECTION_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVariant>
+#include <vector>
+#include "configtable.h"
+
+/*
+ * The keys of one section, e.g. "Zone/12" with "Valve" and "Duration" for the keys
+ * "Zone/12/Valve" and "Zone/12/Duration". The section of a key is everything before its last
+ * '/', keys without one are in the section "".
+ *
+ * A view into a ConfigSnapshot: only valid as long as the snapshot is, so it must not be kept
+ * outside of the reader section it has been obtained in.
+ */
+class ConfigSection
+{
+public:
+    ConfigSection() = default;
+
+    QStringView name() const { return m_name; }
+    qsizetype size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // In insertion order. The key without the section, e.g. "Valve"
+    QStringView key(qsizetype i) const;
+    const QVariant& value(qsizetype i) const;
+    const ConfigTable::Entry& entry(qsizetype i) const { return *m_entries[i]; }
+
+    // nullptr if the section doesn't have the key. Sections are small, so this is a linear search.
+    const QVariant* find(QStringView key) const;
+
+private:
+    friend class ConfigSectionIndex;
+
+    ConfigSection(QStringView name, const ConfigTable::Entry* const* entries, qsizetype count)
+        : m_name{name}, m_entries{entries}, m_count{count} {}
+
+    QStringView m_name;
+    const ConfigTable::Entry* const* m_entries = nullptr;
+    qsizetype m_count = 0;
+};
+
+/*
+ * Groups the entries of a ConfigTable by section, built once per snapshot.
+ *
+ * The sections are sorted by name, so a section is found by a binary search over views of
+ * the existing keys, and all sections with a common prefix ("Zone/") are a contiguous range.
+ * Nothing is allocated per key: the index holds pointers to the table's entries.
+ */
+class ConfigSectionIndex
+{
+public:
+    // The table must not be modified or destroyed while the index is used
+    explicit ConfigSectionIndex(const ConfigTable& table);
+    // The index of a table with the same keys in the same order as previousTable, only the
+    // values may differ: the sections of the previous index are taken over, nothing is sorted
+    ConfigSectionIndex(const ConfigTable& table, const ConfigSectionIndex& previous, const ConfigTable& previousTable);
+
+    ConfigSectionIndex(const ConfigSectionIndex&) = delete;
+    ConfigSectionIndex& operator=(const ConfigSectionIndex&) = delete;
+    ConfigSectionIndex(ConfigSectionIndex&&) = default; // Points into the table, not into itself
+
+    qsizetype sectionCount() const;
+    // Empty if there is no such section
+    ConfigSection section(QStringView name) const;
+    // Sorted by name
+    QStringList sectionNames(QStringView prefix = QStringView()) const;
+
+    // Calls f(const ConfigSection&) for every section whose name starts with prefix, sorted by name
+    template<typename F>
+    void forEachSection(QStringView prefix, F f) const
+    {
+        for (auto it = lowerBound(prefix); it != m_sections.end() && it->name.startsWith(prefix); ++it)
+            f(makeSection(*it));
+    }
+
+    // "Zone/12/Valve" -> "Zone/12"
+    static QStringView sectionOf(QStringView key);
+
+private:
+    struct Section
+    {
+        QStringView name;
+        qint32 first; // Into m_entries
+        qint32 count;
+    };
+
+    std::vector<Section>::const_iterator lowerBound(QStringView name) const;
+    ConfigSection makeSection(const Section& section) const;
+
+    std::vector<Section> m_sections;
+    std::vector<const ConfigTable::Entry*> m_entries; // Grouped by section
+};
+
+#endif // CONFIGSECTION_H
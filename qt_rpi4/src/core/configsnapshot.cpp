@@ -0,0 +1,90 @@
+#include "configsnapshot.h"
+
+namespace {
+
+ConfigTable withChanges(ConfigTable values, const ConfigTable& changes)
+{
+    for (const ConfigTable::Entry& change : changes)
+    {
+        if (change.value.isValid())
+            values.insert(change.key, change.value, change.source);
+        else
+            values.remove(change.key);
+    }
+    return values;
+}
+
+// True if applying the changes only replaces values, the keys stay where they are
+bool keepsKeys(const ConfigTable& values, const ConfigTable& changes)
+{
+    for (const ConfigTable::Entry& change : changes)
+    {
+        if (!change.value.isValid() || !values.contains(change.key))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ConfigSnapshot::ConfigSnapshot(quint64 version, ConfigTable values)
+    : m_version{version},
+      m_values{std::move(values)},
+      m_sections{m_values}
+{
+}
+
+ConfigSnapshot::ConfigSnapshot(quint64 version, const ConfigSnapshot &previous, const ConfigTable &changes)
+    : m_version{version},
+      m_values{withChanges(previous.m_values, changes)},
+      m_sections{keepsKeys(previous.m_values, changes)
+                     ? ConfigSectionIndex(m_values, previous.m_sections, previous.m_values)
+                     : ConfigSectionIndex(m_values)}
+{
+}
+
+quint64 ConfigSnapshot::version() const
+{
+    return m_version;
+}
+
+bool ConfigSnapshot::contains(const QString &key) const
+{
+    return m_values.contains(key);
+}
+
+QVariant ConfigSnapshot::value(const QString &key, const QVariant &defaultValue) const
+{
+    const QVariant* value = m_values.find(key);
+    return value ? *value : defaultValue;
+}
+
+const ConfigTable &ConfigSnapshot::values() const
+{
+    return m_values;
+}
+
+const ConfigSectionIndex &ConfigSnapshot::sections() const
+{
+    return m_sections;
+}
+
+QStringList ConfigSnapshot::changedKeys(const ConfigSnapshot *other) const
+{
+    QStringList keys;
+    for (const ConfigTable::Entry& entry : m_values)
+    {
+        const QVariant* otherValue = other ? other->m_values.find(entry.key) : nullptr;
+        if (!otherValue || *otherValue != entry.value)
+            keys.append(entry.key);
+    }
+    if (other)
+    {
+        for (const ConfigTable::Entry& entry : other->m_values)
+        {
+            if (!m_values.contains(entry.key))
+                keys.append(entry.key);
+        }
+    }
+    return keys;
+}
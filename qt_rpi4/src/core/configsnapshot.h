@@ -0,0 +1,40 @@
+#ifndef CONFIGSNAPSHOT_H
+#define CONFIGSNAPSHOT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include "configtable.h"
+#include "configsection.h"
+
+/*
+ * The values of one (re)load of the config file. A snapshot is never modified after it has
+ * been published, so any number of threads can read it at the same time.
+ * Besides the flat table, the values are indexed by section (see ConfigSectionIndex).
+ */
+class ConfigSnapshot
+{
+public:
+    ConfigSnapshot(quint64 version, ConfigTable values);
+    // The values of previous with the changes applied, invalid values remove their key. The
+    // section index is taken over from previous unless keys are added or removed.
+    ConfigSnapshot(quint64 version, const ConfigSnapshot& previous, const ConfigTable& changes);
+    Q_DISABLE_COPY(ConfigSnapshot) // The section index points into the table
+
+    // Increases with every published snapshot
+    quint64 version() const;
+    bool contains(const QString& key) const;
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    const ConfigTable& values() const;
+    const ConfigSectionIndex& sections() const;
+
+    // Keys which have been added, removed or changed compared to the other snapshot
+    QStringList changedKeys(const ConfigSnapshot* other) const;
+
+private:
+    const quint64 m_version;
+    const ConfigTable m_values;
+    const ConfigSectionIndex m_sections; // Built after m_values
+};
+
+#endif // CONFIGSNAPSHOT_H
@@ -0,0 +1,219 @@
+#include "configtable.h"
+#include <QLatin1StringView>
+
+namespace {
+
+constexpr quint64 FnvOffsetBasis = 14695981039346656037ULL;
+constexpr quint64 FnvPrime = 1099511628211ULL;
+
+inline quint64 hashStep(quint64 hash, char16_t c)
+{
+    hash ^= static_cast<quint64>(c);
+    return hash * FnvPrime;
+}
+
+quint64 hashBytes(quint64 hash, QByteArrayView bytes)
+{
+    for (char c : bytes)
+        hash = hashStep(hash, static_cast<char16_t>(static_cast<uchar>(c)));
+    return hash;
+}
+
+bool isAscii(QByteArrayView bytes)
+{
+    for (char c : bytes)
+    {
+        if (static_cast<uchar>(c) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ConfigTable::ConfigTable(std::initializer_list<std::pair<QString, QVariant>> values)
+{
+    reserve(static_cast<qsizetype>(values.size()));
+    for (const auto& value : values)
+        insert(value.first, value.second);
+}
+
+void ConfigTable::reserve(qsizetype count)
+{
+    m_entries.reserve(static_cast<size_t>(count));
+    // Keep the load factor at 1/2 at most
+    size_t capacity = 16;
+    while (capacity < static_cast<size_t>(count) * 2)
+        capacity *= 2;
+    if (capacity > m_index.size())
+        rehash(capacity);
+}
+
+void ConfigTable::insert(const QString &key, const QVariant &value, ConfigSource source)
+{
+    const quint64 hash = hashKey(key);
+    const qint32 slot = findSlot(key, hash);
+    if (slot >= 0)
+    {
+        Entry& entry = m_entries[static_cast<size_t>(slot)];
+        entry.value = value;
+        entry.source = source;
+    }
+    else
+    {
+        append({key, value, hash, source});
+    }
+}
+
+void ConfigTable::insert(QByteArrayView section, QByteArrayView key, QByteArrayView value)
+{
+    const QVariant variant(QString::fromUtf8(value));
+    if (!isAscii(section) || !isAscii(key))
+    {
+        insert(section.isEmpty() ? QString::fromUtf8(key) : QString::fromUtf8(section) + '/' + QString::fromUtf8(key), variant);
+        return;
+    }
+
+    // Hash and compare the bytes directly, the key string is only built if it's new
+    quint64 hash = FnvOffsetBasis;
+    if (!section.isEmpty())
+    {
+        hash = hashBytes(hash, section);
+        hash = hashStep(hash, u'/');
+    }
+    hash = hashBytes(hash, key);
+
+    const qsizetype length = section.isEmpty() ? key.size() : section.size() + 1 + key.size();
+    if (!m_index.empty())
+    {
+        const size_t mask = m_index.size() - 1;
+        for (size_t i = slotOf(hash, mask); m_index[i] != EmptySlot; i = (i + 1) & mask)
+        {
+            Entry& entry = m_entries[static_cast<size_t>(m_index[i])];
+            if (entry.hash != hash || entry.key.size() != length)
+                continue;
+            const QStringView existing(entry.key);
+            const bool equal = section.isEmpty()
+                                   ? existing == QLatin1StringView(key)
+                                   : existing.left(section.size()) == QLatin1StringView(section)
+                                         && existing.at(section.size()) == u'/'
+                                         && existing.sliced(section.size() + 1) == QLatin1StringView(key);
+            if (equal)
+            {
+                entry.value = variant;
+                return;
+            }
+        }
+    }
+
+    QString fullKey;
+    fullKey.reserve(length);
+    if (!section.isEmpty())
+    {
+        fullKey.append(QLatin1StringView(section));
+        fullKey.append(u'/');
+    }
+    fullKey.append(QLatin1StringView(key));
+    append({fullKey, variant, hash});
+}
+
+bool ConfigTable::appendUnique(QString key, QVariant value, quint64 hash)
+{
+    if (findSlot(key, hash) != EmptySlot)
+        return false;
+    append({std::move(key), std::move(value), hash});
+    return true;
+}
+
+bool ConfigTable::remove(QStringView key)
+{
+    const qint32 slot = findSlot(key, hashKey(key));
+    if (slot < 0)
+        return false;
+    // The entry numbers behind it shift, so the index is rebuilt
+    m_entries.erase(m_entries.begin() + slot);
+    rehash(m_index.size());
+    return true;
+}
+
+const QVariant *ConfigTable::find(QStringView key) const
+{
+    const qint32 slot = findSlot(key, hashKey(key));
+    return slot >= 0 ? &m_entries[static_cast<size_t>(slot)].value : nullptr;
+}
+
+const ConfigTable::Entry *ConfigTable::findEntry(QStringView key) const
+{
+    const qint32 slot = findSlot(key, hashKey(key));
+    return slot >= 0 ? &m_entries[static_cast<size_t>(slot)] : nullptr;
+}
+
+bool ConfigTable::contains(QStringView key) const
+{
+    return find(key) != nullptr;
+}
+
+qsizetype ConfigTable::size() const
+{
+    return static_cast<qsizetype>(m_entries.size());
+}
+
+bool ConfigTable::isEmpty() const
+{
+    return m_entries.empty();
+}
+
+quint64 ConfigTable::hashKey(QStringView key)
+{
+    quint64 hash = FnvOffsetBasis;
+    for (QChar c : key)
+        hash = hashStep(hash, c.unicode());
+    return hash;
+}
+
+size_t ConfigTable::slotOf(quint64 hash, size_t mask)
+{
+    if constexpr (sizeof(size_t) < sizeof(quint64))
+        return static_cast<size_t>(hash ^ (hash >> 32)) & mask;
+    else
+        return static_cast<size_t>(hash) & mask;
+}
+
+qint32 ConfigTable::findSlot(QStringView key, quint64 hash) const
+{
+    if (m_index.empty())
+        return EmptySlot;
+    const size_t mask = m_index.size() - 1;
+    for (size_t i = slotOf(hash, mask); m_index[i] != EmptySlot; i = (i + 1) & mask)
+    {
+        const Entry& entry = m_entries[static_cast<size_t>(m_index[i])];
+        if (entry.hash == hash && entry.key == key)
+            return m_index[i];
+    }
+    return EmptySlot;
+}
+
+void ConfigTable::append(Entry entry)
+{
+    if ((m_entries.size() + 1) * 2 > m_index.size())
+        rehash(qMax<size_t>(16, m_index.size() * 2));
+    const size_t mask = m_index.size() - 1;
+    size_t i = slotOf(entry.hash, mask);
+    while (m_index[i] != EmptySlot)
+        i = (i + 1) & mask;
+    m_index[i] = static_cast<qint32>(m_entries.size());
+    m_entries.push_back(std::move(entry));
+}
+
+void ConfigTable::rehash(size_t capacity)
+{
+    m_index.assign(capacity, EmptySlot);
+    const size_t mask = capacity - 1;
+    for (size_t n = 0; n < m_entries.size(); ++n)
+    {
+        size_t i = slotOf(m_entries[n].hash, mask);
+        while (m_index[i] != EmptySlot)
+            i = (i + 1) & mask;
+        m_index[i] = static_cast<qint32>(n);
+    }
+}
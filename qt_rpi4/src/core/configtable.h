@@ -0,0 +1,82 @@
+#ifndef CONFIGTABLE_H
+#define CONFIGTABLE_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <QVariant>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// Where a config value comes from. The layers are applied in this order, later ones win.
+enum class ConfigSource : quint8
+{
+    Unset,       // The key doesn't exist
+    Default,     // Built into the application
+    File,        // The INI file
+    Environment, // GREENOASIS_<Section>__<Key>
+    CommandLine  // --set Section/Key=value
+};
+
+/*
+ * Flat hash table of config values, keyed by "Section/Key".
+ *
+ * The entries are kept in insertion order in one vector and found through an open addressing
+ * index of entry numbers, so a lookup is a hash and usually a single compare, and iterating
+ * walks contiguous memory. Every key is stored once as a QString (interned): inserting a key
+ * that exists already replaces the value without creating another string.
+ */
+class ConfigTable
+{
+public:
+    struct Entry
+    {
+        QString key;
+        QVariant value;
+        quint64 hash = 0; // hashKey(key)
+        ConfigSource source = ConfigSource::File;
+    };
+
+    ConfigTable() = default;
+    ConfigTable(std::initializer_list<std::pair<QString, QVariant>> values);
+
+    void reserve(qsizetype count);
+    // Inserts or replaces the value of the key
+    void insert(const QString& key, const QVariant& value, ConfigSource source = ConfigSource::File);
+    // For the parser: the key is section + '/' + key, a string is only created for new keys
+    void insert(QByteArrayView section, QByteArrayView key, QByteArrayView value);
+    // For the binary cache: hash has to be hashKey(key). False if the key exists already.
+    bool appendUnique(QString key, QVariant value, quint64 hash);
+    // Keeps the order of the other entries, O(size()). False if the key doesn't exist.
+    bool remove(QStringView key);
+
+    // nullptr if the key doesn't exist
+    const QVariant* find(QStringView key) const;
+    const Entry* findEntry(QStringView key) const;
+    bool contains(QStringView key) const;
+    qsizetype size() const;
+    bool isEmpty() const;
+
+    // In insertion order
+    std::vector<Entry>::const_iterator begin() const { return m_entries.cbegin(); }
+    std::vector<Entry>::const_iterator end() const { return m_entries.cend(); }
+
+    // 64 bit FNV-1a over the UTF-16 code units, so Latin-1 bytes hash the same without a
+    // conversion. The same on every platform, it is stored in the binary cache.
+    static quint64 hashKey(QStringView key);
+
+private:
+    static constexpr qint32 EmptySlot = -1;
+
+    // Folds the hash to the width of size_t before masking, so 32 bit builds use all of it
+    static size_t slotOf(quint64 hash, size_t mask);
+    qint32 findSlot(QStringView key, quint64 hash) const;
+    void append(Entry entry);
+    void rehash(size_t capacity);
+
+    std::vector<Entry> m_entries;
+    std::vector<qint32> m_index; // Entry numbers, EmptySlot if unused. Size is a power of two.
+};
+
+#endif // CONFIGTABLE_H
@@ -0,0 +1,230 @@
+#include "flightrecorder.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = {'G', 'O', 'F', 'L', 'R', 'E', 'C', '\0'};
+constexpr quint64 FileHeaderSize = sizeof(FlightRecorder::FileHeader);
+constexpr quint64 RecordHeaderSize = sizeof(FlightRecorder::RecordHeader);
+static_assert(FileHeaderSize == 64, "The file header is part of the file format");
+static_assert(RecordHeaderSize == 32, "The record header is part of the file format");
+
+quint64 alignedRecordSize(quint64 textLength)
+{
+    return (RecordHeaderSize + textLength + 7) & ~quint64(7);
+}
+
+struct RecordLocation
+{
+    quint64 position;
+    quint64 offset;
+};
+
+// Collects the complete records of the data area which belong to the last lap, ordered by
+// position. end is the position behind the newest record, which is where appending continues.
+QList<RecordLocation> scanRecords(const uchar* data, quint64 capacity, quint64& end)
+{
+    // A record is only accepted where its own position says it has to be. Stale records
+    // that have been partially overwritten are older than one lap and get dropped below.
+    QList<RecordLocation> records;
+    end = 0;
+    for (quint64 offset = 0; offset + RecordHeaderSize <= capacity; offset += 8)
+    {
+        FlightRecorder::RecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        if (header.marker != FlightRecorder::RecordMarker
+            || header.position % capacity != offset
+            || header.textLength > FlightRecorder::MaxTextLength
+            || header.size != alignedRecordSize(header.textLength)
+            || offset + header.size > capacity)
+        {
+            continue;
+        }
+        records.append({header.position, offset});
+        end = qMax(end, header.position + header.size);
+    }
+
+    const quint64 oldest = end > capacity ? end - capacity : 0;
+    records.removeIf([oldest](const RecordLocation& record) { return record.position < oldest; });
+    std::sort(records.begin(), records.end(), [](const RecordLocation& a, const RecordLocation& b) {
+        return a.position < b.position;
+    });
+    return records;
+}
+
+} // namespace
+
+FlightRecorder::~FlightRecorder()
+{
+    close();
+}
+
+bool FlightRecorder::open(const QString &filePath, qint64 capacity)
+{
+    close();
+    m_capacity = static_cast<quint64>(qMax(capacity, MinCapacity)) & ~quint64(7);
+    const qint64 fileSize = static_cast<qint64>(FileHeaderSize + m_capacity);
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadWrite))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+    // A file of another size can't be continued, so it is started from scratch
+    if (m_file.size() != fileSize && (!m_file.resize(0) || !m_file.resize(fileSize)))
+    {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_mapping = m_file.map(0, fileSize);
+    if (!m_mapping)
+    {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_data = m_mapping + FileHeaderSize;
+
+    FileHeader header;
+    std::memcpy(&header, m_mapping, sizeof(header));
+    const bool validHeader = std::memcmp(header.magic, Magic, sizeof(Magic)) == 0
+                             && header.version == Version
+                             && header.headerSize == FileHeaderSize
+                             && header.capacity == m_capacity;
+    if (validHeader)
+    {
+        // Continue behind the newest record of the previous run
+        quint64 end = 0;
+        scanRecords(m_data, m_capacity, end);
+        m_writePosition.store(end, std::memory_order_relaxed);
+    }
+    else
+    {
+        std::memset(m_data, 0, m_capacity);
+        header = FileHeader{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.headerSize = FileHeaderSize;
+        header.capacity = m_capacity;
+        header.createdMsecs = QDateTime::currentMSecsSinceEpoch();
+        std::memcpy(m_mapping, &header, sizeof(header));
+        m_writePosition.store(0, std::memory_order_relaxed);
+    }
+    m_errorString.clear();
+    return true;
+}
+
+void FlightRecorder::close()
+{
+    if (m_mapping)
+    {
+        m_file.unmap(m_mapping);
+        m_mapping = nullptr;
+        m_data = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+bool FlightRecorder::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+QString FlightRecorder::fileName() const
+{
+    return m_file.fileName();
+}
+
+QString FlightRecorder::errorString() const
+{
+    return m_errorString;
+}
+
+void FlightRecorder::append(QtMsgType type, QByteArrayView text)
+{
+    if (!m_data)
+        return;
+
+    const quint64 textLength = static_cast<quint64>(qMin(text.size(), qsizetype(MaxTextLength)));
+    const quint64 size = alignedRecordSize(textLength);
+
+    // Reserve the space. A record that would wrap around starts at the beginning instead.
+    quint64 position = m_writePosition.load(std::memory_order_relaxed);
+    quint64 next;
+    do
+    {
+        const quint64 remaining = m_capacity - position % m_capacity;
+        next = position + (remaining < size ? remaining : 0) + size;
+    } while (!m_writePosition.compare_exchange_weak(position, next, std::memory_order_relaxed));
+
+    const quint64 recordPosition = next - size;
+    uchar* record = m_data + recordPosition % m_capacity;
+
+    // Invalidate whatever was stored here before, then fill in the record and mark it as
+    // complete as the very last step. A record torn by a crash is never decoded.
+    const quint32 incomplete = 0;
+    std::memcpy(record + offsetof(RecordHeader, marker), &incomplete, sizeof(incomplete));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    RecordHeader header{};
+    header.size = static_cast<quint32>(size);
+    header.marker = 0;
+    header.position = recordPosition;
+    header.msecs = QDateTime::currentMSecsSinceEpoch();
+    header.textLength = static_cast<quint32>(textLength);
+    header.type = static_cast<quint8>(type);
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + RecordHeaderSize, text.data(), textLength);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(record + offsetof(RecordHeader, marker), &RecordMarker, sizeof(RecordMarker));
+}
+
+bool FlightRecorder::decode(QByteArrayView fileData, QList<Entry> &entries, QString *errorString)
+{
+    entries.clear();
+    auto fail = [errorString](const QString& message) {
+        if (errorString)
+            *errorString = message;
+        return false;
+    };
+
+    if (static_cast<quint64>(fileData.size()) < FileHeaderSize)
+        return fail(QStringLiteral("File is too small for a flight recorder file"));
+
+    FileHeader header;
+    std::memcpy(&header, fileData.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+        return fail(QStringLiteral("Not a flight recorder file"));
+    if (header.version != Version)
+        return fail(QStringLiteral("Unsupported flight recorder version %1").arg(header.version));
+    if (header.headerSize != FileHeaderSize || header.capacity == 0 || header.capacity % 8 != 0
+        || static_cast<quint64>(fileData.size()) < FileHeaderSize + header.capacity)
+    {
+        return fail(QStringLiteral("Corrupt flight recorder header"));
+    }
+
+    const uchar* data = reinterpret_cast<const uchar*>(fileData.data()) + FileHeaderSize;
+    quint64 end = 0;
+    const QList<RecordLocation> records = scanRecords(data, header.capacity, end);
+    entries.reserve(records.size());
+    for (const RecordLocation& location : records)
+    {
+        RecordHeader record;
+        std::memcpy(&record, data + location.offset, sizeof(record));
+        Entry entry;
+        entry.position = record.position;
+        entry.msecs = record.msecs;
+        entry.type = static_cast<QtMsgType>(record.type);
+        entry.text = QByteArray(reinterpret_cast<const char*>(data + location.offset + RecordHeaderSize),
+                                static_cast<qsizetype>(record.textLength));
+        entries.append(entry);
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <QtGlobal>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <atomic>
+
+/*
+ * Crash-safe binary log sink ("flight recorder").
+ *
+ * Records are appended to a fixed-size circular file which is memory-mapped, so appending
+ * is a plain memory copy without any syscall. The mapped pages belong to the kernel, which
+ * means the last records survive a crash or an abort of the process. They are written back
+ * to the storage periodically by the kernel. The file is decoded offline with rpi4_logdump.
+ *
+ * File layout: a FileHeader followed by the circular data area of FileHeader::capacity bytes.
+ * Records are aligned to 8 bytes and never wrap around the end of the data area, a record
+ * which doesn't fit anymore starts at the beginning instead. Every record stores its own
+ * logical position (the number of bytes written before it), so the reader can tell valid
+ * records from stale or partially overwritten data without any index.
+ */
+class FlightRecorder
+{
+public:
+    static constexpr quint32 Version = 1;
+    static constexpr quint32 RecordMarker = 0x31434552; // "REC1", written last
+    static constexpr int MaxTextLength = 4096;
+    static constexpr qint64 MinCapacity = 16 * 1024;
+
+    struct FileHeader
+    {
+        char magic[8]; // "GOFLREC\0"
+        quint32 version;
+        quint32 headerSize;
+        quint64 capacity; // Size of the data area in bytes
+        qint64 createdMsecs;
+        quint8 reserved[32];
+    };
+
+    struct RecordHeader
+    {
+        quint32 size;       // Total size including this header, multiple of 8
+        quint32 marker;     // RecordMarker once the record is complete
+        quint64 position;   // Logical position of this record
+        qint64 msecs;       // UTC timestamp in milliseconds since epoch
+        quint32 textLength; // Length of the UTF-8 text following this header
+        quint8 type;        // QtMsgType
+        quint8 reserved[3];
+    };
+
+    // A decoded record
+    struct Entry
+    {
+        quint64 position;
+        qint64 msecs;
+        QtMsgType type;
+        QByteArray text;
+    };
+
+    FlightRecorder() = default;
+    ~FlightRecorder(); // Deconstructor
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Opens or creates the file with a data area of capacity bytes (at least MinCapacity).
+    // An existing file with the same capacity is continued, so the previous records are kept.
+    bool open(const QString& filePath, qint64 capacity);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    // Thread-safe and lock-free. Texts longer than MaxTextLength are truncated.
+    void append(QtMsgType type, QByteArrayView text);
+
+    // Decodes the valid records of a flight recorder file, oldest first
+    static bool decode(QByteArrayView fileData, QList<Entry>& entries, QString* errorString = nullptr);
+
+private:
+    QFile m_file;
+    uchar* m_mapping = nullptr;
+    uchar* m_data = nullptr;
+    quint64 m_capacity = 0;
+    std::atomic<quint64> m_writePosition{0};
+    QString m_errorString;
+};
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,43 @@
+#include "iniparser.h"
+#include <QFile>
+
+bool IniParser::parseFile(const QString &fileName, ConfigTable &table, QString *errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return parseFile(file, table, errorString);
+}
+
+bool IniParser::parseFile(QFile &file, ConfigTable &table, QString *errorString)
+{
+    auto insert = [&table](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+        table.insert(section, key, value);
+    };
+
+    const qint64 size = file.size();
+    if (size == 0)
+        return true;
+    // Mapping saves copying the file, the values are converted straight from the mapped pages
+    if (uchar* data = file.map(0, size))
+    {
+        parse(QByteArrayView(reinterpret_cast<const char*>(data), size), insert);
+        file.unmap(data);
+        return true;
+    }
+
+    // Not mappable, e.g. a pipe
+    const QByteArray content = file.readAll();
+    if (file.error() != QFileDevice::NoError)
+    {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    parse(content, insert);
+    return true;
+}
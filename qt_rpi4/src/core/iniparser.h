@@ -0,0 +1,66 @@
+#ifndef INIPARSER_H
+#define INIPARSER_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <cstring>
+#include "configtable.h"
+
+class QFile;
+
+/*
+ * Single pass INI tokenizer working on slices of the input, it doesn't allocate anything.
+ *
+ *   [Section]
+ *   key = value            -> handler("Section", "key", "value")
+ *   url = https://a?b=c    -> everything after the first '=' is the value
+ *   ; comment, # comment
+ *
+ * Whitespace around sections, keys and values is trimmed; lines without '=' and lines
+ * with an empty key are skipped, as are comments. Keys before the first section have an
+ * empty section. A UTF-8 byte order mark at the start is skipped.
+ */
+namespace IniParser
+{
+    template<typename Handler>
+    void parse(QByteArrayView text, Handler&& handler)
+    {
+        // Windows editors save UTF-8 with a byte order mark, which would hide the first line
+        if (text.startsWith("\xEF\xBB\xBF"))
+            text = text.sliced(3);
+
+        QByteArrayView section;
+        const char* position = text.data();
+        const char* const end = position + text.size();
+        while (position < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', static_cast<size_t>(end - position)));
+            if (!lineEnd)
+                lineEnd = end;
+            const QByteArrayView line = QByteArrayView(position, lineEnd - position).trimmed();
+            position = lineEnd + 1;
+
+            if (line.isEmpty() || line.front() == ';' || line.front() == '#')
+                continue;
+            if (line.front() == '[' && line.back() == ']')
+            {
+                section = line.sliced(1, line.size() - 2).trimmed();
+                continue;
+            }
+            const qsizetype separator = line.indexOf('=');
+            if (separator <= 0)
+                continue;
+            const QByteArrayView key = line.first(separator).trimmed();
+            if (key.isEmpty())
+                continue;
+            handler(section, key, line.sliced(separator + 1).trimmed());
+        }
+    }
+
+    // Maps the file and parses it into the table. False if it can't be read.
+    bool parseFile(const QString& fileName, ConfigTable& table, QString* errorString = nullptr);
+    // The same for a file that has been opened for reading
+    bool parseFile(QFile& file, ConfigTable& table, QString* errorString = nullptr);
+}
+
+#endif // INIPARSER_H
@@ -0,0 +1,194 @@
+#include "iniwriter.h"
+#include "configsection.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QSaveFile>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+QByteArray singleLine(const QVariant& value)
+{
+    QByteArray text = value.toString().toUtf8();
+    text.replace('\r', ' ');
+    text.replace('\n', ' ');
+    return text.trimmed();
+}
+
+// "Section/Key" -> "Key"
+QByteArray keyName(const QString& key, QStringView section)
+{
+    return (section.isEmpty() ? QStringView(key) : QStringView(key).sliced(section.size() + 1)).toUtf8();
+}
+
+} // namespace
+
+QByteArray IniWriter::apply(QByteArrayView text, const ConfigTable &changes)
+{
+    // Kept in front of the first line, which has to be recognised without it
+    const QByteArrayView byteOrderMark("\xEF\xBB\xBF");
+    const bool hasByteOrderMark = text.startsWith(byteOrderMark);
+    if (hasByteOrderMark)
+        text = text.sliced(byteOrderMark.size());
+    const QByteArray newline = text.contains("\r\n") ? QByteArray("\r\n") : QByteArray("\n");
+    QList<QByteArray> lines;
+    for (QByteArrayView rest = text; !rest.isEmpty();)
+    {
+        const qsizetype lineEnd = rest.indexOf('\n');
+        QByteArrayView line = lineEnd < 0 ? rest : rest.first(lineEnd);
+        if (line.endsWith('\r'))
+            line.chop(1);
+        lines.append(line.toByteArray());
+        rest = lineEnd < 0 ? QByteArrayView() : rest.sliced(lineEnd + 1);
+    }
+
+    // Same rules as IniParser: replace the values in place and remember where each section ends
+    QHash<QString, qsizetype> sectionEnds; // Line after which new keys of the section go
+    QHash<QString, bool> written;
+    QList<qsizetype> removed; // Lines of removed keys, ascending
+    QString section;
+    sectionEnds.insert(QString(), -1); // Keys without a section go before the first section
+    for (qsizetype i = 0; i < lines.size(); ++i)
+    {
+        QByteArray& line = lines[i];
+        const QByteArrayView trimmed = QByteArrayView(line).trimmed();
+        if (trimmed.isEmpty() || trimmed.front() == ';' || trimmed.front() == '#')
+            continue;
+        if (trimmed.front() == '[' && trimmed.back() == ']')
+        {
+            section = QString::fromUtf8(trimmed.sliced(1, trimmed.size() - 2).trimmed());
+            sectionEnds.insert(section, i);
+            continue;
+        }
+        const qsizetype separator = line.indexOf('=');
+        const QByteArrayView key = separator > 0 ? QByteArrayView(line).first(separator).trimmed() : QByteArrayView();
+        if (key.isEmpty())
+            continue;
+        sectionEnds.insert(section, i);
+
+        const QString fullKey = section.isEmpty() ? QString::fromUtf8(key) : section + '/' + QString::fromUtf8(key);
+        const QVariant* value = changes.find(fullKey);
+        if (!value)
+            continue;
+        written.insert(fullKey, true);
+        if (!value->isValid())
+        {
+            removed.append(i);
+            continue;
+        }
+        // Keep the key and the spacing around '=' as they are
+        qsizetype valueStart = separator + 1;
+        while (valueStart < line.size() && (line[valueStart] == ' ' || line[valueStart] == '\t'))
+            ++valueStart;
+        line = line.first(valueStart) + singleLine(*value);
+    }
+
+    // New keys, grouped by the line they go after
+    QHash<qsizetype, QList<QByteArray>> insertions;
+    QList<QString> newSections;
+    QHash<QString, QList<QByteArray>> newSectionLines;
+    for (const ConfigTable::Entry& entry : changes)
+    {
+        if (written.contains(entry.key) || !entry.value.isValid())
+            continue;
+        const QString keySection = ConfigSectionIndex::sectionOf(entry.key).toString();
+        const QByteArray line = keyName(entry.key, keySection) + '=' + singleLine(entry.value);
+        const auto end = sectionEnds.constFind(keySection);
+        if (end != sectionEnds.constEnd())
+        {
+            insertions[*end].append(line);
+        }
+        else
+        {
+            if (!newSectionLines.contains(keySection))
+                newSections.append(keySection);
+            newSectionLines[keySection].append(line);
+        }
+    }
+
+    QByteArray result;
+    result.reserve(byteOrderMark.size() + text.size() + 64 * changes.size());
+    if (hasByteOrderMark)
+        result += byteOrderMark;
+    auto appendLines = [&result, &newline](const QList<QByteArray>& newLines) {
+        for (const QByteArray& newLine : newLines)
+            result += newLine + newline;
+    };
+    appendLines(insertions.value(-1));
+    qsizetype nextRemoved = 0;
+    for (qsizetype i = 0; i < lines.size(); ++i)
+    {
+        if (nextRemoved < removed.size() && removed[nextRemoved] == i)
+            ++nextRemoved;
+        else
+            result += lines[i] + newline;
+        appendLines(insertions.value(i));
+    }
+    for (const QString& newSection : std::as_const(newSections))
+    {
+        if (result.size() > (hasByteOrderMark ? byteOrderMark.size() : 0) && !result.endsWith(newline + newline))
+            result += newline;
+        result += '[' + newSection.toUtf8() + ']' + newline;
+        appendLines(newSectionLines.value(newSection));
+    }
+    return result;
+}
+
+bool IniWriter::writeFile(const QString &fileName, QByteArrayView content, QString *errorString)
+{
+    auto fail = [errorString](const QString& error) {
+        if (errorString)
+            *errorString = error;
+        return false;
+    };
+
+    // Through a symbolic link the file it points to is replaced, not the link
+    const QFileInfo info(fileName);
+    const QString targetFileName = info.exists() ? info.canonicalFilePath() : info.absoluteFilePath();
+
+    // QSaveFile gives the temporary file the permissions of the existing one and renames it
+    // over the original, replacing it atomically on every platform
+    QSaveFile file(targetFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return fail(file.errorString());
+#ifdef Q_OS_UNIX
+    // Keep the owner as well, which only works with the privileges to change it
+    struct stat status;
+    if (::stat(QFile::encodeName(targetFileName).constData(), &status) == 0
+        && ::fchown(file.handle(), status.st_uid, status.st_gid) == 0)
+        ::fchmod(file.handle(), status.st_mode & 07777); // chown clears the set-id bits
+#endif
+    if (file.write(content.data(), content.size()) != content.size() || !file.flush())
+    {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        return fail(error);
+    }
+#ifdef Q_OS_UNIX
+    if (::fsync(file.handle()) != 0)
+    {
+        file.cancelWriting();
+        return fail("Couldn't sync the file to the disk");
+    }
+#endif
+    if (!file.commit())
+        return fail(file.errorString());
+
+#ifdef Q_OS_UNIX
+    // The rename survives a power cut once the directory is synced
+    const int directory = ::open(QFile::encodeName(QFileInfo(targetFileName).absolutePath()).constData(), O_RDONLY);
+    if (directory >= 0)
+    {
+        ::fsync(directory);
+        ::close(directory);
+    }
+#endif
+    return true;
+}
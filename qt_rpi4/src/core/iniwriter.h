@@ -0,0 +1,31 @@
+#ifndef INIWRITER_H
+#define INIWRITER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include "configtable.h"
+
+/*
+ * Writes changed values back into an INI file, the counterpart of IniParser.
+ *
+ * apply() edits the text: the value of an existing key is replaced in its line, so comments,
+ * blank lines, the order of the keys and the line endings are kept. New keys are added after
+ * the last line of their section, new sections at the end of the file. A UTF-8 byte order
+ * mark is kept.
+ *
+ * writeFile() never leaves a partly written file behind: the content goes to a temporary file
+ * (QSaveFile) in the same directory, which is flushed to the disk (fsync) and renamed over the
+ * original. The file keeps its permissions and, where the process may set it, its owner. A
+ * symbolic link is followed, the file it points to is replaced. On Unix the directory is
+ * synced as well, so the rename survives a power cut.
+ */
+namespace IniWriter
+{
+    // changes: "Section/Key" -> value. Line breaks in values are replaced by spaces, an invalid
+    // value removes the line of the key.
+    QByteArray apply(QByteArrayView text, const ConfigTable& changes);
+    bool writeFile(const QString& fileName, QByteArrayView content, QString* errorString = nullptr);
+}
+
+#endif // INIWRITER_H
@@ -0,0 +1,37 @@
+#include "logcategories.h"
+#include "configmanager.h"
+
+Q_LOGGING_CATEGORY(lcCore, "core")
+Q_LOGGING_CATEGORY(lcWeatherFetch, "weather.fetch")
+Q_LOGGING_CATEGORY(lcWeatherParse, "weather.parse")
+Q_LOGGING_CATEGORY(lcWeatherModel, "weather.model")
+
+QStringList LogCategories::names()
+{
+    return {"core", "weather.fetch", "weather.parse", "weather.model"};
+}
+
+void LogCategories::applyConfiguration()
+{
+    // Levels below the threshold are disabled, in the order of severity
+    const QStringList levels = {"debug", "info", "warning", "critical"};
+
+    QStringList rules;
+    for (const QString& category : names())
+    {
+        const QString threshold = ConfigManager::instance()
+                                      .getValue("LogCategories/" + category, "debug")
+                                      .toString().trimmed().toLower();
+        const int thresholdIndex = levels.indexOf(threshold);
+        if (thresholdIndex < 0)
+        {
+            qCWarning(lcCore) << "Unknown log level" << threshold << "for category" << category;
+            continue;
+        }
+        for (int i = 0; i < thresholdIndex; ++i)
+        {
+            rules.append(QString("%1.%2=false").arg(category, levels[i]));
+        }
+    }
+    QLoggingCategory::setFilterRules(rules.join('\n'));
+}
@@ -0,0 +1,33 @@
+#ifndef LOGCATEGORIES_H
+#define LOGCATEGORIES_H
+
+#include <QLoggingCategory>
+#include <QStringList>
+
+/*
+ * Logging categories of the subsystems. Use them with qCDebug(), qCInfo(), ...
+ * instead of the plain qDebug() macros: a disabled category is checked before
+ * anything gets formatted.
+ *
+ * The threshold of each category is read from the [LogCategories] section, e.g.
+ *   [LogCategories]
+ *   weather.fetch=info
+ *   weather.model=warning
+ * Valid levels: debug, info, warning, critical. Missing keys default to debug.
+ *
+ * Configuring with -DGREENOASIS_STRIP_DEBUG_LOGS=ON compiles all debug statements out.
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcCore)
+Q_DECLARE_LOGGING_CATEGORY(lcWeatherFetch)
+Q_DECLARE_LOGGING_CATEGORY(lcWeatherParse)
+Q_DECLARE_LOGGING_CATEGORY(lcWeatherModel)
+
+namespace LogCategories
+{
+    // Names of all categories above
+    QStringList names();
+    // Builds QLoggingCategory filter rules from the [LogCategories] section and installs them
+    void applyConfiguration();
+}
+
+#endif // LOGCATEGORIES_H
@@ -0,0 +1,367 @@
+#include "logformatter.h"
+#include <QDateTime>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+namespace {
+
+// Text of "yyyy-MM-dd hh:mm:ss.zzz" for the last formatted millisecond
+struct TimestampCache
+{
+    static constexpr int Length = 23;
+    qint64 msecs = -1;
+    qint64 secs = -1;
+    char text[Length];
+};
+
+void writeDigits(char* out, int value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+LogLineBuffer::LogLineBuffer(qsizetype reserve)
+{
+    m_data.reserve(static_cast<size_t>(reserve));
+}
+
+void LogLineBuffer::clear()
+{
+    m_data.clear();
+}
+
+void LogLineBuffer::append(const char *data, qsizetype size)
+{
+    m_data.insert(m_data.end(), data, data + size);
+}
+
+void LogLineBuffer::append(QByteArrayView bytes)
+{
+    append(bytes.data(), bytes.size());
+}
+
+void LogLineBuffer::append(char c)
+{
+    m_data.push_back(c);
+}
+
+void LogLineBuffer::appendNumber(qint64 value)
+{
+    char digits[24];
+    int pos = sizeof(digits);
+    const bool negative = value < 0;
+    quint64 magnitude = negative ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+    do
+    {
+        digits[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) digits[--pos] = '-';
+    append(digits + pos, static_cast<qsizetype>(sizeof(digits)) - pos);
+}
+
+void LogLineBuffer::appendUtf16(QStringView text)
+{
+    const char16_t* it = text.utf16();
+    const char16_t* end = it + text.size();
+    while (it < end)
+    {
+        char32_t codePoint = *it++;
+        if (codePoint < 0x80)
+        {
+            m_data.push_back(static_cast<char>(codePoint));
+            continue;
+        }
+
+        // Combine surrogate pairs, replace lone surrogates
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF && it < end && *it >= 0xDC00 && *it <= 0xDFFF)
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (*it++ - 0xDC00);
+        else if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            codePoint = 0xFFFD;
+
+        if (codePoint < 0x800)
+        {
+            m_data.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            m_data.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            m_data.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            m_data.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            m_data.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            m_data.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            m_data.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            m_data.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            m_data.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+}
+
+const char *LogLineBuffer::constData() const
+{
+    return m_data.data();
+}
+
+qsizetype LogLineBuffer::size() const
+{
+    return static_cast<qsizetype>(m_data.size());
+}
+
+QByteArrayView LogLineBuffer::view() const
+{
+    return QByteArrayView(m_data.data(), static_cast<qsizetype>(m_data.size()));
+}
+
+LogLineBuffer &LogFormatter::threadBuffer()
+{
+    static thread_local LogLineBuffer buffer;
+    return buffer;
+}
+
+void LogFormatter::format(LogLineBuffer &out, QtMsgType type, const QMessageLogContext &context,
+                          QStringView msg, bool fileAndLineEnabled, bool contentEnabled)
+{
+    formatText(out, LogRecord(type, context, msg), fileAndLineEnabled, contentEnabled);
+}
+
+void LogFormatter::formatText(LogLineBuffer &out, const LogRecord &record, bool fileAndLineEnabled, bool contentEnabled)
+{
+    out.clear();
+    appendTimestamp(out);
+    out.append(" [", 2);
+    out.append(levelName(record.type));
+    out.append(']');
+    // Name the category unless it is the one plain qDebug() & co. use
+    if (record.category && std::strcmp(record.category, "default") != 0)
+    {
+        out.append(" [", 2);
+        out.append(record.category, static_cast<qsizetype>(std::strlen(record.category)));
+        out.append(']');
+    }
+    if (fileAndLineEnabled)
+    {
+        out.append(" (", 2);
+        if (record.file)
+            out.append(record.file, static_cast<qsizetype>(std::strlen(record.file)));
+        out.append(':');
+        out.appendNumber(record.line);
+        out.append(')');
+    }
+    if (!contentEnabled)
+        return;
+
+    out.append(": ", 2);
+    if (!record.isStructured())
+    {
+        out.appendUtf16(record.message);
+        return;
+    }
+
+    // Structured record: event name followed by key=value pairs
+    out.append(record.event, static_cast<qsizetype>(std::strlen(record.event)));
+    for (int i = 0; i < record.fieldCount; ++i)
+    {
+        const LogField& field = record.fields[i];
+        out.append(' ');
+        out.append(field.key, static_cast<qsizetype>(std::strlen(field.key)));
+        out.append('=');
+        appendTextValue(out, field);
+    }
+}
+
+void LogFormatter::formatJson(LogLineBuffer &out, const LogRecord &record, bool fileAndLineEnabled)
+{
+    out.clear();
+    out.append(QByteArrayView("{\"ts\":\""));
+    appendTimestamp(out, 'T');
+    out.append(QByteArrayView("\",\"level\":\""));
+    out.append(levelName(record.type));
+    out.append('"');
+    if (record.category && std::strcmp(record.category, "default") != 0)
+    {
+        out.append(QByteArrayView(",\"category\":"));
+        appendJsonString(out, QByteArrayView(record.category, static_cast<qsizetype>(std::strlen(record.category))));
+    }
+    if (fileAndLineEnabled && record.file)
+    {
+        out.append(QByteArrayView(",\"file\":"));
+        appendJsonString(out, QByteArrayView(record.file, static_cast<qsizetype>(std::strlen(record.file))));
+        out.append(QByteArrayView(",\"line\":"));
+        out.appendNumber(record.line);
+    }
+
+    if (!record.isStructured())
+    {
+        out.append(QByteArrayView(",\"msg\":"));
+        appendJsonString(out, record.message);
+    }
+    else
+    {
+        out.append(QByteArrayView(",\"event\":"));
+        appendJsonString(out, QByteArrayView(record.event, static_cast<qsizetype>(std::strlen(record.event))));
+        for (int i = 0; i < record.fieldCount; ++i)
+        {
+            const LogField& field = record.fields[i];
+            out.append(',');
+            appendJsonString(out, QByteArrayView(field.key, static_cast<qsizetype>(std::strlen(field.key))));
+            out.append(':');
+            appendJsonValue(out, field);
+        }
+    }
+    out.append('}');
+}
+
+void LogFormatter::appendTimestamp(LogLineBuffer &out, char dateTimeSeparator)
+{
+    static thread_local TimestampCache cache;
+
+    const qint64 msecs = QDateTime::currentMSecsSinceEpoch();
+    if (msecs != cache.msecs)
+    {
+        const qint64 secs = msecs / 1000;
+        if (secs != cache.secs)
+        {
+            // A new second, so the date and time part has to be rebuilt
+            const std::time_t time = static_cast<std::time_t>(secs);
+            std::tm local{};
+#ifdef Q_OS_WIN
+            localtime_s(&local, &time);
+#else
+            localtime_r(&time, &local);
+#endif
+            writeDigits(cache.text, local.tm_year + 1900, 4);
+            cache.text[4] = '-';
+            writeDigits(cache.text + 5, local.tm_mon + 1, 2);
+            cache.text[7] = '-';
+            writeDigits(cache.text + 8, local.tm_mday, 2);
+            cache.text[10] = ' ';
+            writeDigits(cache.text + 11, local.tm_hour, 2);
+            cache.text[13] = ':';
+            writeDigits(cache.text + 14, local.tm_min, 2);
+            cache.text[16] = ':';
+            writeDigits(cache.text + 17, local.tm_sec, 2);
+            cache.text[19] = '.';
+            cache.secs = secs;
+        }
+        writeDigits(cache.text + 20, static_cast<int>(msecs % 1000), 3);
+        cache.msecs = msecs;
+    }
+    out.append(cache.text, 10);
+    out.append(dateTimeSeparator);
+    out.append(cache.text + 11, TimestampCache::Length - 11);
+}
+
+void LogFormatter::appendTextValue(LogLineBuffer &out, const LogField &field)
+{
+    switch (field.type)
+    {
+    case LogField::Type::Int: out.appendNumber(field.value.i); break;
+    case LogField::Type::UInt:
+        if (field.value.u > static_cast<quint64>(std::numeric_limits<qint64>::max()))
+            appendDouble(out, static_cast<double>(field.value.u));
+        else
+            out.appendNumber(static_cast<qint64>(field.value.u));
+        break;
+    case LogField::Type::Double: appendDouble(out, field.value.d); break;
+    case LogField::Type::Bool: out.append(field.value.b ? QByteArrayView("true") : QByteArrayView("false")); break;
+    // Strings are quoted, so values with spaces stay readable
+    case LogField::Type::Utf8: appendJsonString(out, field.utf8()); break;
+    case LogField::Type::Utf16: appendJsonString(out, field.utf16()); break;
+    }
+}
+
+void LogFormatter::appendJsonValue(LogLineBuffer &out, const LogField &field)
+{
+    if (field.type == LogField::Type::Double && !std::isfinite(field.value.d))
+    {
+        out.append(QByteArrayView("null")); // JSON has no NaN or infinity
+        return;
+    }
+    appendTextValue(out, field);
+}
+
+void LogFormatter::appendJsonString(LogLineBuffer &out, QByteArrayView utf8)
+{
+    out.append('"');
+    appendEscaped(out, utf8);
+    out.append('"');
+}
+
+void LogFormatter::appendEscaped(LogLineBuffer &out, QByteArrayView utf8)
+{
+    for (const char c : utf8)
+    {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            out.append('\\');
+            out.append(c);
+        }
+        else if (byte < 0x20)
+        {
+            static const char hex[] = "0123456789abcdef";
+            const char escaped[] = {'\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 0xF]};
+            out.append(escaped, sizeof(escaped));
+        }
+        else
+        {
+            out.append(c);
+        }
+    }
+}
+
+void LogFormatter::appendJsonString(LogLineBuffer &out, QStringView utf16)
+{
+    // Encode chunks between characters that need escaping in one go
+    out.append('"');
+    qsizetype chunkStart = 0;
+    for (qsizetype i = 0; i < utf16.size(); ++i)
+    {
+        const char16_t c = utf16[i].unicode();
+        if (c != u'"' && c != u'\\' && c >= 0x20)
+            continue;
+        out.appendUtf16(utf16.mid(chunkStart, i - chunkStart));
+        const char ascii = static_cast<char>(c);
+        appendEscaped(out, QByteArrayView(&ascii, 1));
+        chunkStart = i + 1;
+    }
+    out.appendUtf16(utf16.mid(chunkStart));
+    out.append('"');
+}
+
+void LogFormatter::appendDouble(LogLineBuffer &out, double value)
+{
+    // std::to_chars is locale independent and doesn't allocate
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<qsizetype>(result.ptr - digits));
+}
+
+QByteArrayView LogFormatter::levelName(QtMsgType type)
+{
+    switch(type)
+    {
+    case QtDebugMsg: return QByteArrayView("DEBUG");
+    case QtInfoMsg: return QByteArrayView("INFO");
+    case QtWarningMsg: return QByteArrayView("WARNING");
+    case QtCriticalMsg: return QByteArrayView("CRITICAL");
+    case QtFatalMsg: return QByteArrayView("FATAL");
+    default: return QByteArrayView("UNKNOWN");
+    }
+}
+
+qsizetype LogFormatter::textPrefixLength(QtMsgType type)
+{
+    return TimestampCache::Length + 2 + levelName(type).size() + 1;
+}
@@ -0,0 +1,71 @@
+#ifndef LOGFORMATTER_H
+#define LOGFORMATTER_H
+
+#include <QtGlobal>
+#include <QByteArrayView>
+#include <QStringView>
+#include <QMessageLogContext>
+#include "logrecord.h"
+#include <vector>
+
+/*
+ * Growable UTF-8 byte buffer which keeps its capacity when it is cleared.
+ * Once it has grown to the size of the longest line, appending doesn't allocate anymore.
+ */
+class LogLineBuffer
+{
+public:
+    explicit LogLineBuffer(qsizetype reserve = 512);
+
+    void clear(); // Keeps the capacity
+    void append(const char* data, qsizetype size);
+    void append(QByteArrayView bytes);
+    void append(char c);
+    void appendNumber(qint64 value);
+    void appendUtf16(QStringView text); // Encodes UTF-16 to UTF-8 without a temporary QByteArray
+
+    const char* constData() const;
+    qsizetype size() const;
+    QByteArrayView view() const;
+
+private:
+    std::vector<char> m_data;
+};
+
+/*
+ * Allocation-free formatting of log records. Text lines look like:
+ *   "yyyy-MM-dd hh:mm:ss.zzz [LEVEL] [category] (file:line): message"
+ *   "yyyy-MM-dd hh:mm:ss.zzz [LEVEL] (file:line): fetch.done latency_ms=120 city=\"Berlin\""
+ * The category is left out for the "default" category of qDebug() & co.
+ * JSON lines contain one object per record with the fields as members.
+ *
+ * Every thread formats into its own reusable buffer and keeps its own timestamp cache,
+ * so formatting needs neither a lock nor a temporary QString.
+ */
+class LogFormatter
+{
+public:
+    // The calling thread's reusable line buffer
+    static LogLineBuffer& threadBuffer();
+
+    static void format(LogLineBuffer& out, QtMsgType type, const QMessageLogContext& context,
+                       QStringView msg, bool fileAndLineEnabled, bool contentEnabled);
+    static void formatText(LogLineBuffer& out, const LogRecord& record, bool fileAndLineEnabled, bool contentEnabled);
+    static void formatJson(LogLineBuffer& out, const LogRecord& record, bool fileAndLineEnabled);
+    // Appends the local time, the text is cached per thread for the current millisecond
+    static void appendTimestamp(LogLineBuffer& out, char dateTimeSeparator = ' ');
+    // Static byte literals, e.g. "WARNING"
+    static QByteArrayView levelName(QtMsgType type);
+    // Length of the "yyyy-MM-dd hh:mm:ss.zzz [LEVEL]" prefix of a text line
+    static qsizetype textPrefixLength(QtMsgType type);
+
+private:
+    static void appendTextValue(LogLineBuffer& out, const LogField& field);
+    static void appendJsonValue(LogLineBuffer& out, const LogField& field);
+    static void appendJsonString(LogLineBuffer& out, QByteArrayView utf8);
+    static void appendJsonString(LogLineBuffer& out, QStringView utf16);
+    static void appendEscaped(LogLineBuffer& out, QByteArrayView utf8);
+    static void appendDouble(LogLineBuffer& out, double value);
+};
+
+#endif // LOGFORMATTER_H
@@ -1,27 +1,111 @@
 #include "logger.h"
+#include "logcategories.h"
+#include "configkey.h"
+#include <QCoreApplication>
+#include <QStringList>
+
+// The [Logging] keys, resolved whenever the config is (re)loaded
+struct Logger::ConfigKeys
+{
+    ConfigKey<bool> logToFile{"Logging/LogToFile", false};
+    ConfigKey<bool> logToConsole{"Logging/LogToConsole", false};
+    ConfigKey<bool> logFileAndLineEnabled{"Logging/LogFileAndLineEnabled", false};
+    ConfigKey<bool> logContentEnabled{"Logging/LogContentEnabled", false};
+    ConfigKey<QString> fileName{"Logging/FileName"};
+    ConfigKey<bool> logToJournal{"Logging/LogToJournal", false};
+    ConfigKey<QString> journalSocket{"Logging/JournalSocket", JournalLogSink::DefaultSocketPath};
+    ConfigKey<QString> journalIdentifier{"Logging/JournalIdentifier", "greenoasis"};
+    ConfigKey<bool> logToMemory{"Logging/LogToMemory", false};
+    ConfigKey<int> memoryCapacity{"Logging/MemoryCapacity", 1000};
+    // Shared by all sinks, see SinkKeys
+    ConfigKey<QString> format{"Logging/Format", "text"};
+    ConfigKey<QString> level{"Logging/Level", "debug"};
+    ConfigKey<bool> async{"Logging/Async", false};
+    ConfigKey<int> asyncQueueSize{"Logging/AsyncQueueSize", 4096};
+    ConfigKey<QString> asyncOverflowPolicy{"Logging/AsyncOverflowPolicy", "block"};
+    ConfigKey<qint64> rotateMaxBytes{"Logging/RotateMaxBytes", 4 * 1024 * 1024};
+    ConfigKey<qint64> rotateIntervalSecs{"Logging/RotateIntervalSecs", 0};
+    ConfigKey<int> rotateGenerations{"Logging/RotateGenerations", 5};
+    ConfigKey<int> compressionLevel{"Logging/CompressionLevel", 6};
+    ConfigKey<bool> flightRecorder{"Logging/FlightRecorder", false};
+    ConfigKey<QString> flightRecorderFile{"Logging/FlightRecorderFile", "greenoasis.flight"};
+    ConfigKey<qint64> flightRecorderSize{"Logging/FlightRecorderSize", 1024 * 1024};
+    ConfigKey<QString> flightRecorderLevel{"Logging/FlightRecorderLevel"}; // Falls back to Level
+    ConfigKey<qint64> duplicateWindowSecs{"Logging/DuplicateWindowSecs", 0};
+    ConfigKey<double> rateLimitPerSecond{"Logging/RateLimitPerSecond", 0};
+    ConfigKey<int> rateLimitBurst{"Logging/RateLimitBurst", 20};
+};
+
+// Sink specific keys, e.g. ConsoleLevel, which override the keys shared by all sinks
+struct Logger::SinkKeys
+{
+    explicit SinkKeys(const QString& name)
+        : format{"Logging/" + name + "Format"},
+          level{"Logging/" + name + "Level"},
+          async{"Logging/" + name + "Async"},
+          asyncQueueSize{"Logging/" + name + "AsyncQueueSize"},
+          asyncOverflowPolicy{"Logging/" + name + "AsyncOverflowPolicy"}
+    {
+    }
+
+    ConfigKey<QString> format;
+    ConfigKey<QString> level;
+    ConfigKey<bool> async;
+    ConfigKey<int> asyncQueueSize;
+    ConfigKey<QString> asyncOverflowPolicy;
+};
+
+namespace {
+
+template<typename T>
+T sinkValue(const ConfigKey<T>& sinkKey, const ConfigKey<T>& sharedKey)
+{
+    return sinkKey.isSet() ? sinkKey.value() : sharedKey.value();
+}
+
+} // namespace
 
 Logger::Logger()
+    : m_config{std::make_unique<ConfigKeys>()}
 {
     setObjectName("Logger");
+    m_clock.start();
     readConfiguration();
-    if (m_logToFileEnabled)
+    if (m_flightRecorderEnabled)
     {
-        if (!m_logFile.open(QIODevice::Append | QIODevice::Text))
+        if (!m_flightRecorder.isOpen())
         {
-            qWarning() << "Failed to open log file:" << m_logFile.errorString();
-            m_logToFileEnabled = false;
+            qCWarning(lcCore) << "Failed to open the flight recorder:" << m_flightRecorder.errorString();
+            m_flightRecorderEnabled = false;
         } else
         {
-            qInfo() << this << "Log file has been opened successfully";
-            qDebug() << "Log file: " << m_logFile.fileName();
+            qCInfo(lcCore) << this << "Flight recorder file:" << m_flightRecorder.fileName();
         }
     }
+
+    // Levels of the sinks and the flight recorder, and the minimum of them all
+    applyLevels();
+
+    // Thread-safe, so it runs right away on the thread that has reloaded the config
+    connect(&ConfigManager::instance(), &ConfigManager::valueChanged, this,
+            [this](const QString& key) { applyConfigChange(key); }, Qt::DirectConnection);
 }
 
 Logger::~Logger()
 {
-    if (m_logFile.isOpen())
-        m_logFile.close();
+    disconnect(&ConfigManager::instance(), nullptr, this, nullptr);
+
+    // Report what the throttle has dropped so far
+    LogThrottle::Summaries summaries;
+    m_throttle.takePending(summaries);
+    logSummaries(summaries);
+
+    // Stop the writers, they flush everything that is still queued
+    for (const auto& sink : m_sinks)
+        sink->stop();
+    m_memorySink = nullptr;
+    m_sinks.clear();
+    m_flightRecorder.close();
 }
 
 Logger &Logger::instance()
@@ -32,68 +116,262 @@ Logger &Logger::instance()
 
 void Logger::log(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    // Lock the mutex to ensure thread-safety
-    QMutexLocker locker(&m_mutex);
+    logRecord(LogRecord(type, context, msg));
+}
+
+bool Logger::isEnabled(QtMsgType type) const
+{
+    return LogSink::severity(type) >= m_minimumSeverity.load(std::memory_order_relaxed);
+}
+
+QList<LogSink::Statistics> Logger::sinkStatistics() const
+{
+    QList<LogSink::Statistics> statistics;
+    for (const auto& sink : m_sinks)
+        statistics.append(sink->statistics());
+    return statistics;
+}
+
+MemoryLogSink *Logger::memorySink() const
+{
+    return m_memorySink;
+}
 
-    // Create the time stamp and the log level as strings
-    QString timeStamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString logLevel = logLevelToString(type);
+void Logger::logRecord(const LogRecord &record)
+{
+    if (!isEnabled(record.type))
+        return; // Nothing would be written, so don't render anything
 
-    // Create a formatted message that is configurable
-    QString formattedMessage = QString("%1 [%2]").arg(timeStamp, logLevel);
-    if (m_logFileAndLineEnabled)
+    if (m_throttle.isEnabled())
     {
-        formattedMessage += QString(" (%1:%2)").arg(QString::fromUtf8(context.file),
-                                                    QString::number(context.line));
+        LogThrottle::Summaries summaries;
+        const bool admitted = m_throttle.admit(record, m_clock.elapsed(), summaries);
+        logSummaries(summaries);
+        if (!admitted)
+            return;
     }
-    if (m_logContentEnabled)
+    dispatch(record);
+}
+
+void Logger::dispatch(const LogRecord &record)
+{
+    const QtMsgType type = record.type;
+
+    // Render each format at most once, into the calling thread's own buffers.
+    // This needs neither a lock nor an allocation.
+    LogLineBuffer& textLine = LogFormatter::threadBuffer();
+    static thread_local LogLineBuffer jsonLine;
+    bool textRendered = false;
+    bool jsonRendered = false;
+    for (const auto& sink : m_sinks)
     {
-        formattedMessage += QString(": %1").arg(msg);
+        if (!sink->accepts(type))
+            continue;
+        if (sink->format() == LogSink::Format::Json)
+        {
+            if (!jsonRendered)
+            {
+                LogFormatter::formatJson(jsonLine, record, m_logFileAndLineEnabled);
+                jsonRendered = true;
+            }
+            sink->submit(type, jsonLine.view());
+        }
+        else
+        {
+            if (!textRendered)
+            {
+                LogFormatter::formatText(textLine, record, m_logFileAndLineEnabled, m_logContentEnabled);
+                textRendered = true;
+            }
+            sink->submit(type, textLine.view());
+        }
     }
 
-    // Log to the file if enabled
-    if (m_logToFileEnabled && m_logFile.isOpen())
+    // The flight recorder is written right away on the calling thread, it's only a memory copy
+    if (m_flightRecorderEnabled && LogSink::severity(type) >= m_flightRecorderSeverity.load(std::memory_order_relaxed))
     {
-        QTextStream out(&m_logFile);
-        out << formattedMessage << "\n";
-        out.flush();
+        if (!textRendered)
+            LogFormatter::formatText(textLine, record, m_logFileAndLineEnabled, m_logContentEnabled);
+        recordFlight(record, textLine);
     }
+}
 
-    // Log to the console if enabled
-    if (m_logToConsoleEnabled)
+void Logger::logSummaries(const LogThrottle::Summaries &summaries)
+{
+    for (const LogThrottle::Summary& summary : summaries)
     {
-        fprintf(stderr, "%s\n", formattedMessage.toLocal8Bit().constData());
+        LogRecord notice = LogRecord::create(summary.type, summary.file.isEmpty() ? nullptr : summary.file.constData(),
+                                             summary.line, nullptr, summary.event,
+                                             "count", summary.count, "message", summary.text);
+        notice.category = summary.category.isEmpty() ? nullptr : summary.category.constData();
+        if (isEnabled(notice.type))
+            dispatch(notice);
     }
 }
 
+void Logger::recordFlight(const LogRecord &record, const LogLineBuffer &textLine)
+{
+    // Timestamp and level are part of the binary record, so only the rest of the line is stored
+    m_flightRecorder.append(record.type, textLine.view().sliced(LogFormatter::textPrefixLength(record.type)));
+}
+
 void Logger::readConfiguration()
 {
     // Get config flags from the config.ini file
-    m_logToFileEnabled = ConfigManager::instance().getValue("Logging/LogToFile").toBool();
-    m_logToConsoleEnabled = ConfigManager::instance().getValue("Logging/LogToConsole").toBool();
-    m_logFileAndLineEnabled = ConfigManager::instance().getValue("Logging/LogFileAndLineEnabled").toBool();
-    m_logContentEnabled = ConfigManager::instance().getValue("Logging/LogContentEnabled").toBool();
+    m_logFileAndLineEnabled = m_config->logFileAndLineEnabled.value();
+    m_logContentEnabled = m_config->logContentEnabled.value();
 
     // Use the temp directory for the log file
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QString logFileName = ConfigManager::instance().getValue("Logging/FileName").toString();
-    QString logFilePath = QDir(appDataPath).filePath(logFileName);
 
-    if (m_logToFileEnabled) {
-        m_logFile.setFileName(logFilePath);
-        // qDebug() << "Log file path" << logFilePath;
+    if (m_config->logToFile.value())
+    {
+        // Log rotation settings (optional)
+        LogRotator::Settings rotation;
+        rotation.maxBytes = qMax(m_config->rotateMaxBytes.value(), qint64(0));
+        rotation.intervalSecs = qMax(m_config->rotateIntervalSecs.value(), qint64(0));
+        rotation.generations = qMax(m_config->rotateGenerations.value(), 1);
+        rotation.compressionLevel = qBound(0, m_config->compressionLevel.value(), 9);
+
+        QString logFileName = m_config->fileName.value();
+        QString logFilePath = QDir(appDataPath).filePath(logFileName);
+        auto fileSink = std::make_unique<FileLogSink>();
+        if (!fileSink->open(logFilePath, rotation))
+        {
+            qCWarning(lcCore) << "Failed to open log file:" << fileSink->errorString();
+        } else
+        {
+            qCInfo(lcCore) << this << "Log file has been opened successfully";
+            qCDebug(lcCore) << "Log file: " << fileSink->fileName();
+            addSink(std::move(fileSink), "File");
+        }
+    }
+
+    if (m_config->logToConsole.value())
+    {
+        addSink(std::make_unique<ConsoleLogSink>(), "Console", true);
+    }
+
+    // Journal and in-memory sinks (optional)
+    if (m_config->logToJournal.value())
+    {
+        const QString socketPath = m_config->journalSocket.value();
+        const QString identifier = m_config->journalIdentifier.value();
+        auto journalSink = std::make_unique<JournalLogSink>();
+        if (!journalSink->open(socketPath, identifier))
+            qCWarning(lcCore) << "Failed to connect to the journal socket" << socketPath << ":" << journalSink->errorString();
+        else
+            addSink(std::move(journalSink), "Journal", true);
+    }
+
+    if (m_config->logToMemory.value())
+    {
+        auto memorySink = std::make_unique<MemoryLogSink>(m_config->memoryCapacity.value());
+        m_memorySink = memorySink.get();
+        addSink(std::move(memorySink), "Memory");
+    }
+
+    // Duplicate suppression and rate limit (optional)
+    applyThrottleSettings();
+
+    // Flight recorder settings (optional)
+    m_flightRecorderEnabled = m_config->flightRecorder.value();
+    if (m_flightRecorderEnabled)
+    {
+        const QString flightRecorderFileName = m_config->flightRecorderFile.value();
+        const qint64 flightRecorderSize = m_config->flightRecorderSize.value();
+        m_flightRecorder.open(QDir(appDataPath).filePath(flightRecorderFileName), flightRecorderSize);
+    }
+}
+
+void Logger::addSink(std::unique_ptr<LogSink> sink, const QString &name, bool asyncByDefault)
+{
+    // The level is set by applyLevels(), it can change while the sink is running
+    auto keys = std::make_unique<SinkKeys>(name);
+    sink->setFormat(LogSink::formatFromString(sinkValue(keys->format, m_config->format)));
+    const bool async = keys->async.isSet() || m_config->async.isSet() ? sinkValue(keys->async, m_config->async)
+                                                                      : asyncByDefault;
+    if (async)
+    {
+        const int queueSize = qMax(sinkValue(keys->asyncQueueSize, m_config->asyncQueueSize), 2);
+        sink->startAsync(queueSize, LogWriterThread::overflowPolicyFromString(sinkValue(keys->asyncOverflowPolicy, m_config->asyncOverflowPolicy)));
+        qCInfo(lcCore) << this << "Async logging to" << sink->name() << "enabled with a queue size of" << queueSize;
     }
+    m_sinks.push_back(std::move(sink));
+    m_sinkKeys.push_back(std::move(keys));
 }
 
-QString Logger::logLevelToString(QtMsgType type)
+void Logger::applyConfigChange(const QString &key)
 {
-    switch(type)
+    // Runs on the thread which has reloaded the config
+    if (!key.startsWith("Logging/"))
+        return;
+    const QString name = key.section('/', 1);
+
+    if (name == "LogFileAndLineEnabled")
+        m_logFileAndLineEnabled = m_config->logFileAndLineEnabled.value();
+    else if (name == "LogContentEnabled")
+        m_logContentEnabled = m_config->logContentEnabled.value();
+    else if (name.endsWith("Level"))
+        applyLevels();
+    else if (name == "DuplicateWindowSecs" || name.startsWith("RateLimit"))
+        applyThrottleSettings();
+    else
     {
-    case QtDebugMsg: return "DEBUG";
-    case QtInfoMsg: return "INFO";
-    case QtWarningMsg: return "WARNING";
-    case QtCriticalMsg: return "CRITICAL";
-    case QtFatalMsg: return "FATAL";
-    default: return "UNKNOWN";
+        qCInfo(lcCore) << this << key << "has changed, it takes effect after a restart";
+        return;
     }
+    qCInfo(lcCore) << this << "Applied" << key << "=" << ConfigManager::instance().getValue(key, QVariant()).toString();
+}
+
+void Logger::applyLevels()
+{
+    for (size_t i = 0; i < m_sinks.size(); ++i)
+        m_sinks[i]->setMinimumLevel(LogSink::levelFromString(sinkValue(m_sinkKeys[i]->level, m_config->level)));
+    m_flightRecorderSeverity = LogSink::severity(LogSink::levelFromString(sinkValue(m_config->flightRecorderLevel, m_config->level)));
+    updateMinimumSeverity();
+}
+
+void Logger::applyThrottleSettings()
+{
+    LogThrottle::Settings throttle;
+    throttle.duplicateWindowMsecs = qMax(m_config->duplicateWindowSecs.value(), qint64(0)) * 1000;
+    throttle.ratePerSecond = qMax(m_config->rateLimitPerSecond.value(), 0.0);
+    throttle.burst = qMax(m_config->rateLimitBurst.value(), 1);
+    m_throttle.setSettings(throttle);
+
+    // Summaries are due even if the call site doesn't log again, so don't wait for its next record
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app)
+        return; // Reported at shutdown, see takePending()
+    const bool enabled = m_throttle.isEnabled();
+    QMetaObject::invokeMethod(app, [this, enabled]() {
+        if (!m_sweepTimer)
+        {
+            // A child of the application, so that it is gone before the Logger is destroyed
+            m_sweepTimer = new QTimer(QCoreApplication::instance());
+            m_sweepTimer->setInterval(LogThrottle::SweepIntervalMsecs);
+            connect(m_sweepTimer, &QTimer::timeout, m_sweepTimer, [this]() { sweepThrottle(); });
+        }
+        if (!enabled)
+            m_sweepTimer->stop();
+        else if (!m_sweepTimer->isActive())
+            m_sweepTimer->start();
+    });
+}
+
+void Logger::sweepThrottle()
+{
+    LogThrottle::Summaries summaries;
+    m_throttle.takeDue(m_clock.elapsed(), summaries);
+    logSummaries(summaries);
+}
+
+void Logger::updateMinimumSeverity()
+{
+    // Records below every threshold are dropped before they are rendered
+    int minimumSeverity = m_flightRecorderEnabled ? m_flightRecorderSeverity.load() : LogSink::severity(QtFatalMsg) + 1;
+    for (const auto& sink : m_sinks)
+        minimumSeverity = qMin(minimumSeverity, sink->minimumSeverity());
+    m_minimumSeverity = minimumSeverity;
 }
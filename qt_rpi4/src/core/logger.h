@@ -9,28 +9,107 @@
 #include <QDebug>
 #include <QSettings>
 #include <QStandardPaths>
+#include <memory>
+#include <vector>
 #include <configmanager.h>
+#include <logformatter.h>
+#include <logrecord.h>
+#include <logrotator.h>
+#include <logsink.h>
+#include <logsinks.h>
+#include <flightrecorder.h>
+#include <logthrottle.h>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
 
+/*
+ * Logger configuration ([Logging] section of the config file):
+ *   LogToFile, LogToConsole, LogFileAndLineEnabled, LogContentEnabled, FileName
+ *   LogToJournal          - true: send records to the local journal socket (default false)
+ *   JournalSocket         - datagram socket of the journal (default /run/systemd/journal/socket)
+ *   JournalIdentifier     - SYSLOG_IDENTIFIER of the records (default greenoasis)
+ *   LogToMemory           - true: keep the latest records in memory (default false)
+ *   MemoryCapacity        - number of records kept in memory (default 1000)
+ *   Format                - text | json (default text)
+ *   Level                 - minimum level: debug | info | warning | critical (default debug)
+ *   Async                 - true: records are queued and written by a background thread (default false
+ *                           for File and Memory, true for Console and Journal: a full pipe or socket
+ *                           would block the logging thread, e.g. the UI, while it is drained)
+ *   AsyncQueueSize        - capacity of the async queue in records (default 4096)
+ *   AsyncOverflowPolicy   - block | drop-oldest | drop-newest (default block)
+ *   RotateMaxBytes        - rotate the log file when it reaches this size (default 4 MiB, 0 = off)
+ *   RotateIntervalSecs    - rotate the log file at multiples of this interval (default 0 = off)
+ *   RotateGenerations     - number of rotated files to keep (default 5)
+ *   CompressionLevel      - gzip level 1..9 for rotated files, 0 = don't compress (default 6)
+ *   FlightRecorder        - true: additionally keep the latest records in a crash-safe binary file (default false)
+ *   FlightRecorderFile    - file name in the temp directory (default greenoasis.flight), decode it with rpi4_logdump
+ *   FlightRecorderSize    - size of the circular file in bytes (default 1 MiB)
+ *   FlightRecorderLevel   - minimum level of the flight recorder (default: Level)
+ *   DuplicateWindowSecs   - drop records repeating the previous one of their call site within this window
+ *                           and log how often they were repeated instead (default 0 = off)
+ *   RateLimitPerSecond    - records per second and call site, the rest is dropped and counted (default 0 = off)
+ *   RateLimitBurst        - records a call site may log at once before the rate limit applies (default 20)
+ *
+ * Every sink (File, Console, Journal, Memory) has its own queue, so Format, Level, Async,
+ * AsyncQueueSize and AsyncOverflowPolicy can be overridden per sink by prefixing the key
+ * with the sink's name, e.g. ConsoleLevel=warning, FileAsync=true, JournalFormat=json.
+ *
+ * The levels, LogFileAndLineEnabled, LogContentEnabled and the throttle settings are applied
+ * as soon as the config file has been reloaded; all other keys take effect after a restart.
+ */
 class Logger : public QObject
 {
     Q_OBJECT
 public:
     // The logger uses the singleton pattern, so the constructor has to be private
     static Logger& instance();
+    // Compatibility route for qDebug() & co., called by the custom message handler
     void log(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+    // Structured route, use the LOG_* macros of logrecord.h instead of calling this directly
+    void logRecord(const LogRecord &record);
+    // False if a record of this type would be dropped anyway, checked before fields are captured
+    bool isEnabled(QtMsgType type) const;
+
+    // Written, dropped and latency counters of every sink
+    QList<LogSink::Statistics> sinkStatistics() const;
+    // The in-memory sink, nullptr unless LogToMemory is enabled
+    MemoryLogSink* memorySink() const;
 
 private:
+    struct ConfigKeys;
+    struct SinkKeys;
+
     Logger();
     ~Logger();
     void readConfiguration();
-    static QString logLevelToString(QtMsgType type);
+    // asyncByDefault applies unless Async or <name>Async is set
+    void addSink(std::unique_ptr<LogSink> sink, const QString& name, bool asyncByDefault = false);
+    void applyConfigChange(const QString& key);
+    void applyLevels();
+    void applyThrottleSettings();
+    // Logs the summaries of the throttle which are due, called by m_sweepTimer
+    void sweepThrottle();
+    void updateMinimumSeverity();
+    void dispatch(const LogRecord &record);
+    void logSummaries(const LogThrottle::Summaries &summaries);
+    void recordFlight(const LogRecord &record, const LogLineBuffer &textLine);
 
-    QFile m_logFile;
-    bool m_logToFileEnabled;
-    bool m_logToConsoleEnabled;
-    bool m_logFileAndLineEnabled;
-    bool m_logContentEnabled;
-    QMutex m_mutex;
+    // Atomic where a config reload may change them while other threads are logging
+    std::atomic<bool> m_logFileAndLineEnabled{false};
+    std::atomic<bool> m_logContentEnabled{false};
+    std::atomic<int> m_minimumSeverity{0}; // Lowest threshold of all sinks
+    bool m_flightRecorderEnabled;
+    std::atomic<int> m_flightRecorderSeverity{0};
+    FlightRecorder m_flightRecorder;
+    LogThrottle m_throttle;
+    QElapsedTimer m_clock; // Monotonic time for the throttle, the wall clock may jump on the Pi
+    QPointer<QTimer> m_sweepTimer; // Lives in the application's thread
+    MemoryLogSink* m_memorySink = nullptr;
+    std::vector<std::unique_ptr<LogSink>> m_sinks;
+    std::unique_ptr<ConfigKeys> m_config;
+    std::vector<std::unique_ptr<SinkKeys>> m_sinkKeys; // One per sink
 };
 
 #endif // LOGGER_H
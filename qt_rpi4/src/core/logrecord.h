@@ -0,0 +1,152 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <QMessageLogContext>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * A typed key/value pair of a structured log record.
+ *
+ * Fields don't own their data: strings are referenced, not copied. This is safe because
+ * a record is rendered before the LOG_* statement that created it has finished.
+ * Keys have to be string literals.
+ */
+struct LogField
+{
+    enum class Type : quint8 { Int, UInt, Double, Bool, Utf8, Utf16 };
+
+    LogField() = default;
+    LogField(const char* fieldKey, bool fieldValue) : key{fieldKey}, type{Type::Bool} { value.b = fieldValue; }
+    LogField(const char* fieldKey, double fieldValue) : key{fieldKey}, type{Type::Double} { value.d = fieldValue; }
+    LogField(const char* fieldKey, float fieldValue) : LogField(fieldKey, static_cast<double>(fieldValue)) {}
+    LogField(const char* fieldKey, const char* fieldValue)
+        : LogField(fieldKey, QByteArrayView(fieldValue, fieldValue ? static_cast<qsizetype>(std::strlen(fieldValue)) : 0)) {}
+    LogField(const char* fieldKey, QByteArrayView fieldValue) : key{fieldKey}, type{Type::Utf8}
+    {
+        value.text.data = fieldValue.data();
+        value.text.size = fieldValue.size();
+    }
+    LogField(const char* fieldKey, const QByteArray& fieldValue) : LogField(fieldKey, QByteArrayView(fieldValue)) {}
+    LogField(const char* fieldKey, QStringView fieldValue) : key{fieldKey}, type{Type::Utf16}
+    {
+        value.text.data = fieldValue.utf16();
+        value.text.size = fieldValue.size();
+    }
+    LogField(const char* fieldKey, const QString& fieldValue) : LogField(fieldKey, QStringView(fieldValue)) {}
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    LogField(const char* fieldKey, T fieldValue) : key{fieldKey}
+    {
+        if constexpr (std::is_signed_v<T>)
+        {
+            type = Type::Int;
+            value.i = static_cast<qint64>(fieldValue);
+        }
+        else
+        {
+            type = Type::UInt;
+            value.u = static_cast<quint64>(fieldValue);
+        }
+    }
+
+    QByteArrayView utf8() const { return QByteArrayView(static_cast<const char*>(value.text.data), value.text.size); }
+    QStringView utf16() const { return QStringView(static_cast<const char16_t*>(value.text.data), value.text.size); }
+
+    const char* key = nullptr;
+    Type type = Type::Int;
+    union
+    {
+        qint64 i;
+        quint64 u;
+        double d;
+        bool b;
+        struct
+        {
+            const void* data;
+            qsizetype size;
+        } text;
+    } value{};
+};
+
+/*
+ * A log record as it is handed to the logger. Either a structured event with typed
+ * fields (LOG_* macros) or a plain message from the qDebug() & co. compatibility route.
+ */
+struct LogRecord
+{
+    static constexpr int MaxFields = 12;
+
+    LogRecord() = default;
+    // Plain message, as received by the Qt message handler
+    LogRecord(QtMsgType messageType, const QMessageLogContext& context, QStringView msg)
+        : type{messageType}, message{msg}, file{context.file}, line{context.line},
+          function{context.function}, category{context.category} {}
+
+    template <typename... Args>
+    static LogRecord create(QtMsgType type, const char* file, int line, const char* function,
+                            const char* event, const Args&... keysAndValues)
+    {
+        static_assert(sizeof...(Args) % 2 == 0, "LOG_* expects key/value pairs after the event name");
+        static_assert(sizeof...(Args) / 2 <= MaxFields, "Too many fields for one log record");
+        LogRecord record;
+        record.type = type;
+        record.event = event;
+        record.file = file;
+        record.line = line;
+        record.function = function;
+        record.addFields(keysAndValues...);
+        return record;
+    }
+
+    bool isStructured() const { return event != nullptr; }
+
+    QtMsgType type = QtDebugMsg;
+    const char* event = nullptr; // Event name of structured records, e.g. "fetch.done"
+    QStringView message;         // Text of plain messages
+    const char* file = nullptr;
+    int line = 0;
+    const char* function = nullptr;
+    const char* category = nullptr;
+    int fieldCount = 0;
+    LogField fields[MaxFields];
+
+private:
+    void addFields() {}
+    template <typename Value, typename... Rest>
+    void addFields(const char* key, const Value& value, const Rest&... rest)
+    {
+        fields[fieldCount++] = LogField(key, value);
+        addFields(rest...);
+    }
+};
+
+/*
+ * Structured logging, e.g.
+ *   LOG_INFO("fetch.done", "latency_ms", ms, "bytes", n);
+ * The fields are only captured if the logger would write the record at all, and they
+ * are only rendered (as text or JSON) for enabled outputs. LOG_DEBUG compiles to nothing
+ * with GREENOASIS_STRIP_DEBUG_LOGS.
+ */
+#define GREENOASIS_LOG(type, ...) \
+    do { \
+        if (Logger::instance().isEnabled(type)) \
+            Logger::instance().logRecord(LogRecord::create(type, QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, \
+                                                           QT_MESSAGELOG_FUNC, __VA_ARGS__)); \
+    } while (false)
+
+#ifdef QT_NO_DEBUG_OUTPUT
+#define LOG_DEBUG(...) do {} while (false)
+#else
+#define LOG_DEBUG(...) GREENOASIS_LOG(QtDebugMsg, __VA_ARGS__)
+#endif
+#define LOG_INFO(...) GREENOASIS_LOG(QtInfoMsg, __VA_ARGS__)
+#define LOG_WARNING(...) GREENOASIS_LOG(QtWarningMsg, __VA_ARGS__)
+#define LOG_CRITICAL(...) GREENOASIS_LOG(QtCriticalMsg, __VA_ARGS__)
+
+#endif // LOGRECORD_H
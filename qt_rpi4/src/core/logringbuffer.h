@@ -0,0 +1,153 @@
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+ * Bounded lock-free ring buffer based on Dmitry Vyukov's MPMC queue.
+ *
+ * Every thread that logs is a producer, the background writer is the consumer.
+ * The algorithm itself allows several consumers, which the logger makes use of:
+ * a producer can drop the oldest entry on overflow and the fatal path can drain
+ * the queue on the calling thread, both without taking a lock.
+ *
+ * T has to be default constructible and move assignable.
+ */
+template <typename T>
+class LogRingBuffer
+{
+public:
+    explicit LogRingBuffer(int capacity);
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    // Moves the item into the buffer. Returns false (and leaves the item untouched) if the buffer is full
+    bool tryPush(T&& item);
+    // Moves the oldest item out of the buffer. Returns false if the buffer is empty
+    bool tryPop(T& item);
+
+    int capacity() const;
+    bool isEmpty() const;
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value);
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    // Keep the producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+template <typename T>
+LogRingBuffer<T>::LogRingBuffer(int capacity)
+    : m_capacity{roundUpToPowerOfTwo(static_cast<size_t>(qMax(capacity, 2)))},
+      m_mask{m_capacity - 1},
+      m_cells{new Cell[m_capacity]},
+      m_enqueuePos{0},
+      m_dequeuePos{0}
+{
+    for (size_t i = 0; i < m_capacity; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool LogRingBuffer<T>::tryPush(T &&item)
+{
+    Cell* cell = nullptr;
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0)
+        {
+            // The cell is free, try to claim it
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // Buffer is full
+        }
+        else
+        {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->data = std::move(item);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool LogRingBuffer<T>::tryPop(T &item)
+{
+    Cell* cell = nullptr;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0)
+        {
+            // The cell holds a published item, try to claim it
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // Buffer is empty
+        }
+        else
+        {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    item = std::move(cell->data);
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+int LogRingBuffer<T>::capacity() const
+{
+    return static_cast<int>(m_capacity);
+}
+
+template <typename T>
+bool LogRingBuffer<T>::isEmpty() const
+{
+    // Sequentially consistent loads on purpose, the writer thread relies on them
+    // to decide whether it may go to sleep (see LogWriterThread::waitForWork())
+    return m_dequeuePos.load() >= m_enqueuePos.load();
+}
+
+template <typename T>
+size_t LogRingBuffer<T>::roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+#endif // LOGRINGBUFFER_H
@@ -0,0 +1,302 @@
+#include "logrotator.h"
+#include <QDateTime>
+#include <array>
+#include <cstdio>
+
+namespace {
+
+quint32 crc32(const QByteArray& data)
+{
+    // Table driven CRC-32 (polynomial 0xEDB88320) as required by the gzip trailer
+    static const auto table = [] {
+        std::array<quint32, 256> values{};
+        for (quint32 i = 0; i < 256; ++i)
+        {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            values[i] = crc;
+        }
+        return values;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (const char byte : data)
+        crc = table[(crc ^ static_cast<quint8>(byte)) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendLittleEndian(QByteArray& out, quint32 value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+QString generationPath(const QString& logFilePath, int generation, bool compressed)
+{
+    return logFilePath + '.' + QString::number(generation) + (compressed ? ".gz" : "");
+}
+
+} // namespace
+
+LogArchiver::LogArchiver(QObject *parent)
+    : QThread{parent}
+{
+    setObjectName("LogArchiver");
+}
+
+LogArchiver::~LogArchiver()
+{
+    stop();
+}
+
+void LogArchiver::setGenerations(int generations)
+{
+    QMutexLocker locker(&m_mutex);
+    m_generations = qMax(generations, 1);
+}
+
+void LogArchiver::setCompressionLevel(int level)
+{
+    QMutexLocker locker(&m_mutex);
+    m_compressionLevel = qBound(-1, level, 9);
+}
+
+void LogArchiver::archive(const QString &rotatedFilePath, const QString &logFilePath)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.enqueue(Job{rotatedFilePath, logFilePath});
+        m_jobAvailable.wakeOne();
+    }
+    if (!isRunning())
+        start(QThread::IdlePriority);
+}
+
+void LogArchiver::waitForIdle()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_jobs.isEmpty())
+    {
+        if (!isRunning()) return;
+        m_idle.wait(&m_mutex);
+    }
+}
+
+void LogArchiver::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopRequested = true;
+        m_jobAvailable.wakeAll();
+    }
+    wait();
+}
+
+QByteArray LogArchiver::gzipCompress(const QByteArray &data, int level)
+{
+    // qCompress() produces: 4 byte length (big endian) + zlib stream (2 byte header,
+    // raw deflate data, 4 byte adler32). gzip wants the raw deflate data with its own
+    // header and a CRC-32/size trailer instead.
+    const QByteArray zlibData = qCompress(data, level);
+    const qsizetype headerSize = 4 + 2;
+    const qsizetype trailerSize = 4;
+    if (zlibData.size() < headerSize + trailerSize)
+        return QByteArray();
+
+    QByteArray gzip;
+    gzip.reserve(10 + zlibData.size() - headerSize - trailerSize + 8);
+    // Magic, deflate, no flags, no mtime, no extra flags, OS = Unix
+    gzip.append("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10);
+    gzip.append(zlibData.constData() + headerSize, zlibData.size() - headerSize - trailerSize);
+    appendLittleEndian(gzip, crc32(data));
+    appendLittleEndian(gzip, static_cast<quint32>(data.size()));
+    return gzip;
+}
+
+void LogArchiver::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;)
+    {
+        while (m_jobs.isEmpty() && !m_stopRequested)
+            m_jobAvailable.wait(&m_mutex);
+        if (m_jobs.isEmpty())
+            break; // Stop requested and nothing left to do
+
+        const Job job = m_jobs.dequeue();
+        const int generations = m_generations;
+        const int compressionLevel = m_compressionLevel;
+        m_busy = true;
+
+        locker.unlock();
+        archiveFile(job, generations, compressionLevel);
+        locker.relock();
+
+        m_busy = false;
+        m_idle.wakeAll();
+    }
+    m_idle.wakeAll();
+}
+
+void LogArchiver::archiveFile(const Job &job, int generations, int compressionLevel)
+{
+    // Note: this runs while the logger may be writing, so problems are reported with
+    // fprintf instead of qWarning() which would end up in the log again.
+
+    // Drop the oldest generation and shift the others by one
+    for (const bool compressed : {true, false})
+        QFile::remove(generationPath(job.logFilePath, generations, compressed));
+    for (int generation = generations - 1; generation >= 1; --generation)
+    {
+        for (const bool compressed : {true, false})
+        {
+            const QString from = generationPath(job.logFilePath, generation, compressed);
+            if (QFile::exists(from))
+                QFile::rename(from, generationPath(job.logFilePath, generation + 1, compressed));
+        }
+    }
+
+    if (compressionLevel == 0)
+    {
+        QFile::rename(job.rotatedFilePath, generationPath(job.logFilePath, 1, false));
+        return;
+    }
+
+    // Whatever goes wrong, the rotated file becomes the uncompressed generation 1 instead of
+    // being left behind as "<log>.rotating-*"
+    const auto keepUncompressed = [&job]() {
+        QFile::rename(job.rotatedFilePath, generationPath(job.logFilePath, 1, false));
+    };
+
+    QFile rotatedFile(job.rotatedFilePath);
+    if (!rotatedFile.open(QIODevice::ReadOnly))
+    {
+        fprintf(stderr, "LogArchiver: couldn't open %s: %s\n",
+                qPrintable(job.rotatedFilePath), qPrintable(rotatedFile.errorString()));
+        keepUncompressed();
+        return;
+    }
+    const QByteArray content = rotatedFile.readAll();
+    rotatedFile.close();
+
+    // Write to a temporary file first, so a crash never leaves a truncated archive behind
+    const QString archivePath = generationPath(job.logFilePath, 1, true);
+    const QString tempPath = archivePath + ".tmp";
+    QFile archiveFile(tempPath);
+    const QByteArray compressed = gzipCompress(content, compressionLevel);
+    if (!content.isEmpty() && compressed.isEmpty())
+    {
+        fprintf(stderr, "LogArchiver: couldn't compress %s\n", qPrintable(job.rotatedFilePath));
+        keepUncompressed();
+        return;
+    }
+    if (!archiveFile.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || archiveFile.write(compressed) != compressed.size()
+        || !archiveFile.flush())
+    {
+        fprintf(stderr, "LogArchiver: couldn't write %s: %s\n",
+                qPrintable(tempPath), qPrintable(archiveFile.errorString()));
+        if (archiveFile.isOpen())
+            archiveFile.remove();
+        keepUncompressed();
+        return;
+    }
+    archiveFile.close();
+    if (!QFile::rename(tempPath, archivePath))
+    {
+        fprintf(stderr, "LogArchiver: couldn't rename %s to %s\n", qPrintable(tempPath), qPrintable(archivePath));
+        QFile::remove(tempPath);
+        keepUncompressed();
+        return;
+    }
+    QFile::remove(job.rotatedFilePath);
+}
+
+LogRotator::LogRotator()
+{
+}
+
+LogRotator::~LogRotator()
+{
+    // Finish archiving rotated files before the process ends
+    m_archiver.stop();
+}
+
+void LogRotator::setSettings(const Settings &settings)
+{
+    m_settings = settings;
+    m_archiver.setGenerations(settings.generations);
+    m_archiver.setCompressionLevel(settings.compressionLevel);
+}
+
+LogRotator::Settings LogRotator::settings() const
+{
+    return m_settings;
+}
+
+bool LogRotator::isEnabled() const
+{
+    return m_settings.maxBytes > 0 || m_settings.intervalSecs > 0;
+}
+
+void LogRotator::start(const QFile &logFile)
+{
+    m_currentSize = logFile.size();
+    m_nextRotationSecs = nextRotationTime(QDateTime::currentSecsSinceEpoch());
+}
+
+void LogRotator::recordWrite(qint64 bytes)
+{
+    m_currentSize += bytes;
+}
+
+bool LogRotator::rotationDue() const
+{
+    if (m_settings.maxBytes > 0 && m_currentSize >= m_settings.maxBytes)
+        return true;
+    if (m_settings.intervalSecs > 0 && QDateTime::currentSecsSinceEpoch() >= m_nextRotationSecs)
+        return true;
+    return false;
+}
+
+bool LogRotator::rotate(QFile &logFile)
+{
+    const QString logFilePath = logFile.fileName();
+    const QIODevice::OpenMode openMode = logFile.openMode();
+    // Unique name, several rotations may be waiting for the archiver
+    const QString rotatedFilePath = QString("%1.rotating-%2-%3").arg(logFilePath)
+                                        .arg(QDateTime::currentMSecsSinceEpoch()).arg(++m_rotationCount);
+
+    logFile.close();
+    const bool renamed = QFile::rename(logFilePath, rotatedFilePath);
+    if (!logFile.open(openMode))
+    {
+        fprintf(stderr, "LogRotator: couldn't reopen %s: %s\n",
+                qPrintable(logFilePath), qPrintable(logFile.errorString()));
+    }
+
+    // Start over even if renaming failed, otherwise every write would retry it
+    start(logFile);
+    if (!renamed)
+    {
+        fprintf(stderr, "LogRotator: couldn't rename %s\n", qPrintable(logFilePath));
+        return false;
+    }
+
+    m_archiver.archive(rotatedFilePath, logFilePath);
+    return true;
+}
+
+LogArchiver &LogRotator::archiver()
+{
+    return m_archiver;
+}
+
+qint64 LogRotator::nextRotationTime(qint64 now) const
+{
+    if (m_settings.intervalSecs <= 0)
+        return 0;
+    // Align to multiples of the interval, e.g. an interval of 86400 rotates at midnight UTC
+    return (now / m_settings.intervalSecs + 1) * m_settings.intervalSecs;
+}
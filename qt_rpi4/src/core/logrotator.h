@@ -0,0 +1,105 @@
+#ifndef LOGROTATOR_H
+#define LOGROTATOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QString>
+#include <QByteArray>
+
+/*
+ * Background thread which turns a rotated log file into generation 1 of the archive:
+ *   <log>.N.gz is deleted, <log>.1.gz ... <log>.N-1.gz are shifted by one and the
+ *   rotated file is gzip compressed into <log>.1.gz.
+ * Runs with idle priority, so it only uses CPU time nobody else needs.
+ */
+class LogArchiver : public QThread
+{
+    Q_OBJECT
+public:
+    explicit LogArchiver(QObject *parent = nullptr);
+    ~LogArchiver(); // Deconstructor
+
+    void setGenerations(int generations);
+    void setCompressionLevel(int level); // 0 = no compression, 1..9 zlib levels, -1 = zlib default
+
+    // Queues a rotated file for archiving, logFilePath is the name of the live log file
+    void archive(const QString& rotatedFilePath, const QString& logFilePath);
+    // Blocks until all queued files have been archived
+    void waitForIdle();
+    // Stops the thread after all queued files have been archived
+    void stop();
+
+    // Compresses data into the gzip format (RFC 1952), so archives can be read with zcat & co.
+    static QByteArray gzipCompress(const QByteArray& data, int level);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        QString rotatedFilePath;
+        QString logFilePath;
+    };
+
+    void archiveFile(const Job& job, int generations, int compressionLevel);
+
+    QMutex m_mutex;
+    QWaitCondition m_jobAvailable;
+    QWaitCondition m_idle;
+    QQueue<Job> m_jobs;
+    bool m_busy = false;
+    bool m_stopRequested = false;
+    int m_generations = 5;
+    int m_compressionLevel = 6;
+};
+
+/*
+ * Decides when the log file has to be rotated (by size and/or wall-clock interval) and
+ * performs the cheap part of the rotation: renaming the live file and reopening it.
+ * Shifting the generations and compressing is left to the LogArchiver thread, so the
+ * thread that writes the log never pays for it.
+ */
+class LogRotator
+{
+public:
+    struct Settings
+    {
+        qint64 maxBytes = 0;      // Rotate when the file reaches this size, 0 = disabled
+        qint64 intervalSecs = 0;  // Rotate at multiples of this interval (UTC), 0 = disabled
+        int generations = 5;      // Number of archived files to keep
+        int compressionLevel = 6; // 0 = no compression, 1..9 zlib levels
+    };
+
+    LogRotator();
+    ~LogRotator(); // Deconstructor
+
+    void setSettings(const Settings& settings);
+    Settings settings() const;
+    bool isEnabled() const;
+
+    // Has to be called after the log file was opened
+    void start(const QFile& logFile);
+    void recordWrite(qint64 bytes);
+    bool rotationDue() const;
+    // Renames the file, reopens it with the same open mode and hands the old one to the archiver
+    bool rotate(QFile& logFile);
+
+    LogArchiver& archiver();
+
+private:
+    qint64 nextRotationTime(qint64 now) const;
+
+    Settings m_settings;
+    qint64 m_currentSize = 0;
+    qint64 m_nextRotationSecs = 0;
+    quint64 m_rotationCount = 0;
+    LogArchiver m_archiver;
+};
+
+#endif // LOGROTATOR_H
@@ -0,0 +1,215 @@
+#include "logsink.h"
+#include "logformatter.h"
+#include "logrecord.h"
+#include <chrono>
+
+namespace {
+
+qint64 monotonicNsecs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+LogSink::LogSink(const QString &name)
+    : m_name{name}
+{
+}
+
+LogSink::~LogSink()
+{
+    stop();
+}
+
+QString LogSink::name() const
+{
+    return m_name;
+}
+
+void LogSink::setFormat(Format format)
+{
+    m_format = format;
+}
+
+LogSink::Format LogSink::format() const
+{
+    return m_format;
+}
+
+void LogSink::setMinimumLevel(QtMsgType type)
+{
+    m_minimumSeverity.store(severity(type), std::memory_order_relaxed);
+}
+
+int LogSink::minimumSeverity() const
+{
+    return m_minimumSeverity.load(std::memory_order_relaxed);
+}
+
+bool LogSink::accepts(QtMsgType type) const
+{
+    return severity(type) >= m_minimumSeverity.load(std::memory_order_relaxed);
+}
+
+void LogSink::startAsync(int queueSize, LogWriterThread::OverflowPolicy policy)
+{
+    if (m_writerThread)
+        return;
+    m_writerThread = std::make_unique<LogWriterThread>(
+        queueSize, policy,
+        [this](const LogMessage* messages, int count, quint64 droppedMessages) {
+            writeQueued(messages, count, droppedMessages);
+        });
+    m_writerThread->setObjectName("LogWriterThread-" + m_name);
+    // Logging must not compete with the GUI thread for the CPU
+    m_writerThread->start(QThread::LowPriority);
+}
+
+bool LogSink::isAsync() const
+{
+    return m_writerThread != nullptr;
+}
+
+void LogSink::stop()
+{
+    if (m_writerThread)
+        m_writerThread->stop();
+}
+
+void LogSink::submit(QtMsgType type, QByteArrayView line)
+{
+    const qint64 start = monotonicNsecs();
+    if (m_writerThread && m_writerThread->isRunning())
+    {
+        LogMessage message(type, line);
+        message.queuedNsecs = start;
+        if (type == QtFatalMsg)
+        {
+            // The process is about to abort, so write the queue and this message right now
+            m_writerThread->writeSynchronously(std::move(message));
+        }
+        else
+        {
+            m_writerThread->enqueue(std::move(message));
+        }
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        writeLine(type, line);
+        const quint64 latency = static_cast<quint64>(monotonicNsecs() - start);
+        countWritten(1, latency, latency);
+    }
+    linesWritten();
+}
+
+LogSink::Statistics LogSink::statistics() const
+{
+    Statistics statistics;
+    statistics.name = m_name;
+    statistics.written = m_written.load(std::memory_order_relaxed);
+    statistics.dropped = m_dropped.load(std::memory_order_relaxed);
+    statistics.totalLatencyNsecs = m_totalLatencyNsecs.load(std::memory_order_relaxed);
+    statistics.maxLatencyNsecs = m_maxLatencyNsecs.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+int LogSink::severity(QtMsgType type)
+{
+    // QtMsgType values aren't ordered by severity (QtInfoMsg was added last)
+    switch(type)
+    {
+    case QtDebugMsg: return 0;
+    case QtInfoMsg: return 1;
+    case QtWarningMsg: return 2;
+    case QtCriticalMsg: return 3;
+    case QtFatalMsg: return 4;
+    default: return 0;
+    }
+}
+
+LogSink::Format LogSink::formatFromString(const QString &format, Format defaultFormat)
+{
+    const QString value = format.trimmed().toLower();
+    if (value == "text") return Format::Text;
+    if (value == "json") return Format::Json;
+    return defaultFormat;
+}
+
+QtMsgType LogSink::levelFromString(const QString &level, QtMsgType defaultLevel)
+{
+    const QString value = level.trimmed().toLower();
+    if (value == "debug") return QtDebugMsg;
+    if (value == "info") return QtInfoMsg;
+    if (value == "warning") return QtWarningMsg;
+    if (value == "critical") return QtCriticalMsg;
+    return defaultLevel;
+}
+
+void LogSink::writeBatch(const LogMessage *messages, int count)
+{
+    for (int i = 0; i < count; ++i)
+        writeLine(messages[i].type, messages[i].line());
+}
+
+void LogSink::linesWritten()
+{
+}
+
+void LogSink::countDropped(quint64 count)
+{
+    m_dropped.fetch_add(count, std::memory_order_relaxed);
+}
+
+void LogSink::writeQueued(const LogMessage *messages, int count, quint64 droppedMessages)
+{
+    if (droppedMessages > 0)
+    {
+        // Report the loss in the sink's format, using the writer thread's own buffer
+        countDropped(droppedMessages);
+        const LogRecord notice = LogRecord::create(QtWarningMsg, nullptr, 0, nullptr, "log.dropped",
+                                                   "sink", QStringView(m_name), "reason", "queue full",
+                                                   "count", droppedMessages);
+        LogLineBuffer& noticeLine = LogFormatter::threadBuffer();
+        if (m_format == Format::Json)
+            LogFormatter::formatJson(noticeLine, notice, false);
+        else
+            LogFormatter::formatText(noticeLine, notice, false, true);
+        writeLine(QtWarningMsg, noticeLine.view());
+    }
+    if (count == 0)
+    {
+        if (droppedMessages > 0)
+            linesWritten();
+        return;
+    }
+
+    writeBatch(messages, count);
+
+    // Latency of a queued line: from submit() until its batch has been written
+    const qint64 now = monotonicNsecs();
+    quint64 totalLatency = 0;
+    quint64 maxLatency = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const quint64 latency = static_cast<quint64>(qMax(now - messages[i].queuedNsecs, qint64(0)));
+        totalLatency += latency;
+        maxLatency = qMax(maxLatency, latency);
+    }
+    countWritten(static_cast<quint64>(count), totalLatency, maxLatency);
+    linesWritten();
+}
+
+void LogSink::countWritten(quint64 count, quint64 totalLatencyNsecs, quint64 maxLatencyNsecs)
+{
+    m_written.fetch_add(count, std::memory_order_relaxed);
+    m_totalLatencyNsecs.fetch_add(totalLatencyNsecs, std::memory_order_relaxed);
+    quint64 currentMax = m_maxLatencyNsecs.load(std::memory_order_relaxed);
+    while (maxLatencyNsecs > currentMax
+           && !m_maxLatencyNsecs.compare_exchange_weak(currentMax, maxLatencyNsecs, std::memory_order_relaxed))
+    {
+    }
+}
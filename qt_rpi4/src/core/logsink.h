@@ -0,0 +1,94 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <QtGlobal>
+#include <QByteArrayView>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include "logwriterthread.h"
+
+/*
+ * An output of the logger (file, console, journal, memory).
+ *
+ * Every sink has its own level threshold and output format. A sink either writes on
+ * the logging thread (synchronous mode) or owns a queue and a writer thread (async mode),
+ * so a slow sink only ever delays itself. What happens when its queue is full is decided
+ * by the sink's own overflow policy.
+ *
+ * Derived classes implement writeLine() and have to call stop() in their destructor,
+ * because the writer thread may still be using them until then.
+ */
+class LogSink
+{
+public:
+    enum class Format { Text, Json };
+
+    struct Statistics
+    {
+        QString name;
+        quint64 written = 0;           // Lines written
+        quint64 dropped = 0;           // Lines lost to a full queue or a failed write
+        quint64 totalLatencyNsecs = 0; // Sum over all written lines: queue time + write time
+        quint64 maxLatencyNsecs = 0;
+    };
+
+    explicit LogSink(const QString& name);
+    virtual ~LogSink(); // Deconstructor
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    QString name() const;
+    void setFormat(Format format);
+    Format format() const;
+    void setMinimumLevel(QtMsgType type);
+    int minimumSeverity() const;
+    bool accepts(QtMsgType type) const;
+
+    // From now on lines are queued and written by a background thread
+    void startAsync(int queueSize, LogWriterThread::OverflowPolicy policy);
+    bool isAsync() const;
+    // Stops the background thread after everything queued has been written
+    void stop();
+
+    // Thread-safe. Fatal lines are written right away, even in async mode.
+    void submit(QtMsgType type, QByteArrayView line);
+
+    Statistics statistics() const;
+
+    // Orders QtMsgType by severity: debug 0, info 1, warning 2, critical 3, fatal 4
+    static int severity(QtMsgType type);
+    static Format formatFromString(const QString& format, Format defaultFormat = Format::Text);
+    // Accepts debug | info | warning | critical
+    static QtMsgType levelFromString(const QString& level, QtMsgType defaultLevel = QtDebugMsg);
+
+protected:
+    // Lines come without a trailing newline. Calls are serialised.
+    virtual void writeLine(QtMsgType type, QByteArrayView line) = 0;
+    // Writes a batch of the async queue, line by line unless a sink can do better
+    virtual void writeBatch(const LogMessage* messages, int count);
+    // Called after a line or a batch has been written, without the lock of the synchronous
+    // mode, so an implementation may log
+    virtual void linesWritten();
+    // For sinks which can lose lines themselves, e.g. a full socket buffer
+    void countDropped(quint64 count = 1);
+
+private:
+    void writeQueued(const LogMessage* messages, int count, quint64 droppedMessages);
+    void countWritten(quint64 count, quint64 totalLatencyNsecs, quint64 maxLatencyNsecs);
+
+    const QString m_name;
+    Format m_format = Format::Text;
+    std::atomic<int> m_minimumSeverity{0}; // Can be changed by a config reload while logging
+    std::unique_ptr<LogWriterThread> m_writerThread;
+    QMutex m_mutex; // Serialises writeLine() in synchronous mode
+
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_totalLatencyNsecs{0};
+    std::atomic<quint64> m_maxLatencyNsecs{0};
+};
+
+#endif // LOGSINK_H
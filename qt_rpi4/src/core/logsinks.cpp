@@ -0,0 +1,318 @@
+#include "logsinks.h"
+#include <cstdio>
+#include <cstring>
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+FileLogSink::FileLogSink()
+    : LogSink{"file"}
+{
+}
+
+FileLogSink::~FileLogSink()
+{
+    // The writer thread flushes everything that is still queued
+    stop();
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+bool FileLogSink::open(const QString &filePath, const LogRotator::Settings &rotation)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered))
+        return false;
+    m_rotator.setSettings(rotation);
+    m_rotator.start(m_file);
+    return true;
+}
+
+QString FileLogSink::fileName() const
+{
+    return m_file.fileName();
+}
+
+QString FileLogSink::errorString() const
+{
+    return m_file.errorString();
+}
+
+void FileLogSink::writeLine(QtMsgType type, QByteArrayView line)
+{
+    Q_UNUSED(type)
+    m_buffer.clear();
+    m_buffer.append(line);
+    m_buffer.append('\n');
+    write(m_buffer.constData(), m_buffer.size());
+}
+
+void FileLogSink::writeBatch(const LogMessage *messages, int count)
+{
+    // Concatenate the batch so that it is written with a single call
+    m_buffer.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        m_buffer.append(messages[i].line());
+        m_buffer.append('\n');
+    }
+    write(m_buffer.constData(), m_buffer.size());
+}
+
+void FileLogSink::write(const char *data, qsizetype size)
+{
+    // The file is unbuffered, so this is a single write call
+    if (m_file.write(data, size) < 0)
+        countDropped();
+
+    // Renaming and reopening is all that happens here, the archiver thread does the rest
+    if (m_rotator.isEnabled())
+    {
+        m_rotator.recordWrite(size);
+        if (m_rotator.rotationDue())
+            m_rotator.rotate(m_file);
+    }
+}
+
+ConsoleLogSink::ConsoleLogSink()
+    : LogSink{"console"}
+{
+}
+
+ConsoleLogSink::~ConsoleLogSink()
+{
+    stop();
+}
+
+void ConsoleLogSink::writeLine(QtMsgType type, QByteArrayView line)
+{
+    Q_UNUSED(type)
+    fwrite(line.data(), 1, static_cast<size_t>(line.size()), stderr);
+    fputc('\n', stderr);
+    fflush(stderr);
+}
+
+void ConsoleLogSink::writeBatch(const LogMessage *messages, int count)
+{
+    // stdio buffers the lines, the flush at the end writes them all at once
+    for (int i = 0; i < count; ++i)
+    {
+        const QByteArrayView line = messages[i].line();
+        fwrite(line.data(), 1, static_cast<size_t>(line.size()), stderr);
+        fputc('\n', stderr);
+    }
+    fflush(stderr);
+}
+
+JournalLogSink::JournalLogSink()
+    : LogSink{"journal"}
+{
+}
+
+JournalLogSink::~JournalLogSink()
+{
+    stop();
+#ifdef Q_OS_UNIX
+    if (m_socket >= 0)
+        ::close(m_socket);
+#endif
+}
+
+bool JournalLogSink::open(const QString &socketPath, const QString &identifier)
+{
+    m_socketPath = socketPath.toLocal8Bit();
+    m_identifier = identifier.toUtf8();
+#ifdef Q_OS_UNIX
+    sockaddr_un address{};
+    if (m_socketPath.size() >= static_cast<qsizetype>(sizeof(address.sun_path)))
+    {
+        m_errorString = "Socket path is too long";
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, m_socketPath.constData(), static_cast<size_t>(m_socketPath.size()));
+
+    m_socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (m_socket < 0)
+    {
+        m_errorString = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    ::fcntl(m_socket, F_SETFD, FD_CLOEXEC);
+    // A connected datagram socket fails right away if nobody is listening
+    if (::connect(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        m_errorString = QString::fromLocal8Bit(std::strerror(errno));
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+    return true;
+#else
+    m_errorString = "Local datagram sockets are not supported on this platform";
+    return false;
+#endif
+}
+
+QString JournalLogSink::errorString() const
+{
+    return m_errorString;
+}
+
+void JournalLogSink::writeLine(QtMsgType type, QByteArrayView line)
+{
+#ifdef Q_OS_UNIX
+    if (m_socket < 0)
+        return;
+
+    QByteArrayView message = line;
+    if (format() == Format::Text)
+    {
+        // Strip "yyyy-MM-dd hh:mm:ss.zzz [LEVEL]" and the separator that follows it
+        message = line.sliced(qMin(LogFormatter::textPrefixLength(type), line.size()));
+        if (message.startsWith(": "))
+            message = message.sliced(2);
+        else if (message.startsWith(' '))
+            message = message.sliced(1);
+    }
+
+    m_datagram.clear();
+    m_datagram.append(QByteArrayView("PRIORITY="));
+    m_datagram.appendNumber(syslogPriority(type));
+    m_datagram.append(QByteArrayView("\nSYSLOG_IDENTIFIER="));
+    m_datagram.append(m_identifier);
+    m_datagram.append('\n');
+    if (std::memchr(message.data(), '\n', static_cast<size_t>(message.size())))
+    {
+        // Multi-line values need the binary form: name, newline, 64 bit little endian size, data
+        m_datagram.append(QByteArrayView("MESSAGE\n"));
+        const quint64 size = static_cast<quint64>(message.size());
+        for (int i = 0; i < 8; ++i)
+            m_datagram.append(static_cast<char>((size >> (8 * i)) & 0xFF));
+    }
+    else
+    {
+        m_datagram.append(QByteArrayView("MESSAGE="));
+    }
+    m_datagram.append(message);
+    m_datagram.append('\n');
+
+    int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    if (::send(m_socket, m_datagram.constData(), static_cast<size_t>(m_datagram.size()), flags) < 0)
+        countDropped();
+#else
+    Q_UNUSED(type)
+    Q_UNUSED(line)
+#endif
+}
+
+int JournalLogSink::syslogPriority(QtMsgType type)
+{
+    switch(type)
+    {
+    case QtDebugMsg: return 7;    // LOG_DEBUG
+    case QtInfoMsg: return 6;     // LOG_INFO
+    case QtWarningMsg: return 4;  // LOG_WARNING
+    case QtCriticalMsg: return 3; // LOG_ERR
+    case QtFatalMsg: return 2;    // LOG_CRIT
+    default: return 6;
+    }
+}
+
+MemoryLogSink::MemoryLogSink(int capacity)
+    : LogSink{"memory"},
+      m_slots(static_cast<size_t>(qMax(capacity, 1))),
+      m_text(m_slots.size() * MaxLineLength)
+{
+}
+
+MemoryLogSink::~MemoryLogSink()
+{
+    stop();
+}
+
+int MemoryLogSink::capacity() const
+{
+    return static_cast<int>(m_slots.size());
+}
+
+quint64 MemoryLogSink::nextSequence() const
+{
+    QMutexLocker locker(&m_entriesMutex);
+    return m_nextSequence;
+}
+
+QList<MemoryLogSink::Entry> MemoryLogSink::entries(quint64 fromSequence) const
+{
+    QMutexLocker locker(&m_entriesMutex);
+    const quint64 capacity = m_slots.size();
+    const quint64 oldest = m_nextSequence > capacity ? m_nextSequence - capacity : 0;
+    const quint64 first = qMax(fromSequence, oldest);
+    QList<Entry> result;
+    result.reserve(static_cast<qsizetype>(m_nextSequence > first ? m_nextSequence - first : 0));
+    for (quint64 sequence = first; sequence < m_nextSequence; ++sequence)
+    {
+        const size_t index = static_cast<size_t>(sequence % capacity);
+        const Slot& slot = m_slots[index];
+        result.append({slot.sequence, slot.type, QByteArray(m_text.data() + index * MaxLineLength, slot.length)});
+    }
+    return result;
+}
+
+void MemoryLogSink::setWriteNotifier(std::function<void()> notifier)
+{
+    // Destroyed after the lock has been released
+    std::shared_ptr<const std::function<void()>> previous;
+    QMutexLocker locker(&m_entriesMutex);
+    previous = std::exchange(m_writeNotifier, notifier ? std::make_shared<const std::function<void()>>(std::move(notifier))
+                                                       : nullptr);
+    // The writing thread may still be calling it, e.g. with a model that is being destroyed
+    while (previous && previous.use_count() > 1)
+        m_notifierReleased.wait(&m_entriesMutex);
+}
+
+void MemoryLogSink::writeLine(QtMsgType type, QByteArrayView line)
+{
+    QMutexLocker locker(&m_entriesMutex);
+    const size_t index = static_cast<size_t>(m_nextSequence % m_slots.size());
+    Slot& slot = m_slots[index];
+    slot.sequence = m_nextSequence++;
+    slot.type = type;
+    qsizetype length = line.size();
+    if (length > MaxLineLength)
+    {
+        // A cut through a multi-byte character would leave invalid UTF-8, so back off to its
+        // lead byte (at most 3 continuation bytes, anything longer isn't UTF-8 anyway)
+        length = MaxLineLength;
+        for (int i = 0; i < 3 && length > 0 && (static_cast<uchar>(line[length]) & 0xC0) == 0x80; ++i)
+            --length;
+        if ((static_cast<uchar>(line[length]) & 0xC0) == 0x80)
+            length = MaxLineLength;
+    }
+    slot.length = static_cast<int>(length);
+    if (slot.length > 0)
+        std::memcpy(m_text.data() + index * MaxLineLength, line.data(), static_cast<size_t>(slot.length));
+}
+
+void MemoryLogSink::linesWritten()
+{
+    std::shared_ptr<const std::function<void()>> notifier;
+    {
+        QMutexLocker locker(&m_entriesMutex);
+        notifier = m_writeNotifier;
+    }
+    if (!notifier)
+        return;
+    // Called without the lock: a notifier which logs writes to this sink again
+    (*notifier)();
+    QMutexLocker locker(&m_entriesMutex);
+    notifier.reset();
+    m_notifierReleased.wakeAll();
+}
@@ -0,0 +1,135 @@
+#ifndef LOGSINKS_H
+#define LOGSINKS_H
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "logsink.h"
+#include "logformatter.h"
+#include "logrotator.h"
+
+// Appends lines to a log file, optionally rotated by size and age
+class FileLogSink : public LogSink
+{
+public:
+    FileLogSink();
+    ~FileLogSink() override; // Deconstructor
+
+    bool open(const QString& filePath, const LogRotator::Settings& rotation);
+    QString fileName() const;
+    QString errorString() const;
+
+protected:
+    void writeLine(QtMsgType type, QByteArrayView line) override;
+    void writeBatch(const LogMessage* messages, int count) override;
+
+private:
+    void write(const char* data, qsizetype size);
+
+    QFile m_file;
+    LogRotator m_rotator;
+    LogLineBuffer m_buffer; // Collects a line or a whole batch, so each is a single write call
+};
+
+// Writes lines to stderr
+class ConsoleLogSink : public LogSink
+{
+public:
+    ConsoleLogSink();
+    ~ConsoleLogSink() override; // Deconstructor
+
+protected:
+    void writeLine(QtMsgType type, QByteArrayView line) override;
+    void writeBatch(const LogMessage* messages, int count) override;
+};
+
+/*
+ * Sends every line as a datagram to a local socket, using the native protocol of the
+ * systemd journal ("PRIORITY=4\nSYSLOG_IDENTIFIER=greenoasis\nMESSAGE=...\n").
+ * Timestamp and level are fields of the journal, so text lines are sent without them.
+ * The socket never blocks: lines are dropped and counted if the receiver can't keep up.
+ */
+class JournalLogSink : public LogSink
+{
+public:
+    static constexpr const char* DefaultSocketPath = "/run/systemd/journal/socket";
+
+    JournalLogSink();
+    ~JournalLogSink() override; // Deconstructor
+
+    bool open(const QString& socketPath, const QString& identifier);
+    QString errorString() const;
+
+protected:
+    void writeLine(QtMsgType type, QByteArrayView line) override;
+
+private:
+    static int syslogPriority(QtMsgType type);
+
+    int m_socket = -1;
+    QByteArray m_socketPath;
+    QByteArray m_identifier;
+    LogLineBuffer m_datagram;
+    QString m_errorString;
+};
+
+/*
+ * Keeps the latest lines in memory, e.g. to show them in the UI.
+ * All memory is allocated up front: capacity slots of MaxLineLength bytes each,
+ * longer lines are truncated.
+ */
+class MemoryLogSink : public LogSink
+{
+public:
+    static constexpr int MaxLineLength = 512; // Longer lines are cut at a UTF-8 character boundary
+
+    struct Entry
+    {
+        quint64 sequence = 0; // Counts all lines ever written to the sink
+        QtMsgType type = QtDebugMsg;
+        QByteArray line;
+    };
+
+    explicit MemoryLogSink(int capacity);
+    ~MemoryLogSink() override; // Deconstructor
+
+    int capacity() const;
+    // The sequence number the next line will get
+    quint64 nextSequence() const;
+    // Thread-safe copy of the stored lines with a sequence number >= fromSequence, oldest first
+    QList<Entry> entries(quint64 fromSequence = 0) const;
+
+    // Called on the writing thread after every line, or every batch in async mode, e.g. to
+    // schedule a UI update. It is called without the locks of the sink, so it may log, but it
+    // should return quickly. Waits until a running call of the previous notifier has returned,
+    // so it must not be called from the notifier.
+    void setWriteNotifier(std::function<void()> notifier);
+
+protected:
+    void writeLine(QtMsgType type, QByteArrayView line) override;
+    void linesWritten() override;
+
+private:
+    struct Slot
+    {
+        quint64 sequence = 0;
+        QtMsgType type = QtDebugMsg;
+        int length = 0;
+    };
+
+    mutable QMutex m_entriesMutex;
+    std::vector<Slot> m_slots;  // Ring buffer indexed by sequence % capacity
+    std::vector<char> m_text;   // MaxLineLength bytes per slot
+    quint64 m_nextSequence = 0;
+    // Copied by the writing thread, which keeps it alive while calling it. Its copy is released
+    // under m_entriesMutex and announced with m_notifierReleased, which setWriteNotifier() waits on.
+    std::shared_ptr<const std::function<void()>> m_writeNotifier;
+    QWaitCondition m_notifierReleased;
+};
+
+#endif // LOGSINKS_H
@@ -0,0 +1,142 @@
+#include "logtailmodel.h"
+#include "logger.h"
+
+LogTailModel::LogTailModel(QObject *parent)
+    : LogTailModel{Logger::instance().memorySink(), parent}
+{
+}
+
+LogTailModel::LogTailModel(MemoryLogSink *sink, QObject *parent)
+    : QAbstractListModel{parent}
+{
+    setObjectName("LogTailModel");
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(FrameIntervalMsecs);
+    connect(&m_frameTimer, &QTimer::timeout, this, &LogTailModel::update);
+    attach(sink);
+}
+
+LogTailModel::~LogTailModel()
+{
+    if (m_sink)
+        m_sink->setWriteNotifier(nullptr);
+}
+
+int LogTailModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return static_cast<int>(m_rows.count());
+}
+
+QVariant LogTailModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= m_rows.count())
+        return QVariant(); // Constructs and returns an invalid variant
+
+    const Row& row = m_rows[index.row()];
+    switch (role) {
+    case SequenceRole:
+        return static_cast<qulonglong>(row.sequence);
+    case LevelRole:
+        return LogSink::severity(row.type);
+    case LevelNameRole:
+        return QString::fromLatin1(LogFormatter::levelName(row.type));
+    case Qt::DisplayRole:
+    case LineRole:
+        return row.line;
+    default:
+        return QVariant(); // Constructs and returns an invalid variant
+    }
+}
+
+QHash<int, QByteArray> LogTailModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[SequenceRole] = "sequence";
+    roles[LevelRole] = "level";
+    roles[LevelNameRole] = "levelName";
+    roles[LineRole] = "line";
+    return roles;
+}
+
+int LogTailModel::minimumLevel() const
+{
+    return m_minimumLevel;
+}
+
+void LogTailModel::setMinimumLevel(int level)
+{
+    level = qBound(0, level, LogSink::severity(QtFatalMsg));
+    if (level == m_minimumLevel)
+        return;
+    m_minimumLevel = level;
+
+    // Filtering the other way round needs the lines which have been left out, so start over
+    beginResetModel();
+    m_rows.clear();
+    m_nextSequence = 0;
+    endResetModel();
+    update();
+    emit minimumLevelChanged();
+    emit countChanged(rowCount());
+}
+
+void LogTailModel::update()
+{
+    if (!m_sink)
+        return;
+    // Lines written from now on schedule the next update
+    m_updatePending.store(false);
+
+    const QList<MemoryLogSink::Entry> entries = m_sink->entries(m_nextSequence);
+    if (entries.isEmpty())
+        return;
+    m_nextSequence = entries.last().sequence + 1;
+
+    QList<Row> rows;
+    rows.reserve(entries.size());
+    for (const MemoryLogSink::Entry& entry : entries)
+    {
+        if (LogSink::severity(entry.type) >= m_minimumLevel)
+            rows.append({entry.sequence, entry.type, QString::fromUtf8(entry.line)});
+    }
+    if (rows.isEmpty())
+        return;
+    if (rows.count() > m_capacity)
+        rows.remove(0, rows.count() - m_capacity);
+
+    // Make room first, so the model never holds more rows than the sink
+    const int overflow = static_cast<int>(m_rows.count() + rows.count()) - m_capacity;
+    if (overflow > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_rows.remove(0, overflow);
+        endRemoveRows();
+    }
+
+    const int first = static_cast<int>(m_rows.count());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(rows.count()) - 1);
+    m_rows.append(rows);
+    endInsertRows();
+    emit countChanged(rowCount());
+}
+
+void LogTailModel::attach(MemoryLogSink *sink)
+{
+    m_sink = sink;
+    if (!m_sink)
+        return;
+    m_capacity = m_sink->capacity();
+    // Runs on the logging thread: only the first line after an update posts an event
+    m_sink->setWriteNotifier([this]() {
+        if (!m_updatePending.exchange(true))
+            QMetaObject::invokeMethod(this, &LogTailModel::scheduleUpdate, Qt::QueuedConnection);
+    });
+    update();
+}
+
+void LogTailModel::scheduleUpdate()
+{
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
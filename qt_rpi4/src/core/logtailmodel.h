@@ -0,0 +1,73 @@
+#ifndef LOGTAILMODEL_H
+#define LOGTAILMODEL_H
+
+#include <QObject>
+#include <QAbstractListModel>
+#include <QTimer>
+#include <atomic>
+#include "logsinks.h"
+
+/*
+ * The latest log lines of the in-memory sink as a list model for QML.
+ *
+ * New lines are appended with beginInsertRows()/endInsertRows(), and the oldest rows are
+ * removed once the sink's capacity is exceeded, so views are never reset while lines come in.
+ * Lines written in quick succession are collected and appended once per frame at most.
+ * Changing minimumLevel rebuilds the rows from the sink.
+ */
+class LogTailModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(int minimumLevel READ minimumLevel WRITE setMinimumLevel NOTIFY minimumLevelChanged)
+
+public:
+    // Uses the in-memory sink of the logger, if LogToMemory is enabled
+    explicit LogTailModel(QObject *parent = nullptr);
+    LogTailModel(MemoryLogSink *sink, QObject *parent = nullptr);
+    ~LogTailModel(); // Deconstructor
+
+    enum Roles {
+        SequenceRole = Qt::UserRole + 1,
+        LevelRole,     // Severity: 0 debug, 1 info, 2 warning, 3 critical, 4 fatal
+        LevelNameRole, // e.g. "WARNING"
+        LineRole
+    };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int minimumLevel() const;
+    void setMinimumLevel(int level);
+
+    // Appends what the sink has got since the last update, normally called by the frame timer
+    void update();
+
+signals:
+    void countChanged(int count);
+    void minimumLevelChanged();
+
+private:
+    struct Row
+    {
+        quint64 sequence;
+        QtMsgType type;
+        QString line;
+    };
+
+    static constexpr int FrameIntervalMsecs = 16;
+
+    void attach(MemoryLogSink *sink);
+    void scheduleUpdate();
+
+    MemoryLogSink* m_sink = nullptr;
+    QList<Row> m_rows;
+    int m_capacity = 0;
+    int m_minimumLevel = 0;
+    quint64 m_nextSequence = 0;
+    QTimer m_frameTimer;
+    std::atomic<bool> m_updatePending{false};
+};
+
+#endif // LOGTAILMODEL_H
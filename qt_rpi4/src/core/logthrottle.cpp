@@ -0,0 +1,312 @@
+#include "logthrottle.h"
+#include <QStringEncoder>
+#include <QThread>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Copies the end of a file path, the file name is the part worth keeping
+template<size_t Size>
+void copyTail(char (&out)[Size], const char* text)
+{
+    const size_t length = text ? std::strlen(text) : 0;
+    const size_t copied = qMin(length, Size - 1);
+    if (copied > 0)
+        std::memcpy(out, text + length - copied, copied);
+    out[copied] = '\0';
+}
+
+template<size_t Size>
+void copyHead(char (&out)[Size], const char* text)
+{
+    const size_t copied = text ? qMin(std::strlen(text), Size - 1) : 0;
+    if (copied > 0)
+        std::memcpy(out, text, copied);
+    out[copied] = '\0';
+}
+
+template<size_t Size>
+void copyHead(char (&out)[Size], QStringView text)
+{
+    // Every UTF-16 unit takes at most 3 bytes, so this can't overflow
+    char utf8[3 * Size];
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    size_t length = encoder.appendToBuffer(utf8, text.first(qMin(text.size(), qsizetype(Size)))) - utf8;
+    if (length > Size - 1)
+    {
+        // Don't cut a multi-byte character in half
+        length = Size - 1;
+        while (length > 0 && (utf8[length] & 0xC0) == 0x80)
+            --length;
+    }
+    std::memcpy(out, utf8, length);
+    out[length] = '\0';
+}
+
+} // namespace
+
+LogThrottle::LogThrottle()
+    : m_sites{std::make_unique<Site[]>(TableSize)}
+{
+}
+
+// Deconstructor
+LogThrottle::~LogThrottle() = default;
+
+void LogThrottle::setSettings(const Settings &settings)
+{
+    const double ratePerSecond = qMax(settings.ratePerSecond, 0.0);
+    m_duplicateWindowMsecs.store(qMax(settings.duplicateWindowMsecs, qint64(0)), std::memory_order_relaxed);
+    m_ratePerSecond.store(ratePerSecond, std::memory_order_relaxed);
+    m_emissionIntervalUsecs.store(ratePerSecond > 0 ? qMax(qRound64(1e6 / ratePerSecond), qint64(1)) : 0,
+                                  std::memory_order_relaxed);
+    m_burst.store(qMax(settings.burst, 1), std::memory_order_relaxed);
+    m_enabled.store(settings.duplicateWindowMsecs > 0 || ratePerSecond > 0, std::memory_order_relaxed);
+}
+
+LogThrottle::Settings LogThrottle::settings() const
+{
+    Settings settings;
+    settings.duplicateWindowMsecs = m_duplicateWindowMsecs.load(std::memory_order_relaxed);
+    settings.ratePerSecond = m_ratePerSecond.load(std::memory_order_relaxed);
+    settings.burst = m_burst.load(std::memory_order_relaxed);
+    return settings;
+}
+
+bool LogThrottle::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+bool LogThrottle::admit(const LogRecord &record, qint64 nowMsecs, Summaries &summaries)
+{
+    if (!isEnabled() || record.type == QtFatalMsg)
+        return true;
+
+    // Only one thread sweeps, the others don't wait for it
+    qint64 lastSweepMsecs = m_lastSweepMsecs.load(std::memory_order_relaxed);
+    if (nowMsecs - lastSweepMsecs >= SweepIntervalMsecs && !m_sweeping.test_and_set(std::memory_order_acquire))
+    {
+        if (m_lastSweepMsecs.compare_exchange_strong(lastSweepMsecs, nowMsecs, std::memory_order_relaxed))
+            sweep(nowMsecs, false, summaries);
+        m_sweeping.clear(std::memory_order_release);
+    }
+
+    const quint64 key = siteKey(record);
+    Site* site = findSite(key, record, nowMsecs);
+    if (!site)
+        return true; // Untracked, the table is full around this call site
+    if (admitAt(*site, record, nowMsecs))
+        return true;
+    // The slot has been given to another call site in the meantime, the counts aren't ours
+    return site->key.load(std::memory_order_acquire) != key;
+}
+
+bool LogThrottle::admitAt(Site &site, const LogRecord &record, qint64 nowMsecs)
+{
+    site.type.store(record.type, std::memory_order_relaxed);
+    site.lastSeenMsecs.store(nowMsecs, std::memory_order_relaxed);
+
+    const qint64 duplicateWindowMsecs = m_duplicateWindowMsecs.load(std::memory_order_relaxed);
+    if (duplicateWindowMsecs > 0)
+    {
+        const quint64 hash = contentHash(record);
+        if (hash == site.contentHash.load(std::memory_order_relaxed)
+            && nowMsecs - site.windowStartMsecs.load(std::memory_order_relaxed) < duplicateWindowMsecs)
+        {
+            site.repeated.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // Something new or the window is over: the duplicates of the previous window are due
+        if (const quint64 repeated = site.repeated.exchange(0, std::memory_order_relaxed))
+            site.repeatedDue.fetch_add(repeated, std::memory_order_relaxed);
+        site.contentHash.store(hash, std::memory_order_relaxed);
+        site.windowStartMsecs.store(nowMsecs, std::memory_order_relaxed);
+    }
+
+    const qint64 intervalUsecs = m_emissionIntervalUsecs.load(std::memory_order_relaxed);
+    if (intervalUsecs > 0)
+    {
+        // A record may arrive up to burst - 1 intervals before its theoretical arrival time
+        const qint64 nowUsecs = nowMsecs * 1000;
+        const qint64 toleranceUsecs = (m_burst.load(std::memory_order_relaxed) - 1) * intervalUsecs;
+        qint64 nextArrivalUsecs = site.nextArrivalUsecs.load(std::memory_order_relaxed);
+        qint64 arrivalUsecs;
+        do
+        {
+            arrivalUsecs = qMax(nextArrivalUsecs, nowUsecs);
+            if (arrivalUsecs - nowUsecs > toleranceUsecs)
+            {
+                site.rateLimited.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!site.nextArrivalUsecs.compare_exchange_weak(nextArrivalUsecs, arrivalUsecs + intervalUsecs,
+                                                              std::memory_order_relaxed));
+    }
+    return true;
+}
+
+void LogThrottle::takeDue(qint64 nowMsecs, Summaries &summaries)
+{
+    if (!isEnabled() || m_sweeping.test_and_set(std::memory_order_acquire))
+        return;
+    m_lastSweepMsecs.store(nowMsecs, std::memory_order_relaxed);
+    sweep(nowMsecs, false, summaries);
+    m_sweeping.clear(std::memory_order_release);
+}
+
+void LogThrottle::takePending(Summaries &summaries)
+{
+    while (m_sweeping.test_and_set(std::memory_order_acquire))
+        QThread::yieldCurrentThread();
+    sweep(0, true, summaries);
+    m_sweeping.clear(std::memory_order_release);
+}
+
+quint64 LogThrottle::siteKey(const LogRecord &record)
+{
+    size_t key;
+    if (record.isStructured())
+    {
+        // LOG_* passes string literals, their addresses identify the call site
+        key = qHashMulti(0, reinterpret_cast<quintptr>(record.file), record.line,
+                         reinterpret_cast<quintptr>(record.event));
+    }
+    else
+    {
+        // The qDebug() route, which has built a QString already. The strings are hashed by
+        // content because QML passes temporary copies with every message.
+        const QByteArrayView file(record.file, record.file ? static_cast<qsizetype>(std::strlen(record.file)) : 0);
+        const QByteArrayView category(record.category, record.category ? static_cast<qsizetype>(std::strlen(record.category)) : 0);
+        key = qHashMulti(0, file, record.line, category);
+        if (!record.file)
+            key = qHash(record.message, key);
+    }
+    return key <= TombstoneKey ? key + TombstoneKey + 1 : key;
+}
+
+quint64 LogThrottle::contentHash(const LogRecord &record)
+{
+    if (!record.isStructured())
+        return qHash(record.message);
+
+    size_t hash = qHash(reinterpret_cast<quintptr>(record.event));
+    for (int i = 0; i < record.fieldCount; ++i)
+    {
+        const LogField& field = record.fields[i];
+        hash = qHash(reinterpret_cast<quintptr>(field.key), hash);
+        switch (field.type)
+        {
+        case LogField::Type::Utf8: hash = qHash(field.utf8(), hash); break;
+        case LogField::Type::Utf16: hash = qHash(field.utf16(), hash); break;
+        case LogField::Type::Double: hash = qHash(field.value.d, hash); break;
+        case LogField::Type::Bool: hash = qHash(field.value.b, hash); break;
+        default: hash = qHash(field.value.u, hash); break;
+        }
+    }
+    return hash;
+}
+
+LogThrottle::Site *LogThrottle::findSite(quint64 key, const LogRecord &record, qint64 nowMsecs)
+{
+    for (;;)
+    {
+        // The call site may be anywhere up to the first free slot, freed ones are skipped
+        Site* reusable = nullptr;
+        Site* free = nullptr;
+        for (int probe = 0; probe < MaxProbes; ++probe)
+        {
+            Site& site = m_sites[(key + probe) & (TableSize - 1)];
+            const quint64 siteKey = site.key.load(std::memory_order_acquire);
+            if (siteKey == key)
+                return &site;
+            if (siteKey == ClaimingKey)
+                return nullptr; // Perhaps by another record of this call site, so don't claim a second slot
+            if (siteKey == TombstoneKey && !reusable)
+                reusable = &site;
+            if (siteKey == FreeKey)
+            {
+                free = &site;
+                break;
+            }
+        }
+        Site* target = reusable ? reusable : free;
+        if (!target)
+            return nullptr;
+        quint64 expected = target == reusable ? TombstoneKey : FreeKey;
+        if (target->key.compare_exchange_strong(expected, ClaimingKey, std::memory_order_acquire))
+        {
+            claim(*target, record);
+            target->lastSeenMsecs.store(nowMsecs, std::memory_order_relaxed);
+            target->key.store(key, std::memory_order_release);
+            return target;
+        }
+        // Claimed by another thread in the meantime, perhaps for this call site: look again
+    }
+}
+
+void LogThrottle::claim(Site &site, const LogRecord &record)
+{
+    site.contentHash.store(0, std::memory_order_relaxed);
+    site.windowStartMsecs.store(std::numeric_limits<qint64>::min() / 2, std::memory_order_relaxed);
+    site.repeated.store(0, std::memory_order_relaxed);
+    site.repeatedDue.store(0, std::memory_order_relaxed);
+    site.nextArrivalUsecs.store(0, std::memory_order_relaxed);
+    site.rateLimited.store(0, std::memory_order_relaxed);
+    site.line = record.line;
+    copyTail(site.file, record.file);
+    copyHead(site.category, record.category);
+    if (record.isStructured())
+        copyHead(site.text, record.event);
+    else
+        copyHead(site.text, record.message);
+}
+
+bool LogThrottle::mayLog(const Site &site, qint64 nowUsecs) const
+{
+    const qint64 intervalUsecs = m_emissionIntervalUsecs.load(std::memory_order_relaxed);
+    const qint64 toleranceUsecs = (m_burst.load(std::memory_order_relaxed) - 1) * intervalUsecs;
+    return site.nextArrivalUsecs.load(std::memory_order_relaxed) - nowUsecs <= toleranceUsecs;
+}
+
+void LogThrottle::sweep(qint64 nowMsecs, bool everything, Summaries &summaries)
+{
+    // Report what has been dropped, then free the call sites which have gone quiet
+    const qint64 duplicateWindowMsecs = m_duplicateWindowMsecs.load(std::memory_order_relaxed);
+    const qint64 idleMsecs = qMax(duplicateWindowMsecs, qint64(60000));
+    for (int i = 0; i < TableSize; ++i)
+    {
+        Site& site = m_sites[i];
+        quint64 key = site.key.load(std::memory_order_acquire);
+        if (key == FreeKey || key == ClaimingKey || key == TombstoneKey)
+            continue;
+
+        quint64 repeated = site.repeatedDue.exchange(0, std::memory_order_relaxed);
+        if (everything || nowMsecs - site.windowStartMsecs.load(std::memory_order_relaxed) >= duplicateWindowMsecs)
+            repeated += site.repeated.exchange(0, std::memory_order_relaxed);
+        addSummary(site, "log.repeated", repeated, summaries);
+        if (everything || mayLog(site, nowMsecs * 1000))
+            addSummary(site, "log.ratelimited", site.rateLimited.exchange(0, std::memory_order_relaxed), summaries);
+
+        if (!everything && site.repeated.load(std::memory_order_relaxed) == 0
+            && site.rateLimited.load(std::memory_order_relaxed) == 0
+            && nowMsecs - site.lastSeenMsecs.load(std::memory_order_relaxed) > idleMsecs)
+            site.key.compare_exchange_strong(key, TombstoneKey, std::memory_order_release);
+    }
+}
+
+void LogThrottle::addSummary(const Site &site, const char *event, quint64 count, Summaries &summaries)
+{
+    if (count == 0)
+        return;
+    Summary summary;
+    summary.event = event;
+    summary.type = static_cast<QtMsgType>(site.type.load(std::memory_order_relaxed));
+    summary.file = QByteArray(site.file);
+    summary.line = site.line;
+    summary.category = QByteArray(site.category);
+    summary.count = count;
+    summary.text = QByteArray(site.text);
+    summaries.append(std::move(summary));
+}
@@ -0,0 +1,122 @@
+#ifndef LOGTHROTTLE_H
+#define LOGTHROTTLE_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QVarLengthArray>
+#include <atomic>
+#include <memory>
+#include "logrecord.h"
+
+/*
+ * Keeps repetitive log statements from flooding the sinks.
+ *
+ * Records are tracked per call site (file and line, or category and text where Qt doesn't
+ * provide a location in release builds):
+ * - Duplicate suppression: a record with the same content as the previous one of its call
+ *   site is dropped while it repeats within the window. A "log.repeated" summary with the
+ *   number of dropped records is logged once the window is over or the content has changed.
+ * - Rate limit: every call site may log burst records at once and ratePerSecond records
+ *   on average (GCRA, the lock-free form of a token bucket). Dropped records are reported
+ *   with a "log.ratelimited" summary as soon as the call site may log again.
+ * Fatal records are never dropped.
+ *
+ * admit() takes no lock and doesn't allocate: the call sites live in a fixed table of atomic
+ * counters. The summaries are built by a sweep over the table, which runs at most once a
+ * second on the thread whose record is due for it. takeDue() sweeps without a record, so a
+ * call site that has gone quiet gets its summary as well: call it every SweepIntervalMsecs.
+ */
+class LogThrottle
+{
+public:
+    static constexpr qint64 SweepIntervalMsecs = 1000;
+
+    struct Settings
+    {
+        qint64 duplicateWindowMsecs = 0; // 0 = no duplicate suppression
+        double ratePerSecond = 0;        // 0 = no rate limit
+        int burst = 20;
+    };
+
+    // Describes records which have been dropped at one call site
+    struct Summary
+    {
+        const char* event = nullptr; // "log.repeated" or "log.ratelimited"
+        QtMsgType type = QtDebugMsg;
+        QByteArray file;
+        int line = 0;
+        QByteArray category;
+        quint64 count = 0;
+        QByteArray text; // Beginning of the first record of the call site
+    };
+    using Summaries = QVarLengthArray<Summary, 4>;
+
+    LogThrottle();
+    ~LogThrottle(); // Deconstructor
+
+    void setSettings(const Settings& settings);
+    Settings settings() const;
+    bool isEnabled() const;
+
+    // Thread-safe and lock-free. Returns false if the record has to be dropped. If the sweep
+    // was due at nowMsecs, its summaries are added to summaries and should be logged before
+    // the record.
+    bool admit(const LogRecord& record, qint64 nowMsecs, Summaries& summaries);
+    // Thread-safe. Summaries of the records whose drops are due at nowMsecs, e.g. from a timer.
+    // Adds nothing if another thread is sweeping right now, it reports them.
+    void takeDue(qint64 nowMsecs, Summaries& summaries);
+    // Summaries of all records dropped so far, e.g. at shutdown
+    void takePending(Summaries& summaries);
+
+private:
+    static constexpr int TableSize = 256; // Power of two
+    static constexpr int MaxProbes = 8;
+    static constexpr quint64 FreeKey = 0;
+    static constexpr quint64 ClaimingKey = 1;
+    // A call site freed by the sweep: lookups probe past it, new call sites may claim it
+    static constexpr quint64 TombstoneKey = 2;
+
+    // The counters are atomics, the strings are written once by the thread which claims the
+    // slot and only read by the sweep. A slot may be freed and claimed again while a thread that
+    // found it before is still counting, so admit() checks the key again before dropping.
+    struct Site
+    {
+        std::atomic<quint64> key{FreeKey};
+        std::atomic<int> type{QtDebugMsg};
+        std::atomic<qint64> lastSeenMsecs{0};
+        // Duplicate suppression
+        std::atomic<quint64> contentHash{0};
+        std::atomic<qint64> windowStartMsecs{0};
+        std::atomic<quint64> repeated{0};    // Dropped within the current window
+        std::atomic<quint64> repeatedDue{0}; // Dropped within windows which are over
+        // Rate limit: theoretical arrival time of the next record
+        std::atomic<qint64> nextArrivalUsecs{0};
+        std::atomic<quint64> rateLimited{0};
+        // Copies, QML passes temporary strings with every message
+        int line = 0;
+        char file[80] = {};
+        char category[32] = {};
+        char text[120] = {};
+    };
+
+    static quint64 siteKey(const LogRecord& record);
+    static quint64 contentHash(const LogRecord& record);
+    Site* findSite(quint64 key, const LogRecord& record, qint64 nowMsecs);
+    // Updates the counters of the call site, false if the record has to be dropped
+    bool admitAt(Site& site, const LogRecord& record, qint64 nowMsecs);
+    static void claim(Site& site, const LogRecord& record);
+    bool mayLog(const Site& site, qint64 nowUsecs) const;
+    void sweep(qint64 nowMsecs, bool everything, Summaries& summaries);
+    static void addSummary(const Site& site, const char* event, quint64 count, Summaries& summaries);
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<qint64> m_duplicateWindowMsecs{0};
+    std::atomic<double> m_ratePerSecond{0};
+    std::atomic<qint64> m_emissionIntervalUsecs{0}; // 0 = no rate limit
+    std::atomic<int> m_burst{20};
+    std::atomic<qint64> m_lastSweepMsecs{0};
+    std::atomic_flag m_sweeping = ATOMIC_FLAG_INIT;
+    std::unique_ptr<Site[]> m_sites;
+};
+
+#endif // LOGTHROTTLE_H
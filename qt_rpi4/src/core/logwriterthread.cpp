@@ -0,0 +1,201 @@
+#include "logwriterthread.h"
+#include <QDeadlineTimer>
+#include <cstring>
+
+LogMessage::LogMessage(QtMsgType type, QByteArrayView line)
+{
+    setLine(type, line);
+}
+
+LogMessage::LogMessage(LogMessage &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+LogMessage &LogMessage::operator=(LogMessage &&other) noexcept
+{
+    // Only copy the used part of the inline buffer
+    type = other.type;
+    length = other.length;
+    queuedNsecs = other.queuedNsecs;
+    if (length <= InlineCapacity)
+        std::memcpy(inlineText, other.inlineText, static_cast<size_t>(length));
+    overflow = std::move(other.overflow);
+    return *this;
+}
+
+void LogMessage::setLine(QtMsgType messageType, QByteArrayView line)
+{
+    type = messageType;
+    length = line.size();
+    if (length == 0)
+        return;
+    if (length <= InlineCapacity)
+        std::memcpy(inlineText, line.data(), static_cast<size_t>(length));
+    else
+        overflow = line.toByteArray();
+}
+
+QByteArrayView LogMessage::line() const
+{
+    if (length <= InlineCapacity)
+        return QByteArrayView(inlineText, length);
+    return QByteArrayView(overflow);
+}
+
+LogWriterThread::LogWriterThread(int queueSize, OverflowPolicy policy, WriteFunction writeFunction, QObject *parent)
+    : QThread{parent}, m_queue{queueSize}, m_overflowPolicy{policy}, m_writeFunction{std::move(writeFunction)}
+{
+    setObjectName("LogWriterThread");
+    m_batch.reserve(m_maxBatchSize + 1);
+}
+
+LogWriterThread::~LogWriterThread()
+{
+    stop();
+}
+
+bool LogWriterThread::enqueue(LogMessage &&message)
+{
+    bool queued = true;
+    switch (m_overflowPolicy)
+    {
+    case OverflowPolicy::Block:
+        while (!m_queue.tryPush(std::move(message)))
+        {
+            if (m_stopRequested.load())
+            {
+                // Nobody is going to make room anymore
+                m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // Make sure the writer is awake and give it a chance to catch up
+            wakeIfSleeping();
+            QThread::yieldCurrentThread();
+        }
+        break;
+    case OverflowPolicy::DropOldest:
+        while (!m_queue.tryPush(std::move(message)))
+        {
+            LogMessage discarded;
+            if (m_queue.tryPop(discarded))
+            {
+                m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                m_droppedSinceLastBatch.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        break;
+    case OverflowPolicy::DropNewest:
+        if (!m_queue.tryPush(std::move(message)))
+        {
+            m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            m_droppedSinceLastBatch.fetch_add(1, std::memory_order_relaxed);
+            queued = false;
+        }
+        break;
+    }
+
+    wakeIfSleeping();
+    return queued;
+}
+
+void LogWriterThread::writeSynchronously(LogMessage &&message)
+{
+    // Waits for a batch that is currently being written by the writer thread
+    QMutexLocker locker(&m_writeMutex);
+
+    m_batch.clear();
+    LogMessage queued;
+    while (m_queue.tryPop(queued))
+    {
+        m_batch.push_back(std::move(queued));
+    }
+    m_batch.push_back(std::move(message));
+    m_writeFunction(m_batch.data(), static_cast<int>(m_batch.size()),
+                    m_droppedSinceLastBatch.exchange(0, std::memory_order_relaxed));
+    m_batch.clear();
+}
+
+void LogWriterThread::stop()
+{
+    if (!isRunning()) return;
+    m_stopRequested.store(true);
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wakeCondition.wakeAll();
+    }
+    wait();
+}
+
+LogWriterThread::OverflowPolicy LogWriterThread::overflowPolicy() const
+{
+    return m_overflowPolicy;
+}
+
+quint64 LogWriterThread::droppedMessages() const
+{
+    return m_droppedMessages.load(std::memory_order_relaxed);
+}
+
+LogWriterThread::OverflowPolicy LogWriterThread::overflowPolicyFromString(const QString &policy, OverflowPolicy defaultPolicy)
+{
+    const QString value = policy.trimmed().toLower();
+    if (value == "block") return OverflowPolicy::Block;
+    if (value == "drop-oldest") return OverflowPolicy::DropOldest;
+    if (value == "drop-newest") return OverflowPolicy::DropNewest;
+    return defaultPolicy;
+}
+
+void LogWriterThread::run()
+{
+    while (!m_stopRequested.load())
+    {
+        if (drain() == 0)
+            waitForWork();
+    }
+
+    // Write whatever is left before the thread finishes
+    while (drain() > 0) {}
+}
+
+int LogWriterThread::drain()
+{
+    QMutexLocker locker(&m_writeMutex);
+
+    m_batch.clear();
+    LogMessage message;
+    while (static_cast<int>(m_batch.size()) < m_maxBatchSize && m_queue.tryPop(message))
+    {
+        m_batch.push_back(std::move(message));
+    }
+
+    const quint64 dropped = m_droppedSinceLastBatch.exchange(0, std::memory_order_relaxed);
+    const int count = static_cast<int>(m_batch.size());
+    if (count > 0 || dropped > 0)
+        m_writeFunction(m_batch.data(), count, dropped);
+    m_batch.clear();
+    return count;
+}
+
+void LogWriterThread::waitForWork()
+{
+    QMutexLocker locker(&m_wakeMutex);
+    m_sleeping.store(true);
+    // Re-check after announcing that we are about to sleep. A producer either sees
+    // m_sleeping == true and wakes us up, or we see its message here.
+    if (m_queue.isEmpty() && !m_stopRequested.load())
+    {
+        // The timeout is only a safety net, producers wake the thread up explicitly
+        m_wakeCondition.wait(&m_wakeMutex, QDeadlineTimer(100));
+    }
+    m_sleeping.store(false);
+}
+
+void LogWriterThread::wakeIfSleeping()
+{
+    if (m_sleeping.load())
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wakeCondition.wakeOne();
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef LOGWRITERTHREAD_H
+#define LOGWRITERTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "logringbuffer.h"
+
+/*
+ * A formatted log line (UTF-8, without trailing newline) waiting to be written.
+ * Lines up to InlineCapacity bytes are stored inside the message itself, so queueing
+ * them doesn't allocate. Only longer lines fall back to a heap allocated QByteArray.
+ */
+struct LogMessage
+{
+    static constexpr int InlineCapacity = 224;
+
+    LogMessage() = default;
+    LogMessage(QtMsgType type, QByteArrayView line);
+    LogMessage(LogMessage&& other) noexcept;
+    LogMessage& operator=(LogMessage&& other) noexcept;
+
+    void setLine(QtMsgType messageType, QByteArrayView line);
+    QByteArrayView line() const;
+
+    QtMsgType type = QtDebugMsg;
+    qsizetype length = 0;
+    qint64 queuedNsecs = 0; // Monotonic time the message was queued at, used for latency statistics
+    char inlineText[InlineCapacity];
+    QByteArray overflow;
+};
+
+/*
+ * Background writer used by the logger's async mode.
+ *
+ * Producers push formatted messages into a bounded lock-free ring buffer and return
+ * immediately. The writer thread drains the buffer in batches and hands each batch
+ * to the write function, so only this thread ever waits on disk or console I/O.
+ */
+class LogWriterThread : public QThread
+{
+    Q_OBJECT
+public:
+    // Defines what happens when a producer finds the queue full
+    enum class OverflowPolicy {
+        Block,      // Wait until the writer has made room
+        DropOldest, // Discard the oldest queued message to make room
+        DropNewest  // Discard the message being logged
+    };
+
+    // Called on the writer thread with a batch of messages in the order they were queued.
+    // droppedMessages is the number of messages discarded since the previous batch.
+    using WriteFunction = std::function<void(const LogMessage* messages, int count, quint64 droppedMessages)>;
+
+    LogWriterThread(int queueSize, OverflowPolicy policy, WriteFunction writeFunction, QObject *parent = nullptr);
+    ~LogWriterThread(); // Deconstructor
+
+    // Thread-safe, lock-free unless the policy is Block and the queue is full
+    bool enqueue(LogMessage&& message);
+    // Writes everything queued so far followed by the message on the calling thread.
+    // Used for fatal messages which must not be lost when the process aborts.
+    void writeSynchronously(LogMessage&& message);
+    // Stops the thread after all queued messages have been written
+    void stop();
+
+    OverflowPolicy overflowPolicy() const;
+    quint64 droppedMessages() const;
+
+    static OverflowPolicy overflowPolicyFromString(const QString& policy, OverflowPolicy defaultPolicy = OverflowPolicy::Block);
+
+protected:
+    void run() override;
+
+private:
+    int drain();
+    void waitForWork();
+    void wakeIfSleeping();
+
+    LogRingBuffer<LogMessage> m_queue;
+    const OverflowPolicy m_overflowPolicy;
+    WriteFunction m_writeFunction;
+
+    // Serialises the write function between the writer thread and writeSynchronously()
+    QMutex m_writeMutex;
+    std::vector<LogMessage> m_batch;
+    const int m_maxBatchSize = 256;
+
+    // Used to park the writer thread while the queue is empty
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+    std::atomic<bool> m_sleeping{false};
+    std::atomic<bool> m_stopRequested{false};
+
+    std::atomic<quint64> m_droppedMessages{0};
+    std::atomic<quint64> m_droppedSinceLastBatch{0};
+};
+
+#endif // LOGWRITERTHREAD_H
@@ -0,0 +1,88 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QStringList>
+#include <cstdio>
+#include <flightrecorder.h>
+#include <logformatter.h>
+#include <logsink.h>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("rpi4_logdump");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Prints the records of a Green Oasis flight recorder file, oldest first.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "The flight recorder file, e.g. /tmp/greenoasis.flight");
+    QCommandLineOption levelOption("level", "Minimum level: debug | info | warning | critical", "level", "debug");
+    QCommandLineOption tailOption("tail", "Print only the last <count> records", "count");
+    QCommandLineOption utcOption("utc", "Print the timestamps in UTC instead of local time");
+    parser.addOption(levelOption);
+    parser.addOption(tailOption);
+    parser.addOption(utcOption);
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1)
+        parser.showHelp(1);
+
+    const QStringList levels = {"debug", "info", "warning", "critical"};
+    const int minimumSeverity = levels.indexOf(parser.value(levelOption).trimmed().toLower());
+    if (minimumSeverity < 0)
+    {
+        fprintf(stderr, "Unknown level: %s\n", qPrintable(parser.value(levelOption)));
+        return 1;
+    }
+
+    QFile file(arguments.first());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        return 1;
+    }
+    // Map the file instead of reading it, it may be the one the application is writing to
+    const uchar* data = file.map(0, file.size());
+    if (!data)
+    {
+        fprintf(stderr, "Failed to map %s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        return 1;
+    }
+
+    QList<FlightRecorder::Entry> entries;
+    QString errorString;
+    if (!FlightRecorder::decode(QByteArrayView(reinterpret_cast<const char*>(data), file.size()), entries, &errorString))
+    {
+        fprintf(stderr, "%s: %s\n", qPrintable(file.fileName()), qPrintable(errorString));
+        return 1;
+    }
+    entries.removeIf([minimumSeverity](const FlightRecorder::Entry& entry) {
+        return LogSink::severity(entry.type) < minimumSeverity;
+    });
+    if (parser.isSet(tailOption))
+    {
+        const qsizetype tail = qMax(parser.value(tailOption).toLongLong(), qint64(0));
+        if (entries.size() > tail)
+            entries.remove(0, entries.size() - tail);
+    }
+
+    // Same layout as the lines of the text log file
+    const bool utc = parser.isSet(utcOption);
+    for (const FlightRecorder::Entry& entry : entries)
+    {
+        QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(entry.msecs);
+        if (utc)
+            timestamp = timestamp.toUTC();
+        const QByteArray prefix = timestamp.toString("yyyy-MM-dd hh:mm:ss.zzz").toUtf8();
+        const QByteArrayView level = LogFormatter::levelName(entry.type);
+        fwrite(prefix.constData(), 1, static_cast<size_t>(prefix.size()), stdout);
+        fputs(" [", stdout);
+        fwrite(level.data(), 1, static_cast<size_t>(level.size()), stdout);
+        fputc(']', stdout);
+        fwrite(entry.text.constData(), 1, static_cast<size_t>(entry.text.size()), stdout);
+        fputc('\n', stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,649 @@
+#include "forecastdecoder.h"
+#include <utility>
+
+namespace {
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool isNumberCharacter(char c)
+{
+    return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isValidNumber(QByteArrayView text)
+{
+    qsizetype i = 0;
+    const qsizetype size = text.size();
+    auto digits = [&]() {
+        const qsizetype start = i;
+        while (i < size && isDigit(text[i]))
+            ++i;
+        return i > start;
+    };
+    if (i < size && text[i] == '-')
+        ++i;
+    if (i < size && text[i] == '0')
+        ++i;
+    else if (!digits())
+        return false;
+    if (i < size && text[i] == '.')
+    {
+        ++i;
+        if (!digits())
+            return false;
+    }
+    if (i < size && (text[i] == 'e' || text[i] == 'E'))
+    {
+        ++i;
+        if (i < size && (text[i] == '+' || text[i] == '-'))
+            ++i;
+        if (!digits())
+            return false;
+    }
+    return i == size;
+}
+
+int hexValue(char c)
+{
+    if (isDigit(c))
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+ForecastDecoder::ForecastDecoder()
+{
+    m_text.reserve(64);
+}
+
+void ForecastDecoder::reset()
+{
+    m_state = State::Value;
+    m_levels.clear();
+    m_keyField = Field::None;
+    m_keyContext = Context::Skip;
+    m_field = Field::None;
+    m_text.resize(0);
+    m_highSurrogate = 0;
+    m_offset = 0;
+    m_errorOffset = -1;
+    m_error = nullptr;
+    m_entry = ForecastEntry();
+    m_entries.clear();
+    m_cityName.clear();
+}
+
+bool ForecastDecoder::feed(QByteArrayView data)
+{
+    const char* bytes = data.data();
+    const qsizetype size = data.size();
+    qsizetype i = 0;
+    while (i < size && m_state != State::Error)
+    {
+        // Tokens can span chunks, their states come first
+        switch (m_state)
+        {
+        case State::String:
+        {
+            // Most characters need no attention, copy (or skip) them in one go
+            const qsizetype start = i;
+            while (i < size && bytes[i] != '"' && bytes[i] != '\\' && static_cast<uchar>(bytes[i]) >= 0x20)
+                ++i;
+            if (m_capture && i > start)
+            {
+                flushSurrogate();
+                m_text.append(bytes + start, i - start);
+            }
+            if (i == size)
+                continue;
+            if (bytes[i] == '"')
+            {
+                if (const char* error = endString())
+                    return fail(error, m_offset + i);
+            }
+            else if (bytes[i] == '\\')
+                m_state = State::Escape;
+            else
+                return fail("Control character in a string", m_offset + i);
+            ++i;
+            continue;
+        }
+        case State::Escape:
+        {
+            char unescaped = 0;
+            switch (bytes[i])
+            {
+            case '"': unescaped = '"'; break;
+            case '\\': unescaped = '\\'; break;
+            case '/': unescaped = '/'; break;
+            case 'b': unescaped = '\b'; break;
+            case 'f': unescaped = '\f'; break;
+            case 'n': unescaped = '\n'; break;
+            case 'r': unescaped = '\r'; break;
+            case 't': unescaped = '\t'; break;
+            case 'u':
+                m_unicode = 0;
+                m_unicodeDigits = 0;
+                m_state = State::Unicode;
+                ++i;
+                continue;
+            default:
+                return fail("Invalid escape sequence", m_offset + i);
+            }
+            if (m_capture)
+            {
+                flushSurrogate();
+                m_text.append(unescaped);
+            }
+            m_state = State::String;
+            ++i;
+            continue;
+        }
+        case State::Unicode:
+        {
+            const int digit = hexValue(bytes[i]);
+            if (digit < 0)
+                return fail("Invalid \\u escape sequence", m_offset + i);
+            m_unicode = m_unicode * 16 + static_cast<uint>(digit);
+            if (++m_unicodeDigits == 4)
+            {
+                if (m_capture)
+                    appendCodePoint(m_unicode);
+                m_state = State::String;
+            }
+            ++i;
+            continue;
+        }
+        case State::Number:
+            if (isNumberCharacter(bytes[i]))
+            {
+                m_text.append(bytes[i]);
+                ++i;
+                continue;
+            }
+            // The byte after the number is handled below
+            if (const char* error = endNumber())
+                return fail(error, m_tokenOffset);
+            break;
+        case State::Literal:
+            if (bytes[i] != m_literal[m_literalIndex])
+                return fail("Invalid literal", m_offset + i);
+            ++i;
+            if (m_literal[++m_literalIndex] == '\0')
+                endScalar();
+            continue;
+        default:
+            break;
+        }
+
+        const char c = bytes[i];
+        if (isWhitespace(c))
+        {
+            ++i;
+            continue;
+        }
+        const qint64 offset = m_offset + i;
+        const char* error = nullptr;
+        switch (m_state)
+        {
+        case State::FirstValue:
+            if (c == ']')
+            {
+                error = endContainer(c);
+                break;
+            }
+            Q_FALLTHROUGH();
+        case State::Value:
+            error = beginValue(c, offset);
+            break;
+        case State::FirstKey:
+            if (c == '}')
+            {
+                error = endContainer(c);
+                break;
+            }
+            Q_FALLTHROUGH();
+        case State::Key:
+            if (c != '"')
+            {
+                error = "Expected a key";
+                break;
+            }
+            m_isKey = true;
+            m_capture = true;
+            m_text.resize(0);
+            m_highSurrogate = 0;
+            m_tokenOffset = offset;
+            m_state = State::String;
+            break;
+        case State::Colon:
+            if (c == ':')
+                m_state = State::Value;
+            else
+                error = "Expected ':'";
+            break;
+        case State::AfterValue:
+            if (c == ',')
+                m_state = m_levels.last().isArray ? State::Value : State::Key;
+            else if (c == '}' || c == ']')
+                error = endContainer(c);
+            else
+                error = m_levels.last().isArray ? "Expected ',' or ']'" : "Expected ',' or '}'";
+            break;
+        case State::Done:
+            error = "Unexpected data after the document";
+            break;
+        default:
+            break;
+        }
+        if (error)
+            return fail(error, offset);
+        ++i;
+    }
+    m_offset += size;
+    return m_state != State::Error;
+}
+
+bool ForecastDecoder::finish()
+{
+    if (m_state == State::Error)
+        return false;
+    // A number is only complete once something follows it
+    if (m_state == State::Number && m_levels.isEmpty())
+    {
+        if (const char* error = endNumber())
+            return fail(error, m_tokenOffset);
+    }
+    if (m_state != State::Done)
+        return fail("Unexpected end of the document", m_offset);
+    return true;
+}
+
+bool ForecastDecoder::decode(QByteArrayView document)
+{
+    reset();
+    return feed(document) && finish();
+}
+
+bool ForecastDecoder::hasError() const
+{
+    return m_state == State::Error;
+}
+
+QString ForecastDecoder::errorString() const
+{
+    if (!m_error)
+        return QString();
+    return QString("%1 at byte %2").arg(QString::fromLatin1(m_error)).arg(m_errorOffset);
+}
+
+qint64 ForecastDecoder::errorOffset() const
+{
+    return m_errorOffset;
+}
+
+QString ForecastDecoder::cityName() const
+{
+    return m_cityName;
+}
+
+qsizetype ForecastDecoder::entryCount() const
+{
+    return m_entries.size();
+}
+
+QList<ForecastEntry> ForecastDecoder::takeEntries()
+{
+    return std::exchange(m_entries, QList<ForecastEntry>());
+}
+
+const char* ForecastDecoder::beginValue(char c, qint64 offset)
+{
+    // What the value is: an element of an array or the value of the current key
+    Context context = Context::Skip;
+    Field field = Field::None;
+    if (m_levels.isEmpty())
+    {
+        context = Context::Root;
+    }
+    else if (m_levels.last().isArray)
+    {
+        Level& parent = m_levels.last();
+        if (parent.context == Context::List)
+            context = Context::Entry;
+        else if (parent.context == Context::Weather && parent.count == 0)
+            context = Context::WeatherItem; // Only the first condition is used
+        ++parent.count;
+    }
+    else
+    {
+        context = m_keyContext;
+        field = m_keyField;
+    }
+
+    switch (c)
+    {
+    case '{':
+    case '[':
+        if (m_levels.size() >= MaxDepth)
+            return "Nested too deeply";
+        if (c == '[' && context != Context::List && context != Context::Weather)
+            context = Context::Skip;
+        if (c == '{' && (context == Context::List || context == Context::Weather))
+            context = Context::Skip;
+        if (context == Context::Entry)
+            m_entry = ForecastEntry();
+        if (context == Context::WeatherItem)
+        {
+            // Keeps the capacity for the next entry
+            m_weatherId = 0;
+            m_weatherMain.resize(0);
+            m_weatherDescription.resize(0);
+            m_weatherIcon.resize(0);
+        }
+        m_levels.append(Level{context, c == '[', 0});
+        m_state = c == '[' ? State::FirstValue : State::FirstKey;
+        return nullptr;
+    case '"':
+        m_field = field;
+        m_isKey = false;
+        m_capture = field != Field::None;
+        m_text.resize(0);
+        m_highSurrogate = 0;
+        m_tokenOffset = offset;
+        m_state = State::String;
+        return nullptr;
+    case 't':
+    case 'f':
+    case 'n':
+        m_field = field;
+        m_literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        m_literalIndex = 1;
+        m_tokenOffset = offset;
+        m_state = State::Literal;
+        return nullptr;
+    default:
+        if (c == '-' || isDigit(c))
+        {
+            m_field = field;
+            m_text.resize(0);
+            m_text.append(c);
+            m_tokenOffset = offset;
+            m_state = State::Number;
+            return nullptr;
+        }
+        return "Unexpected character";
+    }
+}
+
+const char* ForecastDecoder::endContainer(char c)
+{
+    const Level level = m_levels.last();
+    if (level.isArray != (c == ']'))
+        return level.isArray ? "Expected ',' or ']'" : "Expected ',' or '}'";
+    if (level.context == Context::Entry)
+    {
+        m_entry.isCurrent = m_entries.isEmpty();
+        m_entries.append(m_entry);
+    }
+    else if (level.context == Context::WeatherItem)
+    {
+        m_entry.weatherCondition = WeatherConditions::instance().intern(
+            m_weatherId, QUtf8StringView(m_weatherMain), QUtf8StringView(m_weatherDescription),
+            QUtf8StringView(m_weatherIcon));
+    }
+    m_levels.removeLast();
+    m_state = m_levels.isEmpty() ? State::Done : State::AfterValue;
+    return nullptr;
+}
+
+const char* ForecastDecoder::endString()
+{
+    if (m_capture)
+        flushSurrogate();
+    if (m_isKey)
+    {
+        resolveKey();
+        m_state = State::Colon;
+        return nullptr;
+    }
+    if (m_field != Field::None)
+        setString(m_field, m_text);
+    endScalar();
+    return nullptr;
+}
+
+const char* ForecastDecoder::endNumber()
+{
+    if (!isValidNumber(m_text))
+        return "Invalid number";
+    if (m_field != Field::None)
+        setNumber(m_field, m_text);
+    endScalar();
+    return nullptr;
+}
+
+void ForecastDecoder::endScalar()
+{
+    m_state = m_levels.isEmpty() ? State::Done : State::AfterValue;
+}
+
+void ForecastDecoder::resolveKey()
+{
+    m_keyField = Field::None;
+    m_keyContext = Context::Skip;
+    const QByteArrayView key = m_text;
+    switch (m_levels.last().context)
+    {
+    case Context::Root:
+        if (key == "city")
+            m_keyContext = Context::City;
+        else if (key == "list")
+            m_keyContext = Context::List;
+        break;
+    case Context::City:
+        if (key == "name")
+            m_keyField = Field::CityName;
+        break;
+    case Context::Entry:
+        if (key == "dt")
+            m_keyField = Field::Dt;
+        else if (key == "main")
+            m_keyContext = Context::Main;
+        else if (key == "weather")
+            m_keyContext = Context::Weather;
+        else if (key == "wind")
+            m_keyContext = Context::Wind;
+        else if (key == "pop")
+            m_keyField = Field::Pop;
+        else if (key == "rain")
+            m_keyContext = Context::Rain;
+        else if (key == "snow")
+            m_keyContext = Context::Snow;
+        else if (key == "clouds")
+            m_keyContext = Context::Clouds;
+        else if (key == "visibility")
+            m_keyField = Field::Visibility;
+        else if (key == "sys")
+            m_keyContext = Context::Sys;
+        break;
+    case Context::Main:
+        if (key == "temp")
+            m_keyField = Field::Temp;
+        else if (key == "temp_min")
+            m_keyField = Field::TempMin;
+        else if (key == "temp_max")
+            m_keyField = Field::TempMax;
+        else if (key == "feels_like")
+            m_keyField = Field::FeelsLike;
+        else if (key == "humidity")
+            m_keyField = Field::Humidity;
+        else if (key == "pressure")
+            m_keyField = Field::Pressure;
+        break;
+    case Context::WeatherItem:
+        if (key == "id")
+            m_keyField = Field::WeatherId;
+        else if (key == "main")
+            m_keyField = Field::WeatherMain;
+        else if (key == "description")
+            m_keyField = Field::WeatherDescription;
+        else if (key == "icon")
+            m_keyField = Field::WeatherIcon;
+        break;
+    case Context::Wind:
+        if (key == "speed")
+            m_keyField = Field::WindSpeed;
+        else if (key == "deg")
+            m_keyField = Field::WindDeg;
+        else if (key == "gust")
+            m_keyField = Field::WindGust;
+        break;
+    case Context::Rain:
+        if (key == "3h")
+            m_keyField = Field::Rain3h;
+        break;
+    case Context::Snow:
+        if (key == "3h")
+            m_keyField = Field::Snow3h;
+        break;
+    case Context::Clouds:
+        if (key == "all")
+            m_keyField = Field::Clouds;
+        break;
+    case Context::Sys:
+        if (key == "pod")
+            m_keyField = Field::PartOfDay;
+        break;
+    default:
+        break;
+    }
+}
+
+void ForecastDecoder::appendCodePoint(uint codeUnit)
+{
+    uint codePoint = codeUnit;
+    if (codeUnit >= 0xD800 && codeUnit <= 0xDBFF)
+    {
+        flushSurrogate();
+        m_highSurrogate = codeUnit;
+        return;
+    }
+    if (codeUnit >= 0xDC00 && codeUnit <= 0xDFFF)
+    {
+        codePoint = m_highSurrogate ? 0x10000 + ((m_highSurrogate - 0xD800) << 10) + (codeUnit - 0xDC00) : 0xFFFD;
+        m_highSurrogate = 0;
+    }
+    else
+    {
+        flushSurrogate();
+    }
+
+    // UTF-8
+    if (codePoint < 0x80)
+    {
+        m_text.append(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        m_text.append(static_cast<char>(0xC0 | (codePoint >> 6)));
+        m_text.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        m_text.append(static_cast<char>(0xE0 | (codePoint >> 12)));
+        m_text.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_text.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        m_text.append(static_cast<char>(0xF0 | (codePoint >> 18)));
+        m_text.append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        m_text.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_text.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+void ForecastDecoder::flushSurrogate()
+{
+    // A high surrogate without a low one
+    if (m_highSurrogate)
+    {
+        m_highSurrogate = 0;
+        m_text.append("\xEF\xBF\xBD"); // U+FFFD
+    }
+}
+
+void ForecastDecoder::setNumber(Field field, const QByteArray &text)
+{
+    const double value = text.toDouble();
+    switch (field)
+    {
+    case Field::Dt:
+    {
+        bool isInteger = false;
+        const qint64 dt = text.toLongLong(&isInteger);
+        m_entry.dt = isInteger ? dt : static_cast<qint64>(value);
+        break;
+    }
+    case Field::WeatherId:
+    {
+        // The API sends the id as a number
+        bool isInteger = false;
+        const int id = text.toInt(&isInteger);
+        m_weatherId = isInteger ? id : 0;
+        break;
+    }
+    case Field::Temp: m_entry.mainTemp = value; break;
+    case Field::TempMin: m_entry.mainTempMin = value; break;
+    case Field::TempMax: m_entry.mainTempMax = value; break;
+    case Field::WindSpeed: m_entry.windSpeed = value; break;
+    case Field::Pop: m_entry.pop = value; break;
+    case Field::Rain3h: m_entry.rain3h = value; break;
+    case Field::Snow3h: m_entry.snow3h = value; break;
+    case Field::FeelsLike: m_entry.setFeelsLike(value); break;
+    case Field::Humidity: m_entry.setHumidity(value); break;
+    case Field::Pressure: m_entry.setPressure(value); break;
+    case Field::Clouds: m_entry.setClouds(value); break;
+    case Field::WindDeg: m_entry.setWindDeg(value); break;
+    case Field::WindGust: m_entry.setWindGust(value); break;
+    case Field::Visibility: m_entry.setVisibility(value); break;
+    default: break; // A number where a string is expected
+    }
+}
+
+void ForecastDecoder::setString(Field field, const QByteArray &text)
+{
+    switch (field)
+    {
+    case Field::CityName: m_cityName = QString::fromUtf8(text); break;
+    case Field::WeatherId: m_weatherId = text.toInt(); break;
+    case Field::WeatherMain: m_weatherMain.assign(text); break;
+    case Field::WeatherDescription: m_weatherDescription.assign(text); break;
+    case Field::WeatherIcon: m_weatherIcon.assign(text); break;
+    case Field::PartOfDay: m_entry.partOfDay = ForecastEntry::partOfDayFromString(QUtf8StringView(text)); break;
+    default: break; // A string where a number is expected
+    }
+}
+
+bool ForecastDecoder::fail(const char *message, qint64 offset)
+{
+    m_state = State::Error;
+    m_error = message;
+    m_errorOffset = offset;
+    return false;
+}
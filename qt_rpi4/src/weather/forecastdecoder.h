@@ -0,0 +1,135 @@
+#ifndef FORECASTDECODER_H
+#define FORECASTDECODER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include <QVarLengthArray>
+#include "forecastentry.h"
+
+/*
+ * Streaming decoder of the OpenWeather forecast reply, fed with the chunks of readyRead().
+ *
+ * The JSON is decoded in a single pass, byte by byte, straight into ForecastEntry values: no
+ * QJsonDocument is built and no chunk is kept once it has been fed. Only the fields the
+ * ForecastEntry has (and city.name) are converted; the values of all other fields are checked
+ * for well-formedness and skipped without creating strings. Malformed input is reported with
+ * the offset of the offending byte in the whole reply.
+ *
+ *   decoder.reset();
+ *   connect(reply, &QNetworkReply::readyRead, ... decoder.feed(reply->readAll()) ...);
+ *   // finished:
+ *   if (decoder.finish())
+ *       model.setForecast(decoder.cityName(), decoder.takeEntries());
+ */
+class ForecastDecoder
+{
+public:
+    ForecastDecoder();
+
+    // Forgets everything, for the next reply
+    void reset();
+    // Decodes the next chunk. False once the input is malformed, further chunks are ignored then.
+    bool feed(QByteArrayView data);
+    // End of the input: false if it is malformed or incomplete
+    bool finish();
+    // reset(), feed() and finish() for a whole document
+    bool decode(QByteArrayView document);
+
+    bool hasError() const;
+    // E.g. "Invalid escape sequence at byte 1234"
+    QString errorString() const;
+    // Offset of the malformed byte, -1 if there is no error
+    qint64 errorOffset() const;
+
+    QString cityName() const;
+    qsizetype entryCount() const;
+    QList<ForecastEntry> takeEntries();
+
+private:
+    enum class State : quint8
+    {
+        Value,      // After ':' or ',' in an array
+        FirstValue, // After '[': a value or ']'
+        FirstKey,   // After '{': a key or '}'
+        Key,        // After ',' in an object
+        Colon,
+        AfterValue, // ',' or the end of the container
+        String,
+        Escape,
+        Unicode,    // The hex digits of \uXXXX
+        Number,
+        Literal,    // true, false or null
+        Done,       // Only whitespace may follow
+        Error
+    };
+
+    // What an object or array is, from its path in the reply
+    enum class Context : quint8
+    {
+        Skip, Root, City, List, Entry, Main, Weather, WeatherItem, Wind, Rain, Snow, Clouds, Sys
+    };
+
+    // The member of the entry a scalar value goes to
+    enum class Field : quint8
+    {
+        None, CityName, Dt, Temp, TempMin, TempMax, WeatherId, WeatherMain, WeatherDescription,
+        WeatherIcon, WindSpeed, Pop, Rain3h, Snow3h, FeelsLike, Humidity, Pressure, Clouds, WindDeg,
+        WindGust, Visibility, PartOfDay
+    };
+
+    struct Level
+    {
+        Context context;
+        bool isArray;
+        int count; // Values so far, for arrays
+    };
+
+    static constexpr int MaxDepth = 64;
+
+    // The handlers return an error message, nullptr if the byte is valid
+    const char* beginValue(char c, qint64 offset);
+    const char* endContainer(char c);
+    const char* endString();
+    const char* endNumber();
+    void endScalar();
+    void resolveKey();
+    void appendCodePoint(uint codeUnit);
+    void flushSurrogate();
+    void setNumber(Field field, const QByteArray& text);
+    void setString(Field field, const QByteArray& text);
+    bool fail(const char* message, qint64 offset);
+
+    State m_state = State::Value;
+    QVarLengthArray<Level, 16> m_levels;
+    // Of the current key, for the value that follows
+    Field m_keyField = Field::None;
+    Context m_keyContext = Context::Skip;
+    // Of the current scalar value or key
+    Field m_field = Field::None;
+    bool m_isKey = false;
+    bool m_capture = false; // Whether the characters of the string are kept
+    QByteArray m_text;      // Key, captured string (UTF-8) or number
+    qint64 m_tokenOffset = 0;
+    const char* m_literal = nullptr;
+    int m_literalIndex = 0;
+    uint m_unicode = 0;
+    int m_unicodeDigits = 0;
+    uint m_highSurrogate = 0; // Of a \uXXXX pair, waiting for the low one
+
+    qint64 m_offset = 0; // Of the next chunk
+    qint64 m_errorOffset = -1;
+    const char* m_error = nullptr;
+
+    ForecastEntry m_entry; // The entry being decoded
+    // The condition of the entry (UTF-8), interned once its object has ended
+    int m_weatherId = 0;
+    QByteArray m_weatherMain;
+    QByteArray m_weatherDescription;
+    QByteArray m_weatherIcon;
+    QList<ForecastEntry> m_entries;
+    QString m_cityName;
+};
+
+#endif // FORECASTDECODER_H
@@ -0,0 +1,221 @@
+#include "forecastentry.h"
+#include <QJsonArray>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Rounds value * scale to the nearest T, clamped to the range of T without the value which
+// marks a missing one (ForecastEntry::Missing*)
+template<typename T>
+T quantise(double value, double scale = 1)
+{
+    const double scaled = std::round(value * scale);
+    if (std::isnan(scaled))
+        return T(0);
+    const double minimum = std::numeric_limits<T>::is_signed ? double(std::numeric_limits<T>::min()) + 1 : 0;
+    const double maximum = std::numeric_limits<T>::is_signed ? double(std::numeric_limits<T>::max())
+                                                             : double(std::numeric_limits<T>::max()) - 1;
+    return T(qBound(minimum, scaled, maximum));
+}
+
+quint8 quantisePercent(double percent)
+{
+    return qMin(quantise<quint8>(percent), quint8(100));
+}
+
+// A value that is missing or isn't a number leaves the member missing
+void setNumber(ForecastEntry& entry, void (ForecastEntry::*set)(double), const QJsonValue& value)
+{
+    if (value.isDouble())
+        (entry.*set)(value.toDouble());
+}
+
+} // namespace
+
+ForecastEntry ForecastEntry::fromJson(const QJsonObject &data, bool isCurrent)
+{
+    ForecastEntry entry;
+    entry.isCurrent = isCurrent;
+
+    // Extract time of data forecast as UNIX timestamp in seconds
+    entry.dt = data["dt"].toInteger();
+
+    // Extract "main" properties
+    const QJsonObject mainObject = data["main"].toObject();
+    entry.mainTemp = mainObject["temp"].toDouble();
+    entry.mainTempMin = mainObject["temp_min"].toDouble();
+    entry.mainTempMax = mainObject["temp_max"].toDouble();
+    setNumber(entry, &ForecastEntry::setFeelsLike, mainObject["feels_like"]);
+    setNumber(entry, &ForecastEntry::setHumidity, mainObject["humidity"]);
+    setNumber(entry, &ForecastEntry::setPressure, mainObject["pressure"]);
+
+    // Extract "weather" properties, the API sends the id as a number
+    const QJsonObject weatherObject = data["weather"].toArray().at(0).toObject();
+    if (!weatherObject.isEmpty())
+    {
+        const QJsonValue weatherId = weatherObject["id"];
+        entry.setWeather(weatherId.isDouble() ? weatherId.toInt() : weatherId.toString().toInt(),
+                         weatherObject["main"].toString(), weatherObject["description"].toString(),
+                         weatherObject["icon"].toString());
+    }
+
+    // Extract "wind", "pop", "rain" and "snow" properties
+    const QJsonObject windObject = data["wind"].toObject();
+    entry.windSpeed = windObject["speed"].toDouble();
+    setNumber(entry, &ForecastEntry::setWindDeg, windObject["deg"]);
+    setNumber(entry, &ForecastEntry::setWindGust, windObject["gust"]);
+    entry.pop = data["pop"].toDouble();
+    entry.rain3h = data["rain"].toObject().value("3h").toDouble();
+    entry.snow3h = data["snow"].toObject().value("3h").toDouble();
+
+    // Extract "clouds", "visibility" and "sys" properties
+    setNumber(entry, &ForecastEntry::setClouds, data["clouds"].toObject().value("all"));
+    setNumber(entry, &ForecastEntry::setVisibility, data["visibility"]);
+    entry.partOfDay = partOfDayFromString(data["sys"].toObject().value("pod").toString());
+    return entry;
+}
+
+QDateTime ForecastEntry::dateAndTime() const
+{
+    return QDateTime::fromSecsSinceEpoch(dt);
+}
+
+void ForecastEntry::setWeather(int id, QAnyStringView main, QAnyStringView description, QAnyStringView icon)
+{
+    weatherCondition = WeatherConditions::instance().intern(id, main, description, icon);
+}
+
+const WeatherCondition &ForecastEntry::weather() const
+{
+    return WeatherConditions::instance().condition(weatherCondition);
+}
+
+QString ForecastEntry::weatherId() const
+{
+    return weatherCondition == WeatherConditions::Unknown ? QString() : QString::number(weather().id);
+}
+
+QString ForecastEntry::weatherMain() const
+{
+    return weather().main;
+}
+
+QString ForecastEntry::weatherDescription() const
+{
+    return weather().description;
+}
+
+QString ForecastEntry::weatherIcon() const
+{
+    return weather().icon;
+}
+
+bool ForecastEntry::has(Field field) const
+{
+    return (presentFields() & field) != 0;
+}
+
+int ForecastEntry::presentFields() const
+{
+    int fields = 0;
+    if (feelsLikeCentidegrees != MissingInt16)
+        fields |= FeelsLike;
+    if (humidityPercent != MissingUInt8)
+        fields |= Humidity;
+    if (pressureHpa != MissingUInt16)
+        fields |= Pressure;
+    if (cloudsPercent != MissingUInt8)
+        fields |= Clouds;
+    if (windDegrees != MissingUInt16)
+        fields |= WindDeg;
+    if (windGustCentimetres != MissingUInt16)
+        fields |= WindGust;
+    if (visibilityMetres != MissingUInt16)
+        fields |= Visibility;
+    return fields;
+}
+
+double ForecastEntry::feelsLike() const
+{
+    return has(FeelsLike) ? feelsLikeCentidegrees / 100.0 : std::numeric_limits<double>::quiet_NaN();
+}
+
+void ForecastEntry::setFeelsLike(double celsius)
+{
+    feelsLikeCentidegrees = quantise<qint16>(celsius, 100);
+}
+
+int ForecastEntry::humidity() const
+{
+    return has(Humidity) ? humidityPercent : -1;
+}
+
+void ForecastEntry::setHumidity(double percent)
+{
+    humidityPercent = quantisePercent(percent);
+}
+
+int ForecastEntry::pressure() const
+{
+    return has(Pressure) ? pressureHpa : -1;
+}
+
+void ForecastEntry::setPressure(double hectopascals)
+{
+    pressureHpa = quantise<quint16>(hectopascals);
+}
+
+int ForecastEntry::clouds() const
+{
+    return has(Clouds) ? cloudsPercent : -1;
+}
+
+void ForecastEntry::setClouds(double percent)
+{
+    cloudsPercent = quantisePercent(percent);
+}
+
+int ForecastEntry::windDeg() const
+{
+    return has(WindDeg) ? windDegrees : -1;
+}
+
+void ForecastEntry::setWindDeg(double degrees)
+{
+    windDegrees = quantise<quint16>(degrees);
+}
+
+double ForecastEntry::windGust() const
+{
+    return has(WindGust) ? windGustCentimetres / 100.0 : std::numeric_limits<double>::quiet_NaN();
+}
+
+void ForecastEntry::setWindGust(double metresPerSecond)
+{
+    windGustCentimetres = quantise<quint16>(metresPerSecond, 100);
+}
+
+int ForecastEntry::visibility() const
+{
+    return has(Visibility) ? visibilityMetres : -1;
+}
+
+void ForecastEntry::setVisibility(double metres)
+{
+    visibilityMetres = quantise<quint16>(metres);
+}
+
+bool ForecastEntry::isDaytime() const
+{
+    return partOfDay == PartOfDay::Day;
+}
+
+ForecastEntry::PartOfDay ForecastEntry::partOfDayFromString(QAnyStringView pod)
+{
+    if (QAnyStringView::equal(pod, u"d"))
+        return PartOfDay::Day;
+    if (QAnyStringView::equal(pod, u"n"))
+        return PartOfDay::Night;
+    return PartOfDay::Unknown;
+}
@@ -0,0 +1,140 @@
+#ifndef FORECASTENTRY_H
+#define FORECASTENTRY_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QString>
+#include <limits>
+#include "weatherconditions.h"
+
+/*
+ * One entry of the "list" array of the OpenWeather forecast, as a plain value.
+ *
+ * The WeatherModel keeps the entries of a fetch in one QList, so a fetch is a single
+ * allocation for the list, without a QObject, meta-object and objectName per entry. The weather
+ * condition is an index in WeatherConditions, its strings are shared by all entries. The city
+ * name is the same for all entries and is kept by the model. The properties make an entry
+ * readable from QML, e.g. weatherModel.get(0).mainTemp; WeatherData wraps one for the places
+ * that need a QObject.
+ *
+ * The values for the evapotranspiration (feels like, humidity, pressure, clouds, wind direction
+ * and gusts, visibility, part of the day) are stored quantised in 16 bits or less, so an entry
+ * is 80 bytes: a year of three-hourly history takes about 230 KB. Their setters round and clamp
+ * to the range of the member. A value which wasn't in the reply is stored as the largest value
+ * of its member (the smallest for feelsLikeCentidegrees), so it is never mistaken for a real 0;
+ * has() and presentFields() tell which ones are there.
+ */
+struct ForecastEntry
+{
+    Q_GADGET
+    Q_PROPERTY(bool isCurrent MEMBER isCurrent)
+    Q_PROPERTY(qint64 dt MEMBER dt)
+    Q_PROPERTY(QDateTime dateAndTime READ dateAndTime)
+    Q_PROPERTY(QString weatherId READ weatherId)
+    Q_PROPERTY(QString weatherMain READ weatherMain)
+    Q_PROPERTY(QString weatherDescription READ weatherDescription)
+    Q_PROPERTY(QString weatherIcon READ weatherIcon)
+    Q_PROPERTY(double mainTemp MEMBER mainTemp)
+    Q_PROPERTY(double mainTempMin MEMBER mainTempMin)
+    Q_PROPERTY(double mainTempMax MEMBER mainTempMax)
+    Q_PROPERTY(double windSpeed MEMBER windSpeed)
+    Q_PROPERTY(double snow3h MEMBER snow3h)
+    Q_PROPERTY(double rain3h MEMBER rain3h)
+    Q_PROPERTY(double pop MEMBER pop)
+    Q_PROPERTY(double feelsLike READ feelsLike)
+    Q_PROPERTY(int humidity READ humidity)
+    Q_PROPERTY(int pressure READ pressure)
+    Q_PROPERTY(int clouds READ clouds)
+    Q_PROPERTY(int windDeg READ windDeg)
+    Q_PROPERTY(double windGust READ windGust)
+    Q_PROPERTY(int visibility READ visibility)
+    Q_PROPERTY(bool isDaytime READ isDaytime)
+    Q_PROPERTY(int presentFields READ presentFields)
+
+public:
+    // sys.pod of the API
+    enum class PartOfDay : quint8
+    {
+        Unknown, Day, Night
+    };
+    Q_ENUM(PartOfDay)
+
+    // The quantised values which may be missing, flags of presentFields()
+    enum Field : quint8
+    {
+        FeelsLike = 0x01,
+        Humidity = 0x02,
+        Pressure = 0x04,
+        Clouds = 0x08,
+        WindDeg = 0x10,
+        WindGust = 0x20,
+        Visibility = 0x40
+    };
+    Q_ENUM(Field)
+
+    // Stored for the quantised values which are missing
+    static constexpr qint16 MissingInt16 = std::numeric_limits<qint16>::min();
+    static constexpr quint16 MissingUInt16 = std::numeric_limits<quint16>::max();
+    static constexpr quint8 MissingUInt8 = std::numeric_limits<quint8>::max();
+
+    // Missing values are left at their defaults, the quantised ones are marked as missing
+    static ForecastEntry fromJson(const QJsonObject& data, bool isCurrent = false);
+
+    QDateTime dateAndTime() const;
+
+    // Interns the condition, see WeatherConditions
+    void setWeather(int id, QAnyStringView main, QAnyStringView description, QAnyStringView icon);
+    const WeatherCondition& weather() const;
+    QString weatherId() const; // Weather condition id, e.g. "804", empty without a condition
+    QString weatherMain() const; // e.g. "Clouds"
+    QString weatherDescription() const; // e.g. "overcast clouds"
+    QString weatherIcon() const; // Weather icon id
+
+    bool has(Field field) const;
+    int presentFields() const; // Field flags
+
+    // The quantised values in their units, -1 (NaN for the doubles) if missing
+    double feelsLike() const; // [°C]
+    void setFeelsLike(double celsius);
+    int humidity() const; // [%]
+    void setHumidity(double percent);
+    int pressure() const; // [hPa]
+    void setPressure(double hectopascals);
+    int clouds() const; // Cloudiness [%]
+    void setClouds(double percent);
+    int windDeg() const; // Wind direction [°]
+    void setWindDeg(double degrees);
+    double windGust() const; // [m/s]
+    void setWindGust(double metresPerSecond);
+    int visibility() const; // [m]
+    void setVisibility(double metres);
+    bool isDaytime() const;
+    // "d" or "n", anything else is PartOfDay::Unknown
+    static PartOfDay partOfDayFromString(QAnyStringView pod);
+
+    qint64 dt = 0; // Unix timestamp in seconds, UTC
+    double mainTemp = 0; // Temperature
+    double mainTempMin = 0; // Min. Temperature
+    double mainTempMax = 0; // Max. Temperature
+    double windSpeed = 0; // Wind speed [m/s]
+    double snow3h = 0; // Snow volume for the last 3 hours [mm]
+    double rain3h = 0; // Rain volume for the last 3 hours [mm]
+    double pop = 0; // Probability of precipitation, 0..1
+    qint16 feelsLikeCentidegrees = MissingInt16; // [0.01 °C]
+    quint16 pressureHpa = MissingUInt16; // Pressure at sea level [hPa]
+    quint16 windDegrees = MissingUInt16; // Meteorological wind direction [°]
+    quint16 windGustCentimetres = MissingUInt16; // [cm/s]
+    quint16 visibilityMetres = MissingUInt16; // The API reports at most 10 km
+    WeatherConditions::Index weatherCondition = WeatherConditions::Unknown; // Equal for equal conditions
+    quint8 humidityPercent = MissingUInt8;
+    quint8 cloudsPercent = MissingUInt8;
+    PartOfDay partOfDay = PartOfDay::Unknown;
+    bool isCurrent = false; // The current weather, i.e. the first entry of a fetch
+};
+
+static_assert(sizeof(ForecastEntry) <= 80, "A forecast entry should stay within 80 bytes");
+
+Q_DECLARE_METATYPE(ForecastEntry)
+
+#endif // FORECASTENTRY_H
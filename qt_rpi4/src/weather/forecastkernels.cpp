@@ -0,0 +1,286 @@
+#include "forecastkernels.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FORECASTKERNELS_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FORECASTKERNELS_NEON
+#endif
+
+namespace {
+
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+// Longer windows are summed with a running sum and their maximum is taken from block maxima,
+// instead of going over every value of every window
+constexpr qsizetype ShortWindow = 16;
+
+qsizetype windowCount(qsizetype count, qsizetype window)
+{
+    return window > 0 && window <= count ? count - window + 1 : 0;
+}
+
+// Sum of a long window from the previous one, in double so that the rounding errors don't add up
+qsizetype runningWindowSum(const float* values, qsizetype count, qsizetype window, float* out)
+{
+    const qsizetype windows = windowCount(count, window);
+    double running = 0;
+    for (qsizetype i = 0; i < window; ++i)
+        running += values[i];
+    out[0] = float(running);
+    for (qsizetype i = 1; i < windows; ++i)
+    {
+        running += double(values[i + window - 1]) - double(values[i - 1]);
+        out[i] = float(running);
+    }
+    return windows;
+}
+
+// Maximum of long windows in O(count), however long they are (van Herk/Gil-Werman). The values
+// are cut into blocks of window values; every window is the end of one block and the beginning
+// of the next, so its maximum is the larger of a suffix and a prefix maximum of the blocks.
+qsizetype blockWindowMax(const float* values, qsizetype count, qsizetype window, float* out)
+{
+    const qsizetype windows = windowCount(count, window);
+    for (qsizetype start = 0; start < windows; start += window)
+    {
+        // The suffix maxima of the block, stored in out where a window starts
+        const qsizetype end = std::min(start + window, windows);
+        float suffix = ForecastKernels::Scalar::max(values + end, start + window - end);
+        for (qsizetype i = end - 1; i >= start; --i)
+        {
+            suffix = std::max(suffix, values[i]);
+            out[i] = suffix;
+        }
+        // Combined with the prefix maxima of the next block, where the windows end
+        float prefix = -Infinity;
+        for (qsizetype i = start; i < end; ++i)
+        {
+            prefix = std::max(prefix, values[i + window - 1]);
+            out[i] = std::max(out[i], prefix);
+        }
+    }
+    return windows;
+}
+
+#if defined(FORECASTKERNELS_SSE2) || defined(FORECASTKERNELS_NEON)
+
+// The few vector operations the kernels need, with four floats per vector
+#if defined(FORECASTKERNELS_SSE2)
+using Vector = __m128;
+inline Vector load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+inline Vector splat(float value) { return _mm_set1_ps(value); }
+inline Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+inline Vector minimum(Vector a, Vector b) { return _mm_min_ps(a, b); }
+inline Vector maximum(Vector a, Vector b) { return _mm_max_ps(a, b); }
+inline float lane(Vector v) { return _mm_cvtss_f32(v); }
+// Combines the lanes pairwise: {0 op 1, ..} and then {0 op 2, ..}
+template<Vector (*op)(Vector, Vector)>
+inline float reduce(Vector v)
+{
+    v = op(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = op(v, _mm_movehl_ps(v, v));
+    return lane(v);
+}
+#else
+using Vector = float32x4_t;
+inline Vector load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, Vector v) { vst1q_f32(p, v); }
+inline Vector splat(float value) { return vdupq_n_f32(value); }
+inline Vector add(Vector a, Vector b) { return vaddq_f32(a, b); }
+inline Vector minimum(Vector a, Vector b) { return vminq_f32(a, b); }
+inline Vector maximum(Vector a, Vector b) { return vmaxq_f32(a, b); }
+inline float lane(Vector v) { return vgetq_lane_f32(v, 0); }
+template<Vector (*op)(Vector, Vector)>
+inline float reduce(Vector v)
+{
+    // vrev64q swaps the lanes of each half, vcombine swaps the halves
+    v = op(v, vrev64q_f32(v));
+    v = op(v, vcombine_f32(vget_high_f32(v), vget_low_f32(v)));
+    return lane(v);
+}
+#endif
+
+// Folds all values with op, four vectors at a time. Returns the folded vector, and the index of
+// the first value that didn't fill a vector.
+template<Vector (*op)(Vector, Vector)>
+Vector fold(const float* values, qsizetype count, Vector identity, qsizetype* rest)
+{
+    Vector a0 = identity, a1 = identity, a2 = identity, a3 = identity;
+    qsizetype i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        a0 = op(a0, load(values + i));
+        a1 = op(a1, load(values + i + 4));
+        a2 = op(a2, load(values + i + 8));
+        a3 = op(a3, load(values + i + 12));
+    }
+    for (; i + 4 <= count; i += 4)
+        a0 = op(a0, load(values + i));
+    *rest = i;
+    return op(op(a0, a1), op(a2, a3));
+}
+
+// Every window, four windows at a time: the values are added shifted by 0 .. window - 1
+template<Vector (*op)(Vector, Vector)>
+qsizetype shiftedWindows(const float* values, qsizetype count, qsizetype window, float* out, float (*scalar)(const float*, qsizetype))
+{
+    const qsizetype windows = windowCount(count, window);
+    qsizetype i = 0;
+    for (; i + 4 <= windows; i += 4)
+    {
+        Vector result = load(values + i);
+        for (qsizetype k = 1; k < window; ++k)
+            result = op(result, load(values + i + k));
+        store(out + i, result);
+    }
+    for (; i < windows; ++i)
+        out[i] = scalar(values + i, window);
+    return windows;
+}
+
+#endif
+
+} // namespace
+
+float ForecastKernels::Scalar::sum(const float *values, qsizetype count)
+{
+    // Four sums, so that the additions don't wait for each other
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        s0 += values[i];
+        s1 += values[i + 1];
+        s2 += values[i + 2];
+        s3 += values[i + 3];
+    }
+    for (; i < count; ++i)
+        s0 += values[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+float ForecastKernels::Scalar::min(const float *values, qsizetype count)
+{
+    float result = Infinity;
+    for (qsizetype i = 0; i < count; ++i)
+        result = std::min(result, values[i]);
+    return result;
+}
+
+float ForecastKernels::Scalar::max(const float *values, qsizetype count)
+{
+    float result = -Infinity;
+    for (qsizetype i = 0; i < count; ++i)
+        result = std::max(result, values[i]);
+    return result;
+}
+
+qsizetype ForecastKernels::Scalar::windowSum(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    const qsizetype windows = windowCount(count, window);
+    if (window > ShortWindow && windows > 0)
+        return runningWindowSum(values, count, window, out);
+    for (qsizetype i = 0; i < windows; ++i)
+        out[i] = Scalar::sum(values + i, window);
+    return windows;
+}
+
+qsizetype ForecastKernels::Scalar::windowMax(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    const qsizetype windows = windowCount(count, window);
+    if (window > ShortWindow && windows > 0)
+        return blockWindowMax(values, count, window, out);
+    for (qsizetype i = 0; i < windows; ++i)
+        out[i] = Scalar::max(values + i, window);
+    return windows;
+}
+
+#if defined(FORECASTKERNELS_SSE2) || defined(FORECASTKERNELS_NEON)
+
+const char *ForecastKernels::instructionSet()
+{
+#if defined(FORECASTKERNELS_SSE2)
+    return "SSE2";
+#else
+    return "NEON";
+#endif
+}
+
+float ForecastKernels::sum(const float *values, qsizetype count)
+{
+    qsizetype i = 0;
+    float result = reduce<add>(fold<add>(values, count, splat(0), &i));
+    for (; i < count; ++i)
+        result += values[i];
+    return result;
+}
+
+float ForecastKernels::min(const float *values, qsizetype count)
+{
+    qsizetype i = 0;
+    float result = reduce<minimum>(fold<minimum>(values, count, splat(Infinity), &i));
+    for (; i < count; ++i)
+        result = std::min(result, values[i]);
+    return result;
+}
+
+float ForecastKernels::max(const float *values, qsizetype count)
+{
+    qsizetype i = 0;
+    float result = reduce<maximum>(fold<maximum>(values, count, splat(-Infinity), &i));
+    for (; i < count; ++i)
+        result = std::max(result, values[i]);
+    return result;
+}
+
+qsizetype ForecastKernels::windowSum(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    if (window > ShortWindow && windowCount(count, window) > 0)
+        return runningWindowSum(values, count, window, out);
+    return shiftedWindows<add>(values, count, window, out, &ForecastKernels::sum);
+}
+
+qsizetype ForecastKernels::windowMax(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    if (window > ShortWindow && windowCount(count, window) > 0)
+        return blockWindowMax(values, count, window, out);
+    return shiftedWindows<maximum>(values, count, window, out, &ForecastKernels::max);
+}
+
+#else
+
+const char *ForecastKernels::instructionSet()
+{
+    return "scalar";
+}
+
+float ForecastKernels::sum(const float *values, qsizetype count)
+{
+    return Scalar::sum(values, count);
+}
+
+float ForecastKernels::min(const float *values, qsizetype count)
+{
+    return Scalar::min(values, count);
+}
+
+float ForecastKernels::max(const float *values, qsizetype count)
+{
+    return Scalar::max(values, count);
+}
+
+qsizetype ForecastKernels::windowSum(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    return Scalar::windowSum(values, count, window, out);
+}
+
+qsizetype ForecastKernels::windowMax(const float *values, qsizetype count, qsizetype window, float *out)
+{
+    return Scalar::windowMax(values, count, window, out);
+}
+
+#endif
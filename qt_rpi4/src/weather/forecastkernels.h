@@ -0,0 +1,41 @@
+#ifndef FORECASTKERNELS_H
+#define FORECASTKERNELS_H
+
+#include <QtGlobal>
+
+/*
+ * Aggregation kernels over the float columns of a ForecastSeries.
+ *
+ * They use SSE2 on x86-64 and NEON on the Pi (AArch64, or ARMv7 built with -mfpu=neon), with
+ * four vectors in flight so that the additions don't wait for each other; other targets get the
+ * scalar versions. The results can differ from the scalar versions in the last bits, as the
+ * values are added in another order. Values must not be NaN.
+ */
+namespace ForecastKernels
+{
+    // "SSE2", "NEON" or "scalar"
+    const char* instructionSet();
+
+    float sum(const float* values, qsizetype count);
+    // +infinity if count is 0
+    float min(const float* values, qsizetype count);
+    // -infinity if count is 0
+    float max(const float* values, qsizetype count);
+    // out[i] = sum (max) of values[i] .. values[i + window - 1] for every complete window, i.e.
+    // count - window + 1 values. Returns the number of values written, 0 if window is out of range.
+    // Long windows take O(count) whatever their length.
+    qsizetype windowSum(const float* values, qsizetype count, qsizetype window, float* out);
+    qsizetype windowMax(const float* values, qsizetype count, qsizetype window, float* out);
+
+    // The portable versions, for tests and benchmarks
+    namespace Scalar
+    {
+        float sum(const float* values, qsizetype count);
+        float min(const float* values, qsizetype count);
+        float max(const float* values, qsizetype count);
+        qsizetype windowSum(const float* values, qsizetype count, qsizetype window, float* out);
+        qsizetype windowMax(const float* values, qsizetype count, qsizetype window, float* out);
+    }
+}
+
+#endif // FORECASTKERNELS_H
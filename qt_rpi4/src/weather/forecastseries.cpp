@@ -0,0 +1,175 @@
+#include "forecastseries.h"
+#include <QDateTime>
+#include "forecastkernels.h"
+
+ForecastSeries::ForecastSeries(const QList<ForecastEntry> &entries)
+{
+    assign(entries);
+}
+
+void ForecastSeries::assign(const QList<ForecastEntry> &entries)
+{
+    const qsizetype size = entries.size();
+    m_times.resize(size);
+    m_temperatures.resize(size);
+    m_minTemperatures.resize(size);
+    m_maxTemperatures.resize(size);
+    m_pops.resize(size);
+    m_rains.resize(size);
+    m_snows.resize(size);
+    m_windSpeeds.resize(size);
+
+    qint64* times = m_times.data();
+    float* temperatures = m_temperatures.data();
+    float* minTemperatures = m_minTemperatures.data();
+    float* maxTemperatures = m_maxTemperatures.data();
+    float* pops = m_pops.data();
+    float* rains = m_rains.data();
+    float* snows = m_snows.data();
+    float* windSpeeds = m_windSpeeds.data();
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        const ForecastEntry& entry = entries.at(i);
+        times[i] = entry.dt;
+        temperatures[i] = float(entry.mainTemp);
+        minTemperatures[i] = float(entry.mainTempMin);
+        maxTemperatures[i] = float(entry.mainTempMax);
+        pops[i] = float(entry.pop);
+        rains[i] = float(entry.rain3h);
+        snows[i] = float(entry.snow3h);
+        windSpeeds[i] = float(entry.windSpeed);
+    }
+}
+
+void ForecastSeries::clear()
+{
+    assign(QList<ForecastEntry>());
+}
+
+qsizetype ForecastSeries::size() const
+{
+    return m_times.size();
+}
+
+bool ForecastSeries::isEmpty() const
+{
+    return m_times.isEmpty();
+}
+
+const QList<qint64> &ForecastSeries::times() const
+{
+    return m_times;
+}
+
+const QList<float> &ForecastSeries::temperatures() const
+{
+    return m_temperatures;
+}
+
+const QList<float> &ForecastSeries::minTemperatures() const
+{
+    return m_minTemperatures;
+}
+
+const QList<float> &ForecastSeries::maxTemperatures() const
+{
+    return m_maxTemperatures;
+}
+
+const QList<float> &ForecastSeries::pops() const
+{
+    return m_pops;
+}
+
+const QList<float> &ForecastSeries::rains() const
+{
+    return m_rains;
+}
+
+const QList<float> &ForecastSeries::snows() const
+{
+    return m_snows;
+}
+
+const QList<float> &ForecastSeries::windSpeeds() const
+{
+    return m_windSpeeds;
+}
+
+std::pair<qsizetype, qsizetype> ForecastSeries::range(qsizetype first, qsizetype count) const
+{
+    first = qBound(qsizetype(0), first, size());
+    const qsizetype available = size() - first;
+    return {first, count < 0 ? available : qMin(count, available)};
+}
+
+float ForecastSeries::totalRain(qsizetype first, qsizetype count) const
+{
+    const auto [index, length] = range(first, count);
+    return ForecastKernels::sum(m_rains.constData() + index, length);
+}
+
+float ForecastSeries::maxPop(qsizetype first, qsizetype count) const
+{
+    const auto [index, length] = range(first, count);
+    return length > 0 ? ForecastKernels::max(m_pops.constData() + index, length) : 0;
+}
+
+float ForecastSeries::minTemperature(qsizetype first, qsizetype count) const
+{
+    const auto [index, length] = range(first, count);
+    return length > 0 ? ForecastKernels::min(m_minTemperatures.constData() + index, length) : 0;
+}
+
+float ForecastSeries::maxTemperature(qsizetype first, qsizetype count) const
+{
+    const auto [index, length] = range(first, count);
+    return length > 0 ? ForecastKernels::max(m_maxTemperatures.constData() + index, length) : 0;
+}
+
+float ForecastSeries::meanWindSpeed(qsizetype first, qsizetype count) const
+{
+    const auto [index, length] = range(first, count);
+    return length > 0 ? ForecastKernels::sum(m_windSpeeds.constData() + index, length) / float(length) : 0;
+}
+
+QList<float> ForecastSeries::rainWindows(qsizetype window) const
+{
+    QList<float> windows(window > 0 && window <= size() ? size() - window + 1 : 0);
+    ForecastKernels::windowSum(m_rains.constData(), size(), window, windows.data());
+    return windows;
+}
+
+QList<float> ForecastSeries::popWindows(qsizetype window) const
+{
+    QList<float> windows(window > 0 && window <= size() ? size() - window + 1 : 0);
+    ForecastKernels::windowMax(m_pops.constData(), size(), window, windows.data());
+    return windows;
+}
+
+QList<ForecastSeries::Day> ForecastSeries::days() const
+{
+    QList<Day> days;
+    // The date is looked up only when an entry is past the day of the previous one
+    qint64 dayStart = 0;
+    qint64 nextDayStart = 0;
+    for (qsizetype i = 0; i < size(); ++i)
+    {
+        const qint64 time = m_times.at(i);
+        if (days.isEmpty() || time < dayStart || time >= nextDayStart)
+        {
+            const QDate date = QDateTime::fromSecsSinceEpoch(time).date();
+            dayStart = date.startOfDay().toSecsSinceEpoch();
+            nextDayStart = date.addDays(1).startOfDay().toSecsSinceEpoch();
+            if (days.isEmpty() || days.last().date != date)
+                days.append(Day{date, i, 0, 0, 0});
+        }
+        ++days.last().count;
+    }
+    for (Day& day : days)
+    {
+        day.minTemperature = minTemperature(day.first, day.count);
+        day.maxTemperature = maxTemperature(day.first, day.count);
+    }
+    return days;
+}
@@ -0,0 +1,81 @@
+#ifndef FORECASTSERIES_H
+#define FORECASTSERIES_H
+
+#include <QDate>
+#include <QList>
+#include <utility>
+#include "forecastentry.h"
+
+/*
+ * The numeric values of a forecast as columns, one float per entry, for the aggregates the
+ * irrigation needs over the forecast horizon: total rain, highest probability of precipitation,
+ * temperature range per day and mean wind speed.
+ *
+ * The aggregates run over contiguous floats with ForecastKernels, instead of walking the entries.
+ * The WeatherModel rebuilds its series with every fetch.
+ *
+ *   const ForecastSeries& series = weatherModel.series();
+ *   if (series.totalRain(0, 8) < 2.0f) ... // Less than 2 mm within the next 24 hours
+ */
+class ForecastSeries
+{
+public:
+    // The temperature range of a day, in local time
+    struct Day
+    {
+        QDate date;
+        qsizetype first = 0; // Index of the first entry of the day
+        qsizetype count = 0;
+        float minTemperature = 0;
+        float maxTemperature = 0;
+    };
+
+    ForecastSeries() = default;
+    explicit ForecastSeries(const QList<ForecastEntry>& entries);
+
+    // Replaces the values, the columns keep their capacity
+    void assign(const QList<ForecastEntry>& entries);
+    void clear();
+    qsizetype size() const;
+    bool isEmpty() const;
+
+    // The columns, in the order of the entries
+    const QList<qint64>& times() const; // ForecastEntry::dt
+    const QList<float>& temperatures() const;
+    const QList<float>& minTemperatures() const;
+    const QList<float>& maxTemperatures() const;
+    const QList<float>& pops() const;
+    const QList<float>& rains() const; // rain3h
+    const QList<float>& snows() const; // snow3h
+    const QList<float>& windSpeeds() const;
+
+    // Aggregates over count entries from first on, count -1 is up to the last entry. The range
+    // is clamped to the series. An empty range gives 0.
+    float totalRain(qsizetype first = 0, qsizetype count = -1) const;
+    float maxPop(qsizetype first = 0, qsizetype count = -1) const;
+    float minTemperature(qsizetype first = 0, qsizetype count = -1) const; // Of the minimum temperatures
+    float maxTemperature(qsizetype first = 0, qsizetype count = -1) const; // Of the maximum temperatures
+    float meanWindSpeed(qsizetype first = 0, qsizetype count = -1) const;
+    // The rain within window entries from every entry on, e.g. 8 entries of 3 hours for a day.
+    // Empty if the series is shorter than the window.
+    QList<float> rainWindows(qsizetype window) const;
+    // The highest probability of precipitation within window entries from every entry on
+    QList<float> popWindows(qsizetype window) const;
+    // The temperature range of every day of the series
+    QList<Day> days() const;
+
+private:
+    // The range [first, first + count) clamped to the series, as an index and a length
+    std::pair<qsizetype, qsizetype> range(qsizetype first, qsizetype count) const;
+
+    QList<qint64> m_times;
+    QList<float> m_temperatures;
+    QList<float> m_minTemperatures;
+    QList<float> m_maxTemperatures;
+    QList<float> m_pops;
+    QList<float> m_rains;
+    QList<float> m_snows;
+    QList<float> m_windSpeeds;
+};
+
+#endif // FORECASTSERIES_H
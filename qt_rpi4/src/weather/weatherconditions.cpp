@@ -0,0 +1,61 @@
+#include "weatherconditions.h"
+#include <logcategories.h>
+
+WeatherConditions &WeatherConditions::instance()
+{
+    static WeatherConditions conditions;
+    return conditions;
+}
+
+WeatherConditions::WeatherConditions()
+    : m_conditions{new WeatherCondition[Capacity]}
+{
+}
+
+WeatherConditions::~WeatherConditions()
+{
+}
+
+WeatherConditions::Index WeatherConditions::intern(int id, QAnyStringView main, QAnyStringView description,
+                                                   QAnyStringView icon)
+{
+    // E.g. an empty weather object
+    if (id == 0 && main.isEmpty() && description.isEmpty() && icon.isEmpty())
+        return Unknown;
+
+    QMutexLocker locker(&m_mutex);
+    QVarLengthArray<Index, 2>& indices = m_indices[id];
+    for (Index index : std::as_const(indices))
+    {
+        const WeatherCondition& condition = m_conditions[index];
+        if (QAnyStringView::equal(condition.main, main) && QAnyStringView::equal(condition.description, description)
+            && QAnyStringView::equal(condition.icon, icon))
+            return index;
+    }
+
+    const int size = m_size.load(std::memory_order_relaxed);
+    if (size == Capacity)
+    {
+        locker.unlock();
+        qCWarning(lcWeatherParse) << "Too many weather conditions, condition" << id << "is ignored";
+        return Unknown;
+    }
+    WeatherCondition& condition = m_conditions[size];
+    condition.id = id;
+    condition.main = main.toString();
+    condition.description = description.toString();
+    condition.icon = icon.toString();
+    indices.append(Index(size));
+    m_size.store(size + 1, std::memory_order_release);
+    return Index(size);
+}
+
+const WeatherCondition &WeatherConditions::condition(Index index) const
+{
+    return index < m_size.load(std::memory_order_acquire) ? m_conditions[index] : m_conditions[Unknown];
+}
+
+int WeatherConditions::size() const
+{
+    return m_size.load(std::memory_order_acquire);
+}
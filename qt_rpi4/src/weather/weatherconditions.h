@@ -0,0 +1,61 @@
+#ifndef WEATHERCONDITIONS_H
+#define WEATHERCONDITIONS_H
+
+#include <QAnyStringView>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVarLengthArray>
+#include <atomic>
+#include <memory>
+
+// A weather condition of OpenWeather, e.g. 804 "Clouds" "overcast clouds" "04n"
+struct WeatherCondition
+{
+    int id = 0;
+    QString main;
+    QString description;
+    QString icon;
+};
+
+/*
+ * Interning table of the weather conditions, shared by all forecasts of the process.
+ *
+ * A forecast has a handful of distinct conditions for its 40 entries, so the entries store the
+ * index of their condition here instead of three strings each. The strings are resolved only
+ * where they are displayed (WeatherModel::data()); comparing the conditions of two entries is
+ * comparing two integers. The conditions are looked up by their OpenWeather id; an id has a
+ * few variants at most (day and night icon, the language of the description).
+ *
+ * Conditions are never removed, so an index stays valid for the lifetime of the process.
+ * intern() takes a lock, condition() doesn't and can be called from any thread.
+ */
+class WeatherConditions
+{
+public:
+    using Index = quint16;
+    static constexpr Index Unknown = 0; // No condition, all strings are empty
+    static constexpr int Capacity = 1024;
+
+    // Singleton
+    static WeatherConditions& instance();
+
+    // Index of the condition, added if it isn't known yet. Unknown if the table is full.
+    Index intern(int id, QAnyStringView main, QAnyStringView description, QAnyStringView icon);
+    // The condition of an index returned by intern(), the Unknown condition for any other index
+    const WeatherCondition& condition(Index index) const;
+    // Number of conditions, including the Unknown condition
+    int size() const;
+
+private:
+    WeatherConditions(); // Private constructor to prevent instantiation
+    ~WeatherConditions(); // Private deconstructor
+
+    // Written once before their index is published with m_size
+    std::unique_ptr<WeatherCondition[]> m_conditions;
+    std::atomic<int> m_size{1};
+    QMutex m_mutex; // Serialises intern()
+    QHash<int, QVarLengthArray<Index, 2>> m_indices; // Id -> indices of its variants, guarded by m_mutex
+};
+
+#endif // WEATHERCONDITIONS_H
@@ -1,4 +1,5 @@
 #include "weatherdata.h"
+#include <logcategories.h>
 
 WeatherData::WeatherData(QString objectName,
                          const QJsonObject &data,
@@ -9,136 +10,136 @@ WeatherData::WeatherData(QString objectName,
 {
     setObjectName(objectName);
     m_cityName = cityName;
-    m_isCurrentWeather = isCurrentWeather;
+    m_entry.isCurrent = isCurrentWeather;
 
     if (!data.isEmpty())
     {
-        extractData(data);
-        qDebug() << this << "has been successfully created";
-        // qDebug() << m_qDateTime << "mainTemp:" << m_mainTemp << "mainTempMin:" << m_mainTempMin << "mainTempMax:" << m_mainTempMax;
+        m_entry = ForecastEntry::fromJson(data, isCurrentWeather);
+        qCDebug(lcWeatherParse) << this << "has been successfully created";
     }
     else
     {
-        qWarning() << this << "Weather data - QJsonObject - is empty!";
+        qCWarning(lcWeatherParse) << this << "Weather data - QJsonObject - is empty!";
     }
 
 }
 
+WeatherData::WeatherData(const ForecastEntry &entry, const QString &cityName, QObject *parent)
+    : QObject{parent}, m_entry{entry}, m_cityName{cityName}
+{
+    setObjectName("WeatherData");
+}
+
 WeatherData::~WeatherData()
 {
-    qDebug() << this << "has been destroyed";
+    qCDebug(lcWeatherParse) << this << "has been destroyed";
 }
 
-void WeatherData::extractData(const QJsonObject &data)
+ForecastEntry WeatherData::entry() const
 {
-    // Extract time of data forecast as UNIX timestamp in seconds
-    if (data.contains("dt"))
-    {
-        m_dt = data["dt"].toInt();
-        m_qDateTime = QDateTime::fromSecsSinceEpoch(m_dt);
-    }
+    return m_entry;
+}
 
-    // Extract "main" properties
-    if (data.contains("main"))
-    {
-        QJsonObject mainObject = data["main"].toObject();
-        m_mainTemp = mainObject["temp"].toDouble();
-        m_mainTempMin = mainObject["temp_min"].toDouble();
-        m_mainTempMax = mainObject["temp_max"].toDouble();
-    }
+void WeatherData::setEntry(const ForecastEntry &entry, const QString &cityName)
+{
+    m_entry = entry;
+    m_cityName = cityName;
+    emit dataChanged();
+}
 
-    // Extract "weather" properties
-    if (data.contains("weather"))
-    {
-        QJsonArray weatherArray = data["weather"].toArray();
-        QJsonObject weatherObject = weatherArray.at(0).toObject();
-        m_weatherId = weatherObject["id"].toString();
-        m_weatherMain = weatherObject["main"].toString();
-        m_weatherDescription = weatherObject["description"].toString();
-        m_weatherIcon = weatherObject["icon"].toString();
-    }
+double WeatherData::pop() const
+{
+    return m_entry.pop;
+}
 
-    // Extract "wind" properties
-    if (data.contains("wind"))
-    {
-        QJsonObject windObject = data["wind"].toObject();
-        m_windSpeed = windObject["speed"].toDouble();
-    }
+double WeatherData::feelsLike() const
+{
+    return m_entry.feelsLike();
+}
 
-    // Extract "pop" properties
-    if (data.contains("pop"))
-    {
-        m_pop = data["pop"].toDouble();
-    }
+int WeatherData::humidity() const
+{
+    return m_entry.humidity();
+}
 
-    // Extract "rain" properties
-    if (data.contains("rain"))
-    {
-        QJsonObject rainObject = data["rain"].toObject();
-        m_rain3h = rainObject["3h"].toDouble();
-    }
+int WeatherData::pressure() const
+{
+    return m_entry.pressure();
+}
 
-    // Extract "snow" properties
-    if (data.contains("snow"))
-    {
-        QJsonObject snowObject = data["snow"].toObject();
-        m_snow3h = snowObject["3h"].toDouble();
-    }
+int WeatherData::clouds() const
+{
+    return m_entry.clouds();
 }
 
-double WeatherData::pop() const
+int WeatherData::windDeg() const
+{
+    return m_entry.windDeg();
+}
+
+double WeatherData::windGust() const
+{
+    return m_entry.windGust();
+}
+
+int WeatherData::visibility() const
 {
-    return m_pop;
+    return m_entry.visibility();
+}
+
+bool WeatherData::isDaytime() const
+{
+    return m_entry.isDaytime();
 }
 
 double WeatherData::rain3h() const
 {
-    return m_rain3h;
+    return m_entry.rain3h;
 }
 
 double WeatherData::snow3h() const
 {
-    return m_snow3h;
+    return m_entry.snow3h;
 }
 
 double WeatherData::windSpeed() const
 {
-    return m_windSpeed;
+    return m_entry.windSpeed;
 }
 
 double WeatherData::mainTempMax() const
 {
-    return m_mainTempMax;
+    return m_entry.mainTempMax;
 }
 
 double WeatherData::mainTempMin() const
 {
-    return m_mainTempMin;
+    return m_entry.mainTempMin;
 }
 
 double WeatherData::mainTemp() const
 {
-    return m_mainTemp;
+    return m_entry.mainTemp;
 }
 
 QString WeatherData::weatherIcon() const
 {
-    return m_weatherIcon;
+    return m_entry.weatherIcon();
 }
 
 QString WeatherData::weatherDescription() const
 {
-    return m_weatherDescription;
+    return m_entry.weatherDescription();
 }
 
 QString WeatherData::weatherMain() const
 {
-    return m_weatherMain;
+    return m_entry.weatherMain();
 }
 
 QString WeatherData::weatherId() const
 {
-    return m_weatherId;
+    return m_entry.weatherId();
 }
 
 QString WeatherData::cityName() const
@@ -148,19 +149,15 @@ QString WeatherData::cityName() const
 
 QDateTime WeatherData::qDateTime() const
 {
-    return m_qDateTime;
+    return m_entry.dateAndTime();
 }
 
 int WeatherData::dt() const
 {
-    return m_dt;
+    return static_cast<int>(m_entry.dt);
 }
 
 bool WeatherData::isCurrentWeather() const
 {
-    return m_isCurrentWeather;
+    return m_entry.isCurrent;
 }
-
-
-
-
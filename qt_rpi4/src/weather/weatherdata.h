@@ -5,7 +5,12 @@
 #include <QDateTime>
 #include <QJsonObject>
 #include <QJsonArray>
+#include "forecastentry.h"
 
+/*
+ * QObject wrapper of a ForecastEntry, for QML and other places that need an object with
+ * change notifications. The forecast itself is kept as values in the WeatherModel.
+ */
 class WeatherData : public QObject
 {
     Q_OBJECT
@@ -24,6 +29,14 @@ class WeatherData : public QObject
     Q_PROPERTY(double snow3h READ snow3h NOTIFY dataChanged)
     Q_PROPERTY(double rain3h READ rain3h NOTIFY dataChanged)
     Q_PROPERTY(double pop READ pop NOTIFY dataChanged)
+    Q_PROPERTY(double feelsLike READ feelsLike NOTIFY dataChanged)
+    Q_PROPERTY(int humidity READ humidity NOTIFY dataChanged)
+    Q_PROPERTY(int pressure READ pressure NOTIFY dataChanged)
+    Q_PROPERTY(int clouds READ clouds NOTIFY dataChanged)
+    Q_PROPERTY(int windDeg READ windDeg NOTIFY dataChanged)
+    Q_PROPERTY(double windGust READ windGust NOTIFY dataChanged)
+    Q_PROPERTY(int visibility READ visibility NOTIFY dataChanged)
+    Q_PROPERTY(bool isDaytime READ isDaytime NOTIFY dataChanged)
 
 public:
     explicit WeatherData(QString objectName = "WeatherData",
@@ -31,8 +44,12 @@ public:
                          const QString& cityName = "",
                          const bool isCurrentWeather = false,
                          QObject *parent = nullptr);
+    WeatherData(const ForecastEntry& entry, const QString& cityName, QObject *parent = nullptr);
     ~WeatherData();
 
+    ForecastEntry entry() const;
+    void setEntry(const ForecastEntry& entry, const QString& cityName);
+
     // Properties
     bool isCurrentWeather() const;
     int dt() const;
@@ -49,29 +66,21 @@ public:
     double snow3h() const;
     double rain3h() const;
     double pop() const;
+    double feelsLike() const;
+    int humidity() const;
+    int pressure() const;
+    int clouds() const;
+    int windDeg() const;
+    double windGust() const;
+    int visibility() const;
+    bool isDaytime() const;
 
 signals:
     void dataChanged();
 
 private:
-    void extractData(const QJsonObject &data);
-
-    bool m_isCurrentWeather; // Flag to differentiate between current weather and forecast item
-    int m_dt; // Unix timestamp in seconds
-    QDateTime m_qDateTime; // Time of data forecasted, unix, UTC
+    ForecastEntry m_entry;
     QString m_cityName; // City name
-    QString m_weatherId; // Weahter ID
-    QString m_weatherMain; // e.g. "Clouds"
-    QString m_weatherDescription; // e.g. "overcast clouds"
-    QString m_weatherIcon; // Weather icon id
-    double m_mainTemp; // Temperature
-    double m_mainTempMin; // Min. Temperature
-    double m_mainTempMax; // Max. Temperature
-    double m_windSpeed; // Wind speed [m/s]
-    double m_snow3h; // Snow volume for the last 3 hours [mm]
-    double m_rain3h; // Rain volume for the last 3 hours [mm]
-    double m_pop; // Probability of precipitation [%]
-
 };
 
 #endif // WEATHERDATA_H
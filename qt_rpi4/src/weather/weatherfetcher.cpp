@@ -1,10 +1,12 @@
 #include "weatherfetcher.h"
+#include <logcategories.h>
+#include <logger.h>
 
 WeatherFetcher::WeatherFetcher(QNetworkAccessManager *networkManager, WeatherModel &model, QString apiKey, QObject *parent)
     : QObject{parent}, m_networkManager{networkManager}, m_weatherModel{model}, m_apiKey{apiKey}
 {
     setObjectName("WeatherFetcher");
-    qDebug() << this << "object is being constructed";
+    qCDebug(lcWeatherFetch) << this << "object is being constructed";
     // Create an interval timer and connect it to the fetchWeatherData slot
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, &WeatherFetcher::fetchWeatherData);
@@ -12,12 +14,12 @@ WeatherFetcher::WeatherFetcher(QNetworkAccessManager *networkManager, WeatherMod
 
 WeatherFetcher::~WeatherFetcher()
 {
-    qDebug() << this << "object is being destroyed";
+    qCDebug(lcWeatherFetch) << this << "object is being destroyed";
 }
 
 void WeatherFetcher::fetchWeatherData()
 {
-    qDebug() << this << "fetchWeatherData() is being invoked";
+    qCDebug(lcWeatherFetch) << this << "fetchWeatherData() is being invoked";
     // Create API URL string by replacing placeholders in string with arguments
     QString apiString = m_apiString.arg(m_latitude).arg(m_longitude).arg(m_apiKey);
     if (m_networkManager)
@@ -35,13 +37,13 @@ bool WeatherFetcher::fetchIsFinished() const
 
 void WeatherFetcher::startFetching(int interval)
 {
-    qDebug() << this << "startFetching() with an interval of" << interval << "milliseconds";
+    qCDebug(lcWeatherFetch) << this << "startFetching() with an interval of" << interval << "milliseconds";
     m_timer->start(interval); // Interval in milliseconds
 }
 
 void WeatherFetcher::stopFetching()
 {
-    qDebug() << this << "stopFetching() is being invoked";
+    qCDebug(lcWeatherFetch) << this << "stopFetching() is being invoked";
     m_timer->stop();
 }
 
@@ -49,7 +51,7 @@ QNetworkRequest WeatherFetcher::createWeatherRequest(QString url)
 {
     m_apiUrl.setUrl(url);
     QNetworkRequest request(m_apiUrl);
-    qDebug() << this << "Weather request was created with URL: " << m_apiUrl.toString();
+    qCDebug(lcWeatherFetch) << this << "Weather request was created with URL: " << m_apiUrl.toString();
     return request;
 }
 
@@ -60,42 +62,23 @@ void WeatherFetcher::clearPreviousWeatherRequest()
 
 void WeatherFetcher::sendWeatherRequest(const QNetworkRequest &request)
 {
-    qDebug() << this << "sendWeatherRequest() is being invoked";
+    qCDebug(lcWeatherFetch) << this << "sendWeatherRequest() is being invoked";
+    m_requestTimer.start();
     m_lastReply = m_networkManager->get(request);
     m_lastReply->setParent(this);
+    m_decoder.reset();
+    m_replyBytes = 0;
+    connect(m_lastReply, &QNetworkReply::readyRead, this, &WeatherFetcher::decodeAvailableData);
     connect(m_lastReply, &QNetworkReply::finished, this, &WeatherFetcher::exractWeatherFromReply);
 }
 
-QJsonObject WeatherFetcher::extractJsonFromReply()
+void WeatherFetcher::decodeAvailableData()
 {
-    qDebug() << this << "extractJsonFromReply() is being invoked";
-    // First, check for null pointers
     if (!m_lastReply)
-    {
-        throw std::runtime_error("WeatherFetcher::extractJsonFromReply() - m_lastReply pointer is null!");
-    }
-
-    // Read the received JSON data
+        return;
     const QByteArray data = m_lastReply->readAll();
-
-    // Convert the received JSON data into a QJsonObject
-    QJsonParseError parseError;
-    QJsonObject jsonObj = QJsonDocument::fromJson(data, &parseError).object();
-
-    // Check for potential errors
-    if (parseError.error != QJsonParseError::NoError)
-    {
-        // Report a warning about the parsing error
-        qWarning() << this << "Error: JSON parsing failed: " << parseError.errorString();
-        // Emit an error signal with details
-        emit networkError(QNetworkReply::UnknownContentError, parseError.errorString());
-    }
-    else if (jsonObj.isEmpty()) {
-        // Report a warning about the empty object
-        qWarning() << this << "Error: JSON object is empty!";
-    }
-
-    return jsonObj;
+    m_replyBytes += data.size();
+    m_decoder.feed(data);
 }
 
 bool WeatherFetcher::requestWasSuccessful()
@@ -112,51 +95,46 @@ bool WeatherFetcher::requestWasSuccessful()
           && m_lastReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200)) // 200 == ok
     {
         // Report a warning about the occured network error
-        qWarning() << this << "Network error occured: " << m_lastReply->errorString();
+        qCWarning(lcWeatherFetch) << this << "Network error occured: " << m_lastReply->errorString();
         // Emit an error signal with details
         emit networkError(m_lastReply->error(), m_lastReply->errorString());
         status = false;
     }
-    qDebug() << this << "requestWasSuccessful() returned status: " << status;
+    qCDebug(lcWeatherFetch) << this << "requestWasSuccessful() returned status: " << status;
     return status;
 }
 
-void WeatherFetcher::extractWeatherFromJson(const QJsonObject &json)
+bool WeatherFetcher::extractWeatherFromDecoder()
 {
-    qDebug() << this << "extractWeatherFromJson(...) is being invoked";
-    if (json.isEmpty())
+    qCDebug(lcWeatherParse) << this << "extractWeatherFromDecoder() is being invoked";
+    // First, check for null pointers
+    if (!m_lastReply)
     {
-        qWarning() << "Error: weather can't be extracted from JSON due to a empty JSON object!";
-        return;
+        throw std::runtime_error("WeatherFetcher::extractWeatherFromDecoder() - m_lastReply pointer is null!");
     }
 
-    // Create a weather data list that can be passed to the weather model
-    QList<WeatherData*> weatherItemList;
-
-    // Extract "city" object information
-    QJsonObject cityObject = json["city"].toObject();
-    QString cityName = cityObject["name"].toString();
-    qDebug() << this << "Extracted city name: " << cityName;
-
-    // Extract weather information
-    bool isCurrentWeather = true;
-    QJsonArray weatherInfoList = json["list"].toArray();
-    for (const QJsonValue& listValue: weatherInfoList)
+    // Decode what hasn't been received with readyRead() yet
+    decodeAvailableData();
+    if (!m_decoder.finish())
     {
-        if (listValue.isObject())
-        {
-            QJsonObject listObject = listValue.toObject();
-            QString listItemName = listObject["dt_txt"].toString();
-            WeatherData *weatherDataItem = new WeatherData(listItemName, listObject, cityName, isCurrentWeather);
-            isCurrentWeather = false;
-
-            // Append each weather data item to the list
-            weatherItemList.append(weatherDataItem);
-        }
+        // Report a warning about the parsing error
+        qCWarning(lcWeatherParse) << this << "Error: JSON parsing failed: " << m_decoder.errorString();
+        // Emit an error signal with details
+        emit networkError(QNetworkReply::UnknownContentError, m_decoder.errorString());
+        return false;
+    }
+    if (m_decoder.entryCount() == 0)
+    {
+        // Keep the forecast of the previous reply instead of showing nothing
+        qCWarning(lcWeatherParse) << this << "Warning: the reply doesn't contain any weather entries!";
+        emit networkError(QNetworkReply::UnknownContentError, "The reply doesn't contain any weather entries");
+        return false;
     }
+    qCDebug(lcWeatherParse) << this << "Extracted city name: " << m_decoder.cityName();
 
-    // Pass the created weather item list to the weather model
-    m_weatherModel.setWeatherData(weatherItemList);
+    // Pass the entries to the weather model, the first entry is the current weather
+    m_weatherModel.setForecast(m_decoder.cityName(), m_decoder.takeEntries());
+    return true;
 }
 
 double WeatherFetcher::latitude() const
@@ -179,14 +157,27 @@ void WeatherFetcher::setLongitude(double newLongitude)
     m_longitude = newLongitude;
 }
 
+QString WeatherFetcher::apiKey() const
+{
+    return m_apiKey;
+}
+
+void WeatherFetcher::setApiKey(const QString& newApiKey)
+{
+    m_apiKey = newApiKey;
+}
+
 void WeatherFetcher::exractWeatherFromReply()
 {
-    qDebug() << this << "exractWeatherFromReply() is being invoked";
+    qCDebug(lcWeatherFetch) << this << "exractWeatherFromReply() is being invoked";
     if (requestWasSuccessful())
     {
-        const QJsonObject jsonObj = extractJsonFromReply();
-        extractWeatherFromJson(jsonObj);
-        emit dataUpdated();
+        const qint64 latency = m_requestTimer.elapsed();
+        if (extractWeatherFromDecoder())
+        {
+            LOG_INFO("fetch.done", "latency_ms", latency, "bytes", m_replyBytes, "entries", m_weatherModel.rowCount());
+            emit dataUpdated();
+        }
     }
 
 }
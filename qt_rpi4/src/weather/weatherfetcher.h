@@ -7,14 +7,11 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
-#include <QJsonDocument>
-#include <QJsonParseError>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <stdexcept>
 #include "weathermodel.h"
-#include "weatherdata.h"
+#include "forecastdecoder.h"
 
 class WeatherFetcher : public QObject
 {
@@ -34,6 +31,9 @@ public:
     double latitude() const;
     void setLatitude(double newLatitude);
 
+    QString apiKey() const;
+    void setApiKey(const QString& newApiKey);
+
 signals:
     void dataUpdated();
     void networkError(QNetworkReply::NetworkError errorCode, const QString& errorString);
@@ -43,14 +43,14 @@ public slots:
 
 private slots:
     void exractWeatherFromReply();
+    void decodeAvailableData(); // Decodes the reply while it is being received
 
 private:
     QNetworkRequest createWeatherRequest(QString url);
     void clearPreviousWeatherRequest();
     void sendWeatherRequest(const QNetworkRequest& request);
-    QJsonObject extractJsonFromReply();
     bool requestWasSuccessful();
-    void extractWeatherFromJson(const QJsonObject& json);
+    bool extractWeatherFromDecoder();
 
     // Private members
     QTimer* m_timer;
@@ -60,6 +60,9 @@ private:
     QString m_apiKey;
     QString m_apiString = "https://api.openweathermap.org/data/2.5/forecast?lat=%1&lon=%2&appid=%3&units=metric";
     QUrl m_apiUrl;
+    QElapsedTimer m_requestTimer; // Measures the latency of the last request
+    ForecastDecoder m_decoder;    // Of the last reply
+    qint64 m_replyBytes = 0;      // Received with the last reply
     double m_longitude;
     double m_latitude;
 };
@@ -1,4 +1,5 @@
 #include "weathermodel.h"
+#include <logcategories.h>
 
 WeatherModel::WeatherModel(QObject *parent)
     : QAbstractListModel{parent}
@@ -8,51 +9,65 @@ WeatherModel::WeatherModel(QObject *parent)
 
 WeatherModel::~WeatherModel()
 {
-    if (m_data.count() != 0)
-    {
-        qDeleteAll(m_data);
-    }
 }
 
 int WeatherModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
-    return m_data.count();
+    return m_entries.count();
 }
 
 QVariant WeatherModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() < 0 || index.row() >= m_data.count())
+    if (index.row() < 0 || index.row() >= m_entries.count())
         return QVariant(); // Constructs and returns an invalid variant
 
-    WeatherData* data = m_data[index.row()];
+    const ForecastEntry& entry = m_entries[index.row()];
     switch (role) {
     case CityNameRole:
-        return data->cityName();
+        return m_cityName;
     case IsCurrentWeatherRole:
-        return data->isCurrentWeather();
+        return entry.isCurrent;
     case DateAndTimeRole:
-        return data->qDateTime();
+        return entry.dateAndTime();
     case WeatherDescriptionRole:
-        return data->weatherDescription();
+        return entry.weatherDescription();
     case WeatherMainRole:
-        return data->weatherMain();
+        return entry.weatherMain();
     case TemperatureRole:
-        return data->mainTemp();
+        return entry.mainTemp;
     case MinTemperatureRole:
-        return data->mainTempMin();
+        return entry.mainTempMin;
     case MaxTemperatureRole:
-        return data->mainTempMax();
+        return entry.mainTempMax;
     case WindSpeedRole:
-        return data->windSpeed();
+        return entry.windSpeed;
     case WeatherIconRole:
-        return data->weatherIcon();
+        return entry.weatherIcon();
     case Rain3hRole:
-        return data->rain3h();
+        return entry.rain3h;
     case Snow3hRole:
-        return data->snow3h();
+        return entry.snow3h;
     case PopRole:
-        return data->pop();
+        return entry.pop;
+    case FeelsLikeRole:
+        return entry.has(ForecastEntry::FeelsLike) ? QVariant(entry.feelsLike()) : QVariant();
+    case HumidityRole:
+        return entry.has(ForecastEntry::Humidity) ? QVariant(entry.humidity()) : QVariant();
+    case PressureRole:
+        return entry.has(ForecastEntry::Pressure) ? QVariant(entry.pressure()) : QVariant();
+    case CloudsRole:
+        return entry.has(ForecastEntry::Clouds) ? QVariant(entry.clouds()) : QVariant();
+    case WindDegRole:
+        return entry.has(ForecastEntry::WindDeg) ? QVariant(entry.windDeg()) : QVariant();
+    case WindGustRole:
+        return entry.has(ForecastEntry::WindGust) ? QVariant(entry.windGust()) : QVariant();
+    case VisibilityRole:
+        return entry.has(ForecastEntry::Visibility) ? QVariant(entry.visibility()) : QVariant();
+    case IsDaytimeRole:
+        return entry.isDaytime();
+    case PresentFieldsRole:
+        return entry.presentFields();
     default:
         return QVariant(); // Constructs and returns an invalid variant
     }
@@ -75,34 +90,37 @@ QHash<int, QByteArray> WeatherModel::roleNames() const
     roles[Rain3hRole] = "rain3h";
     roles[Snow3hRole] = "snow3h";
     roles[PopRole] = "pop";
+    roles[FeelsLikeRole] = "feelsLike";
+    roles[HumidityRole] = "humidity";
+    roles[PressureRole] = "pressure";
+    roles[CloudsRole] = "clouds";
+    roles[WindDegRole] = "windDeg";
+    roles[WindGustRole] = "windGust";
+    roles[VisibilityRole] = "visibility";
+    roles[IsDaytimeRole] = "isDaytime";
+    roles[PresentFieldsRole] = "presentFields";
     return roles;
 }
 
-void WeatherModel::setWeatherData(QList<WeatherData *> newData)
+void WeatherModel::setForecast(const QString &cityName, QList<ForecastEntry> entries)
 {
     // Any views attached to this model will be reset as well
     beginResetModel();
 
-    // Clear existing data
-    if (m_data.count() != 0)
-    {
-        qDeleteAll(m_data);
-    }
-    m_data.clear();
+    // Replace the old entries, the list is released as a whole
+    m_entries = std::move(entries);
+    m_cityName = cityName;
+    m_series.assign(m_entries);
 
-    // Replace the old data with new data
-    m_data = newData;
-
-    for (WeatherData* weather : m_data)
+    // Dump the rows only if the category's debug output is enabled
+    if (lcWeatherModel().isDebugEnabled())
     {
-        if (weather)
+        for (const ForecastEntry& entry : std::as_const(m_entries))
         {
-            qDebug() << weather->objectName()
-                     << "City:" << weather->cityName()
-                     << "Temp:" << weather->mainTemp()
-                     // << "Min:" << weather->mainTempMin()
-                     // << "Max:" << weather->mainTempMax()
-                     << "Description:" << weather->weatherDescription();
+            qCDebug(lcWeatherModel) << entry.dateAndTime()
+                     << "City:" << m_cityName
+                     << "Temp:" << entry.mainTemp
+                     << "Description:" << entry.weatherDescription();
         }
     }
 
@@ -111,50 +129,57 @@ void WeatherModel::setWeatherData(QList<WeatherData *> newData)
     emit currentDataChanged();
 }
 
+ForecastEntry WeatherModel::get(int row) const
+{
+    return m_entries.value(row);
+}
+
+const ForecastSeries &WeatherModel::series() const
+{
+    return m_series;
+}
+
 QString WeatherModel::currentCityName() const
 {
-    QString value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->cityName();
-    return value;
+    return m_cityName;
 }
 
 QString WeatherModel::currentWeatherDescription() const
 {
     QString value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->weatherDescription();
+    if (!m_entries.isEmpty())
+        value = m_entries.first().weatherDescription();
     return value;
 }
 
 QString WeatherModel::currentWeatherIcon() const
 {
     QString value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->weatherIcon();
+    if (!m_entries.isEmpty())
+        value = m_entries.first().weatherIcon();
     return value;
 }
 
 double WeatherModel::currentMainTemp() const
 {
     double value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->mainTemp();
+    if (!m_entries.isEmpty())
+        value = m_entries.first().mainTemp;
     return value;
 }
 
 double WeatherModel::currentWindSpeed() const
 {
     double value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->windSpeed();
+    if (!m_entries.isEmpty())
+        value = m_entries.first().windSpeed;
     return value;
 }
 
 double WeatherModel::currentPop() const
 {
     double value{};
-    if (!m_data.isEmpty())
-        value = m_data.first()->pop();
+    if (!m_entries.isEmpty())
+        value = m_entries.first().pop;
     return value;
 }
@@ -3,8 +3,16 @@
 
 #include <QObject>
 #include <QAbstractListModel>
-#include "weatherdata.h"
+#include "forecastentry.h"
+#include "forecastseries.h"
 
+/*
+ * The entries of the latest forecast, first the current weather. The entries are values in one
+ * contiguous list, replaced as a whole by every fetch. The text of the weather condition is looked
+ * up in WeatherConditions only when data() is asked for one of the text roles. The numeric values
+ * are kept as columns as well, for the aggregates over the forecast (see series()). A value
+ * which wasn't in the forecast is returned as an invalid QVariant (undefined in QML).
+ */
 class WeatherModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -35,7 +43,16 @@ public:
         WindSpeedRole,
         Rain3hRole,
         Snow3hRole,
-        PopRole
+        PopRole,
+        FeelsLikeRole,
+        HumidityRole,
+        PressureRole,
+        CloudsRole,
+        WindDegRole,
+        WindGustRole,
+        VisibilityRole,
+        IsDaytimeRole,
+        PresentFieldsRole // ForecastEntry::Field flags
         // Add other roles as needed
     };
 
@@ -43,7 +60,11 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
-    void setWeatherData(QList<WeatherData*> newData);
+    void setForecast(const QString& cityName, QList<ForecastEntry> entries);
+    // The entry of a row for QML, a default entry if the row doesn't exist
+    Q_INVOKABLE ForecastEntry get(int row) const;
+    // The values of the entries as columns, rebuilt by setForecast()
+    const ForecastSeries& series() const;
 
     QString currentCityName() const;
     QString currentWeatherDescription() const;
@@ -57,7 +78,9 @@ signals:
     void currentDataChanged();
 
 private:
-    QList<WeatherData*> m_data;
+    QList<ForecastEntry> m_entries;
+    QString m_cityName; // Of all entries
+    ForecastSeries m_series; // Of m_entries
 };
 
 #endif // WEATHERMODEL_H
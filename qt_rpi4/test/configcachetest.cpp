@@ -0,0 +1,179 @@
+#include "configcachetest.h"
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+
+QString value(const ConfigTable& table, const QString& key)
+{
+    const QVariant* found = table.find(key);
+    return found ? found->toString() : QString("<missing>");
+}
+
+} // namespace
+
+ConfigCacheTest::ConfigCacheTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ConfigCacheTest");
+}
+
+QString ConfigCacheTest::writeIni(const QString &name, const QByteArray &content, const QDateTime &modified)
+{
+    const QString fileName = m_directory.filePath(name);
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        file.write(content);
+        file.flush();
+        file.setFileTime(modified.isValid() ? modified : QDateTime::currentDateTime().addSecs(-60),
+                         QFileDevice::FileModificationTime);
+    }
+    return fileName;
+}
+
+void ConfigCacheTest::testColdAndWarmLoad()
+{
+    const QString fileName = writeIni("cold.ini", "[Weather]\nLatitude=52.52\nCity=Zürich\n[Logging]\nLevel=info\n");
+
+    ConfigTable parsed;
+    ConfigCache::Source source = ConfigCache::Source::Cache;
+    QVERIFY(ConfigCache::load(fileName, parsed, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    ConfigCache::waitForWrites();
+    QVERIFY(QFileInfo::exists(ConfigCache::cacheFileName(fileName)));
+
+    ConfigTable cached;
+    QVERIFY(ConfigCache::load(fileName, cached, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Cache);
+    QCOMPARE(cached.size(), parsed.size());
+    QCOMPARE(value(cached, "Weather/Latitude"), QString("52.52"));
+    QCOMPARE(value(cached, "Weather/City"), QString("Zürich"));
+    QCOMPARE(value(cached, "Logging/Level"), QString("info"));
+
+    // Same order and hashes as the parsed table
+    auto parsedEntry = parsed.begin();
+    for (const ConfigTable::Entry& entry : cached)
+    {
+        QCOMPARE(entry.key, parsedEntry->key);
+        QCOMPARE(entry.hash, parsedEntry->hash);
+        ++parsedEntry;
+    }
+}
+
+void ConfigCacheTest::testEditedFileIsParsed()
+{
+    const QString fileName = writeIni("edited.ini", "[Weather]\nLatitude=52.52\n");
+    ConfigTable table;
+    QVERIFY(ConfigCache::load(fileName, table));
+    ConfigCache::waitForWrites();
+
+    // Same size and inode, only the time stamp differs
+    writeIni("edited.ini", "[Weather]\nLatitude=48.13\n", QDateTime::currentDateTime().addSecs(-30));
+    ConfigCache::Source source = ConfigCache::Source::Cache;
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    QCOMPARE(value(table, "Weather/Latitude"), QString("48.13"));
+
+    ConfigCache::waitForWrites();
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Cache);
+    QCOMPARE(value(table, "Weather/Latitude"), QString("48.13"));
+}
+
+void ConfigCacheTest::testCorruptCacheIsRebuilt()
+{
+    const QString fileName = writeIni("corrupt.ini", "[Weather]\nLatitude=52.52\nLongitude=13.40\n");
+    ConfigTable table;
+    QVERIFY(ConfigCache::load(fileName, table));
+    ConfigCache::waitForWrites();
+
+    // Flip a byte in the last record
+    QFile cacheFile(ConfigCache::cacheFileName(fileName));
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    QByteArray image = cacheFile.readAll();
+    QVERIFY(image.size() > 64);
+    image[image.size() - 10] = static_cast<char>(image[image.size() - 10] ^ 0x5A);
+    cacheFile.seek(0);
+    cacheFile.write(image);
+    cacheFile.close();
+
+    ConfigCache::Source source = ConfigCache::Source::Cache;
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    QCOMPARE(value(table, "Weather/Longitude"), QString("13.40"));
+    ConfigCache::waitForWrites();
+
+    // A truncated image is rejected as well
+    QVERIFY(cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    cacheFile.write("GOCFGBIN");
+    cacheFile.close();
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    ConfigCache::waitForWrites();
+
+    // ...and both times the image has been rewritten
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Cache);
+    QCOMPARE(table.size(), 2);
+}
+
+void ConfigCacheTest::testRecentlyModifiedFileIsNotCached()
+{
+    const QString fileName = writeIni("recent.ini", "[Weather]\nLatitude=52.52\n", QDateTime::currentDateTime());
+    ConfigTable table;
+    ConfigCache::Source source = ConfigCache::Source::Cache;
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    ConfigCache::waitForWrites();
+    QVERIFY(!QFileInfo::exists(ConfigCache::cacheFileName(fileName)));
+
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+}
+
+void ConfigCacheTest::testTableOutlivesImageFile()
+{
+    const QString fileName = writeIni("removed.ini", "[Weather]\nCity=München\n");
+    ConfigTable table;
+    QVERIFY(ConfigCache::load(fileName, table));
+    ConfigCache::waitForWrites();
+
+    ConfigCache::Source source = ConfigCache::Source::Parsed;
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Cache);
+
+    // The image has been unmapped after decoding, the table doesn't need the file
+    QVERIFY(QFile::remove(ConfigCache::cacheFileName(fileName)));
+    QCOMPARE(value(table, "Weather/City"), QString("München"));
+
+    // Without the file the INI file is parsed again and the image rebuilt
+    ConfigTable rebuilt;
+    QVERIFY(ConfigCache::load(fileName, rebuilt, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    ConfigCache::waitForWrites();
+    QVERIFY(ConfigCache::load(fileName, rebuilt, nullptr, &source));
+    QCOMPARE(source, ConfigCache::Source::Cache);
+    QCOMPARE(value(rebuilt, "Weather/City"), QString("München"));
+    QCOMPARE(value(table, "Weather/City"), QString("München"));
+}
+
+void ConfigCacheTest::testCacheDisabled()
+{
+    const QString fileName = writeIni("nocache.ini", "[Logging]\nLevel=debug\n");
+    ConfigTable table;
+    ConfigCache::Source source = ConfigCache::Source::Cache;
+    QVERIFY(ConfigCache::load(fileName, table, nullptr, &source, false));
+    QCOMPARE(source, ConfigCache::Source::Parsed);
+    QCOMPARE(value(table, "Logging/Level"), QString("debug"));
+    QVERIFY(!QFileInfo::exists(ConfigCache::cacheFileName(fileName)));
+}
+
+void ConfigCacheTest::testMissingFile()
+{
+    ConfigTable table;
+    QString errorString;
+    QVERIFY(!ConfigCache::load(m_directory.filePath("nonexistentfile.ini"), table, &errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!QFileInfo::exists(ConfigCache::cacheFileName(m_directory.filePath("nonexistentfile.ini"))));
+}
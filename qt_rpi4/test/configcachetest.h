@@ -0,0 +1,34 @@
+#ifndef CONFIGCACHETEST_H
+#define CONFIGCACHETEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <configcache.h>
+
+class ConfigCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigCacheTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testColdAndWarmLoad();
+    void testEditedFileIsParsed();
+    void testCorruptCacheIsRebuilt();
+    void testRecentlyModifiedFileIsNotCached();
+    void testTableOutlivesImageFile();
+    void testCacheDisabled();
+    void testMissingFile();
+
+private:
+    // The modification time is in the past unless given, so that the file gets an image
+    QString writeIni(const QString& name, const QByteArray& content, const QDateTime& modified = QDateTime());
+
+    QTemporaryDir m_directory;
+};
+
+#endif // CONFIGCACHETEST_H
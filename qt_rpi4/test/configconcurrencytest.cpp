@@ -0,0 +1,178 @@
+#include "configconcurrencytest.h"
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <configkey.h>
+#include <iniwriter.h>
+
+namespace {
+
+constexpr int ReaderCount = 8;
+constexpr int Iterations = 200;
+const QStringList StressKeys = {"a", "b", "c", "d", "e", "f", "g", "h"};
+
+// Every key of [Stress] has the same value, so a reader can tell a torn snapshot
+QByteArray stressConfiguration(int value)
+{
+    QByteArray content = "[Weather]\nLatitude=52.52\n[Stress]\n";
+    for (const QString& key : StressKeys)
+        content += key.toUtf8() + '=' + QByteArray::number(value) + '\n';
+    return content;
+}
+
+// Failures of the reader threads, QVERIFY only works on the test's thread
+class Failures
+{
+public:
+    void add(const QString& failure)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_failures.size() < 10)
+            m_failures.append(failure);
+    }
+    QStringList list()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_failures;
+    }
+
+private:
+    QMutex m_mutex;
+    QStringList m_failures;
+};
+
+} // namespace
+
+ConfigConcurrencyTest::ConfigConcurrencyTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ConfigConcurrencyTest");
+}
+
+void ConfigConcurrencyTest::initTestCase()
+{
+    QVERIFY(m_directory.isValid());
+}
+
+void ConfigConcurrencyTest::cleanupTestCase()
+{
+    ConfigManager::instance().initialise("temp_config.txt");
+}
+
+void ConfigConcurrencyTest::testReadsDuringReloads()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    const QString fileName = m_directory.filePath("stress.ini");
+    // Written atomically, so every load sees a complete file and the values only increase
+    QVERIFY(IniWriter::writeFile(fileName, stressConfiguration(0)));
+    configManager.initialise(fileName);
+    ConfigKey<int> stressKey{"Stress/a", -1};
+
+    Failures failures;
+    std::atomic<bool> stop{false};
+    std::atomic<qint64> reads{0};
+    QList<QThread*> readers;
+    for (int r = 0; r < ReaderCount; ++r)
+    {
+        readers.append(QThread::create([&, r]() {
+            quint64 lastVersion = 0;
+            int lastValue = -1;
+            qint64 count = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const quint64 version = configManager.version();
+                if (version < lastVersion)
+                    failures.add(QString("version went back from %1 to %2").arg(lastVersion).arg(version));
+                lastVersion = version;
+
+                int value = -1;
+                switch (r % 4)
+                {
+                case 0:
+                    value = configManager.getValue("Stress/a").toInt();
+                    if (!configManager.getValue("Weather/Latitude").isValid())
+                        failures.add("Weather/Latitude is missing");
+                    break;
+                case 1:
+                    value = stressKey.value();
+                    break;
+                case 2:
+                {
+                    // One snapshot: all values of the section are the same
+                    const QMap<QString, QVariant> section = configManager.sectionValues("Stress");
+                    if (section.size() != StressKeys.size())
+                        failures.add(QString("[Stress] has %1 keys").arg(section.size()));
+                    value = section.value("a").toInt();
+                    for (const QVariant& sectionValue : section)
+                    {
+                        if (sectionValue.toInt() != value)
+                            failures.add(QString("[Stress] is torn: %1 and %2").arg(value).arg(sectionValue.toInt()));
+                    }
+                    break;
+                }
+                default:
+                {
+                    // Keys are registered and unregistered while snapshots are published
+                    ConfigKey<int> key{"Stress/h", -1};
+                    value = key.value();
+                    break;
+                }
+                }
+                if (value < lastValue)
+                    failures.add(QString("value went back from %1 to %2").arg(lastValue).arg(value));
+                lastValue = value;
+                ++count;
+            }
+            reads.fetch_add(count);
+        }));
+        readers.last()->start();
+    }
+
+    // Loads from a thread which isn't the GUI thread, with reloads from the pool in between
+    QThread* writer = QThread::create([&]() {
+        for (int i = 1; i <= Iterations; ++i)
+        {
+            if (!IniWriter::writeFile(fileName, stressConfiguration(i)))
+                failures.add("Failed to write " + fileName);
+            if (i % 2 == 0)
+                configManager.initialise(fileName);
+            else
+                configManager.reload();
+        }
+    });
+    writer->start();
+    QVERIFY(writer->wait(120000));
+    delete writer;
+    QThreadPool::globalInstance()->waitForDone();
+    stop = true;
+    for (QThread* reader : std::as_const(readers))
+    {
+        reader->wait();
+        delete reader;
+    }
+
+    const QStringList found = failures.list();
+    QVERIFY2(found.isEmpty(), qPrintable(found.join('\n')));
+    QVERIFY(reads.load() > 0);
+    QCOMPARE(configManager.getValue("Stress/a").toInt(), Iterations);
+    QCOMPARE(stressKey.value(), Iterations);
+}
+
+void ConfigConcurrencyTest::testInitialiseFromWorkerThread()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    const QString fileName = m_directory.filePath("worker.ini");
+    QVERIFY(IniWriter::writeFile(fileName, "[Logging]\nLevel=debug\n"));
+
+    QThread* worker = QThread::create([&configManager, fileName]() { configManager.initialise(fileName); });
+    worker->start();
+    QVERIFY(worker->wait(10000));
+    delete worker;
+    QCOMPARE(configManager.getValue("Logging/Level").toString(), QString("debug"));
+
+    // The file is watched from the application's thread all the same
+    QTest::qWait(50);
+    QVERIFY(IniWriter::writeFile(fileName, "[Logging]\nLevel=warning\n"));
+    QTRY_COMPARE_WITH_TIMEOUT(configManager.getValue("Logging/Level").toString(), QString("warning"), 10000);
+}
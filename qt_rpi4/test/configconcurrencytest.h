@@ -0,0 +1,31 @@
+#ifndef CONFIGCONCURRENCYTEST_H
+#define CONFIGCONCURRENCYTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <configmanager.h>
+
+/*
+ * Readers on several threads while the config is loaded again and again. Build with
+ * -DGREENOASIS_SANITIZER=thread to have the accesses checked by ThreadSanitizer.
+ */
+class ConfigConcurrencyTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigConcurrencyTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testReadsDuringReloads();
+    void testInitialiseFromWorkerThread();
+
+private:
+    QTemporaryDir m_directory;
+};
+
+#endif // CONFIGCONCURRENCYTEST_H
@@ -0,0 +1,290 @@
+#include "confighistorytest.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <configmanager.h>
+#include <configcache.h>
+
+namespace {
+
+QString value(const ConfigPersistentMap& map, const QString& key)
+{
+    const QVariant* found = map.find(key);
+    return found ? found->toString() : QString("<missing>");
+}
+
+} // namespace
+
+ConfigHistoryTest::ConfigHistoryTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ConfigHistoryTest");
+}
+
+void ConfigHistoryTest::testPersistentMap()
+{
+    ConfigPersistentMap map;
+    QVERIFY(map.isEmpty());
+    for (int i = 0; i < 5000; ++i)
+        map = map.inserted(QString("Zone/%1/Valve").arg(i), i % 16);
+    QCOMPARE(map.size(), 5000);
+    QCOMPARE(value(map, "Zone/4321/Valve"), QString::number(4321 % 16));
+    QVERIFY(!map.find(u"Zone/5000/Valve"));
+
+    // Replacing and removing don't change the original
+    const ConfigPersistentMap changed = map.inserted("Zone/1/Valve", 99).removed("Zone/2/Valve").removed("Missing");
+    QCOMPARE(changed.size(), 4999);
+    QCOMPARE(value(changed, "Zone/1/Valve"), QString("99"));
+    QCOMPARE(value(changed, "Zone/2/Valve"), QString("<missing>"));
+    QCOMPARE(value(map, "Zone/1/Valve"), QString("1"));
+    QCOMPARE(value(map, "Zone/2/Valve"), QString("2"));
+
+    int count = 0;
+    changed.forEach([&count](const QString&, const QVariant&) { ++count; });
+    QCOMPARE(count, 4999);
+
+    for (int i = 0; i < 5000; ++i)
+        map = map.removed(QString("Zone/%1/Valve").arg(i));
+    QVERIFY(map.isEmpty());
+}
+
+void ConfigHistoryTest::testStructuralSharing()
+{
+    ConfigPersistentMap map;
+    map = map.inserted("Weather/Latitude", "52.52");
+    // Setting the same value doesn't create a new version
+    QVERIFY(map.inserted("Weather/Latitude", "52.52").isSharedWith(map));
+    QVERIFY(map.removed("Weather/Longitude").isSharedWith(map));
+    QVERIFY(!map.inserted("Weather/Latitude", "48.14").isSharedWith(map));
+}
+
+void ConfigHistoryTest::testDiff()
+{
+    ConfigPersistentMap from;
+    for (int i = 0; i < 1000; ++i)
+        from = from.inserted(QString("Zone/%1/DurationSecs").arg(i), 600);
+    const ConfigPersistentMap to = from.inserted("Zone/7/DurationSecs", 300)
+                                       .removed("Zone/8/DurationSecs")
+                                       .inserted("Zone/1000/DurationSecs", 900);
+
+    const QList<ConfigPersistentMap::Change> changes = ConfigPersistentMap::diff(from, to);
+    QCOMPARE(changes.size(), 3);
+    // Sorted by key
+    QCOMPARE(changes[0].key, QString("Zone/1000/DurationSecs"));
+    QVERIFY(!changes[0].oldValue.isValid());
+    QCOMPARE(changes[0].newValue.toInt(), 900);
+    QCOMPARE(changes[1].key, QString("Zone/7/DurationSecs"));
+    QCOMPARE(changes[1].oldValue.toInt(), 600);
+    QCOMPARE(changes[1].newValue.toInt(), 300);
+    QCOMPARE(changes[2].key, QString("Zone/8/DurationSecs"));
+    QVERIFY(!changes[2].newValue.isValid());
+
+    QCOMPARE(ConfigPersistentMap::diff(to, from).size(), 3);
+    QVERIFY(ConfigPersistentMap::diff(from, from).isEmpty());
+    QCOMPARE(ConfigPersistentMap::diff(ConfigPersistentMap(), from).size(), 1000);
+}
+
+void ConfigHistoryTest::testRecordAndCapacity()
+{
+    ConfigHistory history;
+    history.setCapacity(3);
+    ConfigTable values{{"Weather/Latitude", "52.52"}, {"Weather/Longitude", "13.40"}};
+    history.record(1, "initialise", 1000, values);
+    values.insert("Weather/Latitude", "48.14");
+    history.record(2, "reload", 2000, values, {"Weather/Latitude"});
+    history.record(2, "reload", 2500, values, {}); // Ids have to increase
+    QCOMPARE(history.ids(), QList<quint64>({1, 2}));
+    QCOMPARE(history.version(2)->origin, QString("reload"));
+    QCOMPARE(value(history.version(2)->values, "Weather/Latitude"), QString("48.14"));
+    QCOMPARE(value(history.version(1)->values, "Weather/Latitude"), QString("52.52"));
+
+    QList<ConfigPersistentMap::Change> changes;
+    QVERIFY(history.diff(1, 2, &changes));
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.first().key, QString("Weather/Latitude"));
+
+    history.record(3, "reload", 3000, values, {});
+    history.record(5, "restore 1", 4000, history.version(1)->values);
+    QCOMPARE(history.ids(), QList<quint64>({2, 3, 5}));
+    QVERIFY(!history.version(1));
+    QVERIFY(!history.diff(1, 5, &changes));
+    QCOMPARE(history.lastId(), quint64(5));
+    QCOMPARE(value(history.latest()->values, "Weather/Latitude"), QString("52.52"));
+}
+
+void ConfigHistoryTest::testSaveAndLoad()
+{
+    ConfigHistory history;
+    ConfigTable values;
+    for (int i = 0; i < 500; ++i)
+        values.insert(QString("Zone/%1/DurationSecs").arg(i), "600");
+    history.record(1, "initialise", 1000, values);
+    for (quint64 id = 2; id <= 20; ++id)
+    {
+        const QString key = QString("Zone/%1/DurationSecs").arg(id);
+        values.insert(key, QString::number(id * 10));
+        history.record(id, "reload", static_cast<qint64>(id) * 1000, values, {key});
+    }
+
+    const QString fileName = m_directory.filePath("history.bin");
+    QString errorString;
+    QVERIFY2(history.save(fileName, &errorString), qPrintable(errorString));
+    // Deltas and compression: far less than 20 full copies of the values
+    QVERIFY(QFileInfo(fileName).size() < 500 * 20);
+
+    ConfigHistory loaded;
+    QVERIFY2(loaded.load(fileName, &errorString), qPrintable(errorString));
+    QCOMPARE(loaded.ids(), history.ids());
+    QCOMPARE(loaded.lastId(), quint64(20));
+    for (quint64 id : history.ids())
+    {
+        QCOMPARE(loaded.version(id)->timestampMsecs, history.version(id)->timestampMsecs);
+        QCOMPARE(loaded.version(id)->origin, history.version(id)->origin);
+        QVERIFY(ConfigPersistentMap::diff(loaded.version(id)->values, history.version(id)->values).isEmpty());
+    }
+    QCOMPARE(value(loaded.version(5)->values, "Zone/5/DurationSecs"), QString("50"));
+    QCOMPARE(value(loaded.version(4)->values, "Zone/5/DurationSecs"), QString("600"));
+}
+
+void ConfigHistoryTest::testCorruptFile()
+{
+    const QString fileName = m_directory.filePath("corrupt.bin");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("GOCFGHIS\x00\x00\x00\x01garbage", 19);
+    file.close();
+
+    ConfigHistory history;
+    QString errorString;
+    QVERIFY(!history.load(fileName, &errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!history.load(m_directory.filePath("nonexistentfile.bin"), &errorString));
+    QVERIFY(history.isEmpty());
+}
+
+void ConfigHistoryTest::testRestore()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QFile file("temp_history_config.txt");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=600\n[Zone/2]\nDurationSecs=300\n");
+    file.close();
+    configManager.initialise("temp_history_config.txt");
+    const quint64 original = configManager.version();
+
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=900\n[Zone/3]\nDurationSecs=120\n");
+    file.close();
+    configManager.reload();
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+    const quint64 edited = configManager.version();
+    QVERIFY(configManager.history().contains(original));
+    QVERIFY(configManager.history().contains(edited));
+
+    bool ok = false;
+    const QList<ConfigPersistentMap::Change> changes = configManager.diff(original, edited, &ok);
+    QVERIFY(ok);
+    QCOMPARE(changes.size(), 3);
+    QCOMPARE(changes[0].key, QString("Zone/1/DurationSecs"));
+    QCOMPARE(changes[1].key, QString("Zone/2/DurationSecs"));
+    QCOMPARE(changes[2].key, QString("Zone/3/DurationSecs"));
+    configManager.diff(original, 0, &ok);
+    QVERIFY(!ok);
+
+    QSignalSpy changedSpy(&configManager, &ConfigManager::valueChanged);
+    QVERIFY(configManager.restore(original));
+    QCOMPARE(changedSpy.count(), 3);
+    QVERIFY(configManager.version() > edited);
+    QCOMPARE(configManager.getValue("Zone/1/DurationSecs").toString(), QString("600"));
+    QCOMPARE(configManager.getValue("Zone/2/DurationSecs").toString(), QString("300"));
+    QVERIFY(!configManager.getValue("Zone/3/DurationSecs", QVariant()).isValid());
+    QVERIFY(configManager.diff(original, configManager.version()).isEmpty());
+    QCOMPARE(configManager.source("Zone/1/DurationSecs"), ConfigSource::File);
+    QVERIFY(!configManager.restore(0));
+
+    // Written to the file like setValue(), so a reload keeps the restored values
+    QVERIFY(configManager.flush());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Zone/1]\nDurationSecs=600\n[Zone/3]\n\n[Zone/2]\nDurationSecs=300\n"));
+    file.close();
+
+    QFile::remove("temp_history_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_history_config.txt"));
+}
+
+void ConfigHistoryTest::testRestoreKeepsOverrides()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QProcessEnvironment environment;
+    environment.insert("GREENOASIS_Zone__1__DurationSecs", "42");
+    configManager.setEnvironment(environment);
+    QFile file("temp_override_config.txt");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=600\n[Zone/2]\nDurationSecs=300\n");
+    file.close();
+    configManager.initialise("temp_override_config.txt");
+    const quint64 original = configManager.version();
+
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=900\n[Zone/2]\nDurationSecs=200\n");
+    file.close();
+    configManager.reload();
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+    // The history has the file layer, not the value of the environment
+    const QList<ConfigPersistentMap::Change> changes = configManager.diff(original, configManager.version());
+    QCOMPARE(changes.size(), 2);
+    QCOMPARE(changes[0].oldValue.toString(), QString("600"));
+    QCOMPARE(changes[0].newValue.toString(), QString("900"));
+
+    // Zone/1 is restored in the file, but the environment keeps overriding it
+    QSignalSpy changedSpy(&configManager, &ConfigManager::valueChanged);
+    QVERIFY(configManager.restore(original));
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(changedSpy[0][0].toString(), QString("Zone/2/DurationSecs"));
+    QCOMPARE(configManager.getValue("Zone/1/DurationSecs").toString(), QString("42"));
+    QCOMPARE(configManager.source("Zone/1/DurationSecs"), ConfigSource::Environment);
+    QCOMPARE(configManager.getValue("Zone/2/DurationSecs").toString(), QString("300"));
+    QVERIFY(configManager.diff(original, configManager.version()).isEmpty());
+
+    QVERIFY(configManager.flush());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Zone/1]\nDurationSecs=600\n[Zone/2]\nDurationSecs=300\n"));
+    file.close();
+
+    configManager.setEnvironment(QProcessEnvironment());
+    QFile::remove("temp_override_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_override_config.txt"));
+}
+
+void ConfigHistoryTest::testHistoryFile()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    const QString historyFileName = m_directory.filePath("manager.history");
+    configManager.setHistoryFile(historyFileName);
+    QFile file("temp_history_config.txt");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=600\n");
+    file.close();
+    configManager.initialise("temp_history_config.txt");
+
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Zone/1]\nDurationSecs=900\n");
+    file.close();
+    configManager.reload();
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+
+    // Saved with the changed values after the write delay, flush() doesn't wait for it
+    QVERIFY(configManager.flush());
+    ConfigHistory saved;
+    QVERIFY(saved.load(historyFileName));
+    QCOMPARE(saved.lastId(), configManager.version());
+    QCOMPARE(saved.ids(), configManager.history());
+    QCOMPARE(value(saved.latest()->values, "Zone/1/DurationSecs"), QString("900"));
+
+    configManager.setHistoryFile(QString());
+    QFile::remove("temp_history_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_history_config.txt"));
+}
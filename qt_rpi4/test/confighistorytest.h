@@ -0,0 +1,33 @@
+#ifndef CONFIGHISTORYTEST_H
+#define CONFIGHISTORYTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <configpersistentmap.h>
+#include <confighistory.h>
+
+class ConfigHistoryTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigHistoryTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testPersistentMap();
+    void testStructuralSharing();
+    void testDiff();
+    void testRecordAndCapacity();
+    void testSaveAndLoad();
+    void testCorruptFile();
+    void testRestore();
+    void testRestoreKeepsOverrides();
+    void testHistoryFile();
+
+private:
+    QTemporaryDir m_directory;
+};
+
+#endif // CONFIGHISTORYTEST_H
@@ -1,4 +1,19 @@
 #include "configmanagertest.h"
+#include <QSignalSpy>
+#include <QRegularExpression>
+#include <configcache.h>
+
+namespace {
+
+bool writeConfigFile(const QString &fileName, const QByteArray &content)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(content) == content.size();
+}
+
+} // namespace
 
 ConfigManagerTest::ConfigManagerTest(QObject *parent)
     : QObject{parent}
@@ -32,6 +47,26 @@ void ConfigManagerTest::cleanupTestCase()
 {
     // Delete temporary config file
     QFile::remove("temp_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_config.txt"));
+}
+
+void ConfigManagerTest::cleanup()
+{
+    // Tests which load a config file of their own get the one of initTestCase() back, even if
+    // they fail half-way
+    ConfigManager& configManager = ConfigManager::instance();
+    configManager.flush();
+    configManager.setWriteDelay(1000);
+    configManager.setDefaults(ConfigTable());
+    configManager.setEnvironment(QProcessEnvironment());
+    configManager.setOverrides({});
+    for (const char* fileName : {"temp_reload_config.txt", "temp_typed_config.txt", "temp_layered_config.txt",
+                                 "temp_write_config.txt"})
+    {
+        QFile::remove(fileName);
+        QFile::remove(ConfigCache::cacheFileName(fileName));
+    }
+    configManager.initialise("temp_config.txt");
 }
 
 void ConfigManagerTest::testGetValue()
@@ -61,3 +96,294 @@ void ConfigManagerTest::testFileOpenError()
     QVERIFY_EXCEPTION_THROWN(configManager.initialise(nonExistentFile), std::runtime_error);
 
 }
+
+void ConfigManagerTest::testReload()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_reload_config.txt", "[Weather]\nLatitude=52.52\nLongitude=13.40\n"));
+    configManager.initialise("temp_reload_config.txt");
+    const quint64 version = configManager.version();
+
+    QSignalSpy changedSpy(&configManager, &ConfigManager::valueChanged);
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(writeConfigFile("temp_reload_config.txt", "[Weather]\nLatitude=48.14\nLongitude=13.40\nFetchIntervalSecs=60\n"));
+    configManager.reload();
+
+    // The file is parsed on another thread, the signals are emitted from there
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+    QCOMPARE(configManager.version(), version + 1);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toDouble(), 48.14);
+    QCOMPARE(configManager.getValue("Weather/FetchIntervalSecs").toInt(), 60);
+
+    // Only the keys which have changed are reported
+    QCOMPARE(changedSpy.count(), 2);
+    QStringList keys;
+    for (const QList<QVariant>& arguments : changedSpy)
+        keys.append(arguments.at(0).toString());
+    keys.sort();
+    QCOMPARE(keys, QStringList({"Weather/FetchIntervalSecs", "Weather/Latitude"}));
+
+    // Reloading an unchanged file doesn't create a new version
+    configManager.reload();
+    QTest::qWait(200);
+    QCOMPARE(reloadedSpy.count(), 1);
+    QCOMPARE(configManager.version(), version + 1);
+
+}
+
+void ConfigManagerTest::testReloadKeepsValuesOnError()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_reload_config.txt", "[Weather]\nLatitude=52.52\n"));
+    configManager.initialise("temp_reload_config.txt");
+    const quint64 version = configManager.version();
+
+    QFile::remove("temp_reload_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_reload_config.txt"));
+    configManager.reload();
+    QTest::qWait(200);
+    QCOMPARE(configManager.version(), version);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toDouble(), 52.52);
+}
+
+void ConfigManagerTest::testReloadWhenFileChanges()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_reload_config.txt", "[Logging]\nLevel=debug\n"));
+    configManager.initialise("temp_reload_config.txt");
+
+    // Give the file a different size and modification time, then wait for the watcher
+    QTest::qWait(50);
+    QVERIFY(writeConfigFile("temp_reload_config.txt", "[Logging]\nLevel=warning\n"));
+    QTRY_COMPARE_WITH_TIMEOUT(configManager.getValue("Logging/Level").toString(), QString("warning"), 10000);
+
+}
+
+void ConfigManagerTest::testChangedKeys()
+{
+    const ConfigSnapshot first(1, {{"A/a", "1"}, {"A/b", "2"}, {"B/c", "3"}});
+    const ConfigSnapshot second(2, {{"A/a", "1"}, {"A/b", "20"}, {"B/d", "4"}});
+
+    QStringList keys = second.changedKeys(&first);
+    keys.sort();
+    QCOMPARE(keys, QStringList({"A/b", "B/c", "B/d"}));
+    QCOMPARE(first.changedKeys(nullptr).count(), 3);
+    QVERIFY(second.changedKeys(&second).isEmpty());
+}
+
+void ConfigManagerTest::testConfigKey()
+{
+    // Resolved from the snapshot of initTestCase()
+    const ConfigKey<QString> databaseName{"Database/databaseName"};
+    const ConfigKey<int> serverPort{"Server/serverPort"};
+    const ConfigKey<double> serverPortAsDouble{"Server/serverPort"};
+    QVERIFY(databaseName.isSet());
+    QCOMPARE(databaseName.value(), QString("myDatabase"));
+    QCOMPARE(serverPort.value(), 8080);
+    QCOMPARE(serverPortAsDouble.value(), 8080.0);
+    QCOMPARE(databaseName.key(), QString("Database/databaseName"));
+}
+
+void ConfigManagerTest::testConfigKeyDefault()
+{
+    const ConfigKey<int> missing{"Server/maxConnections", 16};
+    QVERIFY(!missing.isSet());
+    QCOMPARE(missing.value(), 16);
+
+    // Without a section prefix the key doesn't exist either
+    const ConfigKey<QString> logLevel{"logLevel"};
+    QVERIFY(logLevel.value().isEmpty());
+}
+
+void ConfigManagerTest::testConfigKeyTypeError()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_typed_config.txt", "[Weather]\nLatitude=north\nEnabled=maybe\nInterval=20s\n"));
+    configManager.initialise("temp_typed_config.txt");
+
+    // Invalid values are reported once and read as the default
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Weather/Latitude=north is not a valid double"));
+    const ConfigKey<double> latitude{"Weather/Latitude", 52.52};
+    QVERIFY(!latitude.isSet());
+    QCOMPARE(latitude.value(), 52.52);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Weather/Enabled=maybe is not a valid bool"));
+    const ConfigKey<bool> enabled{"Weather/Enabled", true};
+    QCOMPARE(enabled.value(), true);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Weather/Interval=20s is not a valid int"));
+    const ConfigKey<int> interval{"Weather/Interval", 30};
+    QCOMPARE(interval.value(), 30);
+
+}
+
+void ConfigManagerTest::testConfigKeyFollowsReload()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_typed_config.txt", "[Weather]\nLatitude=52.52\nEnabled=yes\n"));
+    configManager.initialise("temp_typed_config.txt");
+
+    const ConfigKey<double> latitude{"Weather/Latitude"};
+    const ConfigKey<bool> enabled{"Weather/Enabled", false};
+    QCOMPARE(latitude.value(), 52.52);
+    QCOMPARE(enabled.value(), true);
+
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(writeConfigFile("temp_typed_config.txt", "[Weather]\nLatitude=48.14\n"));
+    configManager.reload();
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+    QCOMPARE(latitude.value(), 48.14);
+    QVERIFY(!enabled.isSet());
+    QCOMPARE(enabled.value(), false);
+
+}
+
+void ConfigManagerTest::testLayeredValues()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_layered_config.txt", "[Weather]\nLatitude=52.52\nLongitude=13.40\nCity=Berlin\n"));
+
+    QProcessEnvironment environment;
+    environment.insert("GREENOASIS_WEATHER__LONGITUDE", "11.58");  // Matches the key in the file
+    environment.insert("GREENOASIS_Weather__City", "Munich");
+    environment.insert("GREENOASIS_Zone__1__Valve", "3");         // Not in any lower layer
+    environment.insert("GREENOASIS_CONFIG", "other.ini");          // Not a config value
+    environment.insert("PATH", "/usr/bin");
+    configManager.setDefaults({{"Weather/FetchIntervalSecs", 20}, {"Weather/City", "Hamburg"}});
+    configManager.setEnvironment(environment);
+    QVERIFY(configManager.setOverrides({"Weather/City=Zürich", "Weather/Url = https://example.com/?a=1"}));
+    configManager.initialise("temp_layered_config.txt");
+
+    QCOMPARE(configManager.getValue("Weather/FetchIntervalSecs").toInt(), 20);
+    QVERIFY(configManager.source("Weather/FetchIntervalSecs") == ConfigSource::Default);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toString(), QString("52.52"));
+    QVERIFY(configManager.source("Weather/Latitude") == ConfigSource::File);
+    QCOMPARE(configManager.getValue("Weather/Longitude").toString(), QString("11.58"));
+    QVERIFY(configManager.source("Weather/Longitude") == ConfigSource::Environment);
+    QVERIFY(!configManager.getValue("WEATHER/LONGITUDE", QVariant()).isValid());
+    QCOMPARE(configManager.getValue("Zone/1/Valve").toInt(), 3);
+    QCOMPARE(configManager.getValue("Weather/City").toString(), QString("Zürich"));
+    QVERIFY(configManager.source("Weather/City") == ConfigSource::CommandLine);
+    QCOMPARE(configManager.getValue("Weather/Url").toString(), QString("https://example.com/?a=1"));
+    QVERIFY(!configManager.getValue("CONFIG", QVariant()).isValid());
+    QVERIFY(configManager.source("Weather/Missing") == ConfigSource::Unset);
+
+    // The layers stay in place when the file is reloaded
+    QSignalSpy reloadedSpy(&configManager, &ConfigManager::reloaded);
+    QVERIFY(writeConfigFile("temp_layered_config.txt", "[Weather]\nLatitude=48.14\nLongitude=13.40\nCity=Berlin\n"));
+    configManager.reload();
+    QTRY_COMPARE(reloadedSpy.count(), 1);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toString(), QString("48.14"));
+    QCOMPARE(configManager.getValue("Weather/Longitude").toString(), QString("11.58"));
+    QCOMPARE(configManager.getValue("Weather/City").toString(), QString("Zürich"));
+}
+
+void ConfigManagerTest::testInvalidOverride()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QString errorString;
+    QVERIFY(!configManager.setOverrides({"Weather/City=Berlin", "Weather/City"}, &errorString));
+    QVERIFY(errorString.contains("Weather/City"));
+    QVERIFY(!configManager.setOverrides({"=Berlin"}));
+    QVERIFY(configManager.setOverrides({}));
+}
+
+void ConfigManagerTest::testSetValue()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_write_config.txt", "; Location\n[Weather]\nLatitude = 52.52\nLongitude=13.40\n"));
+    configManager.initialise("temp_write_config.txt");
+    QSignalSpy changedSpy(&configManager, &ConfigManager::valueChanged);
+
+    // Visible right away, written with flush()
+    configManager.setValue("Weather/Latitude", 48.14);
+    configManager.setValue("Zone/1/DurationSecs", 600);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toString(), QString("48.14"));
+    QCOMPARE(configManager.getValue("Zone/1/DurationSecs").toInt(), 600);
+    QVERIFY(configManager.source("Zone/1/DurationSecs") == ConfigSource::File);
+    QCOMPARE(changedSpy.count(), 2);
+    QVERIFY(configManager.flush());
+
+    QFile file("temp_write_config.txt");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("; Location\n[Weather]\nLatitude = 48.14\nLongitude=13.40\n\n[Zone/1]\nDurationSecs=600\n"));
+    file.close();
+
+    // The written values survive loading the file again
+    configManager.initialise("temp_write_config.txt");
+    QCOMPARE(configManager.getValue("Zone/1/DurationSecs").toInt(), 600);
+
+}
+
+void ConfigManagerTest::testUpdateTransaction()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_write_config.txt", "[Weather]\nLatitude=52.52\nLongitude=13.40\n"));
+    configManager.initialise("temp_write_config.txt");
+    const quint64 version = configManager.version();
+
+    configManager.beginUpdate();
+    configManager.setValue("Weather/Latitude", "48.14");
+    configManager.beginUpdate();
+    configManager.setValue("Weather/Longitude", "11.58");
+    configManager.commit();
+    // Nothing is published before the outermost commit()
+    QCOMPARE(configManager.getValue("Weather/Latitude").toString(), QString("52.52"));
+    QCOMPARE(configManager.version(), version);
+    configManager.commit();
+
+    QCOMPARE(configManager.version(), version + 1);
+    QCOMPARE(configManager.getValue("Weather/Latitude").toString(), QString("48.14"));
+    QCOMPARE(configManager.getValue("Weather/Longitude").toString(), QString("11.58"));
+    QVERIFY(configManager.flush());
+
+}
+
+void ConfigManagerTest::testWritesAreCoalesced()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_write_config.txt", "[Zone/1]\nDurationSecs=600\n"));
+    configManager.initialise("temp_write_config.txt");
+    configManager.setWriteDelay(50);
+    QSignalSpy writtenSpy(&configManager, &ConfigManager::valuesWritten);
+
+    // A slider being dragged: one write for all of its values
+    for (int duration = 1; duration <= 100; ++duration)
+        configManager.setValue("Zone/1/DurationSecs", duration);
+    QTRY_COMPARE(writtenSpy.count(), 1);
+    QTest::qWait(100);
+    QCOMPARE(writtenSpy.count(), 1);
+
+    QFile file("temp_write_config.txt");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Zone/1]\nDurationSecs=100\n"));
+    file.close();
+}
+
+void ConfigManagerTest::testChangedValuesOfSnapshot()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QVERIFY(writeConfigFile("temp_write_config.txt", "[Weather]\nLatitude=52.52\nLongitude=13.40\n"));
+    configManager.initialise("temp_write_config.txt");
+
+    // A slot publishing another snapshot while the changes of the first one are being emitted
+    QList<QPair<QString, QString>> changes;
+    const QMetaObject::Connection connection = connect(&configManager, &ConfigManager::valueChanged, this,
+                                                       [&configManager, &changes](const QString& key, const QVariant& value) {
+        changes.append({key, value.toString()});
+        if (key == "Weather/Latitude" && value.toString() == "48.14")
+            configManager.setValue("Weather/Longitude", "0");
+    }, Qt::DirectConnection);
+    configManager.beginUpdate();
+    configManager.setValue("Weather/Latitude", "48.14");
+    configManager.setValue("Weather/Longitude", "11.58");
+    configManager.commit();
+    disconnect(connection);
+
+    // Each signal carries the value of the snapshot that changed the key
+    QCOMPARE(configManager.getValue("Weather/Longitude").toString(), QString("0"));
+    QVERIFY(changes.contains(QPair<QString, QString>("Weather/Longitude", "11.58")));
+    QVERIFY(changes.contains(QPair<QString, QString>("Weather/Longitude", "0")));
+    QVERIFY(configManager.flush());
+
+}
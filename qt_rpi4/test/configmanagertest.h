@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QTest>
 #include <configmanager.h>
+#include <configkey.h>
 #include <stdexcept>
 
 class ConfigManagerTest : public QObject
@@ -17,9 +18,24 @@ signals:
 private slots:
     void initTestCase();
     void cleanupTestCase();
+    void cleanup();
     void testGetValue();
     void testKeyNotFound();
     void testFileOpenError();
+    void testReload();
+    void testReloadKeepsValuesOnError();
+    void testReloadWhenFileChanges();
+    void testChangedKeys();
+    void testConfigKey();
+    void testConfigKeyDefault();
+    void testConfigKeyTypeError();
+    void testConfigKeyFollowsReload();
+    void testLayeredValues();
+    void testInvalidOverride();
+    void testSetValue();
+    void testUpdateTransaction();
+    void testWritesAreCoalesced();
+    void testChangedValuesOfSnapshot();
 
 };
 
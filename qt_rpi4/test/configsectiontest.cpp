@@ -0,0 +1,166 @@
+#include "configsectiontest.h"
+#include <QFile>
+#include <iniparser.h>
+#include <configmanager.h>
+#include <configcache.h>
+
+namespace {
+
+ConfigTable parse(QByteArrayView text)
+{
+    ConfigTable table;
+    IniParser::parse(text, [&table](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+        table.insert(section, key, value);
+    });
+    return table;
+}
+
+struct Zone
+{
+    QString id;
+    int valve = -1;
+    int durationSecs = 600;
+    bool enabled = true;
+    double flowRate = 0.0;
+};
+
+ConfigSchema<Zone> zoneSchema()
+{
+    return ConfigSchema<Zone>()
+        .sectionName(&Zone::id)
+        .field("Valve", &Zone::valve)
+        .field("DurationSecs", &Zone::durationSecs)
+        .field("Enabled", &Zone::enabled)
+        .field("FlowRate", &Zone::flowRate);
+}
+
+} // namespace
+
+ConfigSectionTest::ConfigSectionTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ConfigSectionTest");
+}
+
+void ConfigSectionTest::testSections()
+{
+    const ConfigTable table = parse("global=1\n[Weather]\nLatitude=52.52\n[Zone/2]\nValve=3\n[Logging]\nLevel=info\n"
+                                    "[Weather]\nLongitude=13.40\n");
+    const ConfigSectionIndex index(table);
+    QCOMPARE(index.sectionCount(), 4);
+    QCOMPARE(index.sectionNames(), QStringList({"", "Logging", "Weather", "Zone/2"}));
+    QCOMPARE(index.section(u"").size(), 1);
+    QCOMPARE(index.section(u"").key(0), QStringView(u"global"));
+    QVERIFY(index.section(u"Missing").isEmpty());
+    QVERIFY(index.section(u"Zone").isEmpty());
+}
+
+void ConfigSectionTest::testSectionKeys()
+{
+    // The keys of a section which appears twice are merged, in insertion order
+    const ConfigTable table = parse("[Weather]\nLatitude=52.52\n[Zone/1]\nValve=1\n[Weather]\nLongitude=13.40\n");
+    const ConfigSectionIndex index(table);
+    const ConfigSection weather = index.section(u"Weather");
+    QCOMPARE(weather.name(), QStringView(u"Weather"));
+    QCOMPARE(weather.size(), 2);
+    QCOMPARE(weather.key(0), QStringView(u"Latitude"));
+    QCOMPARE(weather.value(0).toString(), QString("52.52"));
+    QCOMPARE(weather.key(1), QStringView(u"Longitude"));
+    QCOMPARE(weather.entry(1).key, QString("Weather/Longitude"));
+    QCOMPARE(weather.find(u"Longitude")->toString(), QString("13.40"));
+    QVERIFY(!weather.find(u"Valve"));
+}
+
+void ConfigSectionTest::testPrefix()
+{
+    const ConfigTable table = parse("[Zone/2]\nValve=2\n[Zones]\nCount=3\n[Zone/10]\nValve=10\n[Zone/1]\nValve=1\n"
+                                    "[Zone/1/Sensor]\nPin=7\n[Weather]\nLatitude=52.52\n");
+    const ConfigSectionIndex index(table);
+    QCOMPARE(index.sectionNames(u"Zone/"), QStringList({"Zone/1", "Zone/1/Sensor", "Zone/10", "Zone/2"}));
+    QCOMPARE(index.sectionNames(u"Zone/1/"), QStringList({"Zone/1/Sensor"}));
+    QVERIFY(index.sectionNames(u"Valve").isEmpty());
+
+    int count = 0;
+    index.forEachSection(u"Zone", [&count](const ConfigSection&) { ++count; });
+    QCOMPARE(count, 5);
+}
+
+void ConfigSectionTest::testSchema()
+{
+    const ConfigTable table = parse("[Zone/7]\nValve=4\nEnabled=no\nUnknown=x\nFlowRate=2.5\n");
+    const ConfigSectionIndex index(table);
+    Zone zone;
+    QVERIFY(zoneSchema().read(index.section(u"Zone/7"), zone));
+    QCOMPARE(zone.id, QString("Zone/7"));
+    QCOMPARE(zone.valve, 4);
+    QCOMPARE(zone.durationSecs, 600); // Missing keys keep the default
+    QCOMPARE(zone.enabled, false);
+    QCOMPARE(zone.flowRate, 2.5);
+}
+
+void ConfigSectionTest::testSchemaErrors()
+{
+    const ConfigTable table = parse("[Zone/1]\nValve=three\nDurationSecs=60\n");
+    const ConfigSectionIndex index(table);
+    Zone zone;
+    QStringList errors;
+    QVERIFY(!zoneSchema().read(index.section(u"Zone/1"), zone, &errors));
+    QCOMPARE(zone.valve, -1);
+    QCOMPARE(zone.durationSecs, 60);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(errors.first().startsWith("Zone/1/Valve=three is not a valid int"));
+}
+
+void ConfigSectionTest::testManyZones()
+{
+    QByteArray content = "[Weather]\nLatitude=52.52\n";
+    for (int i = 0; i < 2000; ++i)
+    {
+        content += "[Zone/" + QByteArray::number(i) + "]\nValve=" + QByteArray::number(i % 16)
+                   + "\nDurationSecs=" + QByteArray::number(60 + i) + "\nEnabled=" + (i % 2 ? "false" : "true") + "\n";
+    }
+    const ConfigTable table = parse(content);
+    const ConfigSectionIndex index(table);
+    QCOMPARE(index.sectionCount(), 2001);
+
+    Zone defaults;
+    defaults.flowRate = 1.5;
+    const QList<Zone> zones = zoneSchema().readSections(index, u"Zone/", defaults);
+    QCOMPARE(zones.size(), 2000);
+    // Sorted by name: Zone/0, Zone/1, Zone/10, Zone/100, ...
+    QCOMPARE(zones[2].id, QString("Zone/10"));
+    QCOMPARE(zones[2].durationSecs, 70);
+    for (const Zone& zone : zones)
+    {
+        const int i = zone.id.sliced(5).toInt();
+        QCOMPARE(zone.valve, i % 16);
+        QCOMPARE(zone.durationSecs, 60 + i);
+        QCOMPARE(zone.enabled, i % 2 == 0);
+        QCOMPARE(zone.flowRate, 1.5);
+    }
+}
+
+void ConfigSectionTest::testReadSections()
+{
+    ConfigManager& configManager = ConfigManager::instance();
+    QFile file("temp_section_config.txt");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[Zone/1]\nValve=1\nDurationSecs=30\n[Zone/2]\nValve=2\n[Weather]\nLatitude=52.52\n");
+    file.close();
+    configManager.initialise("temp_section_config.txt");
+
+    QCOMPARE(configManager.sections(), QStringList({"Weather", "Zone/1", "Zone/2"}));
+    QCOMPARE(configManager.sections("Zone/"), QStringList({"Zone/1", "Zone/2"}));
+    const QMap<QString, QVariant> values = configManager.sectionValues("Zone/1");
+    QCOMPARE(values.keys(), QStringList({"DurationSecs", "Valve"}));
+    QCOMPARE(values.value("DurationSecs").toString(), QString("30"));
+
+    const QList<Zone> zones = configManager.readSections("Zone/", zoneSchema());
+    QCOMPARE(zones.size(), 2);
+    QCOMPARE(zones[0].durationSecs, 30);
+    QCOMPARE(zones[1].valve, 2);
+    QCOMPARE(zones[1].durationSecs, 600);
+
+    QFile::remove("temp_section_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_section_config.txt"));
+}
@@ -0,0 +1,27 @@
+#ifndef CONFIGSECTIONTEST_H
+#define CONFIGSECTIONTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <configsection.h>
+#include <configschema.h>
+
+class ConfigSectionTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigSectionTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testSections();
+    void testSectionKeys();
+    void testPrefix();
+    void testSchema();
+    void testSchemaErrors();
+    void testManyZones();
+    void testReadSections();
+};
+
+#endif // CONFIGSECTIONTEST_H
@@ -0,0 +1,138 @@
+#include "flightrecordertest.h"
+#include <QFile>
+#include <cstddef>
+
+FlightRecorderTest::FlightRecorderTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("FlightRecorderTest");
+}
+
+QList<FlightRecorder::Entry> FlightRecorderTest::decodeFile(const QString &path)
+{
+    QList<FlightRecorder::Entry> entries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return entries;
+    const QByteArray data = file.readAll();
+    QString errorString;
+    if (!FlightRecorder::decode(data, entries, &errorString))
+        qWarning() << "Decoding failed:" << errorString;
+    return entries;
+}
+
+void FlightRecorderTest::testAppendAndDecode()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("test.flight");
+
+    FlightRecorder recorder;
+    QVERIFY(recorder.open(path, FlightRecorder::MinCapacity));
+    recorder.append(QtInfoMsg, ": fetch.done latency_ms=120");
+    recorder.append(QtWarningMsg, " [weather.fetch]: Network error occured");
+    recorder.append(QtDebugMsg, QByteArray(FlightRecorder::MaxTextLength + 100, 'x'));
+    recorder.close();
+
+    const QList<FlightRecorder::Entry> entries = decodeFile(path);
+    QCOMPARE(entries.size(), 3);
+    QCOMPARE(entries[0].type, QtInfoMsg);
+    QCOMPARE(entries[0].text, QByteArray(": fetch.done latency_ms=120"));
+    QCOMPARE(entries[1].type, QtWarningMsg);
+    QCOMPARE(entries[1].text, QByteArray(" [weather.fetch]: Network error occured"));
+    QVERIFY(entries[0].msecs > 0);
+    // Long texts are truncated
+    QCOMPARE(entries[2].text.size(), FlightRecorder::MaxTextLength);
+}
+
+void FlightRecorderTest::testWrapAround()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("test.flight");
+
+    // Write far more than fits, so the file wraps around many times
+    const int count = 5000;
+    FlightRecorder recorder;
+    QVERIFY(recorder.open(path, FlightRecorder::MinCapacity));
+    for (int i = 0; i < count; ++i)
+        recorder.append(QtInfoMsg, "record " + QByteArray::number(i) + QByteArray(i % 50, '.'));
+    recorder.close();
+
+    // Only the latest records are left, without gaps and in order
+    const QList<FlightRecorder::Entry> entries = decodeFile(path);
+    QVERIFY(entries.size() > 100);
+    QVERIFY(entries.size() < count);
+    QVERIFY(entries.last().text.startsWith("record " + QByteArray::number(count - 1)));
+    int expected = count - static_cast<int>(entries.size());
+    for (const FlightRecorder::Entry& entry : entries)
+    {
+        QVERIFY(entry.text.startsWith("record " + QByteArray::number(expected) + (expected % 50 ? "." : "")));
+        ++expected;
+    }
+}
+
+void FlightRecorderTest::testReopenContinues()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("test.flight");
+
+    FlightRecorder recorder;
+    QVERIFY(recorder.open(path, FlightRecorder::MinCapacity));
+    recorder.append(QtInfoMsg, "first run");
+    recorder.close();
+
+    // Same capacity: the records of the previous run are kept
+    QVERIFY(recorder.open(path, FlightRecorder::MinCapacity));
+    recorder.append(QtInfoMsg, "second run");
+    recorder.close();
+    QList<FlightRecorder::Entry> entries = decodeFile(path);
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries[0].text, QByteArray("first run"));
+    QCOMPARE(entries[1].text, QByteArray("second run"));
+
+    // Another capacity: the file is started from scratch
+    QVERIFY(recorder.open(path, 2 * FlightRecorder::MinCapacity));
+    recorder.append(QtInfoMsg, "third run");
+    recorder.close();
+    entries = decodeFile(path);
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries[0].text, QByteArray("third run"));
+}
+
+void FlightRecorderTest::testTornRecordIsSkipped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("test.flight");
+
+    FlightRecorder recorder;
+    QVERIFY(recorder.open(path, FlightRecorder::MinCapacity));
+    recorder.append(QtInfoMsg, "complete");
+    recorder.append(QtInfoMsg, "torn");
+    recorder.close();
+
+    // Simulate a crash while the second record was written: its marker is still missing
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    const qint64 secondRecord = sizeof(FlightRecorder::FileHeader) + sizeof(FlightRecorder::RecordHeader) + 8;
+    QVERIFY(file.seek(secondRecord + offsetof(FlightRecorder::RecordHeader, marker)));
+    const quint32 incomplete = 0;
+    file.write(reinterpret_cast<const char*>(&incomplete), sizeof(incomplete));
+    file.close();
+
+    const QList<FlightRecorder::Entry> entries = decodeFile(path);
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries[0].text, QByteArray("complete"));
+}
+
+void FlightRecorderTest::testDecodeRejectsOtherFiles()
+{
+    QList<FlightRecorder::Entry> entries;
+    QString errorString;
+    QVERIFY(!FlightRecorder::decode(QByteArray("2023-12-01 10:00:00.000 [DEBUG]: text log"), entries, &errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!FlightRecorder::decode(QByteArray(4096, '\0'), entries, &errorString));
+    QVERIFY(entries.isEmpty());
+}
@@ -0,0 +1,28 @@
+#ifndef FLIGHTRECORDERTEST_H
+#define FLIGHTRECORDERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <flightrecorder.h>
+
+class FlightRecorderTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FlightRecorderTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testAppendAndDecode();
+    void testWrapAround();
+    void testReopenContinues();
+    void testTornRecordIsSkipped();
+    void testDecodeRejectsOtherFiles();
+
+private:
+    static QList<FlightRecorder::Entry> decodeFile(const QString& path);
+};
+
+#endif // FLIGHTRECORDERTEST_H
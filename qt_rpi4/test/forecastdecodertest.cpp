@@ -0,0 +1,205 @@
+#include "forecastdecodertest.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+ForecastDecoderTest::ForecastDecoderTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ForecastDecoderTest");
+}
+
+void ForecastDecoderTest::initTestCase()
+{
+    // Get test data from a external JSON file
+    QFile file("../../qt_rpi4/test/data/test_data_weather.json");
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << this << "Couldn't open file: " << file.fileName() << " Error: " << file.errorString();
+        return;
+    }
+    m_jsonData = file.readAll();
+}
+
+void ForecastDecoderTest::compareEntries(const QList<ForecastEntry>& actual, const QList<ForecastEntry>& expected)
+{
+    QCOMPARE(actual.size(), expected.size());
+    for (qsizetype i = 0; i < actual.size(); ++i)
+    {
+        const ForecastEntry& a = actual.at(i);
+        const ForecastEntry& e = expected.at(i);
+        QCOMPARE(a.dt, e.dt);
+        // Both are interned in the same table
+        QCOMPARE(a.weatherCondition, e.weatherCondition);
+        QCOMPARE(a.mainTemp, e.mainTemp);
+        QCOMPARE(a.mainTempMin, e.mainTempMin);
+        QCOMPARE(a.mainTempMax, e.mainTempMax);
+        QCOMPARE(a.windSpeed, e.windSpeed);
+        QCOMPARE(a.snow3h, e.snow3h);
+        QCOMPARE(a.rain3h, e.rain3h);
+        QCOMPARE(a.pop, e.pop);
+        QCOMPARE(a.feelsLikeCentidegrees, e.feelsLikeCentidegrees);
+        QCOMPARE(a.humidityPercent, e.humidityPercent);
+        QCOMPARE(a.pressureHpa, e.pressureHpa);
+        QCOMPARE(a.cloudsPercent, e.cloudsPercent);
+        QCOMPARE(a.windDegrees, e.windDegrees);
+        QCOMPARE(a.windGustCentimetres, e.windGustCentimetres);
+        QCOMPARE(a.visibilityMetres, e.visibilityMetres);
+        QVERIFY(a.partOfDay == e.partOfDay);
+        QCOMPARE(a.isCurrent, e.isCurrent);
+    }
+}
+
+void ForecastDecoderTest::testMatchesJsonDocument()
+{
+    if (m_jsonData.isEmpty())
+        QSKIP("The test data couldn't be loaded");
+
+    // The decoder must give the same entries as ForecastEntry::fromJson() on the QJsonDocument
+    const QJsonObject json = QJsonDocument::fromJson(m_jsonData).object();
+    QList<ForecastEntry> expected;
+    for (const QJsonValue& listValue : json.value("list").toArray())
+        expected.append(ForecastEntry::fromJson(listValue.toObject(), expected.isEmpty()));
+
+    ForecastDecoder decoder;
+    QVERIFY2(decoder.decode(m_jsonData), qPrintable(decoder.errorString()));
+    QVERIFY(!decoder.hasError());
+    QCOMPARE(decoder.errorOffset(), qint64(-1));
+    QCOMPARE(decoder.cityName(), json.value("city").toObject().value("name").toString());
+    QCOMPARE(decoder.entryCount(), qsizetype(40));
+    compareEntries(decoder.takeEntries(), expected);
+    QCOMPARE(decoder.entryCount(), qsizetype(0));
+}
+
+void ForecastDecoderTest::testChunks_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::newRow("1 byte") << 1;
+    QTest::newRow("7 bytes") << 7;
+    QTest::newRow("TCP segment") << 1460;
+}
+
+void ForecastDecoderTest::testChunks()
+{
+    QFETCH(int, chunkSize);
+    if (m_jsonData.isEmpty())
+        QSKIP("The test data couldn't be loaded");
+
+    ForecastDecoder whole;
+    QVERIFY(whole.decode(m_jsonData));
+
+    // Tokens split across chunks must give the same result, as with readyRead()
+    ForecastDecoder decoder;
+    for (qsizetype i = 0; i < m_jsonData.size(); i += chunkSize)
+        QVERIFY(decoder.feed(QByteArrayView(m_jsonData).sliced(i, qMin<qsizetype>(chunkSize, m_jsonData.size() - i))));
+    QVERIFY2(decoder.finish(), qPrintable(decoder.errorString()));
+    QCOMPARE(decoder.cityName(), whole.cityName());
+    compareEntries(decoder.takeEntries(), whole.takeEntries());
+}
+
+void ForecastDecoderTest::testSkipsUnknownFields()
+{
+    // Fields of the same name elsewhere in the reply are no entry values, only weather[0] counts
+    const QByteArray json = R"({"cod":"200","extra":{"main":{"temp":99},"list":[{"dt":1}]},
+        "list":[{"dt":1700000000,"main":{"temp":-1.5,"humidity":[1,{"temp":2}]},
+                 "weather":[{"id":500,"main":"Rain","description":"light rain","icon":"10d"},{"id":800,"main":"Clear"}],
+                 "wind":{"speed":3.25,"gust":null},"rain":{"3h":0.5,"1h":0.2},"pop":1,"visibility":true},
+                3, "text", null,
+                {"dt":1.7e9,"snow":{"3h":2e-1},"weather":[]}],
+        "city":{"id":1,"name":"Ulm","coord":{"lat":48.4,"lon":9.98}}})";
+    ForecastDecoder decoder;
+    QVERIFY2(decoder.decode(json), qPrintable(decoder.errorString()));
+    QCOMPARE(decoder.cityName(), QString("Ulm"));
+    const QList<ForecastEntry> entries = decoder.takeEntries();
+    QCOMPARE(entries.size(), qsizetype(2));
+
+    QCOMPARE(entries[0].dt, qint64(1700000000));
+    QCOMPARE(entries[0].mainTemp, -1.5);
+    QCOMPARE(entries[0].weatherId(), QString("500"));
+    QCOMPARE(entries[0].weatherMain(), QString("Rain"));
+    QCOMPARE(entries[0].weatherDescription(), QString("light rain"));
+    QCOMPARE(entries[0].weatherIcon(), QString("10d"));
+    QCOMPARE(entries[0].windSpeed, 3.25);
+    QCOMPARE(entries[0].rain3h, 0.5);
+    QCOMPARE(entries[0].pop, 1.0);
+    QVERIFY(entries[0].isCurrent);
+
+    QCOMPARE(entries[1].dt, qint64(1700000000));
+    QCOMPARE(entries[1].snow3h, 0.2);
+    QVERIFY(entries[1].weatherMain().isEmpty());
+    QCOMPARE(entries[1].weatherCondition, WeatherConditions::Unknown);
+    QVERIFY(!entries[1].isCurrent);
+}
+
+void ForecastDecoderTest::testEscapes()
+{
+    const QByteArray json = R"({"city":{"name":"München \"Nord\"\t🌧 \ud800!"},"list":[]})";
+    ForecastDecoder decoder;
+    QVERIFY2(decoder.decode(json), qPrintable(decoder.errorString()));
+    // A lone surrogate becomes U+FFFD, as with QJsonDocument
+    QCOMPARE(decoder.cityName(), QString::fromUtf8("München \"Nord\"\t\U0001F327 �!"));
+    QCOMPARE(decoder.entryCount(), qsizetype(0));
+}
+
+void ForecastDecoderTest::testMalformed_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<qint64>("offset");
+    QTest::newRow("empty") << QByteArray() << qint64(0);
+    QTest::newRow("trailing comma") << QByteArray(R"({"list":[1,]})") << qint64(11);
+    QTest::newRow("literal") << QByteArray(R"({"a":tru})") << qint64(8);
+    QTest::newRow("escape") << QByteArray(R"({"a":"x\q"})") << qint64(8);
+    QTest::newRow("control character") << QByteArray("{\"a\":\"\x01\"}") << qint64(6);
+    QTest::newRow("number") << QByteArray(R"({"a":1.2.3})") << qint64(5);
+    QTest::newRow("leading zero") << QByteArray(R"({"a":01})") << qint64(5);
+    QTest::newRow("missing colon") << QByteArray(R"({"a" 1})") << qint64(5);
+    QTest::newRow("key") << QByteArray(R"({1:2})") << qint64(1);
+    QTest::newRow("bracket") << QByteArray(R"({"a":[1})") << qint64(7);
+    QTest::newRow("after the document") << QByteArray(R"({"a":1}})") << qint64(7);
+    QTest::newRow("truncated") << QByteArray(R"({"list":[)") << qint64(9);
+}
+
+void ForecastDecoderTest::testMalformed()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(qint64, offset);
+
+    // The offset doesn't depend on how the input is split
+    for (int chunkSize : {1, 3, 4096})
+    {
+        ForecastDecoder decoder;
+        bool ok = true;
+        for (qsizetype i = 0; ok && i < json.size(); i += chunkSize)
+            ok = decoder.feed(QByteArrayView(json).sliced(i, qMin<qsizetype>(chunkSize, json.size() - i)));
+        if (ok)
+            ok = decoder.finish();
+        QVERIFY(!ok);
+        QVERIFY(decoder.hasError());
+        QCOMPARE(decoder.errorOffset(), offset);
+        QVERIFY2(decoder.errorString().endsWith(QString(" at byte %1").arg(offset)), qPrintable(decoder.errorString()));
+        // Further input is ignored
+        QVERIFY(!decoder.feed("{}"));
+        QCOMPARE(decoder.errorOffset(), offset);
+    }
+}
+
+void ForecastDecoderTest::testReset()
+{
+    ForecastDecoder decoder;
+    QVERIFY(!decoder.decode(R"({"city":{"name":"Ulm"},"list":[{"dt":1},)"));
+    QCOMPARE(decoder.entryCount(), qsizetype(1));
+
+    // decode() starts over, and so does reset()
+    QVERIFY(decoder.decode(R"({"list":[{"dt":2}]})"));
+    QVERIFY(!decoder.hasError());
+    QVERIFY(decoder.cityName().isEmpty());
+    QCOMPARE(decoder.takeEntries().size(), qsizetype(1));
+
+    decoder.reset();
+    QVERIFY(decoder.feed(R"({"list":[{"dt":3},)"));
+    QCOMPARE(decoder.entryCount(), qsizetype(1));
+    decoder.reset();
+    QCOMPARE(decoder.entryCount(), qsizetype(0));
+    QVERIFY(decoder.feed(R"({"list":[]})"));
+    QVERIFY(decoder.finish());
+}
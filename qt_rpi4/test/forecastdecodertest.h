@@ -0,0 +1,34 @@
+#ifndef FORECASTDECODERTEST_H
+#define FORECASTDECODERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <forecastdecoder.h>
+
+class ForecastDecoderTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ForecastDecoderTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void initTestCase(); // Will be called before the first test function is executed
+
+    void testMatchesJsonDocument();
+    void testChunks_data();
+    void testChunks();
+    void testSkipsUnknownFields();
+    void testEscapes();
+    void testMalformed_data();
+    void testMalformed();
+    void testReset();
+
+private:
+    static void compareEntries(const QList<ForecastEntry>& actual, const QList<ForecastEntry>& expected);
+
+    QByteArray m_jsonData; // test/data/test_data_weather.json
+};
+
+#endif // FORECASTDECODERTEST_H
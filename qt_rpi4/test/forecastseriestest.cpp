@@ -0,0 +1,200 @@
+#include "forecastseriestest.h"
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <forecastkernels.h>
+#include <weathermodel.h>
+#include <cmath>
+#include <limits>
+
+ForecastSeriesTest::ForecastSeriesTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("ForecastSeriesTest");
+}
+
+QList<float> ForecastSeriesTest::randomValues(qsizetype count)
+{
+    QRandomGenerator random(42);
+    QList<float> values(count);
+    for (float& value : values)
+        value = float(random.bounded(70.0) - 30.0);
+    return values;
+}
+
+QList<ForecastEntry> ForecastSeriesTest::entries(int count)
+{
+    const qint64 start = QDate(2024, 6, 1).startOfDay().toSecsSinceEpoch();
+    QList<ForecastEntry> entries;
+    for (int i = 0; i < count; ++i)
+    {
+        ForecastEntry entry;
+        entry.dt = start + i * 3 * 3600;
+        entry.mainTemp = 10 + i % 8;
+        entry.mainTempMin = entry.mainTemp - 1 - i / 8;
+        entry.mainTempMax = entry.mainTemp + 1 + i / 8;
+        entry.rain3h = i % 4 == 0 ? 0.5 : 0;
+        entry.pop = (i % 10) / 10.0;
+        entry.windSpeed = i % 5;
+        entry.isCurrent = i == 0;
+        entries.append(entry);
+    }
+    return entries;
+}
+
+void ForecastSeriesTest::testKernels_data()
+{
+    QTest::addColumn<int>("count");
+    // Empty, less than a vector, whole vectors, unrolled loop and remainders
+    for (int count : {0, 1, 3, 4, 5, 16, 17, 40, 1001})
+        QTest::addRow("%d values", count) << count;
+}
+
+void ForecastSeriesTest::testKernels()
+{
+    QFETCH(int, count);
+    const QList<float> values = randomValues(count);
+    double sum = 0;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+    for (float value : values)
+    {
+        sum += value;
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+
+    // Sums differ in the order of the additions only
+    const double tolerance = 1e-5 * count * 40;
+    QVERIFY2(std::abs(ForecastKernels::sum(values.constData(), count) - sum) <= tolerance, ForecastKernels::instructionSet());
+    QVERIFY(std::abs(ForecastKernels::Scalar::sum(values.constData(), count) - sum) <= tolerance);
+    QCOMPARE(ForecastKernels::min(values.constData(), count), min);
+    QCOMPARE(ForecastKernels::max(values.constData(), count), max);
+    QCOMPARE(ForecastKernels::Scalar::min(values.constData(), count), min);
+    QCOMPARE(ForecastKernels::Scalar::max(values.constData(), count), max);
+}
+
+void ForecastSeriesTest::testWindows_data()
+{
+    QTest::addColumn<int>("window");
+    // Up to ForecastKernels' short windows, and a running sum and block maxima beyond them. The
+    // 100 values are cut into blocks of window values, with and without a partial last block.
+    for (int window : {0, 1, 3, 4, 8, 16, 17, 33, 40, 50, 51, 99, 100, 101})
+        QTest::addRow("window %d", window) << window;
+}
+
+void ForecastSeriesTest::testWindows()
+{
+    QFETCH(int, window);
+    const int count = 100;
+    const QList<float> values = randomValues(count);
+    const qsizetype expectedCount = window > 0 && window <= count ? count - window + 1 : 0;
+
+    // One more value, which must not be written
+    QList<float> sums(expectedCount + 1, -1000.0f);
+    QList<float> scalarSums(expectedCount + 1, -1000.0f);
+    QList<float> maxima(expectedCount + 1, -1000.0f);
+    QList<float> scalarMaxima(expectedCount + 1, -1000.0f);
+    QCOMPARE(ForecastKernels::windowSum(values.constData(), count, window, sums.data()), expectedCount);
+    QCOMPARE(ForecastKernels::Scalar::windowSum(values.constData(), count, window, scalarSums.data()), expectedCount);
+    QCOMPARE(ForecastKernels::windowMax(values.constData(), count, window, maxima.data()), expectedCount);
+    QCOMPARE(ForecastKernels::Scalar::windowMax(values.constData(), count, window, scalarMaxima.data()), expectedCount);
+
+    for (qsizetype i = 0; i < expectedCount; ++i)
+    {
+        double sum = 0;
+        float max = -std::numeric_limits<float>::infinity();
+        for (qsizetype k = i; k < i + window; ++k)
+        {
+            sum += values.at(k);
+            max = qMax(max, values.at(k));
+        }
+        QVERIFY2(std::abs(sums.at(i) - sum) <= 1e-4 * (window + 1), qPrintable(QString("window at %1").arg(i)));
+        QVERIFY(std::abs(scalarSums.at(i) - sum) <= 1e-4 * (window + 1));
+        QCOMPARE(maxima.at(i), max);
+        QCOMPARE(scalarMaxima.at(i), max);
+    }
+    QCOMPARE(sums.last(), -1000.0f);
+    QCOMPARE(scalarSums.last(), -1000.0f);
+    QCOMPARE(maxima.last(), -1000.0f);
+    QCOMPARE(scalarMaxima.last(), -1000.0f);
+}
+
+void ForecastSeriesTest::testAggregates()
+{
+    const QList<ForecastEntry> forecast = entries(40);
+    const ForecastSeries series(forecast);
+    QCOMPARE(series.size(), qsizetype(40));
+    QCOMPARE(series.times().at(1), forecast.at(1).dt);
+    QCOMPARE(series.rains().at(4), 0.5f);
+
+    // 10 entries with 0.5 mm
+    QCOMPARE(series.totalRain(), 5.0f);
+    QCOMPARE(series.totalRain(0, 8), 1.0f);
+    QCOMPARE(series.maxPop(), 0.9f);
+    QCOMPARE(series.maxPop(0, 5), 0.4f);
+    QCOMPARE(series.minTemperature(), 5.0f); // 10 - 1 - 4 at index 32
+    QCOMPARE(series.maxTemperature(), 22.0f); // 17 + 1 + 4 at index 39
+    QCOMPARE(series.meanWindSpeed(), 2.0f);
+
+    // Ranges are clamped, empty ranges are 0
+    QCOMPARE(series.totalRain(36, 100), 0.5f);
+    QCOMPARE(series.totalRain(40), 0.0f);
+    QCOMPARE(series.maxPop(-5, 1), 0.0f);
+    QCOMPARE(series.meanWindSpeed(50), 0.0f);
+
+    // The rain of the next 24 hours from every entry on
+    const QList<float> rain = series.rainWindows(8);
+    QCOMPARE(rain.size(), qsizetype(33));
+    for (float value : rain)
+        QCOMPARE(value, 1.0f);
+    QCOMPARE(series.popWindows(10).first(), 0.9f);
+    QVERIFY(series.rainWindows(41).isEmpty());
+
+    // Reassigning replaces all values
+    ForecastSeries reused = series;
+    reused.assign(entries(3));
+    QCOMPARE(reused.size(), qsizetype(3));
+    QCOMPARE(reused.totalRain(), 0.5f);
+    reused.clear();
+    QVERIFY(reused.isEmpty());
+    QCOMPARE(reused.maxTemperature(), 0.0f);
+}
+
+void ForecastSeriesTest::testDays()
+{
+    // Five whole days of eight entries, June has no change of the daylight saving time
+    const ForecastSeries series(entries(40));
+    const QList<ForecastSeries::Day> days = series.days();
+    QCOMPARE(days.size(), qsizetype(5));
+    for (int d = 0; d < days.size(); ++d)
+    {
+        const ForecastSeries::Day& day = days.at(d);
+        QCOMPARE(day.date, QDate(2024, 6, 1 + d));
+        QCOMPARE(day.first, qsizetype(d * 8));
+        QCOMPARE(day.count, qsizetype(8));
+        QCOMPARE(day.minTemperature, float(10 - 1 - d));
+        QCOMPARE(day.maxTemperature, float(17 + 1 + d));
+    }
+
+    // A day that has begun already
+    QList<ForecastEntry> forecast = entries(12);
+    forecast.remove(0, 6);
+    const QList<ForecastSeries::Day> partial = ForecastSeries(forecast).days();
+    QCOMPARE(partial.size(), qsizetype(2));
+    QCOMPARE(partial.first().count, qsizetype(2));
+    QCOMPARE(partial.last().first, qsizetype(2));
+    QCOMPARE(partial.last().count, qsizetype(4));
+    QVERIFY(ForecastSeries().days().isEmpty());
+}
+
+void ForecastSeriesTest::testWeatherModel()
+{
+    // The model keeps the series of its entries
+    WeatherModel model;
+    model.setForecast("Ulm", entries(40));
+    QCOMPARE(model.series().size(), qsizetype(40));
+    QCOMPARE(model.series().totalRain(), 5.0f);
+    model.setForecast("Ulm", entries(8));
+    QCOMPARE(model.series().size(), qsizetype(8));
+    QCOMPARE(model.series().totalRain(), 1.0f);
+}
@@ -0,0 +1,31 @@
+#ifndef FORECASTSERIESTEST_H
+#define FORECASTSERIESTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <forecastseries.h>
+
+class ForecastSeriesTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ForecastSeriesTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testKernels_data();
+    void testKernels();
+    void testWindows_data();
+    void testWindows();
+    void testAggregates();
+    void testDays();
+    void testWeatherModel();
+
+private:
+    static QList<float> randomValues(qsizetype count);
+    // Three-hourly entries from midnight (local time) of 1 June 2024 on
+    static QList<ForecastEntry> entries(int count);
+};
+
+#endif // FORECASTSERIESTEST_H
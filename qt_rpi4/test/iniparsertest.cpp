@@ -0,0 +1,120 @@
+#include "iniparsertest.h"
+#include <QFile>
+
+namespace {
+
+ConfigTable parse(QByteArrayView text)
+{
+    ConfigTable table;
+    IniParser::parse(text, [&table](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+        table.insert(section, key, value);
+    });
+    return table;
+}
+
+QString value(const ConfigTable& table, const QString& key)
+{
+    const QVariant* found = table.find(key);
+    return found ? found->toString() : QString("<missing>");
+}
+
+} // namespace
+
+IniParserTest::IniParserTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("IniParserTest");
+}
+
+void IniParserTest::testSectionsAndKeys()
+{
+    const ConfigTable table = parse("global=1\n[Weather]\nLatitude=52.52\n[Zone/1]\nValve=3\n");
+    QCOMPARE(table.size(), 3);
+    QCOMPARE(value(table, "global"), QString("1"));
+    QCOMPARE(value(table, "Weather/Latitude"), QString("52.52"));
+    QCOMPARE(value(table, "Zone/1/Valve"), QString("3"));
+    QVERIFY(!table.contains(u"Latitude"));
+}
+
+void IniParserTest::testValueWithEquals()
+{
+    // The old parser dropped these lines, as they have more than one '='
+    const ConfigTable table = parse("[Weather]\nUrl=https://api.openweathermap.org/data?lat=1&lon=2\nEmpty=\n");
+    QCOMPARE(value(table, "Weather/Url"), QString("https://api.openweathermap.org/data?lat=1&lon=2"));
+    QCOMPARE(value(table, "Weather/Empty"), QString(""));
+}
+
+void IniParserTest::testWhitespaceAndComments()
+{
+    const ConfigTable table = parse("; comment=1\r\n# another = comment\r\n  [ Logging ]  \r\n  Level =  warning \r\n"
+                                    "no separator\r\n = no key\r\n\r\nFormat=json");
+    QCOMPARE(table.size(), 2);
+    QCOMPARE(value(table, "Logging/Level"), QString("warning"));
+    QCOMPARE(value(table, "Logging/Format"), QString("json"));
+}
+
+void IniParserTest::testDuplicateKeys()
+{
+    // The last value wins, the key is stored only once
+    const ConfigTable table = parse("[A]\nkey=1\n[B]\nkey=2\n[A]\nkey=3\n");
+    QCOMPARE(table.size(), 2);
+    QCOMPARE(value(table, "A/key"), QString("3"));
+    QCOMPARE(value(table, "B/key"), QString("2"));
+}
+
+void IniParserTest::testParseFile()
+{
+    QFile file("temp_iniparser_config.txt");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[Weather]\nLatitude=52.52\nLongitude=13.40\n");
+    file.close();
+
+    ConfigTable table;
+    QVERIFY(IniParser::parseFile("temp_iniparser_config.txt", table));
+    QCOMPARE(table.size(), 2);
+    QCOMPARE(value(table, "Weather/Longitude"), QString("13.40"));
+    QFile::remove("temp_iniparser_config.txt");
+
+    QString errorString;
+    QVERIFY(!IniParser::parseFile("nonexistentfile.txt", table, &errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void IniParserTest::testTableGrowth()
+{
+    // Lots of zones, inserted from the parser and looked up by QString
+    QByteArray text;
+    for (int zone = 0; zone < 2000; ++zone)
+        text += "[Zone/" + QByteArray::number(zone) + "]\nValve=" + QByteArray::number(zone) + "\nDuration=600\n";
+    const ConfigTable table = parse(text);
+    QCOMPARE(table.size(), 4000);
+    for (int zone = 0; zone < 2000; ++zone)
+        QCOMPARE(value(table, QString("Zone/%1/Valve").arg(zone)), QString::number(zone));
+
+    // Insertion order is kept
+    QCOMPARE(table.begin()->key, QString("Zone/0/Valve"));
+    QCOMPARE((table.end() - 1)->key, QString("Zone/1999/Duration"));
+
+    // 64 bit FNV-1a on every platform, 32 bit builds included, and the same from the parser
+    QCOMPARE(ConfigTable::hashKey(u"Weather/Latitude"), Q_UINT64_C(0x22819aeb7ac7bf94));
+    QCOMPARE(parse("[Weather]\nLatitude=52.52\n").begin()->hash, ConfigTable::hashKey(u"Weather/Latitude"));
+}
+
+void IniParserTest::testNonAsciiKeys()
+{
+    const ConfigTable table = parse("[Zonen]\nGewächshaus=1\n[Zonen]\nGewächshaus=2\n");
+    QCOMPARE(table.size(), 1);
+    QCOMPARE(value(table, QString::fromUtf8("Zonen/Gewächshaus")), QString("2"));
+}
+
+void IniParserTest::testByteOrderMark()
+{
+    // Saved by Notepad: the first section header must not be lost
+    const ConfigTable table = parse("\xEF\xBB\xBF[Weather]\r\nLatitude=52.52\r\n");
+    QCOMPARE(table.size(), 1);
+    QCOMPARE(value(table, "Weather/Latitude"), QString("52.52"));
+
+    // Only at the start of the text
+    QCOMPARE(value(parse("\xEF\xBB\xBF" "key=1\n"), "key"), QString("1"));
+    QVERIFY(!parse("[A]\n\xEF\xBB\xBF[B]\nkey=1\n").contains(u"B/key"));
+}
@@ -0,0 +1,28 @@
+#ifndef INIPARSERTEST_H
+#define INIPARSERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <iniparser.h>
+#include <configtable.h>
+
+class IniParserTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IniParserTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testSectionsAndKeys();
+    void testValueWithEquals();
+    void testWhitespaceAndComments();
+    void testDuplicateKeys();
+    void testParseFile();
+    void testTableGrowth();
+    void testNonAsciiKeys();
+    void testByteOrderMark();
+};
+
+#endif // INIPARSERTEST_H
@@ -0,0 +1,120 @@
+#include "iniwritertest.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <iniparser.h>
+
+IniWriterTest::IniWriterTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("IniWriterTest");
+}
+
+void IniWriterTest::testReplaceValues()
+{
+    const QByteArray text = "; Location of the weather station\n[Weather]\nLatitude = 52.52\nLongitude=13.40\n\n"
+                            "[Zone/1]\n# seconds\nDurationSecs=600\n";
+    const ConfigTable changes{{"Weather/Latitude", "48.14"}, {"Zone/1/DurationSecs", "300\nInjected=1"}};
+    QCOMPARE(IniWriter::apply(text, changes),
+             QByteArray("; Location of the weather station\n[Weather]\nLatitude = 48.14\nLongitude=13.40\n\n"
+                        "[Zone/1]\n# seconds\nDurationSecs=300 Injected=1\n"));
+}
+
+void IniWriterTest::testAddKeys()
+{
+    // New keys go after the last line of their section, even if it appears twice
+    const QByteArray text = "global=1\n[Weather]\nLatitude=52.52\n\n[Logging]\nLevel=info\n[Weather]\nLongitude=13.40\n";
+    const ConfigTable changes{{"Weather/City", "Berlin"}, {"Logging/Format", "json"}, {"top", "2"}};
+    QCOMPARE(IniWriter::apply(text, changes),
+             QByteArray("global=1\ntop=2\n[Weather]\nLatitude=52.52\n\n[Logging]\nLevel=info\nFormat=json\n"
+                        "[Weather]\nLongitude=13.40\nCity=Berlin\n"));
+}
+
+void IniWriterTest::testAddSections()
+{
+    const ConfigTable changes{{"Zone/2/Valve", "3"}, {"Zone/2/DurationSecs", "60"}, {"Zone/3/Valve", "4"}};
+    const QByteArray result = IniWriter::apply("[Weather]\nLatitude=52.52", changes);
+    QCOMPARE(result, QByteArray("[Weather]\nLatitude=52.52\n\n[Zone/2]\nValve=3\nDurationSecs=60\n\n[Zone/3]\nValve=4\n"));
+
+    // What is written is read back the same
+    ConfigTable table;
+    IniParser::parse(result, [&table](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+        table.insert(section, key, value);
+    });
+    QCOMPARE(table.size(), 4);
+    QCOMPARE(table.find(u"Zone/2/DurationSecs")->toString(), QString("60"));
+
+    QCOMPARE(IniWriter::apply("", {{"Weather/Latitude", "52.52"}}), QByteArray("[Weather]\nLatitude=52.52\n"));
+}
+
+void IniWriterTest::testRemoveKeys()
+{
+    // An invalid value removes the line, a key that doesn't exist isn't added
+    const QByteArray text = "[Zone/1]\nDurationSecs=600\nValve=2\n[Zone/3]\nDurationSecs=120\n";
+    const ConfigTable changes{{"Zone/1/Valve", QVariant()}, {"Zone/3/DurationSecs", QVariant()}, {"Zone/4/Valve", QVariant()}};
+    QCOMPARE(IniWriter::apply(text, changes), QByteArray("[Zone/1]\nDurationSecs=600\n[Zone/3]\n"));
+}
+
+void IniWriterTest::testLineEndings()
+{
+    const ConfigTable changes{{"Weather/Latitude", "48.14"}, {"Weather/City", "Berlin"}};
+    QCOMPARE(IniWriter::apply("[Weather]\r\nLatitude=52.52\r\n", changes),
+             QByteArray("[Weather]\r\nLatitude=48.14\r\nCity=Berlin\r\n"));
+}
+
+void IniWriterTest::testByteOrderMark()
+{
+    // The existing section is found and the mark stays in front
+    const ConfigTable changes{{"Weather/Latitude", "48.14"}, {"Weather/City", "Berlin"}};
+    QCOMPARE(IniWriter::apply("\xEF\xBB\xBF[Weather]\nLatitude=52.52\n", changes),
+             QByteArray("\xEF\xBB\xBF[Weather]\nLatitude=48.14\nCity=Berlin\n"));
+    QCOMPARE(IniWriter::apply("\xEF\xBB\xBF", {{"Weather/Latitude", "52.52"}}),
+             QByteArray("\xEF\xBB\xBF[Weather]\nLatitude=52.52\n"));
+}
+
+void IniWriterTest::testWriteFile()
+{
+    QTemporaryDir directory;
+    const QString fileName = directory.filePath("config.ini");
+    QString errorString;
+    QVERIFY2(IniWriter::writeFile(fileName, "[Weather]\nLatitude=52.52\n", &errorString), qPrintable(errorString));
+    QVERIFY2(IniWriter::writeFile(fileName, "[Weather]\nLatitude=48.14\n", &errorString), qPrintable(errorString));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Weather]\nLatitude=48.14\n"));
+    QVERIFY(!QFile::exists(fileName + ".tmp"));
+
+    QVERIFY(!IniWriter::writeFile(directory.filePath("missing/config.ini"), "x", &errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void IniWriterTest::testWriteFileKeepsPermissions()
+{
+    QTemporaryDir directory;
+    const QString fileName = directory.filePath("config.ini");
+    QVERIFY(IniWriter::writeFile(fileName, "[Weather]\nOpenWeatherApiKey=secret\n"));
+    const QFileDevice::Permissions ownerOnly = QFileDevice::ReadOwner | QFileDevice::WriteOwner;
+    QVERIFY(QFile::setPermissions(fileName, ownerOnly));
+
+    QString errorString;
+    QVERIFY2(IniWriter::writeFile(fileName, "[Weather]\nOpenWeatherApiKey=other\n", &errorString), qPrintable(errorString));
+    QCOMPARE(QFile::permissions(fileName) & ~(QFileDevice::ReadUser | QFileDevice::WriteUser), ownerOnly);
+}
+
+void IniWriterTest::testWriteFileThroughSymlink()
+{
+    QTemporaryDir directory;
+    const QString target = directory.filePath("deployed.ini");
+    const QString link = directory.filePath("config.ini");
+    QVERIFY(IniWriter::writeFile(target, "[Weather]\nLatitude=52.52\n"));
+    if (!QFile::link(target, link))
+        QSKIP("Symbolic links aren't supported here");
+
+    QString errorString;
+    QVERIFY2(IniWriter::writeFile(link, "[Weather]\nLatitude=48.14\n", &errorString), qPrintable(errorString));
+    QVERIFY(QFileInfo(link).isSymLink());
+    QFile file(target);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Weather]\nLatitude=48.14\n"));
+}
@@ -0,0 +1,28 @@
+#ifndef INIWRITERTEST_H
+#define INIWRITERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <iniwriter.h>
+
+class IniWriterTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IniWriterTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testReplaceValues();
+    void testAddKeys();
+    void testAddSections();
+    void testRemoveKeys();
+    void testLineEndings();
+    void testByteOrderMark();
+    void testWriteFile();
+    void testWriteFileKeepsPermissions();
+    void testWriteFileThroughSymlink();
+};
+
+#endif // INIWRITERTEST_H
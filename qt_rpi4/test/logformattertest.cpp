@@ -0,0 +1,82 @@
+#include "logformattertest.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+LogFormatterTest::LogFormatterTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogFormatterTest");
+}
+
+QByteArray LogFormatterTest::withoutTimestamp(const LogLineBuffer &line)
+{
+    return line.view().toByteArray().mid(23);
+}
+
+void LogFormatterTest::testPlainMessage()
+{
+    const QMessageLogContext context("weatherfetcher.cpp", 42, "fetchWeatherData", "weather.fetch");
+    LogLineBuffer line;
+    LogFormatter::format(line, QtWarningMsg, context, u"Network error occured: timeout", true, true);
+    QCOMPARE(withoutTimestamp(line),
+             QByteArray(" [WARNING] [weather.fetch] (weatherfetcher.cpp:42): Network error occured: timeout"));
+
+    // The "default" category of qDebug() is left out
+    const QMessageLogContext defaultContext("main.cpp", 7, "main", "default");
+    LogFormatter::format(line, QtDebugMsg, defaultContext, u"Temperature: 21.5 °C", false, true);
+    QCOMPARE(withoutTimestamp(line), QString(" [DEBUG]: Temperature: 21.5 °C").toUtf8());
+}
+
+void LogFormatterTest::testStructuredText()
+{
+    const QString city = "Berlin";
+    const LogRecord record = LogRecord::create(QtInfoMsg, "weatherfetcher.cpp", 99, "f", "fetch.done",
+                                               "latency_ms", 120, "bytes", quint64(16384),
+                                               "pop", 0.25, "current", true, "city", city);
+    LogLineBuffer line;
+    LogFormatter::formatText(line, record, false, true);
+    QCOMPARE(withoutTimestamp(line),
+             QByteArray(" [INFO]: fetch.done latency_ms=120 bytes=16384 pop=0.25 current=true city=\"Berlin\""));
+}
+
+void LogFormatterTest::testStructuredJson()
+{
+    const LogRecord record = LogRecord::create(QtInfoMsg, "weatherfetcher.cpp", 99, "f", "fetch.done",
+                                               "latency_ms", -5, "description", "overcast clouds", "pop", 0.2);
+    LogLineBuffer line;
+    LogFormatter::formatJson(line, record, true);
+
+    QJsonParseError error;
+    const QJsonObject json = QJsonDocument::fromJson(line.view().toByteArray(), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(json["level"].toString(), QString("INFO"));
+    QCOMPARE(json["event"].toString(), QString("fetch.done"));
+    QCOMPARE(json["file"].toString(), QString("weatherfetcher.cpp"));
+    QCOMPARE(json["line"].toInt(), 99);
+    QCOMPARE(json["latency_ms"].toInt(), -5);
+    QCOMPARE(json["description"].toString(), QString("overcast clouds"));
+    QCOMPARE(json["pop"].toDouble(), 0.2);
+    QCOMPARE(json["ts"].toString().at(10), QChar('T'));
+
+    // File and line only when they are enabled, as in the text format
+    LogFormatter::formatJson(line, record, false);
+    const QJsonObject withoutFile = QJsonDocument::fromJson(line.view().toByteArray()).object();
+    QVERIFY(!withoutFile.contains("file"));
+    QVERIFY(!withoutFile.contains("line"));
+    QCOMPARE(withoutFile["event"].toString(), QString("fetch.done"));
+}
+
+void LogFormatterTest::testJsonEscaping()
+{
+    const QMessageLogContext context("main.cpp", 1, "main", "default");
+    const QString message = "quote \" backslash \\ newline \n tab \t umlaut ä";
+    LogLineBuffer line;
+    LogFormatter::formatJson(line, LogRecord(QtCriticalMsg, context, message), false);
+
+    QJsonParseError error;
+    const QJsonObject json = QJsonDocument::fromJson(line.view().toByteArray(), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(json["msg"].toString(), message);
+    QCOMPARE(json["level"].toString(), QString("CRITICAL"));
+    QVERIFY(!json.contains("category"));
+}
@@ -0,0 +1,27 @@
+#ifndef LOGFORMATTERTEST_H
+#define LOGFORMATTERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <logformatter.h>
+
+class LogFormatterTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogFormatterTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testPlainMessage();
+    void testStructuredText();
+    void testStructuredJson();
+    void testJsonEscaping();
+
+private:
+    // Strips the "yyyy-MM-dd hh:mm:ss.zzz" timestamp which changes on every run
+    static QByteArray withoutTimestamp(const LogLineBuffer& line);
+};
+
+#endif // LOGFORMATTERTEST_H
@@ -0,0 +1,113 @@
+#include "logringbuffertest.h"
+#include <QThread>
+#include <QList>
+
+LogRingBufferTest::LogRingBufferTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogRingBufferTest");
+}
+
+void LogRingBufferTest::testCapacity()
+{
+    // The capacity is rounded up to the next power of two
+    LogRingBuffer<int> buffer(100);
+    QCOMPARE(buffer.capacity(), 128);
+    QVERIFY(buffer.isEmpty());
+}
+
+void LogRingBufferTest::testFifoOrder()
+{
+    LogRingBuffer<int> buffer(8);
+    for (int i = 0; i < 5; ++i)
+    {
+        int value = i;
+        QVERIFY(buffer.tryPush(std::move(value)));
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        int value = -1;
+        QVERIFY(buffer.tryPop(value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(buffer.isEmpty());
+}
+
+void LogRingBufferTest::testFullAndEmpty()
+{
+    LogRingBuffer<int> buffer(4);
+    for (int i = 0; i < buffer.capacity(); ++i)
+    {
+        int value = i;
+        QVERIFY(buffer.tryPush(std::move(value)));
+    }
+
+    // A full buffer rejects new items...
+    int rejected = 42;
+    QVERIFY(!buffer.tryPush(std::move(rejected)));
+
+    // ...until an item has been popped
+    int value = -1;
+    QVERIFY(buffer.tryPop(value));
+    QCOMPARE(value, 0);
+    int accepted = 42;
+    QVERIFY(buffer.tryPush(std::move(accepted)));
+
+    // Drain the buffer completely
+    int count = 0;
+    while (buffer.tryPop(value)) ++count;
+    QCOMPARE(count, buffer.capacity());
+    QVERIFY(!buffer.tryPop(value));
+}
+
+void LogRingBufferTest::testConcurrentProducers()
+{
+    const int producerCount = 4;
+    const int itemsPerProducer = 20000;
+    LogRingBuffer<int> buffer(256);
+
+    // Each item encodes the producer and a sequence number
+    QList<QThread*> producers;
+    for (int p = 0; p < producerCount; ++p)
+    {
+        producers.append(QThread::create([&buffer, p, itemsPerProducer]() {
+            for (int i = 0; i < itemsPerProducer; ++i)
+            {
+                int item = p * itemsPerProducer + i;
+                while (!buffer.tryPush(std::move(item)))
+                    QThread::yieldCurrentThread();
+            }
+        }));
+    }
+    for (QThread* producer : producers) producer->start();
+
+    // Consume on this thread and check that the order per producer is preserved. A failure is
+    // only recorded: the producers block on a full buffer until everything has been consumed.
+    QList<int> lastSeen(producerCount, -1);
+    int received = 0;
+    int outOfOrder = 0;
+    while (received < producerCount * itemsPerProducer)
+    {
+        int item = 0;
+        if (!buffer.tryPop(item))
+        {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const int producer = item / itemsPerProducer;
+        const int sequence = item % itemsPerProducer;
+        if (sequence <= lastSeen[producer])
+            ++outOfOrder;
+        lastSeen[producer] = sequence;
+        ++received;
+    }
+
+    for (QThread* producer : producers)
+    {
+        producer->wait();
+        delete producer;
+    }
+    QCOMPARE(outOfOrder, 0);
+    QCOMPARE(received, producerCount * itemsPerProducer);
+    QVERIFY(buffer.isEmpty());
+}
@@ -0,0 +1,24 @@
+#ifndef LOGRINGBUFFERTEST_H
+#define LOGRINGBUFFERTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <logringbuffer.h>
+
+class LogRingBufferTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogRingBufferTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testCapacity();
+    void testFifoOrder();
+    void testFullAndEmpty();
+    void testConcurrentProducers();
+
+};
+
+#endif // LOGRINGBUFFERTEST_H
@@ -0,0 +1,152 @@
+#include "logrotatortest.h"
+#include <QDir>
+#include <QFile>
+
+LogRotatorTest::LogRotatorTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogRotatorTest");
+}
+
+QByteArray LogRotatorTest::gzipUncompress(const QByteArray &gzip, const QByteArray &expected)
+{
+    // Qt can only inflate zlib streams, so the gzip file is converted into the format
+    // qUncompress() expects: 4 byte length + zlib header + raw deflate data + adler32.
+    // The adler32 checksum is computed from the expected content, a mismatch makes
+    // qUncompress() fail as well.
+    if (gzip.size() < 18 || !gzip.startsWith(QByteArray("\x1f\x8b\x08", 3)))
+        return QByteArray();
+
+    quint32 a = 1, b = 0;
+    for (const char byte : expected)
+    {
+        a = (a + static_cast<quint8>(byte)) % 65521;
+        b = (b + a) % 65521;
+    }
+    const quint32 adler = (b << 16) | a;
+    const quint32 size = static_cast<quint32>(expected.size());
+
+    QByteArray zlib;
+    for (int i = 3; i >= 0; --i) zlib.append(static_cast<char>((size >> (8 * i)) & 0xFF));
+    zlib.append("\x78\x9c", 2);
+    zlib.append(gzip.mid(10, gzip.size() - 18));
+    for (int i = 3; i >= 0; --i) zlib.append(static_cast<char>((adler >> (8 * i)) & 0xFF));
+    return qUncompress(zlib);
+}
+
+QByteArray LogRotatorTest::readFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+void LogRotatorTest::writeLines(LogRotator &rotator, QFile &logFile, const QByteArray &line, int count)
+{
+    // Mimics what FileLogSink::write() does for every write
+    for (int i = 0; i < count; ++i)
+    {
+        logFile.write(line);
+        rotator.recordWrite(line.size());
+        if (rotator.rotationDue())
+            rotator.rotate(logFile);
+    }
+}
+
+void LogRotatorTest::testGzipRoundTrip()
+{
+    QByteArray content;
+    for (int i = 0; i < 1000; ++i)
+        content += "2023-12-01 10:00:00.000 [DEBUG]: WeatherData(0x1234) has been created " + QByteArray::number(i) + "\n";
+
+    const QByteArray gzip = LogArchiver::gzipCompress(content, 6);
+    QVERIFY(gzip.startsWith(QByteArray("\x1f\x8b\x08", 3)));
+    QVERIFY(gzip.size() < content.size());
+    QCOMPARE(gzipUncompress(gzip, content), content);
+}
+
+void LogRotatorTest::testRotationBySize()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logFilePath = dir.filePath("test.log");
+
+    LogRotator rotator;
+    LogRotator::Settings settings;
+    settings.maxBytes = 100;
+    settings.generations = 2;
+    settings.compressionLevel = 6;
+    rotator.setSettings(settings);
+
+    QFile logFile(logFilePath);
+    QVERIFY(logFile.open(QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered));
+    rotator.start(logFile);
+
+    // 10 bytes per line, so every 10 lines trigger a rotation
+    writeLines(rotator, logFile, "line 0001\n", 10);
+    rotator.archiver().waitForIdle();
+    QVERIFY(QFile::exists(logFilePath + ".1.gz"));
+    QCOMPARE(logFile.size(), qint64(0));
+
+    const QByteArray firstGeneration = QByteArray("line 0001\n").repeated(10);
+    QCOMPARE(gzipUncompress(readFile(logFilePath + ".1.gz"), firstGeneration), firstGeneration);
+
+    // Two more rotations: generation 1 moves to 2, the oldest one is dropped
+    writeLines(rotator, logFile, "line 0002\n", 10);
+    writeLines(rotator, logFile, "line 0003\n", 10);
+    rotator.archiver().waitForIdle();
+
+    const QByteArray secondGeneration = QByteArray("line 0002\n").repeated(10);
+    const QByteArray thirdGeneration = QByteArray("line 0003\n").repeated(10);
+    QCOMPARE(gzipUncompress(readFile(logFilePath + ".1.gz"), thirdGeneration), thirdGeneration);
+    QCOMPARE(gzipUncompress(readFile(logFilePath + ".2.gz"), secondGeneration), secondGeneration);
+    QVERIFY(!QFile::exists(logFilePath + ".3.gz"));
+}
+
+void LogRotatorTest::testRotationDisabled()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logFilePath = dir.filePath("test.log");
+
+    LogRotator rotator;
+    rotator.setSettings(LogRotator::Settings{});
+    QVERIFY(!rotator.isEnabled());
+
+    QFile logFile(logFilePath);
+    QVERIFY(logFile.open(QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered));
+    rotator.start(logFile);
+    writeLines(rotator, logFile, "line 0001\n", 100);
+
+    QVERIFY(!rotator.rotationDue());
+    QCOMPARE(logFile.size(), qint64(1000));
+    QVERIFY(!QFile::exists(logFilePath + ".1.gz"));
+}
+
+void LogRotatorTest::testFailedArchiveKeepsGeneration()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logFilePath = dir.filePath("test.log");
+    // The temporary archive can't be created where a directory is in the way
+    QVERIFY(QDir(dir.path()).mkdir("test.log.1.gz.tmp"));
+
+    LogRotator rotator;
+    LogRotator::Settings settings;
+    settings.maxBytes = 100;
+    settings.generations = 2;
+    settings.compressionLevel = 6;
+    rotator.setSettings(settings);
+
+    QFile logFile(logFilePath);
+    QVERIFY(logFile.open(QIODevice::Append | QIODevice::Text | QIODevice::Unbuffered));
+    rotator.start(logFile);
+    writeLines(rotator, logFile, "line 0001\n", 10);
+    rotator.archiver().waitForIdle();
+
+    // The rotated file is kept as the uncompressed generation instead of being left behind
+    QCOMPARE(readFile(logFilePath + ".1"), QByteArray("line 0001\n").repeated(10));
+    QVERIFY(!QFile::exists(logFilePath + ".1.gz"));
+    QVERIFY(QDir(dir.path()).entryList({"test.log.rotating-*"}, QDir::Files).isEmpty());
+}
@@ -0,0 +1,29 @@
+#ifndef LOGROTATORTEST_H
+#define LOGROTATORTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <logrotator.h>
+
+class LogRotatorTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogRotatorTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testGzipRoundTrip();
+    void testRotationBySize();
+    void testRotationDisabled();
+    void testFailedArchiveKeepsGeneration();
+
+private:
+    static QByteArray gzipUncompress(const QByteArray& gzip, const QByteArray& expected);
+    static QByteArray readFile(const QString& path);
+    static void writeLines(LogRotator& rotator, QFile& logFile, const QByteArray& line, int count);
+};
+
+#endif // LOGROTATORTEST_H
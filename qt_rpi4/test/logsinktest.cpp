@@ -0,0 +1,157 @@
+#include "logsinktest.h"
+#include <QFile>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+
+LogSinkTest::LogSinkTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogSinkTest");
+}
+
+void LogSinkTest::testMemorySinkKeepsLatestLines()
+{
+    MemoryLogSink sink(3);
+    for (int i = 0; i < 5; ++i)
+        sink.submit(QtInfoMsg, "line " + QByteArray::number(i));
+
+    QCOMPARE(sink.nextSequence(), quint64(5));
+    const QList<MemoryLogSink::Entry> entries = sink.entries();
+    QCOMPARE(entries.size(), 3);
+    QCOMPARE(entries[0].sequence, quint64(2));
+    QCOMPARE(entries[0].line, QByteArray("line 2"));
+    QCOMPARE(entries[2].line, QByteArray("line 4"));
+
+    // Incremental reads only return what is new
+    QCOMPARE(sink.entries(4).size(), 1);
+    QCOMPARE(sink.entries(5).size(), 0);
+}
+
+void LogSinkTest::testMemorySinkAsync()
+{
+    MemoryLogSink sink(100);
+    sink.startAsync(16, LogWriterThread::OverflowPolicy::Block);
+    QVERIFY(sink.isAsync());
+    for (int i = 0; i < 100; ++i)
+        sink.submit(QtDebugMsg, "queued " + QByteArray::number(i));
+    // Stopping flushes the queue, nothing may be lost with the Block policy
+    sink.stop();
+
+    const QList<MemoryLogSink::Entry> entries = sink.entries();
+    QCOMPARE(entries.size(), 100);
+    for (int i = 0; i < entries.size(); ++i)
+        QCOMPARE(entries[i].line, "queued " + QByteArray::number(i));
+    QCOMPARE(sink.statistics().written, quint64(100));
+    QCOMPARE(sink.statistics().dropped, quint64(0));
+}
+
+void LogSinkTest::testMemorySinkNotifierMayLog()
+{
+    // The notifier runs without the locks of the sink, so logging from it doesn't deadlock
+    MemoryLogSink sink(10);
+    int notified = 0;
+    sink.setWriteNotifier([&sink, &notified]() {
+        if (++notified == 1)
+            sink.submit(QtWarningMsg, "logged by the notifier");
+    });
+    sink.submit(QtInfoMsg, "line 0");
+    QCOMPARE(notified, 2);
+    const QList<MemoryLogSink::Entry> entries = sink.entries();
+    QCOMPARE(entries.size(), 2);
+    QCOMPARE(entries[1].line, QByteArray("logged by the notifier"));
+
+    sink.setWriteNotifier(nullptr);
+    sink.submit(QtInfoMsg, "line 1");
+    QCOMPARE(notified, 2);
+}
+
+void LogSinkTest::testMemorySinkWaitsForNotifier()
+{
+    MemoryLogSink sink(10);
+    sink.startAsync(16, LogWriterThread::OverflowPolicy::Block);
+    QSemaphore started;
+    std::atomic<bool> returned{false};
+    sink.setWriteNotifier([&started, &returned]() {
+        started.release();
+        QThread::msleep(50);
+        returned = true;
+    });
+    sink.submit(QtInfoMsg, "line 0");
+    QVERIFY(started.tryAcquire(1, 5000));
+
+    // Replacing the notifier returns only after the running call has
+    sink.setWriteNotifier(nullptr);
+    QVERIFY(returned);
+    sink.stop();
+}
+
+void LogSinkTest::testMemorySinkTruncatesAtCharacter()
+{
+    MemoryLogSink sink(2);
+    // "ä" is two bytes, the limit is between them
+    const QByteArray prefix(MemoryLogSink::MaxLineLength - 1, 'x');
+    sink.submit(QtInfoMsg, prefix + "\xC3\xA4 and more");
+    QCOMPARE(sink.entries().last().line, prefix);
+
+    // A line cut at a character boundary keeps all it can
+    const QByteArray full(MemoryLogSink::MaxLineLength - 2, 'x');
+    sink.submit(QtInfoMsg, full + "\xC3\xA4 and more");
+    QCOMPARE(sink.entries().last().line, full + "\xC3\xA4");
+}
+
+void LogSinkTest::testLevelThreshold()
+{
+    MemoryLogSink sink(10);
+    sink.setMinimumLevel(QtWarningMsg);
+    QVERIFY(!sink.accepts(QtDebugMsg));
+    QVERIFY(!sink.accepts(QtInfoMsg));
+    QVERIFY(sink.accepts(QtWarningMsg));
+    QVERIFY(sink.accepts(QtCriticalMsg));
+    QVERIFY(sink.accepts(QtFatalMsg));
+    QCOMPARE(sink.minimumSeverity(), 2);
+}
+
+void LogSinkTest::testFileSink()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("test.log");
+    LogRotator::Settings rotation;
+    rotation.maxBytes = 0; // No rotation
+
+    {
+        FileLogSink sink;
+        QVERIFY(sink.open(path, rotation));
+        sink.startAsync(4, LogWriterThread::OverflowPolicy::Block);
+        for (int i = 0; i < 10; ++i)
+            sink.submit(QtInfoMsg, "line " + QByteArray::number(i));
+    }
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    QCOMPARE(lines.size(), 11); // The last line is terminated as well
+    QCOMPARE(lines[0], QByteArray("line 0"));
+    QCOMPARE(lines[9], QByteArray("line 9"));
+}
+
+void LogSinkTest::testStatistics()
+{
+    MemoryLogSink sink(10);
+    sink.submit(QtInfoMsg, "one");
+    sink.submit(QtInfoMsg, "two");
+    const LogSink::Statistics statistics = sink.statistics();
+    QCOMPARE(statistics.name, QString("memory"));
+    QCOMPARE(statistics.written, quint64(2));
+    QCOMPARE(statistics.dropped, quint64(0));
+    QVERIFY(statistics.maxLatencyNsecs <= statistics.totalLatencyNsecs);
+}
+
+void LogSinkTest::testConfigurationStrings()
+{
+    QCOMPARE(LogSink::formatFromString(" JSON "), LogSink::Format::Json);
+    QCOMPARE(LogSink::formatFromString("xml", LogSink::Format::Text), LogSink::Format::Text);
+    QCOMPARE(LogSink::levelFromString("Warning"), QtWarningMsg);
+    QCOMPARE(LogSink::levelFromString("verbose", QtInfoMsg), QtInfoMsg);
+}
@@ -0,0 +1,29 @@
+#ifndef LOGSINKTEST_H
+#define LOGSINKTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <logsinks.h>
+
+class LogSinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogSinkTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testMemorySinkKeepsLatestLines();
+    void testMemorySinkAsync();
+    void testMemorySinkNotifierMayLog();
+    void testMemorySinkWaitsForNotifier();
+    void testMemorySinkTruncatesAtCharacter();
+    void testLevelThreshold();
+    void testFileSink();
+    void testStatistics();
+    void testConfigurationStrings();
+};
+
+#endif // LOGSINKTEST_H
@@ -0,0 +1,119 @@
+#include "logtailmodeltest.h"
+#include <QSignalSpy>
+
+LogTailModelTest::LogTailModelTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogTailModelTest");
+}
+
+void LogTailModelTest::testInitialRows()
+{
+    MemoryLogSink sink(10);
+    sink.submit(QtInfoMsg, "one");
+    sink.submit(QtWarningMsg, "two");
+
+    LogTailModel model(&sink);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.data(model.index(0), LogTailModel::LineRole).toString(), QString("one"));
+    QCOMPARE(model.data(model.index(1), LogTailModel::LevelRole).toInt(), LogSink::severity(QtWarningMsg));
+    QCOMPARE(model.data(model.index(1), LogTailModel::LevelNameRole).toString(), QString("WARNING"));
+    QCOMPARE(model.data(model.index(1), LogTailModel::SequenceRole).toULongLong(), 1ULL);
+    QVERIFY(!model.data(model.index(2), LogTailModel::LineRole).isValid());
+}
+
+void LogTailModelTest::testAppendsWithoutReset()
+{
+    MemoryLogSink sink(10);
+    LogTailModel model(&sink);
+    QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+    sink.submit(QtInfoMsg, "one");
+    sink.submit(QtInfoMsg, "two");
+    sink.submit(QtInfoMsg, "three");
+    model.update();
+
+    // All three lines come in with a single insert
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.first().at(1).toInt(), 0);
+    QCOMPARE(insertSpy.first().at(2).toInt(), 2);
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(model.rowCount(), 3);
+
+    // Nothing new, nothing to do
+    model.update();
+    QCOMPARE(insertSpy.count(), 1);
+}
+
+void LogTailModelTest::testRemovesOldestRows()
+{
+    MemoryLogSink sink(3);
+    LogTailModel model(&sink);
+    sink.submit(QtInfoMsg, "line 0");
+    sink.submit(QtInfoMsg, "line 1");
+    model.update();
+
+    QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    for (int i = 2; i < 5; ++i)
+        sink.submit(QtInfoMsg, "line " + QByteArray::number(i));
+    model.update();
+
+    // The model keeps as many rows as the sink
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(removeSpy.first().at(1).toInt(), 0);
+    QCOMPARE(removeSpy.first().at(2).toInt(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(model.data(model.index(0), LogTailModel::LineRole).toString(), QString("line 2"));
+    QCOMPARE(model.data(model.index(2), LogTailModel::LineRole).toString(), QString("line 4"));
+}
+
+void LogTailModelTest::testMinimumLevel()
+{
+    MemoryLogSink sink(10);
+    sink.submit(QtDebugMsg, "debug");
+    sink.submit(QtWarningMsg, "warning");
+    sink.submit(QtInfoMsg, "info");
+
+    LogTailModel model(&sink);
+    QCOMPARE(model.rowCount(), 3);
+
+    model.setMinimumLevel(LogSink::severity(QtWarningMsg));
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.data(model.index(0), LogTailModel::LineRole).toString(), QString("warning"));
+
+    sink.submit(QtInfoMsg, "more info");
+    sink.submit(QtCriticalMsg, "critical");
+    model.update();
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.data(model.index(1), LogTailModel::LineRole).toString(), QString("critical"));
+
+    // Lowering the level brings back the lines which have been left out
+    model.setMinimumLevel(0);
+    QCOMPARE(model.rowCount(), 5);
+}
+
+void LogTailModelTest::testBatchesUpdates()
+{
+    MemoryLogSink sink(100);
+    LogTailModel model(&sink);
+    QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+
+    // Lines written in quick succession end up in one insert on the next frame
+    for (int i = 0; i < 50; ++i)
+        sink.submit(QtInfoMsg, "line " + QByteArray::number(i));
+    QCOMPARE(model.rowCount(), 0);
+    QTRY_COMPARE(model.rowCount(), 50);
+    QCOMPARE(insertSpy.count(), 1);
+}
+
+void LogTailModelTest::testLongLinesAreTruncated()
+{
+    MemoryLogSink sink(2);
+    sink.submit(QtInfoMsg, QByteArray(2 * MemoryLogSink::MaxLineLength, 'x'));
+
+    LogTailModel model(&sink);
+    QCOMPARE(model.data(model.index(0), LogTailModel::LineRole).toString().size(), qsizetype(MemoryLogSink::MaxLineLength));
+}
@@ -0,0 +1,25 @@
+#ifndef LOGTAILMODELTEST_H
+#define LOGTAILMODELTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <logtailmodel.h>
+
+class LogTailModelTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogTailModelTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testInitialRows();
+    void testAppendsWithoutReset();
+    void testRemovesOldestRows();
+    void testMinimumLevel();
+    void testBatchesUpdates();
+    void testLongLinesAreTruncated();
+};
+
+#endif // LOGTAILMODELTEST_H
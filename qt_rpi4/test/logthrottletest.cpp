@@ -0,0 +1,286 @@
+#include "logthrottletest.h"
+
+namespace {
+
+// The same call site as far as the throttle is concerned
+const QMessageLogContext fetcherContext("weatherfetcher.cpp", 118, "exractWeatherFromReply", "weather.fetch");
+const QMessageLogContext qmlContext("qrc:/qt/qml/qt_rpi4/qml/WeatherPage.qml", 68, "onStatusChanged", "qml");
+
+} // namespace
+
+LogThrottleTest::LogThrottleTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("LogThrottleTest");
+}
+
+void LogThrottleTest::testDisabledAdmitsEverything()
+{
+    LogThrottle throttle;
+    QVERIFY(!throttle.isEnabled());
+    LogThrottle::Summaries summaries;
+    for (int i = 0; i < 100; ++i)
+        QVERIFY(throttle.admit(LogRecord(QtWarningMsg, fetcherContext, u"Network error occured"), i, summaries));
+    QVERIFY(summaries.isEmpty());
+}
+
+void LogThrottleTest::testDuplicatesWithinWindow()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    throttle.setSettings(settings);
+
+    // The network-down warning of every fetch tick (20 s)
+    const LogRecord warning(QtWarningMsg, fetcherContext, u"Network error occured: Host not found");
+    LogThrottle::Summaries summaries;
+    QVERIFY(throttle.admit(warning, 0, summaries));
+    QVERIFY(!throttle.admit(warning, 20000, summaries));
+    QVERIFY(!throttle.admit(warning, 40000, summaries));
+    QVERIFY(summaries.isEmpty());
+
+    // The window is over: the record passes and the repetitions are reported
+    QVERIFY(throttle.admit(warning, 60000, summaries));
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(QByteArray(summaries[0].event), QByteArray("log.repeated"));
+    QCOMPARE(summaries[0].count, quint64(2));
+    QCOMPARE(summaries[0].type, QtWarningMsg);
+    QCOMPARE(summaries[0].file, QByteArray("weatherfetcher.cpp"));
+    QCOMPARE(summaries[0].line, 118);
+    QCOMPARE(summaries[0].text, QByteArray("Network error occured: Host not found"));
+}
+
+void LogThrottleTest::testDuplicateSummaryOnNewContent()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    throttle.setSettings(settings);
+
+    LogThrottle::Summaries summaries;
+    const LogRecord warning(QtWarningMsg, fetcherContext, u"Network error occured: Host not found");
+    QVERIFY(throttle.admit(warning, 0, summaries));
+    QVERIFY(!throttle.admit(warning, 100, summaries));
+    const LogRecord timeout(QtWarningMsg, fetcherContext, u"Network error occured: Timeout");
+    QVERIFY(throttle.admit(timeout, 200, summaries));
+    QVERIFY(summaries.isEmpty());
+
+    // The summary is built by the next sweep, the repetition of the new content isn't due yet
+    QVERIFY(!throttle.admit(timeout, 1200, summaries));
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(summaries[0].count, quint64(1));
+}
+
+void LogThrottleTest::testCallSitesAreIndependent()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    throttle.setSettings(settings);
+
+    LogThrottle::Summaries summaries;
+    const QMessageLogContext otherContext("weatherfetcher.cpp", 140, "exractWeatherFromReply", "weather.fetch");
+    QVERIFY(throttle.admit(LogRecord(QtWarningMsg, fetcherContext, u"Same text"), 0, summaries));
+    QVERIFY(throttle.admit(LogRecord(QtWarningMsg, otherContext, u"Same text"), 0, summaries));
+
+    // QML passes a temporary copy of the file name with every message
+    const QByteArray fileCopy = QByteArray(fetcherContext.file);
+    const QMessageLogContext copiedContext(fileCopy.constData(), 118, "exractWeatherFromReply", "weather.fetch");
+    QVERIFY(!throttle.admit(LogRecord(QtWarningMsg, copiedContext, u"Same text"), 0, summaries));
+}
+
+void LogThrottleTest::testRateLimit()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.ratePerSecond = 10;
+    settings.burst = 5;
+    throttle.setSettings(settings);
+
+    // Weather icons being loaded after a model reset, every message has another text
+    LogThrottle::Summaries summaries;
+    int admitted = 0;
+    for (int i = 0; i < 40; ++i)
+    {
+        const QString text = QString("Loading weather icon: qrc:/icons/%1.png").arg(i);
+        if (throttle.admit(LogRecord(QtDebugMsg, qmlContext, text), 0, summaries))
+            ++admitted;
+    }
+    QCOMPARE(admitted, 5);
+    QVERIFY(summaries.isEmpty());
+
+    // 100 ms later the call site may log one record again
+    QVERIFY(throttle.admit(LogRecord(QtDebugMsg, qmlContext, u"Loading weather icon: qrc:/icons/40.png"), 100, summaries));
+    QVERIFY(summaries.isEmpty());
+
+    // The drops are reported by the next sweep
+    QVERIFY(throttle.admit(LogRecord(QtDebugMsg, qmlContext, u"Loading weather icon: qrc:/icons/41.png"), 1000, summaries));
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(QByteArray(summaries[0].event), QByteArray("log.ratelimited"));
+    QCOMPARE(summaries[0].count, quint64(35));
+    QCOMPARE(summaries[0].category, QByteArray("qml"));
+}
+
+void LogThrottleTest::testStructuredCallSites()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    throttle.setSettings(settings);
+
+    // LOG_* records are told apart by the addresses of their file name and event literals
+    static const char file[] = "weatherfetcher.cpp";
+    static const char event[] = "fetch.failed";
+    LogThrottle::Summaries summaries;
+    QVERIFY(throttle.admit(LogRecord::create(QtWarningMsg, file, 118, nullptr, event, "error", 3), 0, summaries));
+    QVERIFY(!throttle.admit(LogRecord::create(QtWarningMsg, file, 118, nullptr, event, "error", 3), 0, summaries));
+    QVERIFY(throttle.admit(LogRecord::create(QtWarningMsg, file, 118, nullptr, event, "error", 5), 0, summaries));
+    QVERIFY(throttle.admit(LogRecord::create(QtWarningMsg, file, 140, nullptr, event, "error", 5), 0, summaries));
+
+    throttle.takePending(summaries);
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(QByteArray(summaries[0].event), QByteArray("log.repeated"));
+    QCOMPARE(summaries[0].line, 118);
+    QCOMPARE(summaries[0].text, QByteArray("fetch.failed"));
+}
+
+void LogThrottleTest::testConcurrentAdmit()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.ratePerSecond = 0.001;
+    settings.burst = 100;
+    throttle.setSettings(settings);
+
+    // Without a lock, the call site still admits exactly its burst
+    constexpr int ThreadCount = 4;
+    constexpr int RecordCount = 1000;
+    std::atomic<int> admitted{0};
+    QList<QThread*> threads;
+    for (int t = 0; t < ThreadCount; ++t)
+    {
+        threads.append(QThread::create([&throttle, &admitted]() {
+            LogThrottle::Summaries summaries;
+            for (int i = 0; i < RecordCount; ++i)
+            {
+                if (throttle.admit(LogRecord(QtDebugMsg, fetcherContext, u"Polling"), 0, summaries))
+                    admitted.fetch_add(1);
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread* thread : threads)
+    {
+        QVERIFY(thread->wait(10000));
+        delete thread;
+    }
+    QCOMPARE(admitted.load(), 100);
+
+    LogThrottle::Summaries summaries;
+    throttle.takePending(summaries);
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(summaries[0].count, quint64(ThreadCount * RecordCount - 100));
+}
+
+void LogThrottleTest::testFreedSitesKeepProbeChains()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.ratePerSecond = 0.001;
+    settings.burst = 1;
+    throttle.setSettings(settings);
+
+    // Enough call sites that many share a probe chain. Every one may log once.
+    constexpr int SiteCount = 120;
+    auto admit = [&throttle](int line, qint64 nowMsecs) {
+        const QMessageLogContext context("zonecontroller.cpp", line, "update", "zone");
+        LogThrottle::Summaries summaries;
+        return throttle.admit(LogRecord(QtWarningMsg, context, u"Valve didn't respond"), nowMsecs, summaries);
+    };
+    for (int line = 0; line < SiteCount; ++line)
+        QVERIFY(admit(line, 0));
+    // The even ones stay busy, the odd ones go quiet and are freed by the sweep
+    QList<int> limited;
+    for (int line = 0; line < SiteCount; line += 2)
+    {
+        if (!admit(line, 30000))
+            limited.append(line);
+    }
+    QVERIFY(limited.size() > SiteCount / 4);
+
+    // Behind a freed slot, a busy call site is still found and keeps its rate limit
+    for (int line : std::as_const(limited))
+        QVERIFY2(!admit(line, 70000), qPrintable(QString("line %1").arg(line)));
+}
+
+void LogThrottleTest::testFatalIsNeverDropped()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    settings.ratePerSecond = 1;
+    settings.burst = 1;
+    throttle.setSettings(settings);
+
+    LogThrottle::Summaries summaries;
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(throttle.admit(LogRecord(QtFatalMsg, fetcherContext, u"Out of memory"), 0, summaries));
+}
+
+void LogThrottleTest::testTakePending()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 60000;
+    throttle.setSettings(settings);
+
+    LogThrottle::Summaries summaries;
+    const LogRecord warning(QtWarningMsg, fetcherContext, u"Network error occured");
+    for (int i = 0; i < 4; ++i)
+        throttle.admit(warning, i, summaries);
+    QVERIFY(summaries.isEmpty());
+
+    throttle.takePending(summaries);
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(summaries[0].count, quint64(3));
+
+    // Nothing is reported twice
+    summaries.clear();
+    throttle.takePending(summaries);
+    QVERIFY(summaries.isEmpty());
+}
+
+void LogThrottleTest::testTakeDue()
+{
+    LogThrottle throttle;
+    LogThrottle::Settings settings;
+    settings.duplicateWindowMsecs = 2000;
+    settings.ratePerSecond = 10;
+    settings.burst = 5;
+    throttle.setSettings(settings);
+
+    // Both call sites go quiet after their drops
+    LogThrottle::Summaries summaries;
+    const LogRecord warning(QtWarningMsg, fetcherContext, u"Network error occured");
+    QVERIFY(throttle.admit(warning, 0, summaries));
+    QVERIFY(!throttle.admit(warning, 100, summaries));
+    for (int i = 0; i < 10; ++i)
+        throttle.admit(LogRecord(QtDebugMsg, qmlContext, QString("Loading weather icon: qrc:/icons/%1.png").arg(i)), 0, summaries);
+    QVERIFY(summaries.isEmpty());
+
+    // The rate limited call site may log again, the duplicate window isn't over yet
+    throttle.takeDue(1000, summaries);
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(QByteArray(summaries[0].event), QByteArray("log.ratelimited"));
+    QCOMPARE(summaries[0].count, quint64(5));
+
+    summaries.clear();
+    throttle.takeDue(2000, summaries);
+    QCOMPARE(summaries.size(), 1);
+    QCOMPARE(QByteArray(summaries[0].event), QByteArray("log.repeated"));
+    QCOMPARE(summaries[0].count, quint64(1));
+
+    summaries.clear();
+    throttle.takeDue(3000, summaries);
+    QVERIFY(summaries.isEmpty());
+}
@@ -0,0 +1,31 @@
+#ifndef LOGTHROTTLETEST_H
+#define LOGTHROTTLETEST_H
+
+#include <QObject>
+#include <QTest>
+#include <QThread>
+#include <logthrottle.h>
+
+class LogThrottleTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogThrottleTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testDisabledAdmitsEverything();
+    void testDuplicatesWithinWindow();
+    void testDuplicateSummaryOnNewContent();
+    void testCallSitesAreIndependent();
+    void testRateLimit();
+    void testStructuredCallSites();
+    void testConcurrentAdmit();
+    void testFreedSitesKeepProbeChains();
+    void testFatalIsNeverDropped();
+    void testTakePending();
+    void testTakeDue();
+};
+
+#endif // LOGTHROTTLETEST_H
@@ -4,6 +4,22 @@
 #include "weatherdatatest.h"
 #include "weathermodeltest.h"
 #include "weatherfetchertest.h"
+#include "logringbuffertest.h"
+#include "logrotatortest.h"
+#include "logformattertest.h"
+#include "flightrecordertest.h"
+#include "logsinktest.h"
+#include "logthrottletest.h"
+#include "logtailmodeltest.h"
+#include "iniparsertest.h"
+#include "iniwritertest.h"
+#include "configcachetest.h"
+#include "configsectiontest.h"
+#include "confighistorytest.h"
+#include "configconcurrencytest.h"
+#include "forecastdecodertest.h"
+#include "weatherconditionstest.h"
+#include "forecastseriestest.h"
 
 int main(int argc, char** argv)
 {
@@ -22,6 +38,22 @@ int main(int argc, char** argv)
     ASSERT_TEST(new WeatherDataTest());
     ASSERT_TEST(new WeatherModelTest());
     ASSERT_TEST(new WeatherFetcherTest());
+    ASSERT_TEST(new LogRingBufferTest());
+    ASSERT_TEST(new LogRotatorTest());
+    ASSERT_TEST(new LogFormatterTest());
+    ASSERT_TEST(new FlightRecorderTest());
+    ASSERT_TEST(new LogSinkTest());
+    ASSERT_TEST(new LogThrottleTest());
+    ASSERT_TEST(new LogTailModelTest());
+    ASSERT_TEST(new IniParserTest());
+    ASSERT_TEST(new IniWriterTest());
+    ASSERT_TEST(new ConfigCacheTest());
+    ASSERT_TEST(new ConfigSectionTest());
+    ASSERT_TEST(new ConfigHistoryTest());
+    ASSERT_TEST(new ConfigConcurrencyTest());
+    ASSERT_TEST(new ForecastDecoderTest());
+    ASSERT_TEST(new WeatherConditionsTest());
+    ASSERT_TEST(new ForecastSeriesTest());
 
     qInfo() << "Test status: " << status;
 
@@ -0,0 +1,92 @@
+#include "weatherconditionstest.h"
+#include <QThread>
+#include <forecastentry.h>
+
+// The table is shared by the whole process, the ids of the tests don't exist in the API
+WeatherConditionsTest::WeatherConditionsTest(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName("WeatherConditionsTest");
+}
+
+void WeatherConditionsTest::testIntern()
+{
+    WeatherConditions& conditions = WeatherConditions::instance();
+    const int size = conditions.size();
+
+    // The same condition is the same index, whatever the encoding of the strings
+    const WeatherConditions::Index night = conditions.intern(90804, u"Clouds", u"overcast clouds", u"04n");
+    QVERIFY(night != WeatherConditions::Unknown);
+    QCOMPARE(conditions.intern(90804, QUtf8StringView("Clouds"), QLatin1StringView("overcast clouds"), QString("04n")), night);
+    QCOMPARE(conditions.size(), size + 1);
+
+    // Another icon or id is another condition
+    const WeatherConditions::Index day = conditions.intern(90804, u"Clouds", u"overcast clouds", u"04d");
+    const WeatherConditions::Index other = conditions.intern(90803, u"Clouds", u"overcast clouds", u"04n");
+    QVERIFY(day != night);
+    QVERIFY(other != night && other != day);
+    QCOMPARE(conditions.size(), size + 3);
+
+    const WeatherCondition& condition = conditions.condition(night);
+    QCOMPARE(condition.id, 90804);
+    QCOMPARE(condition.main, QString("Clouds"));
+    QCOMPARE(condition.description, QString("overcast clouds"));
+    QCOMPARE(condition.icon, QString("04n"));
+
+    // Entries resolve their strings through the table
+    ForecastEntry entry;
+    entry.setWeather(90804, "Clouds", "overcast clouds", "04d");
+    QCOMPARE(entry.weatherCondition, day);
+    QCOMPARE(entry.weatherId(), QString("90804"));
+    QCOMPARE(entry.weatherIcon(), QString("04d"));
+}
+
+void WeatherConditionsTest::testUnknown()
+{
+    WeatherConditions& conditions = WeatherConditions::instance();
+    QCOMPARE(conditions.intern(0, u"", u"", u""), WeatherConditions::Unknown);
+    QVERIFY(conditions.condition(WeatherConditions::Unknown).main.isEmpty());
+    // An index that hasn't been handed out
+    QCOMPARE(&conditions.condition(WeatherConditions::Capacity - 1), &conditions.condition(WeatherConditions::Unknown));
+
+    const ForecastEntry entry;
+    QCOMPARE(entry.weatherCondition, WeatherConditions::Unknown);
+    QVERIFY(entry.weatherId().isEmpty());
+    QVERIFY(entry.weatherDescription().isEmpty());
+}
+
+void WeatherConditionsTest::testConcurrentIntern()
+{
+    // Every thread gets the same index for a condition, and it resolves to that condition
+    constexpr int ThreadCount = 8;
+    constexpr int ConditionCount = 50;
+    QList<WeatherConditions::Index> indices[ThreadCount];
+    QList<QThread*> threads;
+    for (int t = 0; t < ThreadCount; ++t)
+    {
+        threads.append(QThread::create([&indices, t]() {
+            WeatherConditions& conditions = WeatherConditions::instance();
+            for (int i = 0; i < ConditionCount; ++i)
+            {
+                const int id = 91000 + (i + t * 7) % ConditionCount;
+                const WeatherConditions::Index index = conditions.intern(id, u"Rain", QString::number(id), u"10d");
+                if (conditions.condition(index).id != id)
+                    return;
+                indices[t].append(index);
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread* thread : std::as_const(threads))
+    {
+        QVERIFY(thread->wait(10000));
+        delete thread;
+    }
+
+    for (int t = 0; t < ThreadCount; ++t)
+    {
+        QCOMPARE(indices[t].size(), qsizetype(ConditionCount));
+        for (int i = 0; i < ConditionCount; ++i)
+            QCOMPARE(indices[t][i], indices[0][(i + t * 7) % ConditionCount]);
+    }
+}
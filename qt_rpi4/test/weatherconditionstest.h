@@ -0,0 +1,22 @@
+#ifndef WEATHERCONDITIONSTEST_H
+#define WEATHERCONDITIONSTEST_H
+
+#include <QObject>
+#include <QTest>
+#include <weatherconditions.h>
+
+class WeatherConditionsTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WeatherConditionsTest(QObject *parent = nullptr);
+
+signals:
+
+private slots:
+    void testIntern();
+    void testUnknown();
+    void testConcurrentIntern();
+};
+
+#endif // WEATHERCONDITIONSTEST_H
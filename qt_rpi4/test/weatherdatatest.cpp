@@ -1,4 +1,7 @@
 #include "weatherdatatest.h"
+#include <QSignalSpy>
+#include <QJsonDocument>
+#include <cmath>
 
 WeatherDataTest::WeatherDataTest(QObject *parent)
     : QObject{parent}
@@ -189,6 +192,88 @@ void WeatherDataTest::testConstructorWithDataMissing_data()
 
 }
 
+void WeatherDataTest::testEntryAdapter()
+{
+    ForecastEntry entry;
+    entry.dt = 1701421200;
+    entry.setWeather(500, "Rain", "light rain", "10d");
+    entry.mainTemp = 20.3;
+    entry.isCurrent = true;
+
+    // Wraps the value, changes are notified
+    WeatherData weatherData(entry, "London");
+    QCOMPARE(weatherData.qDateTime(), m_qDateTime);
+    QCOMPARE(weatherData.weatherMain(), QString("Rain"));
+    QCOMPARE(weatherData.mainTemp(), 20.3);
+    QCOMPARE(weatherData.cityName(), QString("London"));
+    QVERIFY(weatherData.isCurrentWeather());
+
+    QSignalSpy spy(&weatherData, &WeatherData::dataChanged);
+    entry.mainTemp = 21.5;
+    weatherData.setEntry(entry, "Berlin");
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(weatherData.mainTemp(), 21.5);
+    QCOMPARE(weatherData.cityName(), QString("Berlin"));
+    QCOMPARE(weatherData.entry().dt, entry.dt);
+
+    // A numeric condition id, as the API sends it
+    QJsonObject data;
+    data.insert("weather", QJsonArray{QJsonObject{{"id", 804}, {"main", "Clouds"}}});
+    QCOMPARE(ForecastEntry::fromJson(data).weatherId(), QString("804"));
+}
+
+void WeatherDataTest::testQuantisedValues()
+{
+    // The first entry of test_data_weather.json
+    const QJsonObject data = QJsonDocument::fromJson(R"({"dt": 1701540000,
+        "main": {"temp": -4.89, "feels_like": -8.87, "temp_min": -8.29, "temp_max": -4.89, "pressure": 1014,
+                 "sea_level": 1014, "grnd_level": 959, "humidity": 94, "temp_kf": 3.4},
+        "weather": [{"id": 804, "main": "Clouds", "description": "overcast clouds", "icon": "04n"}],
+        "clouds": {"all": 100}, "wind": {"speed": 2.55, "deg": 280, "gust": 4.5}, "visibility": 10000,
+        "pop": 0.35, "sys": {"pod": "n"}, "dt_txt": "2023-12-02 18:00:00"})").object();
+    const WeatherData weatherData(ForecastEntry::fromJson(data), "Ulm");
+    QCOMPARE(weatherData.feelsLike(), -8.87);
+    QCOMPARE(weatherData.humidity(), 94);
+    QCOMPARE(weatherData.pressure(), 1014);
+    QCOMPARE(weatherData.clouds(), 100);
+    QCOMPARE(weatherData.windDeg(), 280);
+    QCOMPARE(weatherData.windGust(), 4.5);
+    QCOMPARE(weatherData.visibility(), 10000);
+    QVERIFY(!weatherData.isDaytime());
+    QVERIFY(weatherData.entry().partOfDay == ForecastEntry::PartOfDay::Night);
+
+    // Values are rounded to the resolution of the member and clamped to its range
+    ForecastEntry entry;
+    entry.setFeelsLike(21.456);
+    QCOMPARE(entry.feelsLikeCentidegrees, qint16(2146));
+    entry.setFeelsLike(-500);
+    QCOMPARE(entry.feelsLike(), -327.67); // -327.68 marks a missing value
+    entry.setHumidity(101.2);
+    QCOMPARE(entry.humidity(), 100);
+    entry.setClouds(-3);
+    QCOMPARE(entry.clouds(), 0);
+    entry.setWindGust(0.004);
+    QCOMPARE(entry.windGust(), 0.0);
+    entry.setVisibility(100000);
+    QCOMPARE(entry.visibility(), 65534); // 65535 marks a missing value
+
+    // Missing values aren't mistaken for 0
+    const ForecastEntry missing = ForecastEntry::fromJson(QJsonObject{
+        {"main", QJsonObject{{"temp", 12.5}, {"humidity", 0}}},
+        {"wind", QJsonObject{{"speed", 0.0}}}});
+    QCOMPARE(missing.presentFields(), int(ForecastEntry::Humidity));
+    QVERIFY(missing.has(ForecastEntry::Humidity));
+    QCOMPARE(missing.humidity(), 0);
+    QVERIFY(!missing.has(ForecastEntry::Pressure));
+    QCOMPARE(missing.pressure(), -1);
+    QVERIFY(std::isnan(missing.windGust()));
+    QVERIFY(std::isnan(missing.feelsLike()));
+    QCOMPARE(missing.visibility(), -1);
+    QCOMPARE(ForecastEntry().presentFields(), 0);
+    QVERIFY(ForecastEntry::partOfDayFromString(u"d") == ForecastEntry::PartOfDay::Day);
+    QVERIFY(ForecastEntry::partOfDayFromString(u"x") == ForecastEntry::PartOfDay::Unknown);
+}
+
 void WeatherDataTest::initTestCase()
 {
     // Convert UTC timestamp to QDateTime format
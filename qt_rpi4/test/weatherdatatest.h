@@ -22,6 +22,8 @@ private slots:
     void testConstructorWithAllData_data();
     void testConstructorWithDataMissing();
     void testConstructorWithDataMissing_data();
+    void testEntryAdapter();
+    void testQuantisedValues();
 
     // Define methodes that are automatically invoked by the test framework
     void initTestCase(); // Will be called before the first test function is executed
@@ -2,6 +2,8 @@
 #include <weathermodel.h>
 #include <weatherfetcher.h>
 #include <configmanager.h>
+#include <configkey.h>
+#include <configcache.h>
 #include <MockNetworkAccessManager.hpp>
 
 
@@ -18,11 +20,11 @@ void WeatherFetcherTest::testWeatherRequest()
     WeatherModel weatherModel;
 
     // Get the API key from the config.ini file
-    auto apiKey = ConfigManager::instance().getValue("Weather/OpenWeatherApiKey");
-    qDebug() << "api key:" << apiKey.toString();
+    ConfigKey<QString> apiKey{"Weather/OpenWeatherApiKey"};
+    qDebug() << "api key:" << apiKey.value();
 
     // Create a WeatherFetcher instance for testing
-    WeatherFetcher weatherFetcher(&mockNam, weatherModel, apiKey.toString());
+    WeatherFetcher weatherFetcher(&mockNam, weatherModel, apiKey.value());
 
     mockNam.whenGet(QUrl("https://api.openweathermap.org/")).has( MockNetworkAccess::Predicates::UrlMatching(QRegularExpression(".*openweathermap.org.*"))).reply().withBody(m_jsonData);
 
@@ -32,10 +34,10 @@ void WeatherFetcherTest::testWeatherRequest()
 
 
     // Call the method under test by requesting weather data
-    auto latitude = ConfigManager::instance().getValue("Weather/Latitude");
-    auto longitude = ConfigManager::instance().getValue("Weather/Longitude");
-    weatherFetcher.setLatitude(latitude.toDouble());
-    weatherFetcher.setLongitude(longitude.toDouble());
+    ConfigKey<double> latitude{"Weather/Latitude"};
+    ConfigKey<double> longitude{"Weather/Longitude"};
+    weatherFetcher.setLatitude(latitude.value());
+    weatherFetcher.setLongitude(longitude.value());
     weatherFetcher.startFetching(1000); // Fetch the current weather every 1000 milliseconds
 
     // Verify emitted signals
@@ -54,6 +56,34 @@ void WeatherFetcherTest::testNetworkError()
 
 }
 
+void WeatherFetcherTest::testEmptyForecastKeepsData()
+{
+    WeatherModel weatherModel;
+    {
+        MockNetworkAccess::Manager<QNetworkAccessManager> mockNam;
+        mockNam.whenGet(QUrl("https://api.openweathermap.org/")).has(MockNetworkAccess::Predicates::UrlMatching(QRegularExpression(".*openweathermap.org.*"))).reply().withBody(m_jsonData);
+        WeatherFetcher weatherFetcher(&mockNam, weatherModel, "test");
+        QSignalSpy dataUpdatedSpy(&weatherFetcher, &WeatherFetcher::dataUpdated);
+        weatherFetcher.startFetching(1000);
+        QVERIFY2(dataUpdatedSpy.wait(), "dataUpdated signal not emitted");
+        weatherFetcher.stopFetching();
+    }
+    QCOMPARE(weatherModel.rowCount(), 40);
+
+    // A valid reply without entries is reported like a broken one, the forecast stays
+    MockNetworkAccess::Manager<QNetworkAccessManager> mockNam;
+    mockNam.whenGet(QUrl("https://api.openweathermap.org/")).has(MockNetworkAccess::Predicates::UrlMatching(QRegularExpression(".*openweathermap.org.*"))).reply().withBody(QByteArray("{\"cod\":\"200\",\"cnt\":0,\"list\":[],\"city\":{\"name\":\"Berlin\"}}"));
+    WeatherFetcher weatherFetcher(&mockNam, weatherModel, "test");
+    QSignalSpy dataUpdatedSpy(&weatherFetcher, &WeatherFetcher::dataUpdated);
+    QSignalSpy networkErrorSpy(&weatherFetcher, &WeatherFetcher::networkError);
+    weatherFetcher.startFetching(1000);
+    QVERIFY2(networkErrorSpy.wait(), "networkError signal not emitted");
+    QCOMPARE(networkErrorSpy.first().first().value<QNetworkReply::NetworkError>(), QNetworkReply::UnknownContentError);
+    QVERIFY(dataUpdatedSpy.isEmpty());
+    QCOMPARE(weatherModel.rowCount(), 40);
+    QCOMPARE(weatherModel.data(weatherModel.index(0), WeatherModel::WeatherMainRole).toString(), "Clouds");
+}
+
 void WeatherFetcherTest::initTestCase()
 {
     // Get test data from a external JSON file
@@ -65,9 +95,15 @@ void WeatherFetcherTest::initTestCase()
     }
     m_jsonData = file.readAll();
 
-    // Initialise the ConfigManager
+    // Initialise the ConfigManager with a config of its own, the requests go to the mock anyway
+    QFile configFile("temp_weatherfetcher_config.txt");
+    if (configFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        configFile.write("[Weather]\nOpenWeatherApiKey=test\nLatitude=52.52\nLongitude=13.40\n");
+        configFile.close();
+    }
     try {
-        ConfigManager::instance().initialise("/home/parallels/QtProjects/qt-green-oasis/qt_rpi4/resources/config/config.ini");
+        ConfigManager::instance().initialise("temp_weatherfetcher_config.txt");
     } catch (const std::exception &e) {
         qWarning() << "Error: " << this << e.what();
     }
@@ -76,7 +112,8 @@ void WeatherFetcherTest::initTestCase()
 
 void WeatherFetcherTest::cleanupTestCase()
 {
-
+    QFile::remove("temp_weatherfetcher_config.txt");
+    QFile::remove(ConfigCache::cacheFileName("temp_weatherfetcher_config.txt"));
 }
 
 void WeatherFetcherTest::init()
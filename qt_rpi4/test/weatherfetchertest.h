@@ -20,6 +20,7 @@ private slots:
     // Define own test functions
     void testWeatherRequest();
     void testNetworkError();
+    void testEmptyForecastKeepsData();
 
     // Define methodes that are automatically invoked by the test framework
     void initTestCase(); // Will be called before the first test function is executed
@@ -12,20 +12,13 @@ WeatherModelTest::~WeatherModelTest()
     delete m_model;
 }
 
-// This method will be invoked by the test framework before the first test function is executed
-void WeatherModelTest::populateWeatherDataList(QJsonObject obj, QString cityName)
+void WeatherModelTest::populateEntries(QJsonObject obj)
 {
     QJsonArray list = obj["list"].toArray();
-    bool isCurrentWeather = true;
     for (const QJsonValue& item : list)
     {
-        // Convert the item to a object and use date & time as the object name
-        QJsonObject dataItem = item.toObject();
-        QString dataItemName = dataItem["dt_txt"].toString();
-        // Create a new weather data object and append it to the weather data list
-        WeatherData* weatherData = new WeatherData(dataItemName, dataItem, cityName, isCurrentWeather);
-        m_weatherDataList.append(weatherData);
-        isCurrentWeather = false;
+        // The first entry is the current weather
+        m_entries.append(ForecastEntry::fromJson(item.toObject(), m_entries.isEmpty()));
     }
 }
 
@@ -58,7 +51,6 @@ void WeatherModelTest::initTestCase()
     }
 
     // Get the city name
-    QString cityName;
     if (!obj.contains("city") || !obj["city"].isObject())
     {
         qWarning() << this << "JSON does not contain a 'city' object!";
@@ -67,54 +59,76 @@ void WeatherModelTest::initTestCase()
     else
     {
         QJsonObject cityObject = obj["city"].toObject();
-        cityName = cityObject["name"].toString();
+        m_cityName = cityObject["name"].toString();
     }
 
-    // Create WeatherData objects and populate them with the retrieved data
-    populateWeatherDataList(obj, cityName);
-
-    // Pass the created list to the model which will take ownership for all WeatherData objects
-    m_model->setWeatherData(m_weatherDataList);
+    // Extract the entries and pass a copy of them to the model
+    populateEntries(obj);
+    m_model->setForecast(m_cityName, m_entries);
 
 }
 
 // This method will be invoked by the test framework after the last test function was executed
 void WeatherModelTest::cleanupTestCase()
 {
-    /*
-     * Note: Don't use qDeleteAll(m_weatherDataList) here!!!
-     * After invoking weatherModel.setWeatherData(QList<WeatherData*> newData),
-     * the model takes ownership of these weather data objects and deletes them
-     * when the model gets destyoyed (deconstructed). Here, in this cleanupTestCase()
-     * method we only remove these items from the list but we DO NOT delete them.
-     * Double deletion of objects can cause unpredicted behaviour and crash the
-     * application!
-    */
-    m_weatherDataList.clear(); // Remove items from the list
+    m_entries.clear();
 }
 
 void WeatherModelTest::testRowCount()
 {
-    QCOMPARE(m_model->rowCount(), m_weatherDataList.count());
+    QCOMPARE(m_model->rowCount(), m_entries.count());
 }
 
 
 void WeatherModelTest::testData()
 {
-    for (int i = 0; i < m_weatherDataList.count(); i++)
+    for (int i = 0; i < m_entries.count(); i++)
     {
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherMainRole).toString(), m_weatherDataList[i]->weatherMain());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherDescriptionRole).toString(), m_weatherDataList[i]->weatherDescription());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::CityNameRole).toString(), m_weatherDataList[i]->cityName());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::IsCurrentWeatherRole).toBool(), m_weatherDataList[i]->isCurrentWeather());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherIconRole).toString(), m_weatherDataList[i]->weatherIcon());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::TemperatureRole).toDouble(), m_weatherDataList[i]->mainTemp());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::MinTemperatureRole).toDouble(), m_weatherDataList[i]->mainTempMin());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::MaxTemperatureRole).toDouble(), m_weatherDataList[i]->mainTempMax());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WindSpeedRole).toDouble(), m_weatherDataList[i]->windSpeed());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::Rain3hRole).toDouble(), m_weatherDataList[i]->rain3h());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::Snow3hRole).toDouble(), m_weatherDataList[i]->snow3h());
-        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::PopRole).toDouble(), m_weatherDataList[i]->pop());
+        const ForecastEntry& entry = m_entries[i];
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherMainRole).toString(), entry.weatherMain());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherDescriptionRole).toString(), entry.weatherDescription());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::CityNameRole).toString(), m_cityName);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::IsCurrentWeatherRole).toBool(), i == 0);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::DateAndTimeRole).toDateTime(), entry.dateAndTime());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WeatherIconRole).toString(), entry.weatherIcon());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::TemperatureRole).toDouble(), entry.mainTemp);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::MinTemperatureRole).toDouble(), entry.mainTempMin);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::MaxTemperatureRole).toDouble(), entry.mainTempMax);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WindSpeedRole).toDouble(), entry.windSpeed);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::Rain3hRole).toDouble(), entry.rain3h);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::Snow3hRole).toDouble(), entry.snow3h);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::PopRole).toDouble(), entry.pop);
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::FeelsLikeRole).toDouble(), entry.feelsLike());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::HumidityRole).toInt(), entry.humidity());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::PressureRole).toInt(), entry.pressure());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::CloudsRole).toInt(), entry.clouds());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WindDegRole).toInt(), entry.windDeg());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::WindGustRole).toDouble(), entry.windGust());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::VisibilityRole).toInt(), entry.visibility());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::IsDaytimeRole).toBool(), entry.isDaytime());
+        QCOMPARE(m_model->data(m_model->index(i), WeatherModel::PresentFieldsRole).toInt(), entry.presentFields());
     }
 }
 
+void WeatherModelTest::testGet()
+{
+    if (m_entries.isEmpty())
+        QSKIP("test_data_weather.json couldn't be loaded");
+    // The values of the first entry of test_data_weather.json
+    const ForecastEntry current = m_model->get(0);
+    QVERIFY(current.isCurrent);
+    QCOMPARE(current.dt, qint64(1701540000));
+    QCOMPARE(current.weatherId(), QString("804"));
+    QCOMPARE(current.weatherMain(), QString("Clouds"));
+    QCOMPARE(current.mainTemp, -4.89);
+    QCOMPARE(current.pop, 0.35);
+    QCOMPARE(current.feelsLike(), -8.87);
+    QCOMPARE(current.humidity(), 94);
+    QCOMPARE(current.pressure(), 1014);
+    QCOMPARE(m_model->currentMainTemp(), -4.89);
+    QCOMPARE(m_model->currentCityName(), m_cityName);
+
+    // Out of range
+    QCOMPARE(m_model->get(m_entries.count()).dt, qint64(0));
+    QVERIFY(!m_model->data(m_model->index(m_entries.count()), WeatherModel::TemperatureRole).isValid());
+}
@@ -11,7 +11,7 @@
 #include <QJsonValue>
 #include <QJsonDocument>
 #include <QJsonParseError>
-#include <weatherdata.h>
+#include <forecastentry.h>
 #include <weathermodel.h>
 
 class WeatherModelTest : public QObject
@@ -29,11 +29,13 @@ private slots:
 
     void testRowCount();
     void testData();
+    void testGet();
 
 private:
-    QList<WeatherData*> m_weatherDataList;
+    QList<ForecastEntry> m_entries;
+    QString m_cityName;
     WeatherModel* m_model;
-    void populateWeatherDataList(QJsonObject obj, QString cityName);
+    void populateEntries(QJsonObject obj);
 };
 
 #endif // WEATHERMODELTEST_H